@@ -23,6 +23,7 @@
  * THE SOFTWARE.
  */
 #include <cctype>
+#include <limits>
 
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
@@ -359,14 +360,9 @@ namespace graphene { namespace app {
 
        if(_app.is_plugin_enabled("postgres_indexer")) {
           auto pg = _app.get_plugin<postgres_indexer::postgres_indexer_plugin>("postgres_indexer");
-          if(pg.get()->get_running_mode() != postgres_indexer::mode::only_save) {
-             if(!_app.elasticsearch_thread)
-                _app.elasticsearch_thread = std::make_shared<fc::thread>("postgres_indexer");
-
-             return _app.elasticsearch_thread->async([&pg, &account, &stop, &limit, &start]() {
-                return pg->get_account_history(account, stop, limit, start);
-             }, "thread invoke for postgres_indexer").wait();
-          }
+          // the plugin runs the query on one of its own connection threads
+          if(pg.get()->get_running_mode() != postgres_indexer::mode::only_save)
+             return pg->get_account_history(account, stop, limit, start);
        }
 
        if(_app.is_plugin_enabled("elasticsearch")) {
@@ -418,27 +414,33 @@ namespace graphene { namespace app {
        try {
           account = database_api.get_account_id_from_string(account_id_or_name);
        } catch(...) { return result; }
-       const auto& stats = account(db).statistics(db);
-       if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
-       const account_transaction_history_object* node = &stats.most_recent_op(db);
-       if( start == operation_history_id_type() )
-          start = node->operation_id;
+       if( operation_type < 0 || operation_type > std::numeric_limits<uint16_t>::max() )
+          return result;
+       const uint16_t op_type = static_cast<uint16_t>( operation_type );
 
-       while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
-       {
-          if( node->operation_id.instance.value <= start.instance.value ) {
+       const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
+       const auto& by_type_idx = hist_idx.indices().get<by_type_seq>();
 
-             if(node->operation_id(db).op.which() == operation_type)
-               result.push_back( node->operation_id(db) );
-          }
-          if( node->next == account_transaction_history_id_type() )
-             node = nullptr;
-          else node = &node->next(db);
+       // the sequence numbers of an account follow its operation ids, so the latest entry at or before
+       // start bounds the walk through the operations of the requested type
+       auto itr = by_type_idx.upper_bound( boost::make_tuple( account, op_type ) );
+       if( start != operation_history_id_type() )
+       {
+          const auto& by_op_idx = hist_idx.indices().get<by_op>();
+          auto op_itr = by_op_idx.upper_bound( boost::make_tuple( account, start ) );
+          if( op_itr == by_op_idx.begin() || (--op_itr)->account != account )
+             return result;
+          itr = by_type_idx.upper_bound( boost::make_tuple( account, op_type, op_itr->sequence ) );
        }
-       if( stop.instance.value == 0 && result.size() < limit ) {
-          auto head = db.find(account_transaction_history_id_type());
-          if (head != nullptr && head->account == account && head->operation_id(db).op.which() == operation_type)
-            result.push_back(head->operation_id(db));
+
+       while( itr != by_type_idx.begin() && result.size() < limit )
+       {
+          --itr;
+          if( itr->account != account || itr->op_type != op_type )
+             break;
+          if( stop != operation_history_id_type() && itr->operation_id.instance.value <= stop.instance.value )
+             break;
+          result.push_back( itr->operation_id(db) );
        }
        return result;
     }
@@ -503,21 +505,51 @@ namespace graphene { namespace app {
                   ("configured_limit", configured_limit) );
 
        history_operation_detail result;
-       vector<operation_history_object> objs = get_relative_account_history( account_id_or_name, start, limit,
-                                                                             limit + start - 1 );
-       result.total_count = objs.size();
-
        if( operation_types.empty() )
-          result.operation_history_objs = std::move(objs);
-       else
        {
-          for( const operation_history_object &o : objs )
-          {
-             if( operation_types.find(o.op.which()) != operation_types.end() ) {
-                result.operation_history_objs.push_back(o);
-             }
-          }
+          result.operation_history_objs = get_relative_account_history( account_id_or_name, start, limit,
+                                                                        limit + start - 1 );
+          result.total_count = result.operation_history_objs.size();
+          return result;
+       }
+
+       FC_ASSERT( _app.chain_database() );
+       const auto& db = *_app.chain_database();
+       account_id_type account;
+       try {
+          account = database_api.get_account_id_from_string(account_id_or_name);
+       } catch(...) { return result; }
+       const auto& stats = account(db).statistics(db);
+
+       // the same window of sequence numbers get_relative_account_history() would return
+       uint64_t window_last = limit + start - 1;
+       window_last = ( window_last == 0 ) ? stats.total_ops : std::min( stats.total_ops, window_last );
+       const uint64_t window_first = start;
+       if( window_last < window_first || window_last <= stats.removed_ops || limit == 0 )
+          return result;
+
+       const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
+       const auto& by_seq_idx = hist_idx.indices().get<by_seq>();
+       result.total_count = std::distance( by_seq_idx.lower_bound( boost::make_tuple( account, window_first ) ),
+                                           by_seq_idx.upper_bound( boost::make_tuple( account, window_last ) ) );
+
+       // each requested type is a range of its own index, merged back into sequence order
+       const auto& by_type_idx = hist_idx.indices().get<by_type_seq>();
+       vector<const account_transaction_history_object*> entries;
+       for( uint16_t op_type : operation_types )
+       {
+          auto itr = by_type_idx.lower_bound( boost::make_tuple( account, op_type, window_first ) );
+          auto end = by_type_idx.upper_bound( boost::make_tuple( account, op_type, window_last ) );
+          for( ; itr != end; ++itr )
+             entries.push_back( &*itr );
        }
+       std::sort( entries.begin(), entries.end(),
+                  []( const account_transaction_history_object* a, const account_transaction_history_object* b ) {
+          return a->sequence > b->sequence;
+       } );
+       result.operation_history_objs.reserve( entries.size() );
+       for( const auto* entry : entries )
+          result.operation_history_objs.push_back( entry->operation_id(db) );
 
        return result;
     }
@@ -572,28 +604,24 @@ namespace graphene { namespace app {
 
        asset_id_type asset_id = database_api.get_asset_id_from_string( asset );
        const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-       auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
+
+       // balances of an asset are sorted from the largest down, so the holders come before the zero balances
+       auto first = bal_idx.lower_bound( boost::make_tuple( asset_id ) );
+       auto end = bal_idx.lower_bound( boost::make_tuple( asset_id, share_type(0) ) );
+       const auto first_rank = bal_idx.rank( first );
 
        vector<account_asset_balance> result;
+       if( start >= bal_idx.rank( end ) - first_rank )
+          return result;
 
-       uint32_t index = 0;
-       for( const account_balance_object& bal : boost::make_iterator_range( range.first, range.second ) )
+       for( auto itr = bal_idx.nth( first_rank + start ); itr != end && result.size() < limit; ++itr )
        {
-          if( result.size() >= limit )
-             break;
-
-          if( bal.balance.value == 0 )
-             continue;
-
-          if( index++ < start )
-             continue;
-
-          const auto account = _db.find(bal.owner);
+          const auto account = _db.find(itr->owner);
 
           account_asset_balance aab;
           aab.name       = account->name;
           aab.account_id = account->id;
-          aab.amount     = bal.balance.value;
+          aab.amount     = itr->balance.value;
 
           result.push_back(aab);
        }
@@ -602,33 +630,18 @@ namespace graphene { namespace app {
     }
     // get number of asset holders.
     int asset_api::get_asset_holders_count( std::string asset ) const {
-       const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
        asset_id_type asset_id = database_api.get_asset_id_from_string( asset );
-       auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-
-       int count = boost::distance(range) - 1;
-
-       return count;
+       return holders_index().get_holder_count( asset_id );
     }
     // function to get vector of system assets with holders count.
     vector<asset_holders> asset_api::get_all_asset_holders() const {
        vector<asset_holders> result;
-       vector<asset_id_type> total_assets;
+       const auto& holders = holders_index();
        for( const asset_object& asset_obj : _db.get_index_type<asset_index>().indices() )
        {
-          const auto& dasset_obj = asset_obj.dynamic_asset_data_id(_db);
-
-          asset_id_type asset_id;
-          asset_id = dasset_obj.id;
-
-          const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-          auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-
-          int count = boost::distance(range) - 1;
-
           asset_holders ah;
-          ah.asset_id       = asset_id;
-          ah.count     = count;
+          ah.asset_id  = asset_id_type( asset_obj.id );
+          ah.count     = holders.get_holder_count( ah.asset_id );
 
           result.push_back(ah);
        }
@@ -636,6 +649,11 @@ namespace graphene { namespace app {
        return result;
     }
 
+    const asset_holders_index& asset_api::holders_index() const
+    {
+       return _db.get_index_type< primary_index< account_balance_index > >().get_secondary_index< asset_holders_index >();
+    }
+
    // orders_api
    flat_set<uint16_t> orders_api::get_tracked_groups()const
    {
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+
+#include <graphene/app/api_read_pool.hpp>
+
+#include <map>
+#include <mutex>
+
+namespace graphene { namespace app {
+
+namespace {
+
+std::mutex& registry_mutex()
+{
+   static std::mutex m;
+   return m;
+}
+
+std::map<const chain::database*, std::shared_ptr<api_read_pool>>& registry()
+{
+   static std::map<const chain::database*, std::shared_ptr<api_read_pool>> pools;
+   return pools;
+}
+
+} // anonymous namespace
+
+api_read_pool::api_read_pool( chain::database& db, uint32_t threads )
+   : _db( db )
+{
+   FC_ASSERT( threads > 0, "The API read pool needs at least one thread" );
+   _threads.reserve( threads );
+   for( uint32_t i = 0; i < threads; ++i )
+      _threads.emplace_back( new fc::thread( "api_read_" + std::to_string( i ) ) );
+}
+
+api_read_pool::~api_read_pool()
+{
+   for( auto& thread : _threads )
+      thread->quit();
+}
+
+std::shared_ptr<api_read_pool> api_read_pool::start( chain::database& db, uint32_t threads )
+{
+   auto pool = std::make_shared<api_read_pool>( db, threads );
+   {
+      std::lock_guard<std::mutex> lock( registry_mutex() );
+      FC_ASSERT( registry().find( &db ) == registry().end(), "An API read pool already serves this database" );
+      registry()[&db] = pool;
+   }
+   db.enable_concurrent_reads( true );
+   ilog( "Serving read-only API queries on ${n} threads", ("n", threads) );
+   return pool;
+}
+
+void api_read_pool::stop( chain::database& db )
+{
+   std::shared_ptr<api_read_pool> pool;
+   {
+      std::lock_guard<std::mutex> lock( registry_mutex() );
+      auto itr = registry().find( &db );
+      if( itr == registry().end() )
+         return;
+      pool = std::move( itr->second );
+      registry().erase( itr );
+   }
+   db.enable_concurrent_reads( false );
+}
+
+std::shared_ptr<api_read_pool> api_read_pool::find( const chain::database& db )
+{
+   std::lock_guard<std::mutex> lock( registry_mutex() );
+   auto itr = registry().find( &db );
+   return itr == registry().end() ? nullptr : itr->second;
+}
+
+} } // graphene::app
@@ -25,6 +25,7 @@
  */
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_read_pool.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/plugin.hpp>
 
@@ -498,6 +499,19 @@ void application_impl::open_chain_database() const
       _chain_db->enable_standby_votes_tracking( _options->at("enable-standby-votes-tracking").as<bool>() );
    }
 
+   if( _options->count("replay-lookahead") > 0 && _options->count("replay-threads") > 0 )
+   {
+      _chain_db->set_replay_pipeline( _options->at("replay-lookahead").as<uint32_t>(),
+                                      _options->at("replay-threads").as<uint32_t>() );
+   }
+
+   if( _options->count("object-database-checkpoint-interval") > 0
+         && _options->count("object-database-compaction-interval") > 0 )
+   {
+      _chain_db->enable_object_checkpoints( _options->at("object-database-checkpoint-interval").as<uint32_t>(),
+                                            _options->at("object-database-compaction-interval").as<uint32_t>() );
+   }
+
    if( _options->count("replay-blockchain") > 0 || _options->count("revalidate-blockchain") > 0 )
       _chain_db->wipe( _data_dir / "blockchain", false );
 
@@ -546,6 +560,9 @@ void application_impl::startup()
 
    open_chain_database();
 
+   if( _options->count("api-read-threads") > 0 && _options->at("api-read-threads").as<uint32_t>() > 0 )
+      api_read_pool::start( *_chain_db, _options->at("api-read-threads").as<uint32_t>() );
+
    startup_plugins();
 
    if( enable_p2p_network && _active_plugins.find( "delayed_node" ) == _active_plugins.end() )
@@ -768,13 +785,21 @@ message application_impl::get_item(const item_id& id)
   // ilog("Request for item ${id}", ("id", id));
    if( id.item_type == graphene::net::block_message_type )
    {
-      auto opt_block = _chain_db->fetch_block_by_id(id.item_hash);
-      if( !opt_block )
+      // A block_message is the packed block followed by its id, so it is assembled from the stored bytes
+      // without unpacking the block
+      message result;
+      result.msg_type = graphene::net::block_message_type;
+      const block_id_type block_id = id.item_hash;
+      const bool found = _chain_db->fetch_packed_block_by_id( block_id, result.data );
+      if( !found )
          elog("Couldn't find block ${id} -- corresponding ID in our chain is ${id2}",
               ("id", id.item_hash)("id2", _chain_db->get_block_id_for_num(block_header::num_from_id(id.item_hash))));
-      FC_ASSERT( opt_block.valid() );
-      // ilog("Serving up block #${num}", ("num", opt_block->block_num()));
-      return block_message(std::move(*opt_block));
+      FC_ASSERT( found );
+      // ilog("Serving up block #${num}", ("num", block_header::num_from_id(block_id)));
+      const auto packed_id = fc::raw::pack( block_id );
+      result.data.insert( result.data.end(), packed_id.begin(), packed_id.end() );
+      result.size = (uint32_t)result.data.size();
+      return result;
    }
    return trx_message( _chain_db->get_recent_transaction( id.item_hash ) );
 } FC_CAPTURE_AND_RETHROW( (id) ) }
@@ -1028,6 +1053,9 @@ void application_impl::shutdown()
       _websocket_server.reset();
    // TODO wait until all connections are closed and messages handled?
 
+   if( _chain_db )
+      api_read_pool::stop( *_chain_db );
+
    // plugins E.G. witness_plugin may send data to p2p network, so shutdown them first
    ilog( "Shutting down plugins" );
    shutdown_plugins();
@@ -1151,6 +1179,21 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("enable-standby-votes-tracking", bpo::value<bool>()->implicit_value(true),
           "Whether to enable tracking of votes of standby witnesses and committee members. "
           "Set it to true to provide accurate data to API clients, set to false for slightly better performance.")
+         ("api-read-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads serving read-only database API queries concurrently with block application, "
+          "0 serves them on the thread which applies blocks")
+         ("replay-lookahead", bpo::value<uint32_t>()->default_value(256),
+          "Number of blocks read and decoded ahead of the block being applied during a replay")
+         ("replay-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads decoding blocks and verifying their signatures during a replay, "
+          "0 for one per CPU core")
+         ("object-database-checkpoint-interval", bpo::value<uint32_t>()->default_value(0),
+          "Number of irreversible blocks between incremental object database checkpoints, which bound the replay "
+          "needed after a crash. 0 (the default) disables them and only dumps the full object database on clean "
+          "shutdown.")
+         ("object-database-compaction-interval", bpo::value<uint32_t>()->default_value(100),
+          "Number of incremental checkpoints after which their logs are merged into the full object database dump, "
+          "0 never merges them")
          ("api-limit-get-account-history-operations",
           bpo::value<uint64_t>()->default_value(default_opts.api_limit_get_account_history_operations),
           "For history_api::get_account_history_operations to set max limit value")
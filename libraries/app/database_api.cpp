@@ -58,19 +58,9 @@ database_api_impl::database_api_impl( graphene::chain::database& db, const appli
 :_db(db), _app_options(app_options)
 {
    dlog("creating database api ${x}", ("x",int64_t(this)) );
-   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids,
-                                                    const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_new(ids, impacted_accounts);
-                                });
-   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids,
-                                                           const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_changed(ids, impacted_accounts);
-                                });
-   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids,
-                                                            const vector<const object*>& objs,
-                                                            const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_removed(ids, objs, impacted_accounts);
-                                });
+   _hub = subscription_hub::get( _db );
+   _subscriber_id = _hub->add_subscriber();
+   _read_pool = api_read_pool::find( _db );
    _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
 
    _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction& trx ){
@@ -91,6 +81,7 @@ database_api_impl::database_api_impl( graphene::chain::database& db, const appli
 database_api_impl::~database_api_impl()
 {
    dlog("freeing database api ${x}", ("x",int64_t(this)) );
+   _hub->remove_subscriber( _subscriber_id );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -101,7 +92,7 @@ database_api_impl::~database_api_impl()
 
 fc::variants database_api::get_objects( const vector<object_id_type>& ids, optional<bool> subscribe )const
 {
-   return my->get_objects( ids, subscribe );
+   return my->read( [&]() { return my->get_objects( ids, subscribe ); } );
 }
 
 fc::variants database_api_impl::get_objects( const vector<object_id_type>& ids, optional<bool> subscribe )const
@@ -146,8 +137,9 @@ void database_api_impl::set_subscribe_callback( std::function<void(const variant
 
    cancel_all_subscriptions(false, false);
 
-   _subscribe_callback = cb;
-   _notify_remove_create = notify_remove_create;
+   // the hub keeps the callback, queries only need to know whether there is one
+   _subscriptions_enabled = bool( cb );
+   _hub->set_callback( _subscriber_id, cb, notify_remove_create );
 }
 
 void database_api::set_auto_subscription( bool enable )
@@ -188,15 +180,15 @@ void database_api::cancel_all_subscriptions()
 void database_api_impl::cancel_all_subscriptions( bool reset_callback, bool reset_market_subscriptions )
 {
    if ( reset_callback )
-      _subscribe_callback = std::function<void(const fc::variant&)>();
+      _subscriptions_enabled = false;
 
    if ( reset_market_subscriptions )
+   {
       _market_subscriptions.clear();
+      disconnect_market_signals();
+   }
 
-   _notify_remove_create = false;
-   _subscribed_accounts.clear();
-   static fc::bloom_parameters param(10000, 1.0/100, 1024*8*8*2);
-   _subscribe_filter = fc::bloom_filter(param);
+   _hub->reset( _subscriber_id, reset_callback );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -207,7 +199,7 @@ void database_api_impl::cancel_all_subscriptions( bool reset_callback, bool rese
 
 optional<block_header> database_api::get_block_header(uint32_t block_num)const
 {
-   return my->get_block_header( block_num );
+   return my->read( [&]() { return my->get_block_header( block_num ); } );
 }
 
 optional<block_header> database_api_impl::get_block_header(uint32_t block_num) const
@@ -219,7 +211,7 @@ optional<block_header> database_api_impl::get_block_header(uint32_t block_num) c
 }
 map<uint32_t, optional<block_header>> database_api::get_block_header_batch(const vector<uint32_t> block_nums)const
 {
-   return my->get_block_header_batch( block_nums );
+   return my->read( [&]() { return my->get_block_header_batch( block_nums ); } );
 }
 
 map<uint32_t, optional<block_header>> database_api_impl::get_block_header_batch(
@@ -235,7 +227,7 @@ map<uint32_t, optional<block_header>> database_api_impl::get_block_header_batch(
 
 optional<signed_block> database_api::get_block(uint32_t block_num)const
 {
-   return my->get_block( block_num );
+   return my->read( [&]() { return my->get_block( block_num ); } );
 }
 
 optional<signed_block> database_api_impl::get_block(uint32_t block_num)const
@@ -245,7 +237,7 @@ optional<signed_block> database_api_impl::get_block(uint32_t block_num)const
 
 processed_transaction database_api::get_transaction( uint32_t block_num, uint32_t trx_in_block )const
 {
-   return my->get_transaction( block_num, trx_in_block );
+   return my->read( [&]() { return my->get_transaction( block_num, trx_in_block ); } );
 }
 
 processed_transaction database_api_impl::get_transaction(uint32_t block_num, uint32_t trx_num)const
@@ -258,7 +250,7 @@ processed_transaction database_api_impl::get_transaction(uint32_t block_num, uin
 
 optional<signed_transaction> database_api::get_recent_transaction_by_id( const transaction_id_type& id )const
 {
-   return my->get_recent_transaction_by_id( id );
+   return my->read( [&]() { return my->get_recent_transaction_by_id( id ); } );
 }
 
 optional<signed_transaction> database_api_impl::get_recent_transaction_by_id(const transaction_id_type& id )const
@@ -278,7 +270,7 @@ optional<signed_transaction> database_api_impl::get_recent_transaction_by_id(con
 
 chain_property_object database_api::get_chain_properties()const
 {
-   return my->get_chain_properties();
+   return my->read( [&]() { return my->get_chain_properties(); } );
 }
 
 chain_property_object database_api_impl::get_chain_properties()const
@@ -288,7 +280,7 @@ chain_property_object database_api_impl::get_chain_properties()const
 
 global_property_object database_api::get_global_properties()const
 {
-   return my->get_global_properties();
+   return my->read( [&]() { return my->get_global_properties(); } );
 }
 
 global_property_object database_api_impl::get_global_properties()const
@@ -318,7 +310,7 @@ chain_id_type database_api_impl::get_chain_id()const
 
 dynamic_global_property_object database_api::get_dynamic_global_properties()const
 {
-   return my->get_dynamic_global_properties();
+   return my->read( [&]() { return my->get_dynamic_global_properties(); } );
 }
 
 dynamic_global_property_object database_api_impl::get_dynamic_global_properties()const
@@ -328,7 +320,7 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
 
 witness_schedule_object database_api::get_witness_schedule()const
 {
-   return my->get_witness_schedule();
+   return my->read( [&]() { return my->get_witness_schedule(); } );
 }
 
 witness_schedule_object database_api_impl::get_witness_schedule()const
@@ -344,7 +336,7 @@ witness_schedule_object database_api_impl::get_witness_schedule()const
 
 vector<flat_set<account_id_type>> database_api::get_key_references( vector<public_key_type> key )const
 {
-   return my->get_key_references( key );
+   return my->read( [&]() { return my->get_key_references( key ); } );
 }
 
 /**
@@ -405,7 +397,7 @@ vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<
 
 bool database_api::is_public_key_registered(string public_key) const
 {
-    return my->is_public_key_registered(public_key);
+    return my->read( [&]() { return my->is_public_key_registered(public_key); } );
 }
 
 bool database_api_impl::is_public_key_registered(string public_key) const
@@ -445,13 +437,13 @@ bool database_api_impl::is_public_key_registered(string public_key) const
 
 account_id_type database_api::get_account_id_from_string(const std::string& name_or_id)const
 {
-   return my->get_account_from_string( name_or_id )->id;
+   return my->read( [&]() { return my->get_account_from_string( name_or_id )->id; } );
 }
 
 vector<optional<account_object>> database_api::get_accounts( const vector<std::string>& account_names_or_ids,
                                                              optional<bool> subscribe )const
 {
-   return my->get_accounts( account_names_or_ids, subscribe );
+   return my->read( [&]() { return my->get_accounts( account_names_or_ids, subscribe ); } );
 }
 
 vector<optional<account_object>> database_api_impl::get_accounts( const vector<std::string>& account_names_or_ids,
@@ -475,7 +467,7 @@ vector<optional<account_object>> database_api_impl::get_accounts( const vector<s
 std::map<string,full_account> database_api::get_full_accounts( const vector<string>& names_or_ids,
                                                                optional<bool> subscribe )
 {
-   return my->get_full_accounts( names_or_ids, subscribe );
+   return my->read( [&]() { return my->get_full_accounts( names_or_ids, subscribe ); } );
 }
 
 std::map<std::string, full_account> database_api_impl::get_full_accounts( const vector<std::string>& names_or_ids,
@@ -499,8 +491,8 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
 
       if( to_subscribe )
       {
-         if(_subscribed_accounts.size() < 100) {
-            _subscribed_accounts.insert( account->get_id() );
+         if( _hub->subscribed_account_count( _subscriber_id ) < 100 ) {
+            _hub->subscribe_to_account( _subscriber_id, account->get_id() );
             subscribe_to_item( account->id );
          }
       }
@@ -659,7 +651,7 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
 
 optional<account_object> database_api::get_account_by_name( string name )const
 {
-   return my->get_account_by_name( name );
+   return my->read( [&]() { return my->get_account_by_name( name ); } );
 }
 
 optional<account_object> database_api_impl::get_account_by_name( string name )const
@@ -673,7 +665,7 @@ optional<account_object> database_api_impl::get_account_by_name( string name )co
 
 vector<account_id_type> database_api::get_account_references( const std::string account_id_or_name )const
 {
-   return my->get_account_references( account_id_or_name );
+   return my->read( [&]() { return my->get_account_references( account_id_or_name ); } );
 }
 
 vector<account_id_type> database_api_impl::get_account_references( const std::string account_id_or_name )const
@@ -699,7 +691,7 @@ vector<account_id_type> database_api_impl::get_account_references( const std::st
 
 vector<optional<account_object>> database_api::lookup_account_names(const vector<string>& account_names)const
 {
-   return my->lookup_account_names( account_names );
+   return my->read( [&]() { return my->lookup_account_names( account_names ); } );
 }
 
 vector<optional<account_object>> database_api_impl::lookup_account_names(const vector<string>& account_names)const
@@ -711,7 +703,7 @@ map<string,account_id_type> database_api::lookup_accounts( const string& lower_b
                                                            uint32_t limit,
                                                            optional<bool> subscribe )const
 {
-   return my->lookup_accounts( lower_bound_name, limit, subscribe );
+   return my->read( [&]() { return my->lookup_accounts( lower_bound_name, limit, subscribe ); } );
 }
 
 map<string,account_id_type> database_api_impl::lookup_accounts( const string& lower_bound_name,
@@ -745,7 +737,7 @@ map<string,account_id_type> database_api_impl::lookup_accounts( const string& lo
 
 uint64_t database_api::get_account_count()const
 {
-   return my->get_account_count();
+   return my->read( [&]() { return my->get_account_count(); } );
 }
 
 uint64_t database_api_impl::get_account_count()const
@@ -762,7 +754,7 @@ uint64_t database_api_impl::get_account_count()const
 vector<asset> database_api::get_account_balances( const std::string& account_name_or_id,
                                                   const flat_set<asset_id_type>& assets )const
 {
-   return my->get_account_balances( account_name_or_id, assets );
+   return my->read( [&]() { return my->get_account_balances( account_name_or_id, assets ); } );
 }
 
 vector<asset> database_api_impl::get_account_balances( const std::string& account_name_or_id,
@@ -794,12 +786,12 @@ vector<asset> database_api_impl::get_account_balances( const std::string& accoun
 vector<asset> database_api::get_named_account_balances( const std::string& name,
                                                         const flat_set<asset_id_type>& assets )const
 {
-   return my->get_account_balances( name, assets );
+   return my->read( [&]() { return my->get_account_balances( name, assets ); } );
 }
 
 vector<balance_object> database_api::get_balance_objects( const vector<address>& addrs )const
 {
-   return my->get_balance_objects( addrs );
+   return my->read( [&]() { return my->get_balance_objects( addrs ); } );
 }
 
 vector<balance_object> database_api_impl::get_balance_objects( const vector<address>& addrs )const
@@ -827,7 +819,7 @@ vector<balance_object> database_api_impl::get_balance_objects( const vector<addr
 
 vector<ico_balance_object> database_api::get_ico_balance_objects( const vector<string>& addrs )const
 {
-   return my->get_ico_balance_objects( addrs );
+   return my->read( [&]() { return my->get_ico_balance_objects( addrs ); } );
 }
 
 vector<ico_balance_object> database_api_impl::get_ico_balance_objects( const vector<string>& addrs )const
@@ -855,7 +847,7 @@ vector<ico_balance_object> database_api_impl::get_ico_balance_objects( const vec
 
 vector<asset> database_api::get_vested_balances( const vector<balance_id_type>& objs )const
 {
-   return my->get_vested_balances( objs );
+   return my->read( [&]() { return my->get_vested_balances( objs ); } );
 }
 
 vector<asset> database_api_impl::get_vested_balances( const vector<balance_id_type>& objs )const
@@ -873,7 +865,7 @@ vector<asset> database_api_impl::get_vested_balances( const vector<balance_id_ty
 
 vector<vesting_balance_object> database_api::get_vesting_balances( const std::string account_id_or_name )const
 {
-   return my->get_vesting_balances( account_id_or_name );
+   return my->read( [&]() { return my->get_vesting_balances( account_id_or_name ); } );
 }
 
 vector<vesting_balance_object> database_api_impl::get_vesting_balances( const std::string account_id_or_name )const
@@ -901,14 +893,14 @@ vector<vesting_balance_object> database_api_impl::get_vesting_balances( const st
 
 asset_id_type database_api::get_asset_id_from_string(const std::string& symbol_or_id)const
 {
-   return my->get_asset_from_string( symbol_or_id )->id;
+   return my->read( [&]() { return my->get_asset_from_string( symbol_or_id )->id; } );
 }
 
 vector<optional<extended_asset_object>> database_api::get_assets(
       const vector<std::string>& asset_symbols_or_ids,
       optional<bool> subscribe )const
 {
-   return my->get_assets( asset_symbols_or_ids, subscribe );
+   return my->read( [&]() { return my->get_assets( asset_symbols_or_ids, subscribe ); } );
 }
 
 vector<optional<extended_asset_object>> database_api_impl::get_assets(
@@ -932,7 +924,7 @@ vector<optional<extended_asset_object>> database_api_impl::get_assets(
 
 vector<extended_asset_object> database_api::list_assets(const string& lower_bound_symbol, uint32_t limit)const
 {
-   return my->list_assets( lower_bound_symbol, limit );
+   return my->read( [&]() { return my->list_assets( lower_bound_symbol, limit ); } );
 }
 
 vector<extended_asset_object> database_api_impl::list_assets(const string& lower_bound_symbol, uint32_t limit)const
@@ -957,7 +949,7 @@ vector<extended_asset_object> database_api_impl::list_assets(const string& lower
 
 uint64_t database_api::get_asset_count()const
 {
-   return my->get_asset_count();
+   return my->read( [&]() { return my->get_asset_count(); } );
 }
 
 uint64_t database_api_impl::get_asset_count()const
@@ -968,7 +960,7 @@ uint64_t database_api_impl::get_asset_count()const
 vector<extended_asset_object> database_api::get_assets_by_issuer(const std::string& issuer_name_or_id,
                                                                  asset_id_type start, uint32_t limit)const
 {
-   return my->get_assets_by_issuer(issuer_name_or_id, start, limit);
+   return my->read( [&]() { return my->get_assets_by_issuer(issuer_name_or_id, start, limit); } );
 }
 
 vector<extended_asset_object> database_api_impl::get_assets_by_issuer(const std::string& issuer_name_or_id,
@@ -996,7 +988,7 @@ vector<extended_asset_object> database_api_impl::get_assets_by_issuer(const std:
 vector<optional<extended_asset_object>> database_api::lookup_asset_symbols(
                                                          const vector<string>& symbols_or_ids )const
 {
-   return my->lookup_asset_symbols( symbols_or_ids );
+   return my->read( [&]() { return my->lookup_asset_symbols( symbols_or_ids ); } );
 }
 
 vector<optional<extended_asset_object>> database_api_impl::lookup_asset_symbols(
@@ -1013,7 +1005,7 @@ vector<optional<extended_asset_object>> database_api_impl::lookup_asset_symbols(
 
 vector<limit_order_object> database_api::get_limit_orders(std::string a, std::string b, uint32_t limit)const
 {
-   return my->get_limit_orders( a, b, limit );
+   return my->read( [&]() { return my->get_limit_orders( a, b, limit ); } );
 }
 
 vector<limit_order_object> database_api_impl::get_limit_orders( const std::string& a, const std::string& b,
@@ -1034,7 +1026,7 @@ vector<limit_order_object> database_api_impl::get_limit_orders( const std::strin
 vector<limit_order_object> database_api::get_limit_orders_by_account( const string& account_name_or_id,
                               optional<uint32_t> limit, optional<limit_order_id_type> start_id )
 {
-   return my->get_limit_orders_by_account( account_name_or_id, limit, start_id );
+   return my->read( [&]() { return my->get_limit_orders_by_account( account_name_or_id, limit, start_id ); } );
 }
 
 vector<limit_order_object> database_api_impl::get_limit_orders_by_account( const string& account_name_or_id,
@@ -1075,7 +1067,9 @@ vector<limit_order_object> database_api::get_account_limit_orders(
                               const string& account_name_or_id, const string &base, const string &quote,
                               uint32_t limit, optional<limit_order_id_type> ostart_id, optional<price> ostart_price )
 {
-   return my->get_account_limit_orders( account_name_or_id, base, quote, limit, ostart_id, ostart_price );
+   return my->read( [&]() {
+      return my->get_account_limit_orders( account_name_or_id, base, quote, limit, ostart_id, ostart_price );
+   } );
 }
 
 vector<limit_order_object> database_api_impl::get_account_limit_orders(
@@ -1165,7 +1159,7 @@ vector<limit_order_object> database_api_impl::get_account_limit_orders(
 
 vector<call_order_object> database_api::get_call_orders(const std::string& a, uint32_t limit)const
 {
-   return my->get_call_orders( a, limit );
+   return my->read( [&]() { return my->get_call_orders( a, limit ); } );
 }
 
 vector<call_order_object> database_api_impl::get_call_orders(const std::string& a, uint32_t limit)const
@@ -1194,7 +1188,7 @@ vector<call_order_object> database_api_impl::get_call_orders(const std::string&
 vector<call_order_object> database_api::get_call_orders_by_account(const std::string& account_name_or_id,
                                                                    asset_id_type start, uint32_t limit)const
 {
-   return my->get_call_orders_by_account( account_name_or_id, start, limit );
+   return my->read( [&]() { return my->get_call_orders_by_account( account_name_or_id, start, limit ); } );
 }
 
 vector<call_order_object> database_api_impl::get_call_orders_by_account(const std::string& account_name_or_id,
@@ -1221,7 +1215,7 @@ vector<call_order_object> database_api_impl::get_call_orders_by_account(const st
 
 vector<force_settlement_object> database_api::get_settle_orders(const std::string& a, uint32_t limit)const
 {
-   return my->get_settle_orders( a, limit );
+   return my->read( [&]() { return my->get_settle_orders( a, limit ); } );
 }
 
 vector<force_settlement_object> database_api_impl::get_settle_orders(const std::string& a, uint32_t limit)const
@@ -1252,7 +1246,7 @@ vector<force_settlement_object> database_api::get_settle_orders_by_account(
       force_settlement_id_type start,
       uint32_t limit )const
 {
-   return my->get_settle_orders_by_account( account_name_or_id, start, limit);
+   return my->read( [&]() { return my->get_settle_orders_by_account( account_name_or_id, start, limit); } );
 }
 
 vector<force_settlement_object> database_api_impl::get_settle_orders_by_account(
@@ -1282,7 +1276,7 @@ vector<force_settlement_object> database_api_impl::get_settle_orders_by_account(
 
 vector<call_order_object> database_api::get_margin_positions( const std::string account_id_or_name )const
 {
-   return my->get_margin_positions( account_id_or_name );
+   return my->read( [&]() { return my->get_margin_positions( account_id_or_name ); } );
 }
 
 vector<call_order_object> database_api_impl::get_margin_positions( const std::string account_id_or_name )const
@@ -1319,6 +1313,7 @@ void database_api_impl::subscribe_to_market( std::function<void(const variant&)>
    if(asset_a_id > asset_b_id) std::swap(asset_a_id,asset_b_id);
    FC_ASSERT(asset_a_id != asset_b_id);
    _market_subscriptions[ std::make_pair(asset_a_id,asset_b_id) ] = callback;
+   connect_market_signals();
 }
 
 void database_api::unsubscribe_from_market(const std::string& a, const std::string& b)
@@ -1334,11 +1329,13 @@ void database_api_impl::unsubscribe_from_market(const std::string& a, const std:
    if(a > b) std::swap(asset_a_id,asset_b_id);
    FC_ASSERT(asset_a_id != asset_b_id);
    _market_subscriptions.erase(std::make_pair(asset_a_id,asset_b_id));
+   if( _market_subscriptions.empty() )
+      disconnect_market_signals();
 }
 
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
 {
-    return my->get_ticker( base, quote );
+    return my->read( [&]() { return my->get_ticker( base, quote ); } );
 }
 
 market_ticker database_api_impl::get_ticker( const string& base, const string& quote, bool skip_order_book )const
@@ -1372,7 +1369,7 @@ market_ticker database_api_impl::get_ticker( const string& base, const string& q
 
 market_volume database_api::get_24_volume( const string& base, const string& quote )const
 {
-    return my->get_24_volume( base, quote );
+    return my->read( [&]() { return my->get_24_volume( base, quote ); } );
 }
 
 market_volume database_api_impl::get_24_volume( const string& base, const string& quote )const
@@ -1391,7 +1388,7 @@ market_volume database_api_impl::get_24_volume( const string& base, const string
 
 order_book database_api::get_order_book( const string& base, const string& quote, unsigned limit )const
 {
-   return my->get_order_book( base, quote, limit);
+   return my->read( [&]() { return my->get_order_book( base, quote, limit); } );
 }
 
 order_book database_api_impl::get_order_book( const string& base, const string& quote, unsigned limit )const
@@ -1443,7 +1440,7 @@ order_book database_api_impl::get_order_book( const string& base, const string&
 
 vector<market_ticker> database_api::get_top_markets(uint32_t limit)const
 {
-   return my->get_top_markets(limit);
+   return my->read( [&]() { return my->get_top_markets(limit); } );
 }
 
 vector<market_ticker> database_api_impl::get_top_markets(uint32_t limit)const
@@ -1480,7 +1477,7 @@ vector<market_trade> database_api::get_trade_history( const string& base,
                                                       fc::time_point_sec stop,
                                                       unsigned limit )const
 {
-   return my->get_trade_history( base, quote, start, stop, limit );
+   return my->read( [&]() { return my->get_trade_history( base, quote, start, stop, limit ); } );
 }
 
 vector<market_trade> database_api_impl::get_trade_history( const string& base,
@@ -1582,7 +1579,7 @@ vector<market_trade> database_api::get_trade_history_by_sequence(
                                                       fc::time_point_sec stop,
                                                       unsigned limit )const
 {
-   return my->get_trade_history_by_sequence( base, quote, start, stop, limit );
+   return my->read( [&]() { return my->get_trade_history_by_sequence( base, quote, start, stop, limit ); } );
 }
 
 vector<market_trade> database_api_impl::get_trade_history_by_sequence(
@@ -1701,7 +1698,7 @@ vector<market_trade> database_api_impl::get_trade_history_by_sequence(
 
 vector<optional<witness_object>> database_api::get_witnesses(const vector<witness_id_type>& witness_ids)const
 {
-   return my->get_witnesses( witness_ids );
+   return my->read( [&]() { return my->get_witnesses( witness_ids ); } );
 }
 
 vector<optional<witness_object>> database_api_impl::get_witnesses(const vector<witness_id_type>& witness_ids)const
@@ -1718,7 +1715,7 @@ vector<optional<witness_object>> database_api_impl::get_witnesses(const vector<w
 
 fc::optional<witness_object> database_api::get_witness_by_account(const std::string account_id_or_name)const
 {
-   return my->get_witness_by_account( account_id_or_name );
+   return my->read( [&]() { return my->get_witness_by_account( account_id_or_name ); } );
 }
 
 fc::optional<witness_object> database_api_impl::get_witness_by_account(const std::string account_id_or_name) const
@@ -1734,7 +1731,7 @@ fc::optional<witness_object> database_api_impl::get_witness_by_account(const std
 map<string, witness_id_type> database_api::lookup_witness_accounts( const string& lower_bound_name,
                                                                     uint32_t limit )const
 {
-   return my->lookup_witness_accounts( lower_bound_name, limit );
+   return my->read( [&]() { return my->lookup_witness_accounts( lower_bound_name, limit ); } );
 }
 
 map<string, witness_id_type> database_api_impl::lookup_witness_accounts( const string& lower_bound_name,
@@ -1771,7 +1768,7 @@ map<string, witness_id_type> database_api_impl::lookup_witness_accounts( const s
 
 uint64_t database_api::get_witness_count()const
 {
-   return my->get_witness_count();
+   return my->read( [&]() { return my->get_witness_count(); } );
 }
 
 uint64_t database_api_impl::get_witness_count()const
@@ -1788,7 +1785,7 @@ uint64_t database_api_impl::get_witness_count()const
 vector<optional<committee_member_object>> database_api::get_committee_members(
                                              const vector<committee_member_id_type>& committee_member_ids )const
 {
-   return my->get_committee_members( committee_member_ids );
+   return my->read( [&]() { return my->get_committee_members( committee_member_ids ); } );
 }
 
 vector<optional<committee_member_object>> database_api_impl::get_committee_members(
@@ -1807,7 +1804,7 @@ vector<optional<committee_member_object>> database_api_impl::get_committee_membe
 fc::optional<committee_member_object> database_api::get_committee_member_by_account(
                                          const std::string account_id_or_name )const
 {
-   return my->get_committee_member_by_account( account_id_or_name );
+   return my->read( [&]() { return my->get_committee_member_by_account( account_id_or_name ); } );
 }
 
 fc::optional<committee_member_object> database_api_impl::get_committee_member_by_account(
@@ -1824,7 +1821,7 @@ fc::optional<committee_member_object> database_api_impl::get_committee_member_by
 map<string, committee_member_id_type> database_api::lookup_committee_member_accounts(
                                          const string& lower_bound_name, uint32_t limit )const
 {
-   return my->lookup_committee_member_accounts( lower_bound_name, limit );
+   return my->read( [&]() { return my->lookup_committee_member_accounts( lower_bound_name, limit ); } );
 }
 
 map<string, committee_member_id_type> database_api_impl::lookup_committee_member_accounts(
@@ -1861,7 +1858,7 @@ map<string, committee_member_id_type> database_api_impl::lookup_committee_member
 
 uint64_t database_api::get_committee_count()const
 {
-    return my->get_committee_count();
+    return my->read( [&]() { return my->get_committee_count(); } );
 }
 
 uint64_t database_api_impl::get_committee_count()const
@@ -1878,7 +1875,7 @@ uint64_t database_api_impl::get_committee_count()const
 
 vector<worker_object> database_api::get_all_workers( const optional<bool> is_expired )const
 {
-   return my->get_all_workers( is_expired );
+   return my->read( [&]() { return my->get_all_workers( is_expired ); } );
 }
 
 vector<worker_object> database_api_impl::get_all_workers( const optional<bool> is_expired )const
@@ -1911,7 +1908,7 @@ vector<worker_object> database_api_impl::get_all_workers( const optional<bool> i
 
 vector<worker_object> database_api::get_workers_by_account(const std::string account_id_or_name)const
 {
-   return my->get_workers_by_account( account_id_or_name );
+   return my->read( [&]() { return my->get_workers_by_account( account_id_or_name ); } );
 }
 
 vector<worker_object> database_api_impl::get_workers_by_account(const std::string account_id_or_name)const
@@ -1930,7 +1927,7 @@ vector<worker_object> database_api_impl::get_workers_by_account(const std::strin
 
 uint64_t database_api::get_worker_count()const
 {
-    return my->get_worker_count();
+    return my->read( [&]() { return my->get_worker_count(); } );
 }
 
 uint64_t database_api_impl::get_worker_count()const
@@ -1948,7 +1945,7 @@ uint64_t database_api_impl::get_worker_count()const
 
 vector<variant> database_api::lookup_vote_ids( const vector<vote_id_type>& votes )const
 {
-   return my->lookup_vote_ids( votes );
+   return my->read( [&]() { return my->lookup_vote_ids( votes ); } );
 }
 
 vector<variant> database_api_impl::lookup_vote_ids( const vector<vote_id_type>& votes )const
@@ -2013,7 +2010,7 @@ vector<variant> database_api_impl::lookup_vote_ids( const vector<vote_id_type>&
 
 std::string database_api::get_transaction_hex(const signed_transaction& trx)const
 {
-   return my->get_transaction_hex( trx );
+   return my->read( [&]() { return my->get_transaction_hex( trx ); } );
 }
 
 std::string database_api_impl::get_transaction_hex(const signed_transaction& trx)const
@@ -2024,7 +2021,7 @@ std::string database_api_impl::get_transaction_hex(const signed_transaction& trx
 std::string database_api::get_transaction_hex_without_sig(
    const transaction &trx) const
 {
-   return my->get_transaction_hex_without_sig(trx);
+   return my->read( [&]() { return my->get_transaction_hex_without_sig(trx); } );
 }
 
 std::string database_api_impl::get_transaction_hex_without_sig(
@@ -2036,7 +2033,7 @@ std::string database_api_impl::get_transaction_hex_without_sig(
 set<public_key_type> database_api::get_required_signatures( const signed_transaction& trx,
                                                             const flat_set<public_key_type>& available_keys )const
 {
-   return my->get_required_signatures( trx, available_keys );
+   return my->read( [&]() { return my->get_required_signatures( trx, available_keys ); } );
 }
 
 set<public_key_type> database_api_impl::get_required_signatures( const signed_transaction& trx,
@@ -2057,11 +2054,11 @@ set<public_key_type> database_api_impl::get_required_signatures( const signed_tr
 
 set<public_key_type> database_api::get_potential_signatures( const signed_transaction& trx )const
 {
-   return my->get_potential_signatures( trx );
+   return my->read( [&]() { return my->get_potential_signatures( trx ); } );
 }
 set<address> database_api::get_potential_address_signatures( const signed_transaction& trx )const
 {
-   return my->get_potential_address_signatures( trx );
+   return my->read( [&]() { return my->get_potential_address_signatures( trx ); } );
 }
 
 set<public_key_type> database_api_impl::get_potential_signatures( const signed_transaction& trx )const
@@ -2132,7 +2129,7 @@ set<address> database_api_impl::get_potential_address_signatures( const signed_t
 
 bool database_api::verify_authority( const signed_transaction& trx )const
 {
-   return my->verify_authority( trx );
+   return my->read( [&]() { return my->verify_authority( trx ); } );
 }
 
 bool database_api_impl::verify_authority( const signed_transaction& trx )const
@@ -2151,7 +2148,7 @@ bool database_api_impl::verify_authority( const signed_transaction& trx )const
 bool database_api::verify_account_authority( const string& account_name_or_id,
                                              const flat_set<public_key_type>& signers )const
 {
-   return my->verify_account_authority( account_name_or_id, signers );
+   return my->read( [&]() { return my->verify_account_authority( account_name_or_id, signers ); } );
 }
 
 bool database_api_impl::verify_account_authority( const string& account_name_or_id,
@@ -2193,7 +2190,7 @@ processed_transaction database_api_impl::validate_transaction( const signed_tran
 vector< fc::variant > database_api::get_required_fees( const vector<operation>& ops,
                                                        const std::string& asset_id_or_symbol )const
 {
-   return my->get_required_fees( ops, asset_id_or_symbol );
+   return my->read( [&]() { return my->get_required_fees( ops, asset_id_or_symbol ); } );
 }
 
 /**
@@ -2283,7 +2280,7 @@ vector< fc::variant > database_api_impl::get_required_fees( const vector<operati
 
 vector<proposal_object> database_api::get_proposed_transactions( const std::string account_id_or_name )const
 {
-   return my->get_proposed_transactions( account_id_or_name );
+   return my->read( [&]() { return my->get_proposed_transactions( account_id_or_name ); } );
 }
 
 vector<proposal_object> database_api_impl::get_proposed_transactions( const std::string account_id_or_name )const
@@ -2312,7 +2309,7 @@ vector<proposal_object> database_api_impl::get_proposed_transactions( const std:
 
 vector<proposal_object> database_api::get_proposed_global_parameters()const
 {
-   return my->get_proposed_global_parameters();
+   return my->read( [&]() { return my->get_proposed_global_parameters(); } );
 }
 
 vector<proposal_object> database_api_impl::get_proposed_global_parameters()const
@@ -2350,7 +2347,7 @@ vector<withdraw_permission_object> database_api::get_withdraw_permissions_by_giv
                                       withdraw_permission_id_type start,
                                       uint32_t limit)const
 {
-   return my->get_withdraw_permissions_by_giver( account_id_or_name, start, limit );
+   return my->read( [&]() { return my->get_withdraw_permissions_by_giver( account_id_or_name, start, limit ); } );
 }
 
 vector<withdraw_permission_object> database_api_impl::get_withdraw_permissions_by_giver(
@@ -2384,7 +2381,7 @@ vector<withdraw_permission_object> database_api::get_withdraw_permissions_by_rec
                                       withdraw_permission_id_type start,
                                       uint32_t limit)const
 {
-   return my->get_withdraw_permissions_by_recipient( account_id_or_name, start, limit );
+   return my->read( [&]() { return my->get_withdraw_permissions_by_recipient( account_id_or_name, start, limit ); } );
 }
 
 vector<withdraw_permission_object> database_api_impl::get_withdraw_permissions_by_recipient(
@@ -2420,7 +2417,7 @@ vector<withdraw_permission_object> database_api_impl::get_withdraw_permissions_b
 
 optional<htlc_object> database_api::get_htlc( htlc_id_type id, optional<bool> subscribe )const
 {
-   return my->get_htlc( id, subscribe );
+   return my->read( [&]() { return my->get_htlc( id, subscribe ); } );
 }
 
 fc::optional<htlc_object> database_api_impl::get_htlc( htlc_id_type id, optional<bool> subscribe )const
@@ -2436,7 +2433,7 @@ fc::optional<htlc_object> database_api_impl::get_htlc( htlc_id_type id, optional
 vector<htlc_object> database_api::get_htlc_by_from( const std::string account_id_or_name,
                                                     htlc_id_type start, uint32_t limit )const
 {
-   return my->get_htlc_by_from(account_id_or_name, start, limit);
+   return my->read( [&]() { return my->get_htlc_by_from(account_id_or_name, start, limit); } );
 }
 
 vector<htlc_object> database_api_impl::get_htlc_by_from( const std::string account_id_or_name,
@@ -2466,7 +2463,7 @@ vector<htlc_object> database_api_impl::get_htlc_by_from( const std::string accou
 vector<htlc_object> database_api::get_htlc_by_to( const std::string account_id_or_name,
                                                   htlc_id_type start, uint32_t limit )const
 {
-   return my->get_htlc_by_to(account_id_or_name, start, limit);
+   return my->read( [&]() { return my->get_htlc_by_to(account_id_or_name, start, limit); } );
 }
 
 vector<htlc_object> database_api_impl::get_htlc_by_to( const std::string account_id_or_name,
@@ -2495,7 +2492,7 @@ vector<htlc_object> database_api_impl::get_htlc_by_to( const std::string account
 
 vector<htlc_object> database_api::list_htlcs(const htlc_id_type start, uint32_t limit)const
 {
-   return my->list_htlcs(start, limit);
+   return my->read( [&]() { return my->list_htlcs(start, limit); } );
 }
 
 vector<htlc_object> database_api_impl::list_htlcs(const htlc_id_type start, uint32_t limit) const
@@ -2526,7 +2523,7 @@ vector<htlc_object> database_api_impl::list_htlcs(const htlc_id_type start, uint
 vector<personal_data_object> database_api::get_personal_data( const account_id_type subject_account,
                                                               const account_id_type operator_account) const
 {
-   return my->get_personal_data(subject_account, operator_account);
+   return my->read( [&]() { return my->get_personal_data(subject_account, operator_account); } );
 }
 
 vector<personal_data_object> database_api_impl::get_personal_data( const account_id_type subject_account,
@@ -2549,7 +2546,7 @@ vector<personal_data_object> database_api_impl::get_personal_data( const account
 fc::optional<personal_data_object> database_api::get_last_personal_data( const account_id_type subject_account,
                                                                          const account_id_type operator_account) const
 {
-   return my->get_last_personal_data(subject_account, operator_account);
+   return my->read( [&]() { return my->get_last_personal_data(subject_account, operator_account); } );
 }
 
 fc::optional<personal_data_object> database_api_impl::get_last_personal_data( const account_id_type subject_account,
@@ -2578,7 +2575,7 @@ fc::optional<personal_data_object> database_api_impl::get_last_personal_data( co
 
 fc::optional<content_card_object> database_api::get_content_card_by_id( const content_card_id_type content_id ) const
 {
-   return my->get_content_card_by_id(content_id);
+   return my->read( [&]() { return my->get_content_card_by_id(content_id); } );
 }
 
 fc::optional<content_card_object> database_api_impl::get_content_card_by_id( const content_card_id_type content_id ) const
@@ -2594,13 +2591,13 @@ fc::optional<content_card_object> database_api_impl::get_content_card_by_id( con
    if ( itr->id != content_id ){
       return fc::optional<content_card_object>();
    }
-   return *itr;
+   return with_content_payload(*itr);
 }
 
 vector<content_card_object> database_api::get_content_cards( const account_id_type subject_account,
                                                              const content_card_id_type content_id, uint32_t limit ) const
 {
-   return my->get_content_cards(subject_account, content_id, limit);
+   return my->read( [&]() { return my->get_content_cards(subject_account, content_id, limit); } );
 }
 
 vector<content_card_object> database_api_impl::get_content_cards( const account_id_type subject_account,
@@ -2617,7 +2614,7 @@ vector<content_card_object> database_api_impl::get_content_cards( const account_
    vector<content_card_object> result;
    while( itr->subject_account == subject_account && limit-- )
    {
-      result.push_back(*itr);
+      result.push_back(with_content_payload(*itr));
       ++itr;
    }
 
@@ -2628,7 +2625,7 @@ vector<content_card_object> database_api::get_content_cards_by_room( const room_
                                                                      const content_card_id_type content_id,
                                                                      uint32_t limit ) const
 {
-   return my->get_content_cards_by_room(room, content_id, limit);
+   return my->read( [&]() { return my->get_content_cards_by_room(room, content_id, limit); } );
 }
 
 vector<content_card_object> database_api_impl::get_content_cards_by_room( const room_id_type room,
@@ -2646,16 +2643,33 @@ vector<content_card_object> database_api_impl::get_content_cards_by_room( const
    vector<content_card_object> result;
    while( itr != by_room_idx.end() && itr->room.valid() && *(itr->room) == room && limit-- )
    {
-      result.push_back(*itr);
+      result.push_back(with_content_payload(*itr));
       ++itr;
    }
 
    return result;
 }
 
+content_card_object database_api_impl::with_content_payload( const content_card_object& card )const
+{
+   content_card_object result = card;
+   if( !result.payload.valid() )
+      return result;
+   const content_store* store = _db.get_content_store();
+   FC_ASSERT( store != nullptr, "Content card ${id} is kept in the content store, which is not enabled",
+              ("id", card.id) );
+   content_payload payload = store->read( *result.payload );
+   result.url          = std::move( payload.url );
+   result.description  = std::move( payload.description );
+   result.content_key  = std::move( payload.content_key );
+   result.storage_data = std::move( payload.storage_data );
+   result.payload.reset();
+   return result;
+}
+
 fc::optional<permission_object> database_api::get_permission_by_id( const permission_id_type permission_id ) const
 {
-   return my->get_permission_by_id(permission_id);
+   return my->read( [&]() { return my->get_permission_by_id(permission_id); } );
 }
 
 fc::optional<permission_object> database_api_impl::get_permission_by_id( const permission_id_type permission_id ) const
@@ -2673,7 +2687,7 @@ fc::optional<permission_object> database_api_impl::get_permission_by_id( const p
 vector<permission_object> database_api::get_permissions( const account_id_type operator_account,
                                                          const permission_id_type permission_id, uint32_t limit ) const
 {
-   return my->get_permissions(operator_account, permission_id, limit);
+   return my->read( [&]() { return my->get_permissions(operator_account, permission_id, limit); } );
 }
 
 vector<permission_object> database_api_impl::get_permissions( const account_id_type operator_account,
@@ -2701,7 +2715,7 @@ vector<permission_object> database_api_impl::get_permissions( const account_id_t
 
 fc::optional<room_object> database_api::get_room_by_id( const room_id_type room_id ) const
 {
-   return my->get_room_by_id(room_id);
+   return my->read( [&]() { return my->get_room_by_id(room_id); } );
 }
 
 fc::optional<room_object> database_api_impl::get_room_by_id( const room_id_type room_id ) const
@@ -2716,52 +2730,48 @@ fc::optional<room_object> database_api_impl::get_room_by_id( const room_id_type
    return *itr;
 }
 
-vector<room_object> database_api::get_rooms_by_owner( const account_id_type owner,
-                                                      const room_id_type room_id, uint32_t limit ) const
+room_page database_api::get_rooms_by_owner( const account_id_type owner,
+                                            const room_id_type room_id, uint32_t limit ) const
 {
-   return my->get_rooms_by_owner(owner, room_id, limit);
+   return my->read( [&]() { return my->get_rooms_by_owner(owner, room_id, limit); } );
 }
 
-vector<room_object> database_api_impl::get_rooms_by_owner( const account_id_type owner,
-                                                           const room_id_type room_id, uint32_t limit ) const
+room_page database_api_impl::get_rooms_by_owner( const account_id_type owner,
+                                                 const room_id_type room_id, uint32_t limit ) const
 {
    const auto& room_idx = _db.get_index_type<room_index>();
    const auto& by_owner_idx = room_idx.indices().get<by_owner>();
-   auto itr = by_owner_idx.lower_bound(owner);
+   auto itr = by_owner_idx.lower_bound( boost::make_tuple( owner, object_id_type( room_id ) ) );
 
-   vector<room_object> result;
-   while( itr != by_owner_idx.end() && itr->owner == owner && limit-- )
-   {
-      if( itr->id.instance() >= room_id.instance.value )
-         result.push_back(*itr);
-      ++itr;
-   }
+   room_page result;
+   for( ; itr != by_owner_idx.end() && itr->owner == owner && limit > 0; ++itr, --limit )
+      result.rooms.push_back(*itr);
+   if( itr != by_owner_idx.end() && itr->owner == owner )
+      result.next = room_id_type( itr->id );
 
    return result;
 }
 
-vector<room_participant_object> database_api::get_room_participants( const room_id_type room,
-                                                                     const room_participant_id_type participant_id,
-                                                                     uint32_t limit ) const
+room_participant_page database_api::get_room_participants( const room_id_type room,
+                                                           const room_participant_id_type participant_id,
+                                                           uint32_t limit ) const
 {
-   return my->get_room_participants(room, participant_id, limit);
+   return my->read( [&]() { return my->get_room_participants(room, participant_id, limit); } );
 }
 
-vector<room_participant_object> database_api_impl::get_room_participants( const room_id_type room,
-                                                                          const room_participant_id_type participant_id,
-                                                                          uint32_t limit ) const
+room_participant_page database_api_impl::get_room_participants( const room_id_type room,
+                                                                const room_participant_id_type participant_id,
+                                                                uint32_t limit ) const
 {
    const auto& participant_idx = _db.get_index_type<room_participant_index>();
    const auto& by_room_idx = participant_idx.indices().get<by_room>();
-   auto itr = by_room_idx.lower_bound(room);
+   auto itr = by_room_idx.lower_bound( boost::make_tuple( room, object_id_type( participant_id ) ) );
 
-   vector<room_participant_object> result;
-   while( itr != by_room_idx.end() && itr->room == room && limit-- )
-   {
-      if( itr->id.instance() >= participant_id.instance.value )
-         result.push_back(*itr);
-      ++itr;
-   }
+   room_participant_page result;
+   for( ; itr != by_room_idx.end() && itr->room == room && limit > 0; ++itr, --limit )
+      result.participants.push_back(*itr);
+   if( itr != by_room_idx.end() && itr->room == room )
+      result.next = room_participant_id_type( itr->id );
 
    return result;
 }
@@ -2769,7 +2779,7 @@ vector<room_participant_object> database_api_impl::get_room_participants( const
 fc::optional<room_participant_object> database_api::get_room_participant( const room_id_type room,
                                                                           const account_id_type participant ) const
 {
-   return my->get_room_participant(room, participant);
+   return my->read( [&]() { return my->get_room_participant(room, participant); } );
 }
 
 fc::optional<room_participant_object> database_api_impl::get_room_participant( const room_id_type room,
@@ -2787,28 +2797,26 @@ fc::optional<room_participant_object> database_api_impl::get_room_participant( c
    return *itr;
 }
 
-vector<room_participant_object> database_api::get_rooms_by_participant( const account_id_type participant,
-                                                                        const room_participant_id_type participant_id,
-                                                                        uint32_t limit ) const
+room_participant_page database_api::get_rooms_by_participant( const account_id_type participant,
+                                                              const room_participant_id_type participant_id,
+                                                              uint32_t limit ) const
 {
-   return my->get_rooms_by_participant(participant, participant_id, limit);
+   return my->read( [&]() { return my->get_rooms_by_participant(participant, participant_id, limit); } );
 }
 
-vector<room_participant_object> database_api_impl::get_rooms_by_participant( const account_id_type participant,
-                                                                             const room_participant_id_type participant_id,
-                                                                             uint32_t limit ) const
+room_participant_page database_api_impl::get_rooms_by_participant( const account_id_type participant,
+                                                                   const room_participant_id_type participant_id,
+                                                                   uint32_t limit ) const
 {
    const auto& participant_idx = _db.get_index_type<room_participant_index>();
    const auto& by_part_idx = participant_idx.indices().get<by_participant>();
-   auto itr = by_part_idx.lower_bound(participant);
+   auto itr = by_part_idx.lower_bound( boost::make_tuple( participant, object_id_type( participant_id ) ) );
 
-   vector<room_participant_object> result;
-   while( itr != by_part_idx.end() && itr->participant == participant && limit-- )
-   {
-      if( itr->id.instance() >= participant_id.instance.value )
-         result.push_back(*itr);
-      ++itr;
-   }
+   room_participant_page result;
+   for( ; itr != by_part_idx.end() && itr->participant == participant && limit > 0; ++itr, --limit )
+      result.participants.push_back(*itr);
+   if( itr != by_part_idx.end() && itr->participant == participant )
+      result.next = room_participant_id_type( itr->id );
 
    return result;
 }
@@ -2819,7 +2827,7 @@ vector<room_key_epoch_object> database_api::get_room_key_epochs( const room_id_t
                                                                    const account_id_type participant,
                                                                    uint32_t limit ) const
 {
-   return my->get_room_key_epochs(room, participant, limit);
+   return my->read( [&]() { return my->get_room_key_epochs(room, participant, limit); } );
 }
 
 vector<room_key_epoch_object> database_api_impl::get_room_key_epochs( const room_id_type room,
@@ -2832,11 +2840,34 @@ vector<room_key_epoch_object> database_api_impl::get_room_key_epochs( const room
    const auto& by_room_part_idx = epoch_idx.indices().get<by_room_and_participant_epoch>();
    auto itr = by_room_part_idx.lower_bound(boost::make_tuple(room, participant));
 
+   const auto& table_idx = _db.get_index_type<room_key_epoch_table_index>();
+   const auto& tables = table_idx.indices().get<by_room_and_epoch>();
+   auto table_itr = tables.lower_bound(boost::make_tuple(room));
+   const auto table_end = tables.upper_bound(boost::make_tuple(room));
+
+   // Merge the participant's own records with the epoch tables by epoch, records taking precedence
    vector<room_key_epoch_object> result;
-   while( itr != by_room_part_idx.end() && itr->room == room && itr->participant == participant && limit-- )
+   fc::optional<room_key_epoch_object> from_table;
+   while( result.size() < limit )
    {
-      result.push_back(*itr);
-      ++itr;
+      for( ; !from_table.valid() && table_itr != table_end; ++table_itr )
+         from_table = table_itr->find_key_epoch(participant);
+
+      bool has_record = itr != by_room_part_idx.end() && itr->room == room && itr->participant == participant;
+      if( has_record && ( !from_table.valid() || itr->epoch <= from_table->epoch ) )
+      {
+         if( from_table.valid() && from_table->epoch == itr->epoch )
+            from_table.reset();
+         result.push_back(*itr);
+         ++itr;
+      }
+      else if( from_table.valid() )
+      {
+         result.push_back(*from_table);
+         from_table.reset();
+      }
+      else
+         break;
    }
 
    return result;
@@ -2846,7 +2877,7 @@ fc::optional<room_key_epoch_object> database_api::get_room_key_epoch( const room
                                                                        uint32_t epoch,
                                                                        const account_id_type participant ) const
 {
-   return my->get_room_key_epoch(room, epoch, participant);
+   return my->read( [&]() { return my->get_room_key_epoch(room, epoch, participant); } );
 }
 
 fc::optional<room_key_epoch_object> database_api_impl::get_room_key_epoch( const room_id_type room,
@@ -2856,13 +2887,16 @@ fc::optional<room_key_epoch_object> database_api_impl::get_room_key_epoch( const
    const auto& epoch_idx = _db.get_index_type<room_key_epoch_index>();
    const auto& by_rep_idx = epoch_idx.indices().get<by_room_epoch_participant>();
    auto itr = by_rep_idx.find(boost::make_tuple(room, epoch, participant));
+   if( itr != by_rep_idx.end() )
+      return *itr;
 
-   if( itr == by_rep_idx.end() )
-   {
+   const auto& table_idx = _db.get_index_type<room_key_epoch_table_index>();
+   const auto& tables = table_idx.indices().get<by_room_and_epoch>();
+   auto table_itr = tables.find(boost::make_tuple(room, epoch));
+   if( table_itr == tables.end() )
       return fc::optional<room_key_epoch_object>();
-   }
 
-   return *itr;
+   return table_itr->find_key_epoch(participant);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -2980,27 +3014,6 @@ vector<limit_order_object> database_api_impl::get_limit_orders( const asset_id_t
    return result;
 }
 
-bool database_api_impl::is_impacted_account( const flat_set<account_id_type>& accounts)
-{
-   if( _subscribed_accounts.empty() || accounts.empty() )
-      return false;
-
-   return std::any_of(accounts.begin(), accounts.end(), [this](const account_id_type& account) {
-      return _subscribed_accounts.find(account) != _subscribed_accounts.end();
-   });
-}
-
-void database_api_impl::broadcast_updates( const vector<variant>& updates )
-{
-   if( !updates.empty() && _subscribe_callback ) {
-      auto capture_this = shared_from_this();
-      fc::async([capture_this,updates](){
-          if(capture_this->_subscribe_callback)
-            capture_this->_subscribe_callback( fc::variant(updates) );
-      });
-   }
-}
-
 void database_api_impl::broadcast_market_updates( const market_queue_type& queue)
 {
    if( !queue.empty() )
@@ -3017,11 +3030,37 @@ void database_api_impl::broadcast_market_updates( const market_queue_type& queue
    }
 }
 
+void database_api_impl::connect_market_signals()
+{
+   if( _new_connection.connected() )
+      return;
+   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids,
+                                                    const flat_set<account_id_type>& impacted_accounts) {
+                                on_objects_new(ids, impacted_accounts);
+                                });
+   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids,
+                                                           const flat_set<account_id_type>& impacted_accounts) {
+                                on_objects_changed(ids, impacted_accounts);
+                                });
+   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids,
+                                                            const vector<const object*>& objs,
+                                                            const flat_set<account_id_type>& impacted_accounts) {
+                                on_objects_removed(ids, objs, impacted_accounts);
+                                });
+}
+
+void database_api_impl::disconnect_market_signals()
+{
+   _new_connection.disconnect();
+   _change_connection.disconnect();
+   _removed_connection.disconnect();
+}
+
 void database_api_impl::on_objects_removed( const vector<object_id_type>& ids,
                                             const vector<const object*>& objs,
-                                            const flat_set<account_id_type>& impacted_accounts )
+                                            const flat_set<account_id_type>& )
 {
-   handle_object_changed(_notify_remove_create, false, ids, impacted_accounts,
+   handle_market_objects_changed(false, ids,
       [objs](object_id_type id) -> const object* {
          auto it = std::find_if(
                objs.begin(), objs.end(),
@@ -3036,54 +3075,25 @@ void database_api_impl::on_objects_removed( const vector<object_id_type>& ids,
 }
 
 void database_api_impl::on_objects_new( const vector<object_id_type>& ids,
-                                        const flat_set<account_id_type>& impacted_accounts )
+                                        const flat_set<account_id_type>& )
 {
-   handle_object_changed(_notify_remove_create, true, ids, impacted_accounts,
+   handle_market_objects_changed(true, ids,
       std::bind(&object_database::find_object, &_db, std::placeholders::_1)
    );
 }
 
 void database_api_impl::on_objects_changed( const vector<object_id_type>& ids,
-                                            const flat_set<account_id_type>& impacted_accounts )
+                                            const flat_set<account_id_type>& )
 {
-   handle_object_changed(false, true, ids, impacted_accounts,
+   handle_market_objects_changed(true, ids,
       std::bind(&object_database::find_object, &_db, std::placeholders::_1)
    );
 }
 
-void database_api_impl::handle_object_changed( bool force_notify,
-                                               bool full_object,
-                                               const vector<object_id_type>& ids,
-                                               const flat_set<account_id_type>& impacted_accounts,
-                                               std::function<const object*(object_id_type id)> find_object )
+void database_api_impl::handle_market_objects_changed( bool full_object,
+                                                       const vector<object_id_type>& ids,
+                                                       std::function<const object*(object_id_type id)> find_object )
 {
-   if( _subscribe_callback )
-   {
-      vector<variant> updates;
-
-      for(auto id : ids)
-      {
-         if( force_notify || is_subscribed_to_item(id) || is_impacted_account(impacted_accounts) )
-         {
-            if( full_object )
-            {
-               auto obj = find_object(id);
-               if( obj )
-               {
-                  updates.emplace_back( obj->to_variant() );
-               }
-            }
-            else
-            {
-               updates.emplace_back( fc::variant( id, 1 ) );
-            }
-         }
-      }
-
-      if( !updates.empty() )
-         broadcast_updates(updates);
-   }
-
    if( !_market_subscriptions.empty() )
    {
       market_queue_type broadcast_queue;
@@ -24,9 +24,12 @@
  * THE SOFTWARE.
  */
 
+#include <graphene/app/api_read_pool.hpp>
 #include <graphene/app/database_api.hpp>
 
-#include <fc/bloom_filter.hpp>
+#include "subscription_hub.hxx"
+
+#include <atomic>
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
 
@@ -215,16 +218,16 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
       // Rooms
       fc::optional<room_object> get_room_by_id( const room_id_type room_id ) const;
-      vector<room_object> get_rooms_by_owner( const account_id_type owner,
-                                              const room_id_type room_id, uint32_t limit ) const;
-      vector<room_participant_object> get_room_participants( const room_id_type room,
-                                                             const room_participant_id_type participant_id,
-                                                             uint32_t limit ) const;
+      room_page get_rooms_by_owner( const account_id_type owner,
+                                    const room_id_type room_id, uint32_t limit ) const;
+      room_participant_page get_room_participants( const room_id_type room,
+                                                   const room_participant_id_type participant_id,
+                                                   uint32_t limit ) const;
       fc::optional<room_participant_object> get_room_participant( const room_id_type room,
                                                                   const account_id_type participant ) const;
-      vector<room_participant_object> get_rooms_by_participant( const account_id_type participant,
-                                                                const room_participant_id_type participant_id,
-                                                                uint32_t limit ) const;
+      room_participant_page get_rooms_by_participant( const account_id_type participant,
+                                                      const room_participant_id_type participant_id,
+                                                      uint32_t limit ) const;
       vector<room_key_epoch_object> get_room_key_epochs( const room_id_type room,
                                                           const account_id_type participant,
                                                           uint32_t limit ) const;
@@ -271,6 +274,15 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<limit_order_object> get_limit_orders( const asset_id_type a, const asset_id_type b,
                                                    const uint32_t limit )const;
 
+      /// Runs the read-only query @p f on the API read pool if there is one, else on the calling thread
+      template<typename Function>
+      auto read( Function&& f )const -> decltype( f() )
+      {
+         if( !_read_pool )
+            return f();
+         return _read_pool->run( std::forward<Function>( f ) );
+      }
+
       ////////////////////////////////////////////////
       // Subscription
       ////////////////////////////////////////////////
@@ -278,53 +290,22 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       // Decides whether to subscribe using member variables and given parameter
       bool get_whether_to_subscribe( optional<bool> subscribe )const
       {
-         if( !_subscribe_callback )
+         if( !_subscriptions_enabled )
             return false;
          if( subscribe.valid() )
             return *subscribe;
          return _enabled_auto_subscription;
       }
 
-      // Note:
-      //   Different type of object_id<T> objects could become identical after packed.
-      //   For example, both `account_id_type a=1.2.0` and `asset_id_type b=1.3.0` will become `0` after packed.
-      //   In order to avoid collision, we don't use a template function here, instead, we implicitly convert all
-      //   object IDs to `object_id_type` when subscribing.
-      //
-      //   If need to subscribe to other data types, override this function with the types as parameter.
-      //   For example, we had a `get_subscription_key( const public_key_type& item )` function here, which was
-      //   removed lately since we no longer subscribe to public keys.
-      vector<char> get_subscription_key( const object_id_type& item )const
+      // Object IDs of every type are converted to `object_id_type`, so that IDs of different types
+      // with the same instance do not collide
+      void subscribe_to_item( const object_id_type& item )const
       {
-         return fc::raw::pack(item);
-      }
-
-      template<typename T>
-      void subscribe_to_item( const T& item )const
-      {
-         if( !_subscribe_callback )
+         if( !_subscriptions_enabled )
             return;
-
-         vector<char> key = get_subscription_key( item );
-         if( !_subscribe_filter.contains( key.data(), key.size() ) )
-         {
-            _subscribe_filter.insert( key.data(), key.size() );
-         }
+         _hub->subscribe_to_object( _subscriber_id, item );
       }
 
-      template<typename T>
-      bool is_subscribed_to_item( const T& item )const
-      {
-         if( !_subscribe_callback )
-            return false;
-
-         vector<char> key = get_subscription_key( item );
-         return _subscribe_filter.contains( key.data(), key.size() );
-      }
-
-      // for full-account subscription
-      bool is_impacted_account( const flat_set<account_id_type>& accounts );
-
       // for market subscription
       template<typename T>
       const std::pair<asset_id_type,asset_id_type> get_order_market( const T& order )
@@ -356,13 +337,16 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
          }
       }
 
-      void broadcast_updates( const vector<variant>& updates );
       void broadcast_market_updates( const market_queue_type& queue);
-      void handle_object_changed( bool force_notify,
-                                  bool full_object,
-                                  const vector<object_id_type>& ids,
-                                  const flat_set<account_id_type>& impacted_accounts,
-                                  std::function<const object*(object_id_type id)> find_object );
+      void handle_market_objects_changed( bool full_object,
+                                          const vector<object_id_type>& ids,
+                                          std::function<const object*(object_id_type id)> find_object );
+
+      /** Object subscriptions go through the subscription hub, these slots only serve market subscriptions
+       *  and are connected while there is one
+       */
+      void connect_market_signals();
+      void disconnect_market_signals();
 
       /** called every time a block is applied to report the objects that were changed */
       void on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
@@ -371,17 +355,24 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
                               const flat_set<account_id_type>& impacted_accounts);
       void on_applied_block();
 
+      /// A copy of @p card with its payload read back from the content store, if it is kept there
+      content_card_object with_content_payload( const content_card_object& card )const;
+
       ////////////////////////////////////////////////
       // Member variables
       ////////////////////////////////////////////////
    private:
-      bool _notify_remove_create = false;
-      bool _enabled_auto_subscription = true;
+      /// Read by queries on the API read pool, while the API thread may change them
+      std::atomic<bool> _enabled_auto_subscription{ true };
+      std::atomic<bool> _subscriptions_enabled{ false };
+
+      /// Object and account subscriptions of this API instance, shared with the other instances
+      std::shared_ptr<subscription_hub> _hub;
+      uint64_t                          _subscriber_id = 0;
 
-      mutable fc::bloom_filter  _subscribe_filter;
-      std::set<account_id_type> _subscribed_accounts;
+      /// Workers for read-only queries, null when they run on the calling thread
+      std::shared_ptr<api_read_pool>    _read_pool;
 
-      std::function<void(const fc::variant&)> _subscribe_callback;
       std::function<void(const fc::variant&)> _pending_trx_callback;
       std::function<void(const fc::variant&)> _block_applied_callback;
 
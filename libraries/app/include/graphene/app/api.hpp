@@ -379,17 +379,19 @@ namespace graphene { namespace app {
          /**
           * @brief Get asset holders count for a specific asset
           * @param asset The specific asset id or symbol
-          * @return Holders count for the specified asset
+          * @return Number of accounts holding a non-zero balance of the specified asset
           */
          int get_asset_holders_count( std::string asset )const;
 
          /**
           * @brief Get all asset holders
-          * @return A list of all asset holders
+          * @return The number of accounts holding a non-zero balance of each asset
           */
          vector<asset_holders> get_all_asset_holders() const;
 
       private:
+         const graphene::chain::asset_holders_index& holders_index() const;
+
          graphene::app::application& _app;
          graphene::chain::database& _db;
          graphene::app::database_api database_api;
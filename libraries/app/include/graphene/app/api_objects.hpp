@@ -30,6 +30,7 @@
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/withdraw_permission_object.hpp>
 #include <graphene/chain/htlc_object.hpp>
+#include <graphene/chain/room_object.hpp>
 
 #include <graphene/api_helper_indexes/api_helper_indexes.hpp>
 #include <graphene/market_history/market_history_plugin.hpp>
@@ -152,6 +153,20 @@ namespace graphene { namespace app {
       optional<share_type> total_backing_collateral;
    };
 
+   /// A page of rooms, @ref next is where the following page starts if there is one
+   struct room_page
+   {
+      vector<room_object>    rooms;
+      optional<room_id_type> next;
+   };
+
+   /// A page of room participant records, @ref next is where the following page starts if there is one
+   struct room_participant_page
+   {
+      vector<room_participant_object>    participants;
+      optional<room_participant_id_type> next;
+   };
+
 } }
 
 FC_REFLECT( graphene::app::more_data,
@@ -192,3 +207,6 @@ FC_REFLECT( graphene::app::market_trade, (sequence)(date)(price)(amount)(value)(
 
 FC_REFLECT_DERIVED( graphene::app::extended_asset_object, (graphene::chain::asset_object),
                     (total_in_collateral)(total_backing_collateral) )
+
+FC_REFLECT( graphene::app::room_page, (rooms)(next) )
+FC_REFLECT( graphene::app::room_participant_page, (participants)(next) )
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <memory>
+
+namespace graphene { namespace app {
+
+/**
+ * Worker threads serving read-only database API queries, so that queries neither wait for nor
+ * delay block application. Every query holds the database's read lock while it runs, see
+ * graphene::chain::database::enable_concurrent_reads().
+ */
+class api_read_pool
+{
+   public:
+      api_read_pool( chain::database& db, uint32_t threads );
+      ~api_read_pool();
+
+      /// Starts the pool serving @p db and enables concurrent reads on it
+      static std::shared_ptr<api_read_pool> start( chain::database& db, uint32_t threads );
+      /// Stops the pool of @p db, queries already holding the pool finish on it
+      static void stop( chain::database& db );
+      /// The pool serving @p db, null if queries run on the calling thread
+      static std::shared_ptr<api_read_pool> find( const chain::database& db );
+
+      uint32_t size()const { return _threads.size(); }
+
+      /// Runs @p f on a worker under the read lock, and waits for its result
+      template<typename Function>
+      auto run( Function&& f ) -> decltype( f() )
+      {
+         // the writer itself would wait forever for the read lock
+         if( !_db.concurrent_reads_enabled() || _db.is_changing_state() )
+            return f();
+         auto& thread = *_threads[ _next++ % _threads.size() ];
+         return thread.async( [this, &f]() {
+            auto lock = _db.lock_for_reading();
+            return f();
+         }, "api read" ).wait();
+      }
+
+   private:
+      chain::database&                          _db;
+      std::vector<std::unique_ptr<fc::thread>>  _threads;
+      std::atomic<uint32_t>                     _next{ 0 };
+};
+
+} } // graphene::app
@@ -949,21 +949,22 @@ class database_api
        * @param owner The owner account of the rooms
        * @param room_id Lower bound of room id to start getting results
        * @param limit Maximum number of room objects to fetch
-       * @return The list of room objects
+       * @return The room objects, and the id to pass as @p room_id to get the next page if there is one
        */
-      vector<room_object> get_rooms_by_owner( const account_id_type owner,
-                                              const room_id_type room_id, uint32_t limit ) const;
+      room_page get_rooms_by_owner( const account_id_type owner,
+                                    const room_id_type room_id, uint32_t limit ) const;
 
       /**
        * @brief Get list of participants in a room
        * @param room The room to get participants from
        * @param participant_id Lower bound of participant id to start getting results
        * @param limit Maximum number of participant objects to fetch
-       * @return The list of room participant objects
+       * @return The room participant objects, and the id to pass as @p participant_id to get the next
+       *         page if there is one
        */
-      vector<room_participant_object> get_room_participants( const room_id_type room,
-                                                             const room_participant_id_type participant_id,
-                                                             uint32_t limit ) const;
+      room_participant_page get_room_participants( const room_id_type room,
+                                                   const room_participant_id_type participant_id,
+                                                   uint32_t limit ) const;
 
       /**
        * @brief Get a participant record in a room
@@ -979,18 +980,22 @@ class database_api
        * @param participant The participant account
        * @param participant_id Lower bound of participant object id to start getting results
        * @param limit Maximum number of participant objects to fetch
-       * @return The list of room participant objects
+       * @return The room participant objects, and the id to pass as @p participant_id to get the next
+       *         page if there is one
        */
-      vector<room_participant_object> get_rooms_by_participant( const account_id_type participant,
-                                                                const room_participant_id_type participant_id,
-                                                                uint32_t limit ) const;
+      room_participant_page get_rooms_by_participant( const account_id_type participant,
+                                                      const room_participant_id_type participant_id,
+                                                      uint32_t limit ) const;
 
       /**
        * @brief Get key epochs for a participant in a room
        * @param room The room id
        * @param participant The participant account
        * @param limit Maximum number of epoch objects to fetch
-       * @return The list of room key epoch objects
+       * @return The list of room key epoch objects, ordered by epoch
+       *
+       * Keys set by a key rotation are stored in one table per epoch rather than as objects of their own;
+       * they are returned as room key epoch objects with a null ID (0.0.0).
        */
       vector<room_key_epoch_object> get_room_key_epochs( const room_id_type room,
                                                           const account_id_type participant,
@@ -1001,7 +1006,7 @@ class database_api
        * @param room The room id
        * @param epoch The epoch number
        * @param participant The participant account
-       * @return The room key epoch object, if found
+       * @return The room key epoch object, if found. Its ID is null (0.0.0) if the key was set by a key rotation.
        */
       fc::optional<room_key_epoch_object> get_room_key_epoch( const room_id_type room,
                                                                uint32_t epoch,
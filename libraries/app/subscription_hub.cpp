@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+
+#include "subscription_hub.hxx"
+
+namespace graphene { namespace app {
+
+namespace {
+
+std::mutex& registry_mutex()
+{
+   static std::mutex m;
+   return m;
+}
+
+std::map<const chain::database*, std::weak_ptr<subscription_hub>>& registry()
+{
+   static std::map<const chain::database*, std::weak_ptr<subscription_hub>> hubs;
+   return hubs;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<subscription_hub> subscription_hub::get( chain::database& db )
+{
+   std::lock_guard<std::mutex> lock( registry_mutex() );
+   auto& hub = registry()[&db];
+   auto result = hub.lock();
+   if( !result )
+   {
+      result = std::make_shared<subscription_hub>( db );
+      hub = result;
+   }
+   return result;
+}
+
+subscription_hub::subscription_hub( chain::database& db )
+   : _db( db ), _thread( "subscription_hub" )
+{
+   _new_connection = _db.new_objects.connect( [this]( const vector<object_id_type>& ids,
+                                                      const flat_set<account_id_type>& impacted_accounts ) {
+      on_objects_changed( true, ids, impacted_accounts, [this]( object_id_type id ) {
+         const object* obj = _db.find_object( id );
+         return obj ? obj->to_variant() : fc::variant();
+      } );
+   } );
+   _change_connection = _db.changed_objects.connect( [this]( const vector<object_id_type>& ids,
+                                                             const flat_set<account_id_type>& impacted_accounts ) {
+      on_objects_changed( false, ids, impacted_accounts, [this]( object_id_type id ) {
+         const object* obj = _db.find_object( id );
+         return obj ? obj->to_variant() : fc::variant();
+      } );
+   } );
+   _removed_connection = _db.removed_objects.connect( [this]( const vector<object_id_type>& ids,
+                                                              const vector<const object*>&,
+                                                              const flat_set<account_id_type>& impacted_accounts ) {
+      on_objects_changed( true, ids, impacted_accounts, []( object_id_type id ) {
+         return fc::variant( id, 1 );
+      } );
+   } );
+}
+
+subscription_hub::~subscription_hub()
+{
+   _new_connection.disconnect();
+   _change_connection.disconnect();
+   _removed_connection.disconnect();
+   _thread.quit();
+
+   std::lock_guard<std::mutex> lock( registry_mutex() );
+   auto itr = registry().find( &_db );
+   if( itr != registry().end() && itr->second.expired() )
+      registry().erase( itr );
+}
+
+uint64_t subscription_hub::add_subscriber()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   const uint64_t subscriber = _next_subscriber++;
+   _subscribers[subscriber];
+   return subscriber;
+}
+
+void subscription_hub::remove_subscriber( uint64_t subscriber )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _subscribers.find( subscriber );
+   if( itr == _subscribers.end() )
+      return;
+   clear_subscriptions( subscriber, itr->second );
+   _subscribers.erase( itr );
+}
+
+void subscription_hub::set_callback( uint64_t subscriber, callback_type callback, bool notify_remove_create )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto& state = _subscribers.at( subscriber );
+   state.callback = callback;
+   ++state.generation;
+   state.notify_remove_create = notify_remove_create;
+   if( notify_remove_create )
+      _remove_create.insert( subscriber );
+   else
+      _remove_create.erase( subscriber );
+}
+
+void subscription_hub::reset( uint64_t subscriber, bool reset_callback )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto& state = _subscribers.at( subscriber );
+   clear_subscriptions( subscriber, state );
+   if( reset_callback )
+      state.callback = callback_type();
+   ++state.generation;
+}
+
+bool subscription_hub::is_current( uint64_t subscriber, uint64_t generation )const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _subscribers.find( subscriber );
+   return itr != _subscribers.end() && itr->second.generation == generation;
+}
+
+void subscription_hub::clear_subscriptions( uint64_t subscriber, subscriber_state& state )
+{
+   for( const auto& id : state.objects )
+   {
+      auto itr = _by_object.find( id );
+      itr->second.erase( subscriber );
+      if( itr->second.empty() )
+         _by_object.erase( itr );
+   }
+   for( const auto& account : state.accounts )
+   {
+      auto itr = _by_account.find( account );
+      itr->second.erase( subscriber );
+      if( itr->second.empty() )
+         _by_account.erase( itr );
+   }
+   state.objects.clear();
+   state.accounts.clear();
+   state.notify_remove_create = false;
+   _remove_create.erase( subscriber );
+}
+
+void subscription_hub::subscribe_to_object( uint64_t subscriber, object_id_type id )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto& state = _subscribers.at( subscriber );
+   // a query still running when its subscriber was reset subscribes to nothing
+   if( !state.callback )
+      return;
+   if( state.objects.insert( id ).second )
+      _by_object[id].insert( subscriber );
+}
+
+void subscription_hub::subscribe_to_account( uint64_t subscriber, account_id_type account )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto& state = _subscribers.at( subscriber );
+   if( !state.callback )
+      return;
+   if( state.accounts.insert( account ).second )
+      _by_account[account].insert( subscriber );
+}
+
+size_t subscription_hub::subscribed_account_count( uint64_t subscriber )const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _subscribers.at( subscriber ).accounts.size();
+}
+
+void subscription_hub::on_objects_changed( bool created_or_removed, const vector<object_id_type>& ids,
+                                           const flat_set<account_id_type>& impacted_accounts,
+                                           const std::function<fc::variant(object_id_type)>& serialize )
+{
+   // positions in ids each subscriber is notified of
+   std::map<uint64_t, std::vector<uint32_t>> recipients;
+   auto notify = [&recipients]( uint64_t subscriber, uint32_t index ) {
+      auto& indexes = recipients[subscriber];
+      if( indexes.empty() || indexes.back() != index )
+         indexes.push_back( index );
+   };
+
+   struct delivery
+   {
+      uint64_t              subscriber;
+      uint64_t              generation;
+      callback_type         callback;
+      std::vector<uint32_t> indexes;
+   };
+   std::vector<delivery> deliveries;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( _subscribers.empty() )
+         return;
+
+      // a subscriber following an impacted account gets every object of the batch
+      std::set<uint64_t> by_account;
+      for( const auto& account : impacted_accounts )
+      {
+         auto itr = _by_account.find( account );
+         if( itr != _by_account.end() )
+            by_account.insert( itr->second.begin(), itr->second.end() );
+      }
+
+      for( uint32_t i = 0; i < ids.size(); ++i )
+      {
+         if( created_or_removed )
+            for( auto subscriber : _remove_create )
+               notify( subscriber, i );
+         auto itr = _by_object.find( ids[i] );
+         if( itr != _by_object.end() )
+            for( auto subscriber : itr->second )
+               notify( subscriber, i );
+         for( auto subscriber : by_account )
+            notify( subscriber, i );
+      }
+
+      deliveries.reserve( recipients.size() );
+      for( auto& recipient : recipients )
+      {
+         const auto& state = _subscribers.at( recipient.first );
+         if( state.callback )
+            deliveries.push_back( delivery{ recipient.first, state.generation, state.callback,
+                                            std::move( recipient.second ) } );
+      }
+   }
+   if( deliveries.empty() )
+      return;
+
+   // serialized once, whatever the number of recipients
+   auto updates = std::make_shared<std::vector<fc::variant>>( ids.size() );
+   std::vector<bool> needed( ids.size(), false );
+   for( const auto& d : deliveries )
+      for( auto index : d.indexes )
+         needed[index] = true;
+   for( uint32_t i = 0; i < ids.size(); ++i )
+      if( needed[i] )
+         (*updates)[i] = serialize( ids[i] );
+
+   _thread.async( [this, updates, deliveries]() {
+      for( const auto& d : deliveries )
+      {
+         // copies of the serialized objects share their contents
+         fc::variants batch;
+         batch.reserve( d.indexes.size() );
+         for( auto index : d.indexes )
+            if( !(*updates)[index].is_null() )
+               batch.push_back( (*updates)[index] );
+         if( batch.empty() )
+            continue;
+         // the callback was copied, the subscriber may have cancelled or gone since
+         if( !is_current( d.subscriber, d.generation ) )
+            continue;
+         try {
+            d.callback( fc::variant( std::move( batch ) ) );
+         } catch( const fc::exception& e ) {
+            wlog( "Failed to deliver object updates: ${e}", ("e", e.to_detail_string()) );
+         }
+      }
+   }, "subscription_hub notify" );
+}
+
+} } // graphene::app
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+/**
+ * Object change notifications shared by every database API instance of a database.
+ *
+ * The hub is the only listener on the database's object signals. Subscribers are indexed by the
+ * objects and accounts they follow, each object which has at least one recipient is serialized
+ * once, and the updates are handed to the subscribers' callbacks on the hub's own thread. The
+ * work done on the chain thread depends on the changed objects, not on the number of subscribers.
+ */
+class subscription_hub
+{
+   public:
+      typedef std::function<void(const fc::variant&)> callback_type;
+
+      /// The hub of @p db, created when the first API instance asks for it
+      static std::shared_ptr<subscription_hub> get( chain::database& db );
+
+      explicit subscription_hub( chain::database& db );
+      ~subscription_hub();
+
+      /// Registers a subscriber which receives nothing until it gets a callback
+      uint64_t add_subscriber();
+      void remove_subscriber( uint64_t subscriber );
+
+      /// Sets the callback and whether the subscriber wants every created and removed object
+      void set_callback( uint64_t subscriber, callback_type callback, bool notify_remove_create );
+      /// Drops the subscriber's objects and accounts, and its callback if @p reset_callback. Updates queued
+      /// before are not delivered, unless their delivery has already started
+      void reset( uint64_t subscriber, bool reset_callback );
+
+      /// Subscriptions of a subscriber without a callback are ignored
+      void subscribe_to_object( uint64_t subscriber, object_id_type id );
+      /// Follows every change which impacts @p account
+      void subscribe_to_account( uint64_t subscriber, account_id_type account );
+      size_t subscribed_account_count( uint64_t subscriber )const;
+
+   private:
+      struct subscriber_state
+      {
+         callback_type             callback;
+         /// Changed by every reset and new callback, so queued updates for the former ones are dropped
+         uint64_t                  generation = 0;
+         bool                      notify_remove_create = false;
+         std::set<object_id_type>  objects;
+         std::set<account_id_type> accounts;
+      };
+
+      void on_objects_changed( bool created_or_removed, const vector<object_id_type>& ids,
+                               const flat_set<account_id_type>& impacted_accounts,
+                               const std::function<fc::variant(object_id_type)>& serialize );
+      void clear_subscriptions( uint64_t subscriber, subscriber_state& state );
+      /// Whether the subscriber still exists and was not reset since @p generation
+      bool is_current( uint64_t subscriber, uint64_t generation )const;
+
+      chain::database&                                   _db;
+      fc::thread                                         _thread;
+
+      mutable std::mutex                                 _mutex;
+      uint64_t                                           _next_subscriber = 0;
+      std::map<uint64_t, subscriber_state>               _subscribers;
+      std::map<object_id_type, std::set<uint64_t>>       _by_object;
+      std::map<account_id_type, std::set<uint64_t>>      _by_account;
+      /// Subscribers notified of every created and removed object
+      std::set<uint64_t>                                 _remove_create;
+
+      boost::signals2::scoped_connection                 _new_connection;
+      boost::signals2::scoped_connection                 _change_connection;
+      boost::signals2::scoped_connection                 _removed_connection;
+};
+
+} } // graphene::app
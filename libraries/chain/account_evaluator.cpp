@@ -408,6 +408,10 @@ void_result account_upgrade_evaluator::do_apply(const account_upgrade_evaluator:
 { try {
    database& d = db();
 
+   // the fees paid so far in this block are processed along with the older ones
+   if( o.upgrade_to_lifetime_member )
+      d.apply_pending_fees( account->statistics(d) );
+
    d.modify(*account, [&](account_object& a) {
       if( o.upgrade_to_lifetime_member )
       {
@@ -106,33 +106,37 @@ void account_statistics_object::pay_fee( share_type core_fee, share_type cashbac
       pending_vested_fees += core_fee;
 }
 
-set<account_id_type> account_member_index::get_account_members(const account_object& a)const
+set<account_id_type> account_member_index::get_account_members( const authority& owner,
+                                                                 const authority& active )const
 {
    set<account_id_type> result;
-   for( auto auth : a.owner.account_auths )
+   for( auto auth : owner.account_auths )
       result.insert(auth.first);
-   for( auto auth : a.active.account_auths )
+   for( auto auth : active.account_auths )
       result.insert(auth.first);
    return result;
 }
-set<public_key_type, pubkey_comparator> account_member_index::get_key_members(const account_object& a)const
+set<public_key_type, pubkey_comparator> account_member_index::get_key_members( const authority& owner,
+                                                                               const authority& active,
+                                                                               const public_key_type& memo_key )const
 {
    set<public_key_type, pubkey_comparator> result;
-   for( auto auth : a.owner.key_auths )
+   for( auto auth : owner.key_auths )
       result.insert(auth.first);
-   for( auto auth : a.active.key_auths )
+   for( auto auth : active.key_auths )
       result.insert(auth.first);
-   result.insert( a.options.memo_key );
+   result.insert( memo_key );
    return result;
 }
-set<address> account_member_index::get_address_members(const account_object& a)const
+set<address> account_member_index::get_address_members( const authority& owner, const authority& active,
+                                                        const public_key_type& memo_key )const
 {
    set<address> result;
-   for( auto auth : a.owner.address_auths )
+   for( auto auth : owner.address_auths )
       result.insert(auth.first);
-   for( auto auth : a.active.address_auths )
+   for( auto auth : active.address_auths )
       result.insert(auth.first);
-   result.insert( a.options.memo_key );
+   result.insert( memo_key );
    return result;
 }
 
@@ -141,15 +145,15 @@ void account_member_index::object_inserted(const object& obj)
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto account_members = get_account_members(a);
+    auto account_members = get_account_members(a.owner, a.active);
     for( auto item : account_members )
        account_to_account_memberships[item].insert(obj.id);
 
-    auto key_members = get_key_members(a);
+    auto key_members = get_key_members(a.owner, a.active, a.options.memo_key);
     for( auto item : key_members )
        account_to_key_memberships[item].insert(obj.id);
 
-    auto address_members = get_address_members(a);
+    auto address_members = get_address_members(a.owner, a.active, a.options.memo_key);
     for( auto item : address_members )
        account_to_address_memberships[item].insert(obj.id);
 }
@@ -159,28 +163,27 @@ void account_member_index::object_removed(const object& obj)
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto key_members = get_key_members(a);
+    auto key_members = get_key_members(a.owner, a.active, a.options.memo_key);
     for( auto item : key_members )
        account_to_key_memberships[item].erase( obj.id );
 
-    auto address_members = get_address_members(a);
+    auto address_members = get_address_members(a.owner, a.active, a.options.memo_key);
     for( auto item : address_members )
        account_to_address_memberships[item].erase( obj.id );
 
-    auto account_members = get_account_members(a);
+    auto account_members = get_account_members(a.owner, a.active);
     for( auto item : account_members )
        account_to_account_memberships[item].erase( obj.id );
 }
 
 void account_member_index::about_to_modify(const object& before)
 {
-   before_key_members.clear();
-   before_account_members.clear();
    assert( dynamic_cast<const account_object*>(&before) ); // for debug only
    const account_object& a = static_cast<const account_object&>(before);
-   before_key_members     = get_key_members(a);
-   before_address_members = get_address_members(a);
-   before_account_members = get_account_members(a);
+   // copying the authorities is much cheaper than building the member sets, which most modifications do not change
+   before_owner    = a.owner;
+   before_active   = a.active;
+   before_memo_key = a.options.memo_key;
 }
 
 void account_member_index::object_modified(const object& after)
@@ -188,8 +191,12 @@ void account_member_index::object_modified(const object& after)
     assert( dynamic_cast<const account_object*>(&after) ); // for debug only
     const account_object& a = static_cast<const account_object&>(after);
 
+    if( a.owner == before_owner && a.active == before_active && a.options.memo_key == before_memo_key )
+       return;
+
     {
-       set<account_id_type> after_account_members = get_account_members(a);
+       set<account_id_type> before_account_members = get_account_members(before_owner, before_active);
+       set<account_id_type> after_account_members = get_account_members(a.owner, a.active);
        vector<account_id_type> removed; removed.reserve(before_account_members.size());
        std::set_difference(before_account_members.begin(), before_account_members.end(),
                            after_account_members.begin(), after_account_members.end(),
@@ -209,7 +216,10 @@ void account_member_index::object_modified(const object& after)
 
 
     {
-       set<public_key_type, pubkey_comparator> after_key_members = get_key_members(a);
+       set<public_key_type, pubkey_comparator> before_key_members = get_key_members(before_owner, before_active,
+                                                                                    before_memo_key);
+       set<public_key_type, pubkey_comparator> after_key_members = get_key_members(a.owner, a.active,
+                                                                                   a.options.memo_key);
 
        vector<public_key_type> removed; removed.reserve(before_key_members.size());
        std::set_difference(before_key_members.begin(), before_key_members.end(),
@@ -229,7 +239,8 @@ void account_member_index::object_modified(const object& after)
     }
 
     {
-       set<address> after_address_members = get_address_members(a);
+       set<address> before_address_members = get_address_members(before_owner, before_active, before_memo_key);
+       set<address> after_address_members = get_address_members(a.owner, a.active, a.options.memo_key);
 
        vector<address> removed; removed.reserve(before_address_members.size());
        std::set_difference(before_address_members.begin(), before_address_members.end(),
@@ -300,6 +311,49 @@ const account_balance_object* balances_by_account_index::get_account_balance( co
    return itr->second;
 }
 
+void asset_holders_index::object_inserted( const object& obj )
+{
+   const auto& abo = dynamic_cast< const account_balance_object& >( obj );
+   if( abo.balance != 0 )
+      adjust( abo.asset_type, 1 );
+}
+
+void asset_holders_index::object_removed( const object& obj )
+{
+   const auto& abo = dynamic_cast< const account_balance_object& >( obj );
+   if( abo.balance != 0 )
+      adjust( abo.asset_type, -1 );
+}
+
+void asset_holders_index::about_to_modify( const object& before )
+{
+   const auto& abo = dynamic_cast< const account_balance_object& >( before );
+   held_before_modify.push( abo.balance != 0 );
+}
+
+void asset_holders_index::object_modified( const object& after  )
+{
+   const auto& abo = dynamic_cast< const account_balance_object& >( after );
+   const bool held_before = held_before_modify.top();
+   held_before_modify.pop();
+   const bool held_after = ( abo.balance != 0 );
+   if( held_before != held_after )
+      adjust( abo.asset_type, held_after ? 1 : -1 );
+}
+
+uint64_t asset_holders_index::get_holder_count( const asset_id_type& asset )const
+{
+   if( asset.instance.value >= holder_counts.size() ) return 0;
+   return holder_counts[asset.instance.value];
+}
+
+void asset_holders_index::adjust( const asset_id_type& asset, int64_t delta )
+{
+   if( asset.instance.value >= holder_counts.size() )
+      holder_counts.resize( asset.instance.value + 1 );
+   holder_counts[asset.instance.value] += delta;
+}
+
 } } // graphene::chain
 
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::account_object,
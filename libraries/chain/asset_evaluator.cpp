@@ -1003,6 +1003,8 @@ void_result asset_claim_fees_evaluator::do_evaluate( const asset_claim_fees_oper
               ("a",container_asset->symbol)("id",container_asset->id)("fid",o.amount_to_claim.asset_id) );
 
    container_ddo = &container_asset->dynamic_asset_data_id(d);
+   // fees paid so far in this block can be claimed
+   db().apply_pending_fees( *container_ddo );
 
    if (container_asset->get_id() == o.amount_to_claim.asset_id) {
       FC_ASSERT( o.amount_to_claim.amount <= container_ddo->accumulated_fees,
@@ -1057,6 +1059,7 @@ void_result asset_claim_pool_evaluator::do_apply( const asset_claim_pool_operati
 
     const asset_object& a = o.asset_id(d);
     const asset_dynamic_data_object& addo = a.dynamic_asset_data_id(d);
+    d.apply_pending_fees( addo );
     FC_ASSERT( o.amount_to_claim.amount <= addo.fee_pool, "Attempt to claim more fees than is available", ("addo",addo) );
 
     d.modify( addo, [&o]( asset_dynamic_data_object& _addo  ) {
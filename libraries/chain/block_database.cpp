@@ -24,152 +24,182 @@
 #include <graphene/chain/block_database.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
 #include <fc/io/raw.hpp>
-#include <boost/endian/buffers.hpp>
 
-namespace graphene { namespace chain {
-
-struct index_entry
-{
-   index_entry() {
-      block_pos = 0;
-      block_size = 0;
-   };
-   boost::endian::little_uint64_buf_t block_pos;
-   boost::endian::little_uint32_buf_t block_size;
-   block_id_type                      block_id;
-};
- }}
 FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
+// Blocks appended after the mapping was made are read from the stream until this much is unmapped
+static const uint64_t remap_threshold = 64 << 20;
+
 void block_database::open( const fc::path& dbdir )
 { try {
+   std::lock_guard<std::mutex> guard( _mutex );
    fc::create_directories(dbdir);
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
+   _blocks_filename = dbdir / "blocks";
    if( !fc::exists( _index_filename ) )
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
    }
    else
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+   }
+
+   _index.resize( fc::file_size( _index_filename ) / sizeof(index_entry) );
+   if( !_index.empty() )
+   {
+      _block_num_to_pos.seekg( 0 );
+      _block_num_to_pos.read( (char*)_index.data(), _index.size() * sizeof(index_entry) );
    }
+   _blocks_size = fc::file_size( _blocks_filename );
+   _read_position = 0;
+   remap_blocks();
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
 bool block_database::is_open()const
 {
+  std::lock_guard<std::mutex> guard( _mutex );
   return _blocks.is_open();
 }
 
 void block_database::close()
 {
+  std::lock_guard<std::mutex> guard( _mutex );
+  _blocks_region.reset();
+  _blocks_mapping.reset();
+  _mapped_size = 0;
+  _index.clear();
   _blocks.close();
   _block_num_to_pos.close();
 }
 
 void block_database::flush()
 {
+  std::lock_guard<std::mutex> guard( _mutex );
   _blocks.flush();
   _block_num_to_pos.flush();
 }
 
+void block_database::remap_blocks()const
+{
+   _blocks_region.reset();
+   _blocks_mapping.reset();
+   _mapped_size = 0;
+   if( _blocks_size == 0 )
+      return;
+   _blocks.flush();
+   _blocks_mapping = std::make_unique<fc::file_mapping>( _blocks_filename.generic_string().c_str(), fc::read_only );
+   _blocks_region = std::make_unique<fc::mapped_region>( *_blocks_mapping, fc::read_only, 0, _blocks_size );
+   _mapped_size = _blocks_size;
+}
+
+const char* block_database::block_data( const index_entry& e, vector<char>& buffer )const
+{
+   const uint64_t end = e.block_pos.value() + e.block_size.value();
+   FC_ASSERT( end <= _blocks_size, "Block extends past the end of the block log (maybe corrupt on disk?)" );
+   _read_position = end;
+   if( end > _mapped_size && _blocks_size - _mapped_size >= remap_threshold )
+      remap_blocks();
+   if( end <= _mapped_size )
+      return (const char*)_blocks_region->get_address() + e.block_pos.value();
+
+   // recently appended, not worth a new mapping yet
+   buffer.resize( e.block_size.value() );
+   _blocks.seekg( e.block_pos.value() );
+   _blocks.read( buffer.data(), e.block_size.value() );
+   return buffer.data();
+}
+
+const index_entry* block_database::find_entry( uint32_t block_num )const
+{
+   if( block_num >= _index.size() )
+      return nullptr;
+   return &_index[block_num];
+}
+
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
+   std::lock_guard<std::mutex> guard( _mutex );
    block_id_type id = _id;
    if( id == block_id_type() )
    {
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
-   _block_num_to_pos.seekp( sizeof( index_entry ) * int64_t(block_header::num_from_id(id)) );
+   const uint32_t block_num = block_header::num_from_id(id);
+   _block_num_to_pos.seekp( sizeof( index_entry ) * int64_t(block_num) );
    index_entry e;
    _blocks.seekp( 0, _blocks.end );
    auto vec = fc::raw::pack( b );
-   e.block_pos  = _blocks.tellp();
+   e.block_pos  = _blocks_size;
    e.block_size = vec.size();
    e.block_id   = id;
    _blocks.write( vec.data(), vec.size() );
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   _blocks_size += vec.size();
+   if( _index.size() <= block_num )
+      _index.resize( block_num + 1 );
+   _index[block_num] = e;
 }
 
 void block_database::remove( const block_id_type& id )
 { try {
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   std::lock_guard<std::mutex> guard( _mutex );
+   const uint32_t block_num = block_header::num_from_id(id);
+   if( block_num >= _index.size() )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
+   index_entry& e = _index[block_num];
    if( e.block_id == id )
    {
       e.block_size = 0;
-      _block_num_to_pos.seekp( sizeof(e) * int64_t(block_header::num_from_id(id)) );
+      _block_num_to_pos.seekp( sizeof(e) * int64_t(block_num) );
       _block_num_to_pos.write( (char*)&e, sizeof(e) );
    }
 } FC_CAPTURE_AND_RETHROW( (id) ) }
 
 bool block_database::contains( const block_id_type& id )const
 {
+   std::lock_guard<std::mutex> guard( _mutex );
    if( id == block_id_type() )
       return false;
 
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() < int64_t(index_pos + sizeof(e)) )
-      return false;
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   return e.block_id == id && e.block_size.value() > 0;
+   const index_entry* e = find_entry( block_header::num_from_id(id) );
+   return e != nullptr && e->block_id == id && e->block_size.value() > 0;
 }
 
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
+   std::lock_guard<std::mutex> guard( _mutex );
    assert( block_num != 0 );
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_num);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   const index_entry* e = find_entry( block_num );
+   if( e == nullptr )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
-   return e.block_id;
+   FC_ASSERT( e->block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
+   return e->block_id;
 }
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
+   std::lock_guard<std::mutex> guard( _mutex );
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
-
-      _block_num_to_pos.seekg( index_pos );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      if( e.block_id != id ) return optional<signed_block>();
-
-      vector<char> data( e.block_size.value() );
-      _blocks.seekg( e.block_pos.value() );
-      if (e.block_size.value())
-         _blocks.read( data.data(), e.block_size.value() );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
+      const index_entry* e = find_entry( block_header::num_from_id(id) );
+      if( e == nullptr || e->block_id != id ) return optional<signed_block>();
+
+      vector<char> buffer;
+      fc::datastream<const char*> ds( block_data( *e, buffer ), e->block_size.value() );
+      signed_block result;
+      fc::raw::unpack( ds, result );
+      FC_ASSERT( result.id() == e->block_id );
       return result;
    }
    catch (const fc::exception&)
@@ -183,22 +213,18 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
 
 optional<signed_block> block_database::fetch_by_number( uint32_t block_num )const
 {
+   std::lock_guard<std::mutex> guard( _mutex );
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_num);
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
+      const index_entry* e = find_entry( block_num );
+      if( e == nullptr )
          return {};
 
-      _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      vector<char> data( e.block_size.value() );
-      _blocks.seekg( e.block_pos.value() );
-      _blocks.read( data.data(), e.block_size.value() );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
+      vector<char> buffer;
+      fc::datastream<const char*> ds( block_data( *e, buffer ), e->block_size.value() );
+      signed_block result;
+      fc::raw::unpack( ds, result );
+      FC_ASSERT( result.id() == e->block_id );
       return result;
    }
    catch (const fc::exception&)
@@ -210,38 +236,49 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    return optional<signed_block>();
 }
 
-optional<index_entry> block_database::last_index_entry()const {
+bool block_database::fetch_packed( const block_id_type& id, vector<char>& data )const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
    try
    {
-      index_entry e;
-
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      std::streampos pos = _block_num_to_pos.tellg();
-      if( pos < long(sizeof(index_entry)) )
-         return optional<index_entry>();
-
-      pos -= pos % sizeof(index_entry);
+      const index_entry* e = find_entry( block_header::num_from_id(id) );
+      if( e == nullptr || e->block_id != id || e->block_size.value() == 0 )
+         return false;
+
+      vector<char> buffer;
+      const char* packed = block_data( *e, buffer );
+      // the header alone is enough to check the stored bytes belong to the block
+      fc::datastream<const char*> ds( packed, e->block_size.value() );
+      signed_block_header header;
+      fc::raw::unpack( ds, header );
+      FC_ASSERT( header.id() == e->block_id );
+      data.insert( data.end(), packed, packed + e->block_size.value() );
+      return true;
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return false;
+}
 
-      _blocks.seekg( 0, _block_num_to_pos.end );
-      const std::streampos blocks_size = _blocks.tellg();
-      while( pos > 0 )
+optional<index_entry> block_database::last_index_entry()const {
+   try
+   {
+      while( !_index.empty() )
       {
-         pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
-         if( _block_num_to_pos.gcount() == sizeof(e) && e.block_size.value() > 0
-                && int64_t(e.block_pos.value() + e.block_size.value()) <= blocks_size )
+         const index_entry& e = _index.back();
+         if( e.block_size.value() > 0 && e.block_pos.value() + e.block_size.value() <= _blocks_size )
             try
             {
-               vector<char> data( e.block_size.value() );
-               _blocks.seekg( e.block_pos.value() );
-               _blocks.read( data.data(), e.block_size.value() );
-               if( _blocks.gcount() == long(e.block_size.value()) )
-               {
-                  const signed_block block = fc::raw::unpack<signed_block>(data);
-                  if( block.id() == e.block_id )
-                     return e;
-               }
+               vector<char> buffer;
+               fc::datastream<const char*> ds( block_data( e, buffer ), e.block_size.value() );
+               signed_block block;
+               fc::raw::unpack( ds, block );
+               if( block.id() == e.block_id )
+                  return e;
             }
             catch (const fc::exception&)
             {
@@ -249,7 +286,9 @@ optional<index_entry> block_database::last_index_entry()const {
             catch (const std::exception&)
             {
             }
-         fc::resize_file( _index_filename, pos );
+         _index.pop_back();
+         _block_num_to_pos.flush();
+         fc::resize_file( _index_filename, _index.size() * sizeof(index_entry) );
       }
    }
    catch (const fc::exception&)
@@ -263,13 +302,18 @@ optional<index_entry> block_database::last_index_entry()const {
 
 optional<signed_block> block_database::last()const
 {
-   optional<index_entry> entry = last_index_entry();
+   optional<index_entry> entry;
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      entry = last_index_entry();
+   }
    if( entry.valid() ) return fetch_by_number( block_header::num_from_id(entry->block_id) );
    return optional<signed_block>();
 }
 
 optional<block_id_type> block_database::last_id()const
 {
+   std::lock_guard<std::mutex> guard( _mutex );
    optional<index_entry> entry = last_index_entry();
    if( entry.valid() ) return entry->block_id;
    return optional<block_id_type>();
@@ -277,13 +321,14 @@ optional<block_id_type> block_database::last_id()const
 
 size_t block_database::blocks_current_position()const
 {
-   return (size_t)_blocks.tellg();
+   std::lock_guard<std::mutex> guard( _mutex );
+   return (size_t)_read_position;
 }
 
 size_t block_database::total_block_size()const
 {
-   _blocks.seekg( 0, _blocks.end );
-   return (size_t)_blocks.tellg();
+   std::lock_guard<std::mutex> guard( _mutex );
+   return (size_t)_blocks_size;
 }
 
 } }
@@ -35,6 +35,31 @@
 
 namespace graphene { namespace chain {
 
+namespace {
+
+/// Sets the large fields of @p obj, or a reference to them when the content store is enabled
+template<typename Operation>
+void set_content_payload( database& d, content_card_object& obj, const Operation& o )
+{
+   content_store* store = d.get_content_store();
+   if( store == nullptr )
+   {
+      obj.url          = o.url;
+      obj.description  = o.description;
+      obj.content_key  = o.content_key;
+      obj.storage_data = o.storage_data;
+      obj.payload.reset();
+      return;
+   }
+   obj.payload = store->append( content_payload{ o.url, o.description, o.content_key, o.storage_data } );
+   obj.url.clear();
+   obj.description.clear();
+   obj.content_key.clear();
+   obj.storage_data.clear();
+}
+
+} // anonymous namespace
+
 void_result content_card_create_evaluator::do_evaluate( const content_card_create_operation& op )
 { try {
    database& d = db();
@@ -45,8 +70,8 @@ void_result content_card_create_evaluator::do_evaluate( const content_card_creat
    const auto& content_idx = d.get_index_type<content_card_index>();
    const auto& content_op_idx = content_idx.indices().get<by_subject_account_and_hash>();
 
-   auto itr = content_op_idx.lower_bound(boost::make_tuple(op.subject_account, op.hash));
-   FC_ASSERT(itr->subject_account != op.subject_account || itr->hash != op.hash, "Content card already exists.");
+   auto itr = content_op_idx.find(boost::make_tuple(op.subject_account, content_hash(op.hash)));
+   FC_ASSERT(itr == content_op_idx.end(), "Content card already exists.");
 
    // Check room membership if room is specified
    if(op.room.valid()) {
@@ -68,7 +93,7 @@ object_id_type content_card_create_evaluator::do_apply( const content_card_creat
    const auto& new_content_object = d.create<content_card_object>( [&o, &use_full_content_card, &d]( content_card_object& obj )
    {
          obj.subject_account = o.subject_account;
-         obj.hash            = o.hash;
+         obj.hash            = content_hash(o.hash);
          obj.room            = o.room;
 
          if( o.room.valid() )
@@ -78,12 +103,9 @@ object_id_type content_card_create_evaluator::do_apply( const content_card_creat
          }
 
          if (use_full_content_card) {
-            obj.url             = o.url;
             obj.type            = o.type;
-            obj.description     = o.description;
-            obj.content_key     = o.content_key;
             obj.timestamp       = time_point::now().sec_since_epoch();
-            obj.storage_data    = o.storage_data;
+            set_content_payload( d, obj, o );
          }
    });
    return new_content_object.id;
@@ -100,8 +122,8 @@ void_result content_card_update_evaluator::do_evaluate( const content_card_updat
    const auto& content_idx = d.get_index_type<content_card_index>();
    const auto& content_op_idx = content_idx.indices().get<by_subject_account_and_hash>();
 
-   auto itr = content_op_idx.lower_bound(boost::make_tuple(op.subject_account, op.hash));
-   FC_ASSERT(itr->subject_account == op.subject_account && itr->hash == op.hash, "Content card does not exists.");
+   auto itr = content_op_idx.find(boost::make_tuple(op.subject_account, content_hash(op.hash)));
+   FC_ASSERT(itr != content_op_idx.end(), "Content card does not exists.");
 
    // Check room membership if room is specified
    if(op.room.valid()) {
@@ -121,18 +143,15 @@ object_id_type content_card_update_evaluator::do_apply( const content_card_updat
    const auto& content_idx = d.get_index_type<content_card_index>();
    const auto& content_op_idx = content_idx.indices().get<by_subject_account_and_hash>();
 
-   auto itr = content_op_idx.lower_bound(boost::make_tuple(o.subject_account, o.hash));
+   auto itr = content_op_idx.find(boost::make_tuple(o.subject_account, content_hash(o.hash)));
 
    d.modify( *itr, [&o, &d](content_card_object& obj){
          obj.subject_account = o.subject_account;
-         obj.hash            = o.hash;
-         obj.url             = o.url;
+         obj.hash            = content_hash(o.hash);
          obj.type            = o.type;
-         obj.description     = o.description;
-         obj.content_key     = o.content_key;
          obj.timestamp       = time_point::now().sec_since_epoch();
-         obj.storage_data    = o.storage_data;
          obj.room            = o.room;
+         set_content_payload( d, obj, o );
 
          if( o.room.valid() )
          {
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include <graphene/chain/content_hash.hpp>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+bool is_lower_hex_digest( const std::string& hash )
+{
+   if( hash.size() != 2 * sizeof( fc::sha256 ) )
+      return false;
+   for( char c : hash )
+      if( !( ( c >= '0' && c <= '9' ) || ( c >= 'a' && c <= 'f' ) ) )
+         return false;
+   return true;
+}
+
+} // anonymous namespace
+
+content_hash::content_hash( const std::string& hash )
+{
+   if( is_lower_hex_digest( hash ) )
+      _digest = fc::sha256( hash );
+   else
+      _text = std::make_shared<const std::string>( hash );
+}
+
+std::string content_hash::str()const
+{
+   return _text ? *_text : _digest.str();
+}
+
+} } // graphene::chain
+
+namespace fc {
+
+void to_variant( const graphene::chain::content_hash& hash, fc::variant& var, uint32_t max_depth )
+{
+   var = hash.str();
+}
+
+void from_variant( const fc::variant& var, graphene::chain::content_hash& hash, uint32_t max_depth )
+{
+   hash = graphene::chain::content_hash( var.as_string() );
+}
+
+} // fc
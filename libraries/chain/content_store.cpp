@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include <graphene/chain/content_store.hpp>
+
+#include <fc/io/raw.hpp>
+
+namespace graphene { namespace chain {
+
+// Payloads appended after the mapping was made are read from the stream until this much is unmapped
+static const uint64_t remap_threshold = 16 << 20;
+
+void content_store::open( const fc::path& filename )
+{ try {
+   std::lock_guard<std::mutex> guard( _mutex );
+   fc::create_directories( filename.parent_path() );
+   _filename = filename;
+   _file.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   auto mode = std::fstream::binary | std::fstream::in | std::fstream::out;
+   if( !fc::exists( _filename ) )
+      mode |= std::fstream::trunc;
+   _file.open( _filename.generic_string().c_str(), mode );
+   _size = fc::file_size( _filename );
+   reset_caches();
+   remap();
+} FC_CAPTURE_AND_RETHROW( (filename) ) }
+
+void content_store::flush()
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   if( _file.is_open() )
+      _file.flush();
+}
+
+void content_store::close()
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   _region.reset();
+   _mapping.reset();
+   _mapped_size = 0;
+   reset_caches();
+   if( _file.is_open() )
+      _file.close();
+}
+
+void content_store::clear()
+{ try {
+   std::lock_guard<std::mutex> guard( _mutex );
+   FC_ASSERT( _file.is_open(), "The content store is not open" );
+   _region.reset();
+   _mapping.reset();
+   _mapped_size = 0;
+   reset_caches();
+   _file.close();
+   _file.open( _filename.generic_string().c_str(),
+               std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc );
+   _size = 0;
+} FC_CAPTURE_AND_RETHROW( (_filename) ) }
+
+void content_store::reset_caches()
+{
+   _lru.clear();
+   _cached.clear();
+   _cached_bytes = 0;
+   _recent.clear();
+   _recent_order.clear();
+}
+
+void content_store::remap()const
+{
+   _region.reset();
+   _mapping.reset();
+   _mapped_size = 0;
+   if( _size == 0 )
+      return;
+   _file.flush();
+   _mapping = std::make_unique<fc::file_mapping>( _filename.generic_string().c_str(), fc::read_only );
+   _region = std::make_unique<fc::mapped_region>( *_mapping, fc::read_only, 0, _size );
+   _mapped_size = _size;
+}
+
+size_t content_store::payload_bytes( const content_payload& payload )
+{
+   return sizeof( payload ) + payload.url.size() + payload.description.size()
+          + payload.content_key.size() + payload.storage_data.size();
+}
+
+content_store_ref content_store::append( const content_payload& payload )
+{ try {
+   const auto data = fc::raw::pack( payload );
+   const auto digest = fc::sha256::hash( data.data(), data.size() );
+
+   std::lock_guard<std::mutex> guard( _mutex );
+   FC_ASSERT( _file.is_open(), "The content store is not open" );
+   auto itr = _recent.find( digest );
+   if( itr != _recent.end() )
+      return itr->second;
+
+   content_store_ref ref;
+   ref.offset = _size;
+   ref.size = data.size();
+   _file.seekp( _size );
+   _file.write( data.data(), data.size() );
+   _size += data.size();
+
+   _recent.emplace( digest, ref );
+   _recent_order.push_back( digest );
+   if( _recent_order.size() > max_recent )
+   {
+      _recent.erase( _recent_order.front() );
+      _recent_order.pop_front();
+   }
+   return ref;
+} FC_CAPTURE_AND_RETHROW( (_filename) ) }
+
+content_payload content_store::read( const content_store_ref& ref )const
+{ try {
+   std::lock_guard<std::mutex> guard( _mutex );
+   auto cached = _cached.find( ref.offset );
+   if( cached != _cached.end() )
+   {
+      _lru.splice( _lru.begin(), _lru, cached->second );
+      return cached->second->second;
+   }
+
+   const uint64_t end = ref.offset + ref.size;
+   FC_ASSERT( end <= _size, "Payload extends past the end of the content store (maybe corrupt on disk?)" );
+   if( end > _mapped_size && _size - _mapped_size >= remap_threshold )
+      remap();
+   std::vector<char> buffer;
+   const char* data;
+   if( end <= _mapped_size )
+      data = (const char*)_region->get_address() + ref.offset;
+   else
+   {
+      // recently appended, not worth a new mapping yet
+      buffer.resize( ref.size );
+      _file.seekg( ref.offset );
+      _file.read( buffer.data(), ref.size );
+      data = buffer.data();
+   }
+   content_payload payload;
+   fc::datastream<const char*> ds( data, ref.size );
+   fc::raw::unpack( ds, payload );
+
+   const size_t bytes = payload_bytes( payload );
+   if( bytes <= _cache_limit )
+   {
+      _lru.emplace_front( ref.offset, payload );
+      _cached[ref.offset] = _lru.begin();
+      _cached_bytes += bytes;
+      while( _cached_bytes > _cache_limit )
+      {
+         _cached_bytes -= payload_bytes( _lru.back().second );
+         _cached.erase( _lru.back().first );
+         _lru.pop_back();
+      }
+   }
+   return payload;
+} FC_CAPTURE_AND_RETHROW( (ref.offset)(ref.size) ) }
+
+uint64_t content_store::size()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _size;
+}
+
+} } // graphene::chain
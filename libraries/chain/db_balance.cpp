@@ -269,4 +269,29 @@ void database::deposit_witness_pay(const witness_object& wit, share_type amount)
    return;
 }
 
+void database::pay_fee( const account_statistics_object& stats, share_type core_fee )
+{
+   _fee_accumulator.pay_fee( *this, stats, core_fee, get_global_properties().parameters.cashback_vesting_threshold );
+}
+
+void database::convert_fee( const asset_dynamic_data_object& dyn_data, share_type fee_amount, share_type core_fee )
+{
+   _fee_accumulator.convert_fee( *this, dyn_data, fee_amount, core_fee );
+}
+
+share_type database::get_fee_pool( const asset_dynamic_data_object& dyn_data )const
+{
+   return dyn_data.fee_pool + _fee_accumulator.pending_fee_pool_change( dyn_data );
+}
+
+void database::apply_pending_fees( const account_statistics_object& stats )
+{
+   _fee_accumulator.apply( *this, stats );
+}
+
+void database::apply_pending_fees( const asset_dynamic_data_object& dyn_data )
+{
+   _fee_accumulator.apply( *this, dyn_data );
+}
+
 } }
@@ -28,6 +28,7 @@
 #include <graphene/chain/hardfork.hpp>
 
 #include <graphene/chain/block_summary_object.hpp>
+#include <graphene/chain/custom_authority_object.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 
@@ -42,6 +43,12 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/thread/parallel.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/thread/thread_specific.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <map>
 
 namespace graphene { namespace chain {
 
@@ -62,7 +69,18 @@ bool database::is_known_transaction( const transaction_id_type& id )const
 
 block_id_type  database::get_block_id_for_num( uint32_t block_num )const
 { try {
-   return _block_id_to_block.fetch_block_id( block_num );
+   try {
+      return _block_id_to_block.fetch_block_id( block_num );
+   } catch( const fc::exception& ) {
+      // a node started from a snapshot has the ids of the recent blocks before it in the block summaries only
+      const uint32_t head = head_block_num();
+      if( block_num == 0 || block_num > head || head - block_num > 0xffff )
+         throw;
+      const auto* summary = find( block_summary_id_type( block_num & 0xffff ) );
+      if( summary == nullptr || block_header::num_from_id( summary->block_id ) != block_num )
+         throw;
+      return summary->block_id;
+   }
 } FC_CAPTURE_AND_RETHROW( (block_num) ) }
 
 optional<signed_block> database::fetch_block_by_id( const block_id_type& id )const
@@ -73,6 +91,16 @@ optional<signed_block> database::fetch_block_by_id( const block_id_type& id )con
    return b->data;
 }
 
+bool database::fetch_packed_block_by_id( const block_id_type& id, vector<char>& data )const
+{
+   auto b = _fork_db.fetch_block( id );
+   if( !b )
+      return _block_id_to_block.fetch_packed( id, data );
+   auto packed = fc::raw::pack( b->data );
+   data.insert( data.end(), packed.begin(), packed.end() );
+   return true;
+}
+
 optional<signed_block> database::fetch_block_by_number( uint32_t num )const
 {
    auto results = _fork_db.fetch_block_by_number(num);
@@ -108,6 +136,43 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
   return result;
 }
 
+const void* database::current_task()
+{
+   // the address of a marker allocated for each task, freed when the task ends
+   static fc::task_specific_ptr<char> marker;
+   if( !marker )
+      marker.reset( new char() );
+   return marker.get();
+}
+
+database::state_change_scope::state_change_scope( database& db ) : _db( db )
+{
+   if( !_db._concurrent_reads )
+      return;
+   _counted = true;
+   if( _db.is_changing_state() )
+   {
+      ++_db._state_change_depth;
+      return;
+   }
+   // another task of this thread holding the lock can only release it if this one yields
+   while( _db._state_changer_thread.load() == std::this_thread::get_id() )
+      fc::yield();
+   _db._state_mutex.lock();
+   _db._state_changer_thread = std::this_thread::get_id();
+   _db._state_changer = current_task();
+   _db._state_change_depth = 1;
+}
+
+database::state_change_scope::~state_change_scope()
+{
+   if( !_counted || --_db._state_change_depth > 0 )
+      return;
+   _db._state_changer = nullptr;
+   _db._state_changer_thread = std::thread::id();
+   _db._state_mutex.unlock();
+}
+
 /**
  * Push block "may fail" in which case every partial change is unwound.  After
  * push block is successful the block is appended to the chain database on disk.
@@ -117,6 +182,7 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
 bool database::push_block(const signed_block& new_block, uint32_t skip)
 {
 //   idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   state_change_scope state_change( *this );
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -124,6 +190,7 @@ bool database::push_block(const signed_block& new_block, uint32_t skip)
       [&]()
       {
          result = _push_block(new_block);
+         save_object_checkpoint_if_due();
       });
    });
    return result;
@@ -269,6 +336,7 @@ processed_transaction database::push_transaction( const precomputable_transactio
 { try {
    // see https://github.com/bitshares/bitshares-core/issues/1573
    FC_ASSERT( fc::raw::pack_size( trx ) < (1024 * 1024), "Transaction exceeds maximum transaction size." );
+   state_change_scope state_change( *this );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -304,6 +372,7 @@ processed_transaction database::_push_transaction( const precomputable_transacti
 
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
+   state_change_scope state_change( *this );
    auto session = _undo_db.start_undo_session();
    return _apply_transaction( trx );
 }
@@ -336,6 +405,10 @@ processed_transaction database::push_proposal(const proposal_object& proposal)
    eval_state._trx = &ptrx;
    size_t old_applied_ops_size = _applied_ops.size();
 
+   // the proposal may be undone on its own, so the fees it pays are not combined with those of the block
+   _fee_accumulator.apply_all( *this );
+   fee_accumulator::scope direct_fees( _fee_accumulator, false );
+
    try {
       push_proposal_nesting_guard guard( _push_proposal_nesting_depth, *this );
       if( _undo_db.size() >= _undo_db.max_size() )
@@ -362,6 +435,7 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 { try {
+   state_change_scope state_change( *this );
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -493,6 +567,7 @@ signed_block database::_generate_block(
  */
 void database::pop_block()
 { try {
+   state_change_scope state_change( *this );
    _pending_tx_session.reset();
    auto fork_db_head = _fork_db.head();
    FC_ASSERT( fork_db_head, "Trying to pop() from empty fork database!?" );
@@ -509,6 +584,7 @@ void database::pop_block()
 
 void database::clear_pending()
 { try {
+   state_change_scope state_change( *this );
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
    _pending_tx_session.reset();
@@ -544,6 +620,7 @@ const vector<optional< operation_history_object > >& database::get_applied_opera
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
 {
+   state_change_scope state_change( *this );
    auto block_num = next_block.block_num();
    if( _checkpoints.size() && _checkpoints.rbegin()->second != block_id_type() )
    {
@@ -594,16 +671,21 @@ void database::_apply_block( const signed_block& next_block )
    _current_block_num    = next_block_num;
    _current_trx_in_block = 0;
 
-   for( const auto& trx : next_block.transactions )
    {
-      /* We do not need to push the undo state for each transaction
-       * because they either all apply and are valid or the
-       * entire block fails to apply.  We only need an "undo" state
-       * for transactions when validating broadcast transactions or
-       * when building a block.
-       */
-      apply_transaction( trx, skip );
-      ++_current_trx_in_block;
+      // the fees paid by the transactions are applied once per object after the last one
+      fee_accumulator::scope combined_fees( _fee_accumulator, true );
+      for( const auto& trx : next_block.transactions )
+      {
+         /* We do not need to push the undo state for each transaction
+          * because they either all apply and are valid or the
+          * entire block fails to apply.  We only need an "undo" state
+          * for transactions when validating broadcast transactions or
+          * when building a block.
+          */
+         apply_transaction( trx, skip );
+         ++_current_trx_in_block;
+      }
+      _fee_accumulator.apply_all( *this );
    }
 
    _current_op_in_trx    = 0;
@@ -662,7 +744,19 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
-   trx.validate();
+   // a transaction which passed its checks when it was pushed to the mempool is not checked again
+   const bool check_signatures = !(skip & skip_transaction_signatures);
+   const uint32_t max_authority_depth = get_global_properties().parameters.max_authority_depth;
+   digest_type signatures;
+   bool verified = false;
+   if( check_signatures )
+   {
+      signatures = verified_transaction_cache::signatures_digest( trx );
+      verified = _verified_trx_cache.is_verified( trx.id(), signatures, max_authority_depth );
+   }
+
+   if( !verified )
+      trx.validate();
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
@@ -677,17 +771,33 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    const chain_parameters& chain_parameters = get_global_properties().parameters;
    eval_state._trx = &trx;
 
-   if( !(skip & skip_transaction_signatures) )
+   if( check_signatures && !verified )
    {
+      // accounts whose authorities the check depends on
+      flat_set<account_id_type> read_accounts;
       bool allow_non_immediate_owner = true;
-      auto get_active = [this]( account_id_type id ) { return &id(*this).active; };
-      auto get_owner  = [this]( account_id_type id ) { return &id(*this).owner;  };
-      auto get_custom = [this]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
+      auto get_active = [this,&read_accounts]( account_id_type id ) {
+         read_accounts.insert( id );
+         return &id(*this).active;
+      };
+      auto get_owner  = [this,&read_accounts]( account_id_type id ) {
+         read_accounts.insert( id );
+         return &id(*this).owner;
+      };
+      auto get_custom = [this,&read_accounts]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
+         read_accounts.insert( id );
          return get_viable_custom_authorities(id, op, rejects);
       };
 
       trx.verify_authority(chain_id, get_active, get_owner, get_custom, allow_non_immediate_owner,
-                           false, get_global_properties().parameters.max_authority_depth);
+                           false, max_authority_depth);
+
+      // custom authorities come into force and expire with time, checks reading them are not reused
+      const auto& custom_auths = get_index_type<custom_authority_index>().indices().get<by_account_custom>();
+      const bool reads_custom_auths = std::any_of( read_accounts.begin(), read_accounts.end(),
+            [&custom_auths]( account_id_type id ) { return custom_auths.find( id ) != custom_auths.end(); } );
+      if( !reads_custom_auths )
+         _verified_trx_cache.add( trx.id(), signatures, max_authority_depth, read_accounts );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -812,6 +922,122 @@ void database::_precompute_parallel( const Trx* trx, const size_t count, const u
    }
 }
 
+template<typename Trx>
+void database::_recover_signature_keys( const Trx* trx, const size_t count, const digest_type* digests,
+                                        bool in_parallel )const
+{
+   static const size_t cached = std::numeric_limits<size_t>::max();
+
+   // one entry per signature of the transactions without keys, in order
+   std::vector<public_key_type> keys;
+   std::vector<size_t> batch_index;
+   // a pair of digest and signature appearing more than once is only recovered once
+   std::vector<signature_recovery> batch;
+   std::vector<std::pair<fc::sha256,public_key_type>> recovered;
+   std::map<fc::sha256,size_t> queued;
+   for( size_t i = 0; i < count; ++i )
+   {
+      if( trx[i].has_signature_keys() )
+         continue;
+      for( const auto& sig : trx[i].signatures )
+      {
+         const auto key = signature_key_cache::key( digests[i], sig );
+         const auto known = _signature_key_cache.find( key );
+         if( known.valid() )
+         {
+            keys.push_back( *known );
+            batch_index.push_back( cached );
+            continue;
+         }
+         auto itr = queued.emplace( key, batch.size() );
+         if( itr.second )
+         {
+            batch.emplace_back();
+            batch.back().digest = digests[i];
+            batch.back().signature = &sig;
+            recovered.emplace_back( key, public_key_type() );
+         }
+         keys.emplace_back();
+         batch_index.push_back( itr.first->second );
+      }
+   }
+
+   if( in_parallel )
+      recover_signature_keys( batch );
+   else
+   {
+      for( auto& entry : batch )
+         entry.key = fc::ecc::public_key( *entry.signature, entry.digest );
+   }
+   for( size_t i = 0; i < batch.size(); ++i )
+      recovered[i].second = batch[i].key;
+   _signature_key_cache.insert( recovered );
+   for( size_t j = 0; j < keys.size(); ++j )
+      if( batch_index[j] != cached )
+         keys[j] = batch[batch_index[j]].key;
+
+   auto next = keys.begin();
+   for( size_t i = 0; i < count; ++i )
+   {
+      if( trx[i].has_signature_keys() )
+         continue;
+      const auto last = next + trx[i].signatures.size();
+      trx[i].set_signature_keys( std::vector<public_key_type>( next, last ) );
+      next = last;
+   }
+}
+
+template<typename Trx>
+ico_claim_batch database::_get_ico_claims( const Trx* trx, const size_t count )const
+{
+   ico_claim_batch claims;
+   fc::optional<fc::time_point_sec> claim_time;
+   for( size_t i = 0; i < count; ++i, ++trx )
+   {
+      for( const auto& op : trx->operations )
+      {
+         if( !op.template is_type<ico_balance_claim_operation>() )
+            continue;
+         const auto& claim = op.template get<ico_balance_claim_operation>();
+         const account_object* account = find( claim.deposit_to_account );
+         if( !account )
+            continue;
+         // transactions are evaluated on top of the current head block, which dates the phrase
+         if( !claim_time )
+            claim_time = head_block_time();
+         claims.emplace_back( &claim, ico_claim_message( account->name, *claim_time ) );
+      }
+   }
+   return claims;
+}
+
+void database::_check_ico_claims( ico_claim_batch&& claims, std::vector<fc::future<void>>& workers )const
+{
+   if( claims.empty() )
+      return;
+   const size_t chunks = fc::asio::default_io_service_scope::get_num_threads();
+   const size_t chunk_size = ( claims.size() + chunks - 1 ) / chunks;
+   for( size_t base = 0; base < claims.size(); base += chunk_size )
+   {
+      const size_t end = std::min( base + chunk_size, claims.size() );
+      auto chunk = std::make_shared<ico_claim_batch>( std::make_move_iterator( claims.begin() + base ),
+                                                      std::make_move_iterator( claims.begin() + end ) );
+      workers.push_back( fc::do_parallel( [this,chunk] () {
+         _ico_claim_cache.check_claims( *chunk );
+      }) );
+   }
+}
+
+void database::precompute_ico_claims( const signed_block& block )const
+{
+   if( block.transactions.empty() )
+      return;
+   std::vector<fc::future<void>> workers;
+   _check_ico_claims( _get_ico_claims( &block.transactions[0], block.transactions.size() ), workers );
+   for( auto& worker : workers )
+      worker.wait();
+}
+
 fc::future<void> database::precompute_parallel( const signed_block& block, const uint32_t skip )const
 { try {
    std::vector<fc::future<void>> workers;
@@ -821,16 +1047,41 @@ fc::future<void> database::precompute_parallel( const signed_block& block, const
          _precompute_parallel( &block.transactions[0], block.transactions.size(), skip );
       else
       {
+         // the chunks only compute the signed digests, keys are recovered below in one batch for the block,
+         // so that transactions with many signatures do not hold up a single chunk
+         const bool check_signatures = !(skip & skip_transaction_signatures);
+         std::vector<digest_type> digests( check_signatures ? block.transactions.size() : 0 );
          uint32_t chunks = fc::asio::default_io_service_scope::get_num_threads();
          uint32_t chunk_size = ( block.transactions.size() + chunks - 1 ) / chunks;
-         workers.reserve( chunks + 1 );
+         std::vector<fc::future<void>> stage;
+         stage.reserve( chunks );
          for( size_t base = 0; base < block.transactions.size(); base += chunk_size )
-            workers.push_back( fc::do_parallel( [this,&block,base,chunk_size,skip] () {
-               _precompute_parallel( &block.transactions[base],
-                                     base + chunk_size < block.transactions.size() ? chunk_size : block.transactions.size() - base,
-                                     skip );
+            stage.push_back( fc::do_parallel( [this,&block,&digests,base,chunk_size,skip,check_signatures] () {
+               const size_t end = std::min<size_t>( base + chunk_size, block.transactions.size() );
+               _precompute_parallel( &block.transactions[base], end - base, skip | skip_transaction_signatures );
+               if( check_signatures )
+                  for( size_t i = base; i < end; ++i )
+                     if( !block.transactions[i].has_signature_keys() )
+                        digests[i] = block.transactions[i].sig_digest( get_chain_id() );
             }) );
+         // the chunks write into digests, none may still run when the first failure is rethrown
+         fc::exception_ptr failure;
+         for( auto& chunk : stage )
+         {
+            try {
+               chunk.wait();
+            } catch( const fc::exception& e ) {
+               if( !failure )
+                  failure = e.dynamic_copy_exception();
+            }
+         }
+         if( failure )
+            failure->dynamic_rethrow_exception();
+         if( check_signatures )
+            _recover_signature_keys( &block.transactions[0], block.transactions.size(), digests.data(), true );
       }
+      // ICO claims are checked whatever the skip flags, their evaluator always verifies them
+      _check_ico_claims( _get_ico_claims( &block.transactions[0], block.transactions.size() ), workers );
    }
 
    if( !(skip&skip_witness_signature) )
@@ -849,10 +1100,30 @@ fc::future<void> database::precompute_parallel( const signed_block& block, const
    return *first;
 } FC_LOG_AND_RETHROW() }
 
+void database::precompute_block( const signed_block& block, const uint32_t skip )const
+{ try {
+   if( !block.transactions.empty() )
+      _precompute_parallel( &block.transactions[0], block.transactions.size(), skip );
+   if( !(skip&skip_witness_signature) )
+      block.signee();
+   if( !(skip&skip_merkle_check) )
+      block.calculate_merkle_root();
+   block.id();
+} FC_LOG_AND_RETHROW() }
+
 fc::future<void> database::precompute_parallel( const precomputable_transaction& trx )const
 {
-   return fc::do_parallel([this,&trx] () {
-      _precompute_parallel( &trx, 1, skip_nothing );
+   auto claims = std::make_shared<ico_claim_batch>( _get_ico_claims( &trx, 1 ) );
+   return fc::do_parallel([this,&trx,claims] () {
+      _precompute_parallel( &trx, 1, skip_transaction_signatures );
+      // the keys are cached for the block which will include the transaction
+      if( !trx.has_signature_keys() )
+      {
+         const digest_type digest = trx.sig_digest( get_chain_id() );
+         _recover_signature_keys( &trx, 1, &digest, false );
+      }
+      if( !claims->empty() )
+         _ico_claim_cache.check_claims( *claims );
    });
 }
 
@@ -164,7 +164,8 @@ void database::initialize_indexes()
    add_index< primary_index<asset_index, 13> >(); // 8192 assets per chunk
    add_index< primary_index<force_settlement_index> >();
 
-   add_index< primary_index<account_index, 20> >(); // ~1 million accounts per chunk
+   auto acnt_index = add_index< primary_index<account_index, 20> >(); // ~1 million accounts per chunk
+   acnt_index->add_secondary_index<account_authority_watcher>( &_verified_trx_cache );
    add_index< primary_index<committee_member_index, 8> >(); // 256 members per chunk
    add_index< primary_index<witness_index, 10> >(); // 1024 witnesses per chunk
    add_index< primary_index<limit_order_index > >();
@@ -176,7 +177,8 @@ void database::initialize_indexes()
    add_index< primary_index<balance_index> >();
    add_index< primary_index<ico_balance_index> >();
    add_index< primary_index< htlc_index> >();
-   add_index< primary_index< custom_authority_index> >();
+   auto custom_auth_index = add_index< primary_index< custom_authority_index> >();
+   custom_auth_index->add_secondary_index<custom_authority_watcher>( &_verified_trx_cache );
    add_index< primary_index<ticket_index> >();
 
    //Implementation object indexes
@@ -184,6 +186,7 @@ void database::initialize_indexes()
 
    auto bal_idx = add_index< primary_index<account_balance_index          > >();
    bal_idx->add_secondary_index<balances_by_account_index>();
+   bal_idx->add_secondary_index<asset_holders_index>();
 
    add_index< primary_index<asset_bitasset_data_index,                 13 > >(); // 8192
    add_index< primary_index<simple_index<global_property_object          >> >();
@@ -205,6 +208,7 @@ void database::initialize_indexes()
    add_index< primary_index< room_index,                                20> >();
    add_index< primary_index< room_participant_index,                    20> >();
    add_index< primary_index< room_key_epoch_index,                     20> >();
+   add_index< primary_index< room_key_epoch_table_index                   > >();
 }
 
 void database::init_genesis(const genesis_state_type& genesis_state)
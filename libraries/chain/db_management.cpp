@@ -26,6 +26,7 @@
 #include <graphene/chain/database.hpp>
 
 #include <graphene/chain/chain_property_object.hpp>
+#include <graphene/chain/snapshot.hpp>
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/special_authority_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
@@ -33,12 +34,18 @@
 #include <graphene/protocol/fee_schedule.hpp>
 
 #include <fc/io/fstream.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/thread/parallel.hpp>
+#include <fc/thread/thread.hpp>
 
+#include <atomic>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
-#include <queue>
-#include <tuple>
+#include <thread>
 
 namespace graphene { namespace chain {
 
@@ -53,6 +60,40 @@ database::~database()
    clear_pending();
 }
 
+namespace {
+
+/// Progress of one replay stage, updated by the threads of the stage and reported by the apply loop
+struct replay_stage
+{
+   std::atomic<uint64_t> blocks{ 0 };
+   std::atomic<uint64_t> bytes{ 0 };
+   std::atomic<int64_t>  busy_us{ 0 };
+};
+
+/// A block on its way through the replay pipeline
+struct replay_item
+{
+   uint32_t               block_num = 0;
+   block_id_type          block_id;
+   size_t                 position = 0;   ///< end of the block in the block log, for progress by size
+   std::vector<char>      packed;
+   optional<signed_block> block;          ///< invalid if the block could not be read
+   fc::future<void>       decoded;
+};
+
+int64_t elapsed_us( const fc::time_point& since )
+{
+   return ( fc::time_point::now() - since ).count();
+}
+
+} // anonymous namespace
+
+void database::set_replay_pipeline( uint32_t lookahead, uint32_t threads )
+{
+   _replay_lookahead = std::max<uint32_t>( lookahead, 1 );
+   _replay_threads = threads;
+}
+
 void database::reindex( fc::path data_dir )
 { try {
    auto last_block = _block_id_to_block.last();
@@ -79,90 +120,308 @@ void database::reindex( fc::path data_dir )
 
    uint32_t skip = node_properties().skip_flags;
 
+   // Three stages: one thread reads blocks sequentially from the block log, decoding threads unpack them and
+   // verify what can be verified out of order, and this thread applies them. Only the apply stage is serial.
+   const uint32_t thread_count = _replay_threads > 0 ? _replay_threads
+                                 : std::max<uint32_t>( std::thread::hardware_concurrency(), 1 );
+   const uint32_t lookahead = std::max( _replay_lookahead, thread_count );
+   replay_stage read_stage;
+   replay_stage decode_stage;
+   replay_stage apply_stage;
+   int64_t apply_wait_us = 0;
+   // declared after the stage counters, so the threads are gone before the counters are
+   fc::thread reader( "replay_reader" );
+   std::vector< std::unique_ptr<fc::thread> > decoders;
+   decoders.reserve( thread_count );
+   for( uint32_t t = 0; t < thread_count; ++t )
+      decoders.emplace_back( std::make_unique<fc::thread>( "replay_decoder_" + std::to_string( t ) ) );
+
    size_t total_block_size = _block_id_to_block.total_block_size();
    const auto& gpo = get_global_properties();
-   std::queue< std::tuple< size_t, signed_block, fc::future< void > > > blocks;
+   std::deque< std::shared_ptr<replay_item> > blocks;
    uint32_t next_block_num = head_block_num() + 1;
    uint32_t i = next_block_num;
-   while( next_block_num <= last_block_num || !blocks.empty() )
-   {
-      if( next_block_num <= last_block_num && blocks.size() < 20 )
-      {
-         const size_t processed_block_size = _block_id_to_block.blocks_current_position();
-         fc::optional< signed_block > block = _block_id_to_block.fetch_by_number( next_block_num++ );
-         if( block.valid() )
-         {
-            if( block->timestamp >= last_block->timestamp - gpo.parameters.maximum_time_until_expiration )
-               skip &= ~skip_transaction_dupe_check;
-            blocks.emplace( processed_block_size, std::move(*block), fc::future<void>() );
-            std::get<2>(blocks.back()) = precompute_parallel( std::get<1>(blocks.back()), skip );
+
+   auto schedule = [&]( uint32_t block_num ) {
+      auto item = std::make_shared<replay_item>();
+      item->block_num = block_num;
+      const fc::time_point_sec dupe_check_from = last_block->timestamp - gpo.parameters.maximum_time_until_expiration;
+      fc::future<void> read = reader.async( [this,item,&read_stage]() {
+         const auto started = fc::time_point::now();
+         try {
+            item->block_id = _block_id_to_block.fetch_block_id( item->block_num );
+            if( _block_id_to_block.fetch_packed( item->block_id, item->packed ) )
+               item->position = _block_id_to_block.blocks_current_position();
+         } catch( const fc::exception& ) {
+            item->packed.clear();
          }
-         else
-         {
-            wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
-            uint32_t dropped_count = 0;
-            while( true )
+         read_stage.blocks++;
+         read_stage.bytes += item->packed.size();
+         read_stage.busy_us += elapsed_us( started );
+      }, "replay read" );
+      item->decoded = decoders[ block_num % thread_count ]->async( [this,item,read,skip,dupe_check_from,
+                                                                    &decode_stage]() mutable {
+         read.wait();
+         if( item->packed.empty() )
+            return;
+         const auto started = fc::time_point::now();
+         try {
+            signed_block block;
+            fc::datastream<const char*> ds( item->packed.data(), item->packed.size() );
+            fc::raw::unpack( ds, block );
+            if( block.id() == item->block_id )
             {
-               fc::optional< block_id_type > last_id = _block_id_to_block.last_id();
-               // this can trigger if we attempt to e.g. read a file that has block #2 but no block #1
-               if( !last_id.valid() )
-                  break;
-               // we've caught up to the gap
-               if( block_header::num_from_id( *last_id ) <= i )
-                  break;
-               _block_id_to_block.remove( *last_id );
-               dropped_count++;
+               uint32_t block_skip = skip;
+               if( block.timestamp >= dupe_check_from )
+                  block_skip &= ~skip_transaction_dupe_check;
+               item->block = std::move( block );
+               precompute_block( *item->block, block_skip );
             }
-            wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
-            next_block_num = last_block_num + 1; // don't load more blocks
+         } catch( const fc::exception& e ) {
+            // an undecodable block ends the replay like a missing one, the apply stage reports it
+            item->block.reset();
+            wlog( "Unable to decode block ${n}: ${e}", ("n", item->block_num)("e", e.to_string()) );
          }
-      }
-      else
-      {
-         std::get<2>(blocks.front()).wait();
-         const signed_block& block = std::get<1>(blocks.front());
+         item->packed = std::vector<char>();
+         decode_stage.blocks++;
+         decode_stage.busy_us += elapsed_us( started );
+      }, "replay decode" );
+      blocks.push_back( std::move( item ) );
+   };
 
-         if( i % 10000 == 0 )
-         {
-            std::stringstream bysize;
-            std::stringstream bynum;
-            size_t current_pos = std::get<0>(blocks.front());
-            if( current_pos > total_block_size )
-               total_block_size = current_pos;
-            bysize << std::fixed << std::setprecision(5) << double(current_pos) / total_block_size * 100;
-            bynum << std::fixed << std::setprecision(5) << double(i)*100/last_block_num;
-            ilog(
-               "   [by size: ${size}%   ${processed} of ${total}]   [by num: ${num}%   ${i} of ${last}]",
-               ("size", bysize.str())
-               ("processed", current_pos)
-               ("total", total_block_size)
-               ("num", bynum.str())
-               ("i", i)
-               ("last", last_block_num)
-            );
-         }
-         if( i == undo_point )
+   auto last_report = fc::time_point::now();
+   uint64_t reported_read = 0, reported_read_bytes = 0, reported_decoded = 0, reported_applied = 0;
+   int64_t reported_decode_us = 0, reported_apply_wait_us = 0;
+   auto report = [&]( const replay_item& item ) {
+      const auto now = fc::time_point::now();
+      const int64_t interval_us = ( now - last_report ).count();
+      if( interval_us < 10000000 )
+         return;
+      const double seconds = double( interval_us ) / 1000000;
+      if( item.position > total_block_size )
+         total_block_size = item.position;
+      std::stringstream bysize;
+      std::stringstream bynum;
+      std::stringstream rates;
+      bysize << std::fixed << std::setprecision(5) << double(item.position) / total_block_size * 100;
+      bynum << std::fixed << std::setprecision(5) << double(i)*100/last_block_num;
+      rates << std::fixed << std::setprecision(1)
+            << "read " << ( read_stage.blocks - reported_read ) / seconds << " blocks/s "
+            << ( read_stage.bytes - reported_read_bytes ) / seconds / ( 1 << 20 ) << " MiB/s, "
+            << "decode " << ( decode_stage.blocks - reported_decoded ) / seconds << " blocks/s "
+            << double( decode_stage.busy_us - reported_decode_us ) * 100 / interval_us / thread_count
+            << "% busy on " << thread_count << " threads, "
+            << "apply " << ( apply_stage.blocks - reported_applied ) / seconds << " blocks/s, "
+            << "apply waited " << double( apply_wait_us - reported_apply_wait_us ) * 100 / interval_us << "%";
+      ilog(
+         "   [by size: ${size}%   ${processed} of ${total}]   [by num: ${num}%   ${i} of ${last}]   ${rates}",
+         ("size", bysize.str())
+         ("processed", item.position)
+         ("total", total_block_size)
+         ("num", bynum.str())
+         ("i", i)
+         ("last", last_block_num)
+         ("rates", rates.str())
+      );
+      last_report = now;
+      reported_read = read_stage.blocks;
+      reported_read_bytes = read_stage.bytes;
+      reported_decoded = decode_stage.blocks;
+      reported_applied = apply_stage.blocks;
+      reported_decode_us = decode_stage.busy_us;
+      reported_apply_wait_us = apply_wait_us;
+   };
+
+   while( true )
+   {
+      while( next_block_num <= last_block_num && blocks.size() < lookahead )
+         schedule( next_block_num++ );
+      if( blocks.empty() )
+         break;
+
+      const auto wait_started = fc::time_point::now();
+      blocks.front()->decoded.wait();
+      apply_wait_us += elapsed_us( wait_started );
+      const std::shared_ptr<replay_item> item = blocks.front();
+      blocks.pop_front();
+
+      if( !item->block.valid() )
+      {
+         // nothing after the gap may be applied, and the reader must be done before blocks are dropped
+         for( auto& pending : blocks )
+            pending->decoded.wait();
+         blocks.clear();
+         wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
+         uint32_t dropped_count = 0;
+         while( true )
          {
-            ilog( "Writing database to disk at block ${i}", ("i",i) );
-            flush();
-            ilog( "Done" );
+            fc::optional< block_id_type > last_id = _block_id_to_block.last_id();
+            // this can trigger if we attempt to e.g. read a file that has block #2 but no block #1
+            if( !last_id.valid() )
+               break;
+            // we've caught up to the gap
+            if( block_header::num_from_id( *last_id ) <= i )
+               break;
+            _block_id_to_block.remove( *last_id );
+            dropped_count++;
          }
-         if( i < undo_point )
-            apply_block( block, skip );
+         wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
+         break;
+      }
+
+      const signed_block& block = *item->block;
+      const auto apply_started = fc::time_point::now();
+      if( i == undo_point )
+      {
+         ilog( "Writing database to disk at block ${i}", ("i",i) );
+         if( _content_store )
+            _content_store->flush();
+         // a checkpoint only serializes here and writes in the background
+         if( checkpoints_enabled() )
+            save_checkpoint();
          else
-         {
-            _undo_db.enable();
-            push_block( block, skip );
-         }
-         blocks.pop();
-         i++;
+            flush();
+         ilog( "Done" );
+      }
+      if( block.timestamp >= last_block->timestamp - gpo.parameters.maximum_time_until_expiration )
+         skip &= ~skip_transaction_dupe_check;
+      // decoders cannot read account names, so ICO claims are checked here, still off this thread
+      precompute_ico_claims( block );
+      if( i < undo_point )
+      {
+         apply_block( block, skip );
+         save_object_checkpoint_if_due();
       }
+      else
+      {
+         _undo_db.enable();
+         push_block( block, skip );
+      }
+      apply_stage.blocks++;
+      apply_stage.busy_us += elapsed_us( apply_started );
+      report( *item );
+      i++;
    }
    _undo_db.enable();
    auto end = fc::time_point::now();
-   ilog( "Done reindexing, elapsed time: ${t} sec", ("t",double((end-start).count())/1000000.0 ) );
+   ilog( "Done reindexing, elapsed time: ${t} sec, waited for blocks ${w} sec",
+         ("t",double((end-start).count())/1000000.0 )("w",double(apply_wait_us)/1000000.0) );
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
 
+void database::enable_object_checkpoints( uint32_t interval, uint32_t compact_every )
+{
+   _object_checkpoint_interval = interval;
+   if( interval > 0 )
+      object_database::enable_checkpoints( compact_every );
+}
+
+void database::enable_content_store( size_t cache_bytes )
+{
+   FC_ASSERT( !_opened, "The content store must be enabled before the database is opened" );
+   _content_store = std::make_unique<content_store>( cache_bytes );
+}
+
+fc::future<void> database::write_snapshot( const fc::path& file )const
+{ try {
+   FC_ASSERT( !_content_store, "A snapshot cannot hold content card payloads kept in the content store" );
+   const auto start = fc::time_point::now();
+   auto dumps = std::make_shared< vector<index_dump> >( dump_indexes() );
+
+   // the head is the one of the state in the snapshot, not the current head
+   snapshot_header header;
+   header.chain_id = get_chain_id();
+   header.db_version = _db_version;
+   for( const auto& dump : *dumps )
+   {
+      if( dump.space_id != dynamic_global_property_object::space_id
+            || dump.type_id != dynamic_global_property_object::type_id )
+         continue;
+      fc::datastream<const char*> ds( dump.data.data(), dump.data.size() );
+      object_id_type next_id;
+      fc::sha256 version;
+      vector<char> packed;
+      fc::raw::unpack( ds, next_id );
+      fc::raw::unpack( ds, version );
+      fc::raw::unpack( ds, packed );
+      const auto dgpo = fc::raw::unpack<dynamic_global_property_object>( packed );
+      header.head_block_num = dgpo.head_block_number;
+      header.head_block_id = dgpo.head_block_id;
+      header.head_block_time = dgpo.time;
+   }
+   ilog( "Serialized the state of block ${b} for a snapshot in ${t} ms",
+         ("b", header.head_block_num)("t", ( fc::time_point::now() - start ).count() / 1000) );
+
+   return fc::do_parallel( [file,header,dumps] () {
+      write_snapshot_file( file, header, *dumps );
+      ilog( "Wrote the snapshot of block ${b} to ${f}", ("b", header.head_block_num)("f", file) );
+   } );
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+void database::start_from_snapshot( const fc::path& file )
+{
+   FC_ASSERT( !_opened, "The snapshot to start from must be set before the database is opened" );
+   _snapshot_file = file;
+}
+
+void database::load_snapshot( const fc::path& file, const std::function<genesis_state_type()>& genesis_loader )
+{ try {
+   ilog( "Loading the object database from snapshot ${f}", ("f", file) );
+   const auto start = fc::time_point::now();
+   FC_ASSERT( fc::exists( file ), "Snapshot not found" );
+   fc::file_mapping fm( file.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( file ) );
+   const char* data = (const char*)mr.get_address();
+   const snapshot_header header = read_snapshot_header( data, mr.get_size() );
+   FC_ASSERT( header.db_version == _db_version, "The snapshot was made by a node with database version ${v}",
+              ("v", header.db_version) );
+   FC_ASSERT( header.chain_id == genesis_loader().compute_chain_id(), "The snapshot is of chain ${c}",
+              ("c", header.chain_id) );
+
+   std::vector<fc::future<void>> tasks;
+   tasks.reserve( header.sections.size() );
+   for( const auto& section : header.sections )
+      tasks.push_back( fc::do_parallel( [this,data,&section] () {
+         FC_ASSERT( snapshot_section_checksum( data + section.offset, section.size ) == section.checksum,
+                    "Section ${s}.${t} of the snapshot is corrupt", ("s", section.space_id)("t", section.type_id) );
+         load_index_dump( section.space_id, section.type_id, data + section.offset, section.size );
+      } ) );
+   // the tasks read the mapping, none may outlive it
+   fc::optional<fc::exception> failure;
+   for( auto& task : tasks )
+   {
+      try {
+         task.wait();
+      } catch( const fc::exception& e ) {
+         if( !failure.valid() )
+            failure = e;
+      }
+   }
+   if( failure.valid() )
+      failure->dynamic_rethrow_exception();
+
+   FC_ASSERT( get( chain_property_id_type() ).chain_id == header.chain_id, "The snapshot holds another chain" );
+   FC_ASSERT( get( dynamic_global_property_id_type() ).head_block_id == header.head_block_id,
+              "The snapshot holds the state of another block than its header" );
+   ilog( "Loaded the state of block ${b} in ${t} ms",
+         ("b", header.head_block_num)("t", ( fc::time_point::now() - start ).count() / 1000) );
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+void database::save_object_checkpoint_if_due()
+{
+   if( _object_checkpoint_interval == 0 )
+      return;
+   // the checkpoint holds the state before every block still on the undo stack
+   const uint32_t head = head_block_num();
+   const uint32_t checkpoint_block = head - std::min<uint32_t>( head, _undo_db.size() );
+   if( checkpoint_block < _last_object_checkpoint_block + _object_checkpoint_interval )
+      return;
+   // the payloads the checkpoint refers to must be on disk before it
+   if( _content_store )
+      _content_store->flush();
+   object_database::save_checkpoint();
+   _last_object_checkpoint_block = checkpoint_block;
+}
+
 void database::wipe(const fc::path& data_dir, bool include_blocks)
 {
    ilog("Wiping database", ("include_blocks", include_blocks));
@@ -170,6 +429,7 @@ void database::wipe(const fc::path& data_dir, bool include_blocks)
      close();
    }
    object_database::wipe(data_dir);
+   fc::remove_all( data_dir / "content_store" );
    if( include_blocks )
       fc::remove_all( data_dir / "database" );
 }
@@ -200,12 +460,35 @@ void database::open(
       }
 
       object_database::open(data_dir);
+      if( _content_store )
+         _content_store->open( data_dir / "content_store" / "payloads" );
 
       _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
 
+      _db_version = db_version;
+      bool from_genesis = false;
+      bool from_snapshot = false;
       if( !find(global_property_id_type()) )
-         init_genesis(genesis_loader());
-      else
+      {
+         // no object refers to the payloads of an earlier chain state
+         if( _content_store )
+            _content_store->clear();
+         if( _snapshot_file.valid() )
+         {
+            load_snapshot( *_snapshot_file, genesis_loader );
+            from_snapshot = true;
+         }
+         else
+         {
+            init_genesis(genesis_loader());
+            from_genesis = true;
+         }
+      }
+      else if( _snapshot_file.valid() )
+         wlog( "Not starting from snapshot ${f}, the object database is not empty", ("f", *_snapshot_file) );
+      // the watchers saw every loaded account as a change
+      _verified_trx_cache.clear();
+      if( !from_genesis )
       {
          _p_core_asset_obj = &get( asset_id_type() );
          _p_core_dynamic_data_obj = &get( asset_dynamic_data_id_type() );
@@ -214,9 +497,12 @@ void database::open(
          _p_dyn_global_prop_obj = &get( dynamic_global_property_id_type() );
          _p_witness_schedule_obj = &get( witness_schedule_id_type() );
       }
+      _last_object_checkpoint_block = head_block_num();
 
       fc::optional<block_id_type> last_block = _block_id_to_block.last_id();
-      if( last_block.valid() )
+      if( from_snapshot && last_block.valid() && block_header::num_from_id( *last_block ) < head_block_num() )
+         wlog( "The block log ends at block ${n}, before the snapshot", ("n", block_header::num_from_id( *last_block )) );
+      else if( last_block.valid() )
       {
          FC_ASSERT( *last_block >= head_block_id(),
                     "last block ID does not match current chain state",
@@ -263,13 +549,21 @@ void database::close(bool rewind)
    // DB state (issue #336).
    clear_pending();
 
-   object_database::flush();
+   if( _content_store )
+      _content_store->flush();
+   if( checkpoints_enabled() )
+      object_database::save_checkpoint();
+   else
+      object_database::flush();
    object_database::close();
+   if( _content_store )
+      _content_store->close();
 
    if( _block_id_to_block.is_open() )
       _block_id_to_block.close();
 
    _fork_db.reset();
+   _verified_trx_cache.clear();
 
    _opened = false;
 }
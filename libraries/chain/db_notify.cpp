@@ -577,6 +577,13 @@ void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accoun
               break;
              case impl_fba_accumulator_object_type:
               break;
+             case impl_room_key_epoch_table_object_type:{
+              const auto& aobj = dynamic_cast<const room_key_epoch_table_object*>(obj);
+              FC_ASSERT( aobj != nullptr );
+              for( const auto& key : aobj->participant_keys )
+                 accounts.insert( key.first );
+              break;
+           }
       }
    }
 } // end get_relevant_accounts( const object* obj, flat_set<account_id_type>& accounts )
@@ -622,7 +629,7 @@ void database::notify_changed_objects()
         for( const auto& item : head_undo.old_values )
         {
           changed_ids.push_back(item.first);
-          get_relevant_accounts(item.second.get(), changed_accounts_impacted, false);
+          get_relevant_accounts(item.second, changed_accounts_impacted, false);
         }
 
         if( changed_ids.size() )
@@ -638,7 +645,7 @@ void database::notify_changed_objects()
         for( const auto& item : head_undo.removed )
         {
           removed_ids.emplace_back( item.first );
-          auto obj = item.second.get();
+          auto obj = item.second;
           removed.emplace_back( obj );
           get_relevant_accounts(obj, removed_accounts_impacted, false);
         }
@@ -71,8 +71,9 @@ database& generic_evaluator::db()const { return trx_state->db(); }
          asset fee_from_pool = fee_from_account * fee_asset->options.core_exchange_rate;
          FC_ASSERT( fee_from_pool.asset_id == asset_id_type() );
          core_fee_paid = fee_from_pool.amount;
-         FC_ASSERT( core_fee_paid <= fee_asset_dyn_data->fee_pool, "Fee pool balance of '${b}' is less than the ${r} required to convert ${c}",
-                    ("r", db().to_pretty_string( fee_from_pool))("b",db().to_pretty_string(fee_asset_dyn_data->fee_pool))("c",db().to_pretty_string(fee)) );
+         const share_type fee_pool = d.get_fee_pool( *fee_asset_dyn_data );
+         FC_ASSERT( core_fee_paid <= fee_pool, "Fee pool balance of '${b}' is less than the ${r} required to convert ${c}",
+                    ("r", db().to_pretty_string( fee_from_pool))("b",db().to_pretty_string(fee_pool))("c",db().to_pretty_string(fee)) );
       }
    }
 
@@ -80,24 +81,14 @@ database& generic_evaluator::db()const { return trx_state->db(); }
    {
       if( !trx_state->skip_fee ) {
          if( fee_asset->get_id() != asset_id_type() )
-         {
-            db().modify(*fee_asset_dyn_data, [this](asset_dynamic_data_object& d) {
-               d.accumulated_fees += fee_from_account.amount;
-               d.fee_pool -= core_fee_paid;
-            });
-         }
+            db().convert_fee( *fee_asset_dyn_data, fee_from_account.amount, core_fee_paid );
       }
    }
 
    void generic_evaluator::pay_fee()
    { try {
       if( !trx_state->skip_fee ) {
-         database& d = db();
-         /// TODO: db().pay_fee( account_id, core_fee );
-         d.modify(*fee_paying_account_statistics, [&](account_statistics_object& s)
-         {
-            s.pay_fee( core_fee_paid, d.get_global_properties().parameters.cashback_vesting_threshold );
-         });
+         db().pay_fee( *fee_paying_account_statistics, core_fee_paid );
       }
    } FC_CAPTURE_AND_RETHROW() }
 
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include <graphene/chain/fee_accumulator.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/database.hpp>
+
+namespace graphene { namespace chain {
+
+fee_accumulator::scope::scope( fee_accumulator& fees, bool combining )
+   : _fees( fees ), _was_combining( fees._combining )
+{
+   _fees._combining = combining;
+}
+
+fee_accumulator::scope::~scope()
+{
+   // applied amounts are gone, what is left belongs to a failed block
+   if( _fees._combining && !_was_combining )
+      _fees.discard();
+   _fees._combining = _was_combining;
+}
+
+void fee_accumulator::pay_fee( database& db, const account_statistics_object& stats, share_type core_fee,
+                               share_type cashback_vesting_threshold )
+{
+   if( !_combining )
+   {
+      db.modify( stats, [core_fee,cashback_vesting_threshold]( account_statistics_object& s ) {
+         s.pay_fee( core_fee, cashback_vesting_threshold );
+      });
+      return;
+   }
+   pending_fees& pending = _fees[stats.id];
+   pending.stats = &stats;
+   if( core_fee > cashback_vesting_threshold )
+      pending.fees += core_fee;
+   else
+      pending.vested_fees += core_fee;
+}
+
+void fee_accumulator::convert_fee( database& db, const asset_dynamic_data_object& dyn_data, share_type fee_amount,
+                                   share_type core_fee )
+{
+   if( !_combining )
+   {
+      db.modify( dyn_data, [fee_amount,core_fee]( asset_dynamic_data_object& d ) {
+         d.accumulated_fees += fee_amount;
+         d.fee_pool -= core_fee;
+      });
+      return;
+   }
+   pending_conversion& pending = _conversions[dyn_data.id];
+   pending.dyn_data = &dyn_data;
+   pending.accumulated_fees += fee_amount;
+   pending.fee_pool -= core_fee;
+}
+
+share_type fee_accumulator::pending_fee_pool_change( const asset_dynamic_data_object& dyn_data )const
+{
+   auto itr = _conversions.find( dyn_data.id );
+   return itr == _conversions.end() ? share_type() : itr->second.fee_pool;
+}
+
+void fee_accumulator::apply( database& db, const account_statistics_object& stats )
+{
+   auto itr = _fees.find( stats.id );
+   if( itr == _fees.end() )
+      return;
+   apply( db, itr->second );
+   _fees.erase( itr );
+}
+
+void fee_accumulator::apply( database& db, const asset_dynamic_data_object& dyn_data )
+{
+   auto itr = _conversions.find( dyn_data.id );
+   if( itr == _conversions.end() )
+      return;
+   apply( db, itr->second );
+   _conversions.erase( itr );
+}
+
+void fee_accumulator::apply_all( database& db )
+{
+   for( const auto& pending : _fees )
+      apply( db, pending.second );
+   _fees.clear();
+   for( const auto& pending : _conversions )
+      apply( db, pending.second );
+   _conversions.clear();
+}
+
+void fee_accumulator::discard()
+{
+   _fees.clear();
+   _conversions.clear();
+}
+
+void fee_accumulator::apply( database& db, const pending_fees& pending )
+{
+   db.modify( *pending.stats, [&pending]( account_statistics_object& s ) {
+      s.pending_fees += pending.fees;
+      s.pending_vested_fees += pending.vested_fees;
+   });
+}
+
+void fee_accumulator::apply( database& db, const pending_conversion& pending )
+{
+   db.modify( *pending.dyn_data, [&pending]( asset_dynamic_data_object& d ) {
+      d.accumulated_fees += pending.accumulated_fees;
+      d.fee_pool += pending.fee_pool;
+   });
+}
+
+} } // graphene::chain
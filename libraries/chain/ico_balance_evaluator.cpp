@@ -22,12 +22,9 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
-#include <ctime>
-#include <iomanip>
-
 #include <graphene/chain/ico_balance_evaluator.hpp>
+#include <graphene/chain/ico_claim_cache.hpp>
 #include <graphene/protocol/pts_address.hpp>
-#include <graphene/tokendistribution/tokendistribution.hpp>
 
 namespace graphene { namespace chain {
 
@@ -40,16 +37,14 @@ void_result ico_balance_claim_evaluator::do_evaluate(const ico_balance_claim_ope
 
    const account_object* account = d.find(fc::variant(op.deposit_to_account, 1).as<account_id_type>(1));
 
-   // Build the verification phrase
-   std::time_t tm = time_t( d.head_block_time().sec_since_epoch() );
-   std::string datetime(11,0);
-   datetime.resize(std::strftime(&datetime[0], datetime.size(), "%Y-%m-%d", std::localtime(&tm)));
-
-   using namespace std::string_literals;
-   std::string msg = "I "s + account->name + " want to claim "s + GRAPHENE_SYMBOL + " tokens. "s + datetime + "."s;
+   // The key recovery is normally done while precomputing the transaction
+   const std::string msg = ico_claim_message( account->name, d.head_block_time() );
+   fc::optional<ico_claim_check> check = d.find_ico_claim_check( op, msg );
+   if( !check )
+      check = check_ico_claim( op, msg );
 
-   FC_ASSERT(tokendistribution::verifyMessage(op.eth_pub_key, msg, op.eth_sign) == 0, "The key or the signature is not correct");
-   FC_ASSERT(ico_balance->eth_address == tokendistribution::getAddress(op.eth_pub_key));
+   FC_ASSERT(check->signature_valid, "The key or the signature is not correct");
+   FC_ASSERT(ico_balance->eth_address == check->eth_address);
 
    //FC_ASSERT(op.total_claimed.asset_id == ico_balance->asset_type());
 
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include <ctime>
+
+#include <graphene/chain/ico_claim_cache.hpp>
+#include <graphene/protocol/config.hpp>
+#include <graphene/tokendistribution/tokendistribution.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+// The key used to be checked by comparing it with the recovered key in lower case hex,
+// so a key given with upper case digits never verified
+bool is_lower_case( const std::string& hex )
+{
+   return std::none_of( hex.begin(), hex.end(), []( char c ) { return c >= 'A' && c <= 'F'; } );
+}
+
+} // anonymous namespace
+
+std::string ico_claim_message( const std::string& account_name, fc::time_point_sec head_block_time )
+{
+   std::time_t tm = time_t( head_block_time.sec_since_epoch() );
+   std::string datetime(11,0);
+   datetime.resize(std::strftime(&datetime[0], datetime.size(), "%Y-%m-%d", std::localtime(&tm)));
+
+   using namespace std::string_literals;
+   return "I "s + account_name + " want to claim "s + GRAPHENE_SYMBOL + " tokens. "s + datetime + "."s;
+}
+
+ico_claim_check check_ico_claim( const ico_balance_claim_operation& op, const std::string& message )
+{
+   const auto key = tokendistribution::parse_public_key( op.eth_pub_key );
+   const auto signature = tokendistribution::parse_signature( op.eth_sign );
+
+   ico_claim_check check;
+   check.signature_valid = is_lower_case( op.eth_pub_key )
+         && tokendistribution::verify_message( key, tokendistribution::hash_message( message ), signature );
+   check.eth_address = tokendistribution::to_hex( tokendistribution::get_address( key ) );
+   return check;
+}
+
+fc::sha256 ico_claim_cache::key( const ico_balance_claim_operation& op, const std::string& message )
+{
+   fc::sha256::encoder enc;
+   fc::raw::pack( enc, op.eth_pub_key );
+   fc::raw::pack( enc, op.eth_sign );
+   fc::raw::pack( enc, message );
+   return enc.result();
+}
+
+void ico_claim_cache::check_claims( const ico_claim_batch& claims )
+{
+   std::vector<tokendistribution::eth_signed_message> batch;
+   std::vector<std::pair<fc::sha256,ico_claim_check>> checks;
+   batch.reserve( claims.size() );
+   checks.reserve( claims.size() );
+   for( const auto& claim : claims )
+   {
+      const ico_balance_claim_operation& op = *claim.first;
+      try {
+         tokendistribution::eth_signed_message signed_message;
+         signed_message.key = tokendistribution::parse_public_key( op.eth_pub_key );
+         signed_message.signature = tokendistribution::parse_signature( op.eth_sign );
+         signed_message.hash = tokendistribution::hash_message( claim.second );
+
+         ico_claim_check check;
+         check.signature_valid = is_lower_case( op.eth_pub_key );
+         check.eth_address = tokendistribution::to_hex( tokendistribution::get_address( signed_message.key ) );
+         batch.push_back( signed_message );
+         checks.emplace_back( key( op, claim.second ), std::move( check ) );
+      } catch( const fc::exception& ) {
+         // malformed, the evaluator throws the error when the claim is applied
+      }
+   }
+   if( batch.empty() )
+      return;
+
+   const auto verified = tokendistribution::verify_messages( batch );
+   for( size_t i = 0; i < checks.size(); ++i )
+      checks[i].second.signature_valid = checks[i].second.signature_valid && verified[i];
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   for( auto& check : checks )
+   {
+      if( _checks.emplace( check.first, std::move( check.second ) ).second )
+         _order.push_back( check.first );
+   }
+   while( _order.size() > max_size )
+   {
+      _checks.erase( _order.front() );
+      _order.pop_front();
+   }
+}
+
+fc::optional<ico_claim_check> ico_claim_cache::find( const ico_balance_claim_operation& op,
+                                                     const std::string& message )const
+{
+   const auto k = key( op, message );
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _checks.find( k );
+   if( itr == _checks.end() )
+      return {};
+   return itr->second;
+}
+
+} } // graphene::chain
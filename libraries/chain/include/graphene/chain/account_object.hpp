@@ -28,6 +28,7 @@
 #include <graphene/protocol/account.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/ranked_index.hpp>
 
 namespace graphene { namespace chain {
    class database;
@@ -334,13 +335,17 @@ namespace graphene { namespace chain {
 
 
       protected:
-         set<account_id_type>                    get_account_members( const account_object& a )const;
-         set<public_key_type, pubkey_comparator> get_key_members( const account_object& a )const;
-         set<address>                            get_address_members( const account_object& a )const;
-
-         set<account_id_type>                    before_account_members;
-         set<public_key_type, pubkey_comparator> before_key_members;
-         set<address>                            before_address_members;
+         set<account_id_type>                    get_account_members( const authority& owner,
+                                                                      const authority& active )const;
+         set<public_key_type, pubkey_comparator> get_key_members( const authority& owner, const authority& active,
+                                                                  const public_key_type& memo_key )const;
+         set<address>                            get_address_members( const authority& owner, const authority& active,
+                                                                      const public_key_type& memo_key )const;
+
+         /// Members of the account being modified, only looked at again if the modification changed them
+         authority                               before_owner;
+         authority                               before_active;
+         public_key_type                         before_memo_key;
    };
 
 
@@ -368,6 +373,28 @@ namespace graphene { namespace chain {
          std::stack< object_id_type > ids_being_modified;
    };
 
+   /**
+    *  @brief This secondary index keeps the number of accounts holding a non-zero balance of each asset.
+    */
+   class asset_holders_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         uint64_t get_holder_count( const asset_id_type& asset )const;
+
+      private:
+         void adjust( const asset_id_type& asset, int64_t delta );
+
+         /** Holder counts by asset instance */
+         vector< uint64_t >  holder_counts;
+         /** Whether the balances being modified were non-zero before */
+         std::stack< bool >  held_before_modify;
+   };
+
    struct by_asset_balance;
    struct by_maintenance_flag;
    /**
@@ -379,7 +406,8 @@ namespace graphene { namespace chain {
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
          ordered_non_unique< tag<by_maintenance_flag>,
                              member< account_balance_object, bool, &account_balance_object::maintenance_flag > >,
-         ordered_unique< tag<by_asset_balance>,
+         // ranked, so that holders of an asset can be paged through by position
+         ranked_unique< tag<by_asset_balance>,
             composite_key<
                account_balance_object,
                member<account_balance_object, asset_id_type, &account_balance_object::asset_type>,
@@ -23,14 +23,34 @@
  */
 #pragma once
 #include <fstream>
+#include <mutex>
 #include <graphene/protocol/block.hpp>
 
 #include <fc/filesystem.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+
+#include <boost/endian/buffers.hpp>
 
 namespace graphene { namespace chain {
-   struct index_entry;
    using namespace graphene::protocol;
 
+   struct index_entry
+   {
+      index_entry() {
+         block_pos = 0;
+         block_size = 0;
+      };
+      boost::endian::little_uint64_buf_t block_pos;
+      boost::endian::little_uint32_buf_t block_size;
+      block_id_type                      block_id;
+   };
+
+   /**
+    * Append-only log of packed blocks plus a table of index_entry by block number. The table is kept in
+    * memory and blocks are read through a memory mapping of the log, so serving a block costs no seeks,
+    * and fetch_packed() hands out the stored bytes without unpacking the block. Lookups are safe to make
+    * from other threads, e.g. the reader stage of a replay, while blocks are stored.
+    */
    class block_database 
    {
       public:
@@ -46,14 +66,30 @@ namespace graphene { namespace chain {
          block_id_type          fetch_block_id( uint32_t block_num )const;
          optional<signed_block> fetch_optional( const block_id_type& id )const;
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
+         /// Appends the packed block to @p data as stored, returns false if the block is unknown
+         bool                   fetch_packed( const block_id_type& id, vector<char>& data )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
          size_t                 blocks_current_position()const;
          size_t                 total_block_size()const;
       private:
          optional<index_entry> last_index_entry()const;
+         const index_entry* find_entry( uint32_t block_num )const;
+         /// Points at the packed block of @p e, either in the mapping or read into @p buffer
+         const char* block_data( const index_entry& e, vector<char>& buffer )const;
+         void remap_blocks()const;
+
          fc::path _index_filename;
+         fc::path _blocks_filename;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+
+         mutable std::vector<index_entry>             _index;
+         mutable std::unique_ptr<fc::file_mapping>    _blocks_mapping;
+         mutable std::unique_ptr<fc::mapped_region>   _blocks_region;
+         mutable uint64_t                             _mapped_size = 0;
+         uint64_t                                     _blocks_size = 0;
+         mutable uint64_t                             _read_position = 0;
+         mutable std::mutex                           _mutex;
    };
 } }
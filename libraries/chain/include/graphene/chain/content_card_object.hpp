@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <graphene/chain/content_hash.hpp>
+#include <graphene/chain/content_store.hpp>
 #include <graphene/chain/types.hpp>
 #include <graphene/db/generic_index.hpp>
 #include <graphene/protocol/account.hpp>
@@ -48,7 +50,7 @@ namespace graphene { namespace chain {
             static const uint8_t type_id  = content_card_object_type;
 
             account_id_type subject_account;
-            string   hash;
+            content_hash hash;
             string   url;
             uint64_t timestamp;
             string   type;
@@ -57,6 +59,9 @@ namespace graphene { namespace chain {
             string   storage_data;
             optional<room_id_type> room;  // Optional room for encrypted threads
             uint32_t key_epoch = 0;       // Epoch of the room key used to encrypt this card
+            /// Set when url, description, content_key and storage_data are kept in the content store,
+            /// the fields are then left empty
+            optional<content_store_ref> payload;
         };
 
         struct by_subject_account;
@@ -77,12 +82,12 @@ namespace graphene { namespace chain {
                      ordered_unique< tag<by_subject_account_and_hash>,
                            composite_key< content_card_object,
                                  member< content_card_object, account_id_type, &content_card_object::subject_account>,
-                                 member< content_card_object, string, &content_card_object::hash>
+                                 member< content_card_object, content_hash, &content_card_object::hash>
                            >
                      >,
                      ordered_unique< tag<by_hash>,
                            composite_key< content_card_object,
-                                 member< content_card_object, string, &content_card_object::hash>,
+                                 member< content_card_object, content_hash, &content_card_object::hash>,
                                  member< object, object_id_type, &object::id>
                            >
                      >,
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/reflect/typename.hpp>
+#include <fc/variant.hpp>
+
+#include <memory>
+#include <string>
+
+namespace graphene { namespace chain {
+
+   /**
+    * Hash of a content card or personal data entry, as given by the operation which created it, kept
+    * as a fixed-size key. Hashes written as 64 lowercase hex digits, which is what clients send, are
+    * held as the binary digest and compare without touching the heap. Any other string is kept as is,
+    * so that two hashes are equal exactly when their strings are. Digests sort in the order of their
+    * hex strings, before every other hash.
+    *
+    * The hash is serialized and rendered as its string.
+    */
+   class content_hash
+   {
+      public:
+         content_hash() {}
+         explicit content_hash( const std::string& hash );
+
+         /// The hash as it was given
+         std::string str()const;
+
+         bool is_digest()const { return !_text; }
+
+         friend bool operator == ( const content_hash& a, const content_hash& b )
+         {
+            if( !a._text || !b._text )
+               return !a._text && !b._text && a._digest == b._digest;
+            return *a._text == *b._text;
+         }
+         friend bool operator != ( const content_hash& a, const content_hash& b ) { return !( a == b ); }
+         friend bool operator < ( const content_hash& a, const content_hash& b )
+         {
+            if( !a._text || !b._text )
+               return !a._text && ( b._text || a._digest < b._digest );
+            return *a._text < *b._text;
+         }
+
+      private:
+         fc::sha256                         _digest;
+         /// The hash when it is not a digest, shared by the copies the undo database makes
+         std::shared_ptr<const std::string> _text;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT_TYPENAME( graphene::chain::content_hash )
+
+namespace fc {
+
+   void to_variant( const graphene::chain::content_hash& hash, fc::variant& var, uint32_t max_depth = 1 );
+   void from_variant( const fc::variant& var, graphene::chain::content_hash& hash, uint32_t max_depth = 1 );
+
+namespace raw {
+
+   template< typename Stream >
+   void pack( Stream& s, const graphene::chain::content_hash& hash, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+   {
+      fc::raw::pack( s, hash.str(), _max_depth );
+   }
+
+   template< typename Stream >
+   void unpack( Stream& s, graphene::chain::content_hash& hash, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+   {
+      std::string str;
+      fc::raw::unpack( s, str, _max_depth );
+      hash = graphene::chain::content_hash( str );
+   }
+
+} } // fc::raw
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+
+#include <deque>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace graphene { namespace chain {
+
+   using namespace graphene::protocol;
+
+   /// The large fields of a content card, which the content store keeps out of the object database
+   struct content_payload
+   {
+      string url;
+      string description;
+      string content_key;
+      string storage_data;
+   };
+
+   /// Where a payload is kept in the content store
+   struct content_store_ref
+   {
+      uint64_t offset = 0;
+      uint32_t size = 0;
+   };
+
+   /**
+    * Append-only file of packed content payloads, referenced by offset. Payloads are read through a
+    * memory mapping of the file and the most recently read ones are kept unpacked, up to a number of
+    * bytes given on construction. Appending a payload which was appended recently returns the earlier
+    * reference, so that transactions applied again after a pop or while producing do not grow the file.
+    *
+    * Payloads are never removed: the object database may be restored to an earlier state, and every
+    * reference it holds stays valid. Safe to read from other threads while payloads are appended.
+    */
+   class content_store
+   {
+      public:
+         explicit content_store( size_t cache_bytes ) : _cache_limit( cache_bytes ) {}
+
+         void open( const fc::path& filename );
+         void flush();
+         void close();
+         /// Drops every payload, for an object database which is started from genesis
+         void clear();
+
+         content_store_ref append( const content_payload& payload );
+         /// Throws if @p ref is not a payload of this store
+         content_payload   read( const content_store_ref& ref )const;
+
+         uint64_t size()const;
+
+      private:
+         typedef std::list<std::pair<uint64_t, content_payload>> lru_list;
+
+         void remap()const;
+         void reset_caches();
+         static size_t payload_bytes( const content_payload& payload );
+
+         fc::path                                        _filename;
+         mutable std::fstream                            _file;
+         uint64_t                                        _size = 0;
+         mutable std::unique_ptr<fc::file_mapping>       _mapping;
+         mutable std::unique_ptr<fc::mapped_region>      _region;
+         mutable uint64_t                                _mapped_size = 0;
+
+         /// Unpacked payloads by offset, most recently read first
+         const size_t                                    _cache_limit;
+         mutable lru_list                                _lru;
+         mutable std::unordered_map<uint64_t, lru_list::iterator> _cached;
+         mutable size_t                                  _cached_bytes = 0;
+
+         /// References of the last appended payloads by digest, oldest dropped past max_recent
+         static const size_t                             max_recent = 4096;
+         std::map<fc::sha256, content_store_ref>         _recent;
+         std::deque<fc::sha256>                          _recent_order;
+
+         mutable std::mutex                              _mutex;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::content_payload, (url)(description)(content_key)(storage_data) )
+FC_REFLECT( graphene::chain::content_store_ref, (offset)(size) )
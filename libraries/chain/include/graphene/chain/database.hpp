@@ -33,8 +33,13 @@
 #include <graphene/chain/commit_reveal_object.hpp>
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/content_store.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/fee_accumulator.hpp>
+#include <graphene/chain/ico_claim_cache.hpp>
+#include <graphene/chain/signature_key_cache.hpp>
+#include <graphene/chain/verified_transaction_cache.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -43,6 +48,11 @@
 
 #include <fc/log/logger.hpp>
 
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
+#include <thread>
+
 #include <map>
 
 namespace graphene { namespace protocol { struct predicate_result; } }
@@ -138,6 +148,8 @@ namespace graphene { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
+         /// Appends the packed block to @p data, straight from the block log unless it is still reversible
+         bool                       fetch_packed_block_by_id( const block_id_type& id, vector<char>& data )const;
          const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
@@ -370,6 +382,23 @@ namespace graphene { namespace chain {
          // helper to handle witness pay
          void deposit_witness_pay(const witness_object& wit, share_type amount);
 
+         /**
+          * @{
+          * @brief Fee counters of account statistics and asset dynamic data
+          *
+          * While the transactions of a block are applied, the fees they pay are combined by a
+          * fee_accumulator and applied once per object after the last transaction. Code which reads
+          * pending_fees, pending_vested_fees, accumulated_fees or fee_pool in between must call
+          * apply_pending_fees() on the object first, or use get_fee_pool().
+          */
+         void pay_fee( const account_statistics_object& stats, share_type core_fee );
+         void convert_fee( const asset_dynamic_data_object& dyn_data, share_type fee_amount, share_type core_fee );
+         /// Fee pool of @p dyn_data including the pending conversions
+         share_type get_fee_pool( const asset_dynamic_data_object& dyn_data )const;
+         void apply_pending_fees( const account_statistics_object& stats );
+         void apply_pending_fees( const asset_dynamic_data_object& dyn_data );
+         /// @}
+
          //////////////////// db_debug.cpp ////////////////////
 
          void debug_dump();
@@ -525,9 +554,40 @@ namespace graphene { namespace chain {
          /// Enable or disable tracking of votes of standby witnesses and committee members
          inline void enable_standby_votes_tracking(bool enable)  { _track_standby_votes = enable; }
 
+         /**
+          * Save an incremental object database checkpoint whenever @p interval more blocks became irreversible,
+          * merging the checkpoint logs into the full dump every @p compact_every checkpoints. Must be called
+          * before open(). With checkpoints enabled close() saves a last checkpoint instead of a full dump.
+          */
+         void enable_object_checkpoints( uint32_t interval, uint32_t compact_every );
+
+         /**
+          * Keep the url, description, content key and storage data of new and updated content cards in an
+          * append-only content store of the data directory rather than in the objects, holding at most
+          * @p cache_bytes of recently read payloads in memory. Must be called before open().
+          */
+         void enable_content_store( size_t cache_bytes );
+         /// The store of content card payloads, null unless enabled
+         const content_store* get_content_store()const { return _content_store.get(); }
+         content_store*       get_content_store()      { return _content_store.get(); }
+
+         /**
+          * Writes a binary snapshot of the state before the oldest undo state, which leaves out reversible
+          * blocks, to @p file. Indexes are serialized in parallel while the calling thread waits, the file is
+          * written in the background.
+          * @return the background write, which throws if it fails
+          */
+         fc::future<void> write_snapshot( const fc::path& file )const;
+         /**
+          * Makes open() load the binary snapshot @p file rather than the genesis state when the object database
+          * is empty, then replay the blocks of the block log which follow it. Must be called before open().
+          */
+         void start_from_snapshot( const fc::path& file );
+
          /** Precomputes digests, signatures and operation validations depending
           *  on skip flags. "Expensive" computations may be done in a parallel
-          *  thread.
+          *  thread. The signatures of all transactions are recovered as one batch,
+          *  reusing the keys recovered when the transactions were in the mempool.
           *
           * @param block the block to preprocess
           * @param skip indicates which computations can be skipped
@@ -544,9 +604,75 @@ namespace graphene { namespace chain {
           *         precomputations applied
           */
          fc::future<void> precompute_parallel( const precomputable_transaction& trx )const;
+
+         /** Same precomputations as precompute_parallel(), done entirely on the calling thread, for callers
+          *  which already run many blocks in parallel.
+          */
+         void precompute_block( const signed_block& block, const uint32_t skip )const;
+
+         /// Result of checking @p op against @p message while precomputing, if it was checked
+         fc::optional<ico_claim_check> find_ico_claim_check( const ico_balance_claim_operation& op,
+                                                             const std::string& message )const
+         { return _ico_claim_cache.find( op, message ); }
+
+         /**
+          * Configure the replay pipeline: @p lookahead blocks are read and decoded ahead of the block being
+          * applied, by a reader thread and @p threads decoding threads (0 for one per CPU core).
+          */
+         void set_replay_pipeline( uint32_t lookahead, uint32_t threads );
+
+         /**
+          * Allow queries from other threads. Readers hold lock_for_reading() while they query, every change of
+          * the state (pushing or popping blocks and transactions) holds the matching write lock, so a query
+          * always sees the state as of a block or transaction boundary, never half applied.
+          */
+         void enable_concurrent_reads( bool enable )
+         {
+            // waits for the queries in flight when disabling
+            boost::unique_lock<boost::shared_mutex> lock( _state_mutex );
+            _concurrent_reads = enable;
+         }
+         bool concurrent_reads_enabled()const { return _concurrent_reads; }
+         boost::shared_lock<boost::shared_mutex> lock_for_reading()const
+         { return boost::shared_lock<boost::shared_mutex>( _state_mutex ); }
+         /// Whether the calling task is changing the state, a read it waits for would never get the lock.
+         /// Other tasks of the same thread are not, they run while the changing task waits
+         bool is_changing_state()const { return _state_changer.load() == current_task(); }
    private:
          template<typename Trx>
          void _precompute_parallel( const Trx* trx, const size_t count, const uint32_t skip )const;
+         /// Sets the signature keys of the transactions which have none, @p digests holding their signed digests.
+         /// Keys come from the cache or from one batch of recoveries, run on the thread pool if @p in_parallel
+         template<typename Trx>
+         void _recover_signature_keys( const Trx* trx, const size_t count, const digest_type* digests,
+                                       bool in_parallel )const;
+
+         /// Collects the ICO claims of the transactions with their phrases, reads chain state so it must
+         /// run on the chain thread
+         template<typename Trx>
+         ico_claim_batch _get_ico_claims( const Trx* trx, const size_t count )const;
+         /// Splits the claims' key recoveries across the thread pool
+         void _check_ico_claims( ico_claim_batch&& claims, std::vector<fc::future<void>>& workers )const;
+         /// Checks the ICO claims of @p block in parallel and waits for them, used by the replay which
+         /// precomputes blocks away from the chain thread
+         void precompute_ico_claims( const signed_block& block )const;
+
+         void save_object_checkpoint_if_due();
+         void load_snapshot( const fc::path& file, const std::function<genesis_state_type()>& genesis_loader );
+
+         /// Identifies the fc task (fiber) running the caller, unique among the tasks alive
+         static const void* current_task();
+
+         /// Holds the write lock while the state changes if concurrent reads are enabled, nests within a task
+         class state_change_scope
+         {
+            public:
+               explicit state_change_scope( database& db );
+               ~state_change_scope();
+            private:
+               database& _db;
+               bool      _counted = false;
+         };
 
    protected:
          //Mark pop_undo() as protected -- we do not want outside calling pop_undo(); it should call pop_block() instead
@@ -670,6 +796,41 @@ namespace graphene { namespace chain {
          /// Set it to true to provide accurate data to API clients, set to false to have better performance.
          bool                              _track_standby_votes = true;
 
+         /// See enable_concurrent_reads()
+         std::atomic<bool>                 _concurrent_reads{ false };
+         mutable boost::shared_mutex       _state_mutex;
+         /// Nesting of state_change_scope, only touched by the task holding the write lock
+         uint32_t                          _state_change_depth = 0;
+         /// The task holding the write lock, see current_task()
+         std::atomic<const void*>          _state_changer{ nullptr };
+         /// The thread of that task
+         std::atomic<std::thread::id>      _state_changer_thread;
+
+         /// ICO claim checks done by the precompute stage for the evaluator
+         mutable ico_claim_cache           _ico_claim_cache;
+         /// Keys recovered from the signatures of recent transactions
+         mutable signature_key_cache       _signature_key_cache;
+         /// Transactions which passed their authority check, reused when they are applied again in a block
+         verified_transaction_cache        _verified_trx_cache;
+         /// Fees paid by the transactions of the block being applied, see pay_fee()
+         fee_accumulator                   _fee_accumulator;
+
+         /// Replay pipeline depth and decoding threads, see set_replay_pipeline()
+         uint32_t                          _replay_lookahead = 256;
+         uint32_t                          _replay_threads = 0;
+
+         /// Blocks between incremental object database checkpoints, 0 if disabled
+         uint32_t                          _object_checkpoint_interval = 0;
+         /// Block of the state written by the last object database checkpoint
+         uint32_t                          _last_object_checkpoint_block = 0;
+
+         std::unique_ptr<content_store>    _content_store;
+
+         /// Binary snapshot open() starts from instead of the genesis state
+         fc::optional<fc::path>            _snapshot_file;
+         /// Version of the object database given to open()
+         std::string                       _db_version;
+
          /**
           * Whether database is successfully opened or not.
           *
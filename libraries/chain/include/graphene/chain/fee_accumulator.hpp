@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/chain/types.hpp>
+
+#include <map>
+
+namespace graphene { namespace chain {
+
+   class database;
+   class account_statistics_object;
+   class asset_dynamic_data_object;
+
+   /**
+    * Fees paid by the transactions of a block, combined per object. Paying a fee adds to the pending
+    * fees of the payer's account statistics, and to the accumulated fees and fee pool of the fee asset;
+    * rather than modifying these objects for every operation, the amounts are summed here and applied
+    * with one modification per object after the transactions of the block.
+    *
+    * Fees are only combined within a combining scope. Code reading the combined counters while a block
+    * is applied has to apply the pending amounts of the object first, or take them into account.
+    * Since the block is undone as a whole when one of its transactions fails, pending amounts are
+    * simply discarded then.
+    */
+   class fee_accumulator
+   {
+      public:
+         /// Sets whether fees are combined until the end of the scope, discarding what the scope left pending
+         class scope
+         {
+            public:
+               scope( fee_accumulator& fees, bool combining );
+               ~scope();
+
+            private:
+               fee_accumulator& _fees;
+               bool             _was_combining;
+         };
+
+         bool combining()const { return _combining; }
+
+         /// Adds @p core_fee to the pending fees of @p stats, as account_statistics_object::pay_fee() does
+         void pay_fee( database& db, const account_statistics_object& stats, share_type core_fee,
+                       share_type cashback_vesting_threshold );
+         /// Adds @p fee_amount to the accumulated fees of @p dyn_data and takes @p core_fee from its fee pool
+         void convert_fee( database& db, const asset_dynamic_data_object& dyn_data, share_type fee_amount,
+                           share_type core_fee );
+
+         /// Change of the fee pool of @p dyn_data not applied yet, zero or negative
+         share_type pending_fee_pool_change( const asset_dynamic_data_object& dyn_data )const;
+
+         /// Applies the pending amounts of one object
+         void apply( database& db, const account_statistics_object& stats );
+         void apply( database& db, const asset_dynamic_data_object& dyn_data );
+         /// Applies every pending amount, one modification per object
+         void apply_all( database& db );
+         void discard();
+
+      private:
+         struct pending_fees
+         {
+            const account_statistics_object* stats = nullptr;
+            share_type                       fees;
+            share_type                       vested_fees;
+         };
+         struct pending_conversion
+         {
+            const asset_dynamic_data_object* dyn_data = nullptr;
+            share_type                       accumulated_fees;
+            share_type                       fee_pool;
+         };
+
+         static void apply( database& db, const pending_fees& pending );
+         static void apply( database& db, const pending_conversion& pending );
+
+         bool                                                  _combining = false;
+         /// Ordered by object ID, so that the objects are modified in the same order on every node
+         std::map<account_statistics_id_type,pending_fees>     _fees;
+         std::map<asset_dynamic_data_id_type,pending_conversion> _conversions;
+   };
+
+} } // graphene::chain
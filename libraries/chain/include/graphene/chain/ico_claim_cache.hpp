@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/protocol/ico_balance.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/optional.hpp>
+#include <fc/time.hpp>
+
+#include <deque>
+#include <map>
+#include <mutex>
+
+namespace graphene { namespace chain {
+
+   using namespace graphene::protocol;
+
+   /// The phrase an ICO balance claim signs, built from the claiming account and the head block date
+   std::string ico_claim_message( const std::string& account_name, fc::time_point_sec head_block_time );
+
+   /// ICO balance claims paired with the phrase each one has to sign
+   typedef std::vector<std::pair<const ico_balance_claim_operation*, std::string>> ico_claim_batch;
+
+   /// Outcome of checking the Ethereum key and signature of an ICO balance claim against its phrase
+   struct ico_claim_check
+   {
+      bool        signature_valid = false;
+      std::string eth_address;
+   };
+
+   /**
+    * Checks @p op against @p message on the calling thread.
+    * Throws if the key or the signature is malformed.
+    */
+   ico_claim_check check_ico_claim( const ico_balance_claim_operation& op, const std::string& message );
+
+   /**
+    * ICO claim checks done while precomputing transactions, so that the evaluator does not recover
+    * keys on the apply thread. Entries are keyed by the claim's key, signature and phrase, a check
+    * is only reused for the exact phrase the evaluator builds. Safe to use from any thread.
+    */
+   class ico_claim_cache
+   {
+      public:
+         static fc::sha256 key( const ico_balance_claim_operation& op, const std::string& message );
+
+         /**
+          * Checks every claim in @p claims against its phrase, as one batch, and caches the results.
+          * Claims with a malformed key or signature are left out for the evaluator to reject.
+          */
+         void check_claims( const ico_claim_batch& claims );
+
+         fc::optional<ico_claim_check> find( const ico_balance_claim_operation& op, const std::string& message )const;
+
+      private:
+         /// Oldest checks are dropped past this size, claims are looked up within a few blocks
+         static const size_t max_size = 16384;
+
+         mutable std::mutex                   _mutex;
+         std::map<fc::sha256,ico_claim_check> _checks;
+         std::deque<fc::sha256>               _order;
+   };
+
+} } // graphene::chain
@@ -94,6 +94,7 @@ namespace graphene { namespace chain {
          static constexpr uint8_t type_id  = impl_account_transaction_history_object_type;
          account_id_type                      account; /// the account this operation applies to
          operation_history_id_type            operation_id;
+         uint16_t                             op_type = 0; /// operation::which() of the operation
          uint64_t                             sequence = 0; /// the operation position within the given account
          account_transaction_history_id_type  next;
    };
@@ -110,6 +111,7 @@ namespace graphene { namespace chain {
    struct by_seq;
    struct by_op;
    struct by_opid;
+   struct by_type_seq;
 
    typedef multi_index_container<
       account_transaction_history_object,
@@ -129,6 +131,14 @@ namespace graphene { namespace chain {
          >,
          ordered_non_unique< tag<by_opid>,
             member< account_transaction_history_object, operation_history_id_type, &account_transaction_history_object::operation_id>
+         >,
+         /// the history of one account for one operation type, without visiting the other operations
+         ordered_unique< tag<by_type_seq>,
+            composite_key< account_transaction_history_object,
+               member< account_transaction_history_object, account_id_type, &account_transaction_history_object::account>,
+               member< account_transaction_history_object, uint16_t, &account_transaction_history_object::op_type>,
+               member< account_transaction_history_object, uint64_t, &account_transaction_history_object::sequence>
+            >
          >
       >
    > account_transaction_history_multi_index_type;
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <graphene/chain/content_hash.hpp>
 #include <graphene/chain/types.hpp>
 #include <graphene/db/generic_index.hpp>
 #include <graphene/protocol/account.hpp>
@@ -51,7 +52,7 @@ namespace graphene { namespace chain {
             account_id_type subject_account;
             account_id_type operator_account;
             string url;
-            string hash;
+            content_hash hash;
             string storage_data;
         };
 
@@ -66,14 +67,14 @@ namespace graphene { namespace chain {
                            composite_key< personal_data_object,
                                  member< personal_data_object, account_id_type, &personal_data_object::subject_account>,
                                  member< personal_data_object, account_id_type, &personal_data_object::operator_account>,
-                                 member< personal_data_object, string, &personal_data_object::hash>
+                                 member< personal_data_object, content_hash, &personal_data_object::hash>
                            >
                      >,
                      ordered_unique< tag<by_operator_account>,
                            composite_key< personal_data_object,
                                  member< personal_data_object, account_id_type, &personal_data_object::operator_account>,
                                  member< personal_data_object, account_id_type, &personal_data_object::subject_account>,
-                                 member< personal_data_object, string, &personal_data_object::hash>
+                                 member< personal_data_object, content_hash, &personal_data_object::hash>
                            >
                      >
                >
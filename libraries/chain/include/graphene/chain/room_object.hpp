@@ -84,8 +84,11 @@ namespace graphene { namespace chain {
       room_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_non_unique< tag<by_owner>,
-            member< room_object, account_id_type, &room_object::owner >
+         ordered_unique< tag<by_owner>,
+            composite_key< room_object,
+               member< room_object, account_id_type, &room_object::owner>,
+               member< object, object_id_type, &object::id>
+            >
          >,
          ordered_unique< tag<by_name>,
             composite_key< room_object,
@@ -108,11 +111,17 @@ namespace graphene { namespace chain {
       room_participant_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_non_unique< tag<by_room>,
-            member< room_participant_object, room_id_type, &room_participant_object::room >
+         ordered_unique< tag<by_room>,
+            composite_key< room_participant_object,
+               member< room_participant_object, room_id_type, &room_participant_object::room>,
+               member< object, object_id_type, &object::id>
+            >
          >,
-         ordered_non_unique< tag<by_participant>,
-            member< room_participant_object, account_id_type, &room_participant_object::participant >
+         ordered_unique< tag<by_participant>,
+            composite_key< room_participant_object,
+               member< room_participant_object, account_id_type, &room_participant_object::participant>,
+               member< object, object_id_type, &object::id>
+            >
          >,
          ordered_unique< tag<by_room_and_participant>,
             composite_key< room_participant_object,
@@ -167,10 +176,11 @@ namespace graphene { namespace chain {
                member< room_key_epoch_object, account_id_type, &room_key_epoch_object::participant>
             >
          >,
-         ordered_non_unique< tag<by_room_and_participant_epoch>,
+         ordered_unique< tag<by_room_and_participant_epoch>,
             composite_key< room_key_epoch_object,
                member< room_key_epoch_object, room_id_type, &room_key_epoch_object::room>,
-               member< room_key_epoch_object, account_id_type, &room_key_epoch_object::participant>
+               member< room_key_epoch_object, account_id_type, &room_key_epoch_object::participant>,
+               member< room_key_epoch_object, uint32_t, &room_key_epoch_object::epoch>
             >
          >
       >
@@ -178,16 +188,63 @@ namespace graphene { namespace chain {
 
    typedef generic_index<room_key_epoch_object, room_key_epoch_multi_index_type> room_key_epoch_index;
 
+   // ============ Room Key Epoch Table Object ============
+
+   /**
+    * @brief Keys of all participants of a room for one epoch, as set by a key rotation
+    * @ingroup object
+    * @ingroup implementation
+    *
+    * A rotation stores the keys of every participant in one object, rather than one room_key_epoch_object
+    * per participant. Participants added later in the epoch, and keys set for them by room_add_participant,
+    * are still stored as room_key_epoch_object, which take precedence over the table.
+    */
+   class room_key_epoch_table_object : public graphene::db::abstract_object<room_key_epoch_table_object>
+   {
+   public:
+      static constexpr uint8_t space_id = implementation_ids;
+      static constexpr uint8_t type_id  = impl_room_key_epoch_table_object_type;
+
+      room_id_type                        room;
+      uint32_t                            epoch;             // Key epoch number
+      flat_map<account_id_type, string>   participant_keys;  // Epoch key encrypted for each participant
+
+      /// The key of @p participant as a room_key_epoch_object with a null ID, or nothing if the table has no
+      /// key for them
+      fc::optional<room_key_epoch_object> find_key_epoch( account_id_type participant )const;
+   };
+
+   // ============ Room Key Epoch Table Indexes ============
+
+   typedef multi_index_container<
+      room_key_epoch_table_object,
+      indexed_by<
+         ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+         ordered_unique< tag<by_room_and_epoch>,
+            composite_key< room_key_epoch_table_object,
+               member< room_key_epoch_table_object, room_id_type, &room_key_epoch_table_object::room>,
+               member< room_key_epoch_table_object, uint32_t, &room_key_epoch_table_object::epoch>
+            >
+         >
+      >
+   > room_key_epoch_table_multi_index_type;
+
+   typedef generic_index<room_key_epoch_table_object, room_key_epoch_table_multi_index_type>
+           room_key_epoch_table_index;
+
 } } // graphene::chain
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::room_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::room_participant_object)
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::room_key_epoch_object)
+MAP_OBJECT_ID_TO_TYPE(graphene::chain::room_key_epoch_table_object)
 
 FC_REFLECT_TYPENAME( graphene::chain::room_object )
 FC_REFLECT_TYPENAME( graphene::chain::room_participant_object )
 FC_REFLECT_TYPENAME( graphene::chain::room_key_epoch_object )
+FC_REFLECT_TYPENAME( graphene::chain::room_key_epoch_table_object )
 
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::room_object )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::room_participant_object )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::room_key_epoch_object )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::chain::room_key_epoch_table_object )
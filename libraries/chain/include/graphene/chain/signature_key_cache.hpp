@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/optional.hpp>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   using namespace graphene::protocol;
+
+   /// A transaction signature to recover the key of, with the digest it signs
+   struct signature_recovery
+   {
+      digest_type           digest;
+      const signature_type* signature = nullptr;
+      public_key_type       key;
+   };
+
+   /**
+    * Recovers the key of every entry of @p batch, splitting the batch evenly across the thread
+    * pool whatever the number of signatures of each transaction. Waits for the recoveries, and
+    * throws if a signature is malformed.
+    */
+   void recover_signature_keys( std::vector<signature_recovery>& batch );
+
+   /**
+    * Keys recovered from transaction signatures, so that a transaction seen in the mempool does
+    * not have its keys recovered again when it arrives in a block. Entries are keyed by the signed
+    * digest, which includes the chain ID, and the signature. Safe to use from any thread.
+    */
+   class signature_key_cache
+   {
+      public:
+         static fc::sha256 key( const digest_type& digest, const signature_type& signature );
+
+         fc::optional<public_key_type> find( const fc::sha256& key )const;
+         void insert( const std::vector<std::pair<fc::sha256,public_key_type>>& keys );
+
+      private:
+         /// Oldest keys are dropped past this size, which covers a full mempool and a few blocks
+         static const size_t max_size = 65536;
+
+         mutable std::mutex                   _mutex;
+         std::map<fc::sha256,public_key_type> _keys;
+         std::deque<fc::sha256>               _order;
+   };
+
+} } // graphene::chain
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+#include <graphene/db/object_database.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/filesystem.hpp>
+
+namespace graphene { namespace chain {
+
+   using namespace graphene::protocol;
+
+   /// Where the dump of one index is in a binary snapshot
+   struct snapshot_section
+   {
+      uint8_t    space_id = 0;
+      uint8_t    type_id = 0;
+      uint64_t   object_count = 0;
+      uint64_t   offset = 0;
+      uint64_t   size = 0;
+      fc::sha256 checksum;
+   };
+
+   /// The chain state a binary snapshot holds, and where its sections are
+   struct snapshot_header
+   {
+      chain_id_type            chain_id;
+      uint32_t                 head_block_num = 0;
+      block_id_type            head_block_id;
+      fc::time_point_sec       head_block_time;
+      std::string              db_version;
+      vector<snapshot_section> sections;
+   };
+
+   /**
+    * A binary snapshot file starts with a magic string and a format version, followed by one section per
+    * index, each in the format of the object database files. The packed header comes next, and the file
+    * ends with the offset, size and checksum of the header, so that the header can be written last.
+    *
+    * Writes @p dumps to @p file through a temporary file, completing the sections of @p header.
+    */
+   void write_snapshot_file( const fc::path& file, snapshot_header header,
+                             const vector<graphene::db::object_database::index_dump>& dumps );
+
+   /// Reads the header of the snapshot file held by @p data, throws if it is not a valid snapshot
+   snapshot_header read_snapshot_header( const char* data, uint64_t size );
+
+   /// Checksum of the section at @p data, as recorded in the header
+   fc::sha256 snapshot_section_checksum( const char* data, uint64_t size );
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::snapshot_section, (space_id)(type_id)(object_count)(offset)(size)(checksum) )
+FC_REFLECT( graphene::chain::snapshot_header,
+            (chain_id)(head_block_num)(head_block_id)(head_block_time)(db_version)(sections) )
@@ -46,4 +46,5 @@ GRAPHENE_DEFINE_IDS(chain, implementation_ids, impl_,
                     /* 2.13.x */ (special_authority)
                     /* 2.14.x */ (buyback)
                     /* 2.15.x */ (fba_accumulator)
+                    /* 2.16.x */ (room_key_epoch_table)
                    )
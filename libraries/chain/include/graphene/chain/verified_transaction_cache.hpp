@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/db/index.hpp>
+#include <graphene/protocol/authority.hpp>
+#include <graphene/protocol/transaction.hpp>
+
+#include <deque>
+#include <map>
+#include <mutex>
+
+namespace graphene { namespace chain {
+
+   using namespace graphene::protocol;
+   using graphene::db::object;
+   using graphene::db::secondary_index;
+
+   /**
+    * Transactions which passed their authority check, so that a transaction applied from the mempool
+    * is not checked again when it is applied in a block. A check is reused for the same transaction
+    * signed by the same signatures, as long as none of the accounts whose authorities it read has had
+    * them changed since. Changes are reported by the watchers below, which see the changes made by
+    * undoing blocks and pending transactions as well.
+    *
+    * Checks are made and reused by the thread applying transactions, but the watchers are also called
+    * by the threads loading indexes in parallel, when the object database is opened or a snapshot is
+    * loaded, so every member is guarded by a mutex. The database clears the cache once loading is done,
+    * since objects loaded from disk are not changes.
+    */
+   class verified_transaction_cache
+   {
+      public:
+         static digest_type signatures_digest( const signed_transaction& trx );
+
+         /// Whether the transaction passed its authority check with @p signatures and @p max_depth, and still would
+         bool is_verified( const transaction_id_type& id, const digest_type& signatures, uint32_t max_depth )const;
+         /// Records a passed check which read the authorities of @p accounts
+         void add( const transaction_id_type& id, const digest_type& signatures, uint32_t max_depth,
+                   const flat_set<account_id_type>& accounts );
+
+         /// Drops the checks which read the authorities of @p account
+         void authority_changed( account_id_type account );
+         void clear();
+
+      private:
+         struct entry
+         {
+            digest_type                  signatures;
+            uint32_t                     max_depth = 0;
+            uint64_t                     verified_at = 0;
+            std::vector<account_id_type> accounts;
+         };
+
+         /// Oldest checks are dropped past this size, which covers a full mempool and a few blocks
+         static const size_t max_size = 65536;
+
+         mutable std::mutex                        _mutex;
+         /// Advanced by every change, an entry is valid while its accounts changed no later than it
+         uint64_t                                  _clock = 0;
+         std::map<account_id_type,uint64_t>        _changed_at;
+         std::map<transaction_id_type,entry>       _entries;
+         std::deque<transaction_id_type>           _order;
+   };
+
+   /// Reports changes of the owner and active authorities of accounts to a verified_transaction_cache
+   class account_authority_watcher : public secondary_index
+   {
+      public:
+         explicit account_authority_watcher( verified_transaction_cache* cache ) : _cache( cache ) {}
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after ) override;
+
+      private:
+         verified_transaction_cache* _cache;
+         authority                   _before_owner;
+         authority                   _before_active;
+   };
+
+   /// Reports every change of a custom authority to a verified_transaction_cache, as a change of its account
+   class custom_authority_watcher : public secondary_index
+   {
+      public:
+         explicit custom_authority_watcher( verified_transaction_cache* cache ) : _cache( cache ) {}
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after ) override;
+
+      private:
+         verified_transaction_cache* _cache;
+   };
+
+} } // graphene::chain
@@ -45,9 +45,8 @@ void_result personal_data_create_evaluator::do_evaluate( const personal_data_cre
    const auto& by_op_idx = pd_idx.indices().get<by_subject_account>();
 
    if (op.subject_account == op.operator_account){
-      auto itr = by_op_idx.lower_bound(boost::make_tuple(op.subject_account, op.operator_account, op.hash));
-      FC_ASSERT(itr->subject_account != op.subject_account || itr->operator_account != op.operator_account || itr->hash != op.hash,
-                "Personal data already exists.");
+      auto itr = by_op_idx.find(boost::make_tuple(op.subject_account, op.operator_account, content_hash(op.hash)));
+      FC_ASSERT(itr == by_op_idx.end(), "Personal data already exists.");
    } else {
       auto itr = by_op_idx.lower_bound(boost::make_tuple(op.subject_account, op.operator_account));
       FC_ASSERT(itr->subject_account != op.subject_account || itr->operator_account != op.operator_account,
@@ -65,7 +64,7 @@ object_id_type personal_data_create_evaluator::do_apply( const personal_data_cre
          obj.subject_account  = o.subject_account;
          obj.operator_account = o.operator_account;
          obj.url              = o.url;
-         obj.hash             = o.hash;
+         obj.hash             = content_hash(o.hash);
          obj.storage_data     = o.storage_data;
 
    });
@@ -78,9 +77,8 @@ void_result personal_data_remove_evaluator::do_evaluate( const personal_data_rem
    // check personal data exist
    const auto& pd_idx = d.get_index_type<personal_data_index>();
    const auto& by_op_idx = pd_idx.indices().get<by_subject_account>();
-   auto itr = by_op_idx.lower_bound(boost::make_tuple(op.subject_account, op.operator_account, op.hash));
-   FC_ASSERT( itr->subject_account == op.subject_account && itr->operator_account == op.operator_account && itr->hash == op.hash,
-         "Personal data does not exists.");
+   auto itr = by_op_idx.find(boost::make_tuple(op.subject_account, op.operator_account, content_hash(op.hash)));
+   FC_ASSERT( itr != by_op_idx.end(), "Personal data does not exists.");
 
    return void_result();
 } FC_CAPTURE_AND_RETHROW( (op) ) }
@@ -90,7 +88,7 @@ object_id_type personal_data_remove_evaluator::do_apply( const personal_data_rem
    database& d = db();
    const auto& pd_idx = d.get_index_type<personal_data_index>();
    const auto& by_op_idx = pd_idx.indices().get<by_subject_account>();
-   auto itr = by_op_idx.lower_bound(boost::make_tuple(o.subject_account, o.operator_account, o.hash));
+   auto itr = by_op_idx.find(boost::make_tuple(o.subject_account, o.operator_account, content_hash(o.hash)));
    auto pd_id = itr->id;
    d.remove(d.get_object(pd_id));
    return pd_id;
@@ -234,7 +234,7 @@ void_result room_rotate_key_evaluator::do_evaluate( const room_rotate_key_operat
    const auto& by_room_idx = participant_idx.indices().get<by_room>();
 
    flat_set<account_id_type> current_participants;
-   auto itr = by_room_idx.lower_bound(op.room);
+   auto itr = by_room_idx.lower_bound(boost::make_tuple(op.room));
    while( itr != by_room_idx.end() && itr->room == op.room )
    {
       current_participants.insert(itr->participant);
@@ -276,32 +276,32 @@ object_id_type room_rotate_key_evaluator::do_apply( const room_rotate_key_operat
       obj.room_key = o.new_room_key;
    });
 
-   // Update participant content_keys and create epoch records
+   // Update participant content_keys. do_evaluate checked that participant_keys holds exactly the current
+   // participants, so both ranges are ordered by account and are walked in one pass.
    const auto& participant_idx = d.get_index_type<room_participant_index>();
-   const auto& by_room_idx = participant_idx.indices().get<by_room>();
+   const auto& by_room_part = participant_idx.indices().get<by_room_and_participant>();
 
-   auto itr = by_room_idx.lower_bound(o.room);
-   while( itr != by_room_idx.end() && itr->room == o.room )
+   auto itr = by_room_part.lower_bound(boost::make_tuple(o.room));
+   for( const auto& pk : o.participant_keys )
    {
-      auto pk_itr = o.participant_keys.find(itr->participant);
-      if( pk_itr != o.participant_keys.end() )
+      FC_ASSERT( itr != by_room_part.end() && itr->room == o.room && itr->participant == pk.first );
+      if( itr->content_key != pk.second )
       {
-         d.modify(*itr, [&pk_itr](room_participant_object& obj) {
-            obj.content_key = pk_itr->second;
-         });
-
-         // Create epoch key record
-         d.create<room_key_epoch_object>( [&o, &pk_itr, new_epoch]( room_key_epoch_object& obj )
-         {
-            obj.room        = o.room;
-            obj.epoch       = new_epoch;
-            obj.participant = pk_itr->first;
-            obj.content_key = pk_itr->second;
+         d.modify(*itr, [&pk](room_participant_object& obj) {
+            obj.content_key = pk.second;
          });
       }
       ++itr;
    }
 
+   // Store the keys of the epoch in one table
+   d.create<room_key_epoch_table_object>( [&o, new_epoch]( room_key_epoch_table_object& obj )
+   {
+      obj.room             = o.room;
+      obj.epoch            = new_epoch;
+      obj.participant_keys = o.participant_keys;
+   });
+
    return _room->id;
 } FC_CAPTURE_AND_RETHROW((o)) }
 
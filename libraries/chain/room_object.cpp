@@ -31,6 +31,21 @@
 
 namespace graphene { namespace chain {
 
+fc::optional<room_key_epoch_object> room_key_epoch_table_object::find_key_epoch( account_id_type participant )const
+{
+   auto itr = participant_keys.find( participant );
+   if( itr == participant_keys.end() )
+      return fc::optional<room_key_epoch_object>();
+
+   // the key has no object of its own, and the table's ID would be shared by every participant
+   room_key_epoch_object result;
+   result.room        = room;
+   result.epoch       = epoch;
+   result.participant = participant;
+   result.content_key = itr->second;
+   return result;
+}
+
 } } // graphene::chain
 
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::room_object,
@@ -48,6 +63,12 @@ FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::room_key_epoch_object,
                     (room)(epoch)(participant)(content_key)
                     )
 
+FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::room_key_epoch_table_object,
+                    (graphene::db::object),
+                    (room)(epoch)(participant_keys)
+                    )
+
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::chain::room_object )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::chain::room_participant_object )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::chain::room_key_epoch_object )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::chain::room_key_epoch_table_object )
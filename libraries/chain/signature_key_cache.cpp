@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include <graphene/chain/signature_key_cache.hpp>
+
+#include <fc/asio.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/thread/parallel.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+// Recoveries handed to a worker at least, smaller batches are not worth a thread switch
+const size_t min_chunk_size = 8;
+
+void recover_range( signature_recovery* first, signature_recovery* last )
+{
+   for( ; first != last; ++first )
+      first->key = fc::ecc::public_key( *first->signature, first->digest );
+}
+
+} // anonymous namespace
+
+void recover_signature_keys( std::vector<signature_recovery>& batch )
+{
+   if( batch.empty() )
+      return;
+   const size_t threads = fc::asio::default_io_service_scope::get_num_threads();
+   const size_t chunk_size = std::max( min_chunk_size, ( batch.size() + threads - 1 ) / threads );
+   if( chunk_size >= batch.size() )
+   {
+      recover_range( batch.data(), batch.data() + batch.size() );
+      return;
+   }
+
+   std::vector<fc::future<void>> workers;
+   workers.reserve( threads );
+   for( size_t base = 0; base < batch.size(); base += chunk_size )
+   {
+      signature_recovery* first = batch.data() + base;
+      signature_recovery* last = batch.data() + std::min( base + chunk_size, batch.size() );
+      workers.push_back( fc::do_parallel( [first,last] () { recover_range( first, last ); } ) );
+   }
+   // every worker is waited for before the first failure is rethrown, they write into the batch
+   fc::exception_ptr failure;
+   for( auto& worker : workers )
+   {
+      try {
+         worker.wait();
+      } catch( const fc::exception& e ) {
+         if( !failure )
+            failure = e.dynamic_copy_exception();
+      }
+   }
+   if( failure )
+      failure->dynamic_rethrow_exception();
+}
+
+fc::sha256 signature_key_cache::key( const digest_type& digest, const signature_type& signature )
+{
+   fc::sha256::encoder enc;
+   fc::raw::pack( enc, digest );
+   fc::raw::pack( enc, signature );
+   return enc.result();
+}
+
+fc::optional<public_key_type> signature_key_cache::find( const fc::sha256& key )const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _keys.find( key );
+   if( itr == _keys.end() )
+      return {};
+   return itr->second;
+}
+
+void signature_key_cache::insert( const std::vector<std::pair<fc::sha256,public_key_type>>& keys )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   for( const auto& key : keys )
+   {
+      if( _keys.emplace( key.first, key.second ).second )
+         _order.push_back( key.first );
+   }
+   while( _order.size() > max_size )
+   {
+      _keys.erase( _order.front() );
+      _order.pop_front();
+   }
+}
+
+} } // graphene::chain
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include <graphene/chain/snapshot.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <cstring>
+#include <fstream>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+const char     snapshot_magic[8] = { 'G', 'R', 'P', 'H', 'S', 'N', 'A', 'P' };
+const uint32_t snapshot_format = 1;
+// header offset, header size and header checksum
+const uint64_t trailer_size = 2 * sizeof(uint64_t) + sizeof(fc::sha256);
+
+} // anonymous namespace
+
+fc::sha256 snapshot_section_checksum( const char* data, uint64_t size )
+{
+   fc::sha256::encoder enc;
+   while( size > 0 )
+   {
+      const uint32_t chunk = uint32_t( std::min<uint64_t>( size, 1 << 30 ) );
+      enc.write( data, chunk );
+      data += chunk;
+      size -= chunk;
+   }
+   return enc.result();
+}
+
+void write_snapshot_file( const fc::path& file, snapshot_header header,
+                          const vector<graphene::db::object_database::index_dump>& dumps )
+{ try {
+   const fc::path tmp = file.generic_string() + ".tmp";
+   if( file.has_parent_path() )
+      fc::create_directories( file.parent_path() );
+   {
+      std::ofstream out( tmp.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+      out.write( snapshot_magic, sizeof(snapshot_magic) );
+      fc::raw::pack( out, snapshot_format );
+      uint64_t offset = sizeof(snapshot_magic) + sizeof(snapshot_format);
+
+      header.sections.clear();
+      header.sections.reserve( dumps.size() );
+      for( const auto& dump : dumps )
+      {
+         snapshot_section section;
+         section.space_id = dump.space_id;
+         section.type_id = dump.type_id;
+         section.object_count = dump.object_count;
+         section.offset = offset;
+         section.size = dump.data.size();
+         section.checksum = snapshot_section_checksum( dump.data.data(), dump.data.size() );
+         out.write( dump.data.data(), dump.data.size() );
+         offset += dump.data.size();
+         header.sections.push_back( section );
+      }
+
+      const auto packed_header = fc::raw::pack( header );
+      out.write( packed_header.data(), packed_header.size() );
+      fc::raw::pack( out, offset );
+      fc::raw::pack( out, uint64_t( packed_header.size() ) );
+      fc::raw::pack( out, fc::sha256::hash( packed_header.data(), packed_header.size() ) );
+      out.close();
+      FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+   }
+   fc::rename( tmp, file );
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+snapshot_header read_snapshot_header( const char* data, uint64_t size )
+{ try {
+   const uint64_t prefix_size = sizeof(snapshot_magic) + sizeof(snapshot_format);
+   FC_ASSERT( size >= prefix_size + trailer_size && std::memcmp( data, snapshot_magic, sizeof(snapshot_magic) ) == 0,
+              "Not a binary snapshot" );
+   uint32_t format;
+   std::memcpy( &format, data + sizeof(snapshot_magic), sizeof(format) );
+   FC_ASSERT( format == snapshot_format, "Unsupported snapshot format ${f}", ("f", format) );
+
+   uint64_t header_offset;
+   uint64_t header_size;
+   fc::sha256 header_checksum;
+   fc::datastream<const char*> trailer( data + size - trailer_size, trailer_size );
+   fc::raw::unpack( trailer, header_offset );
+   fc::raw::unpack( trailer, header_size );
+   fc::raw::unpack( trailer, header_checksum );
+   FC_ASSERT( header_offset >= prefix_size && header_size <= size - trailer_size - header_offset,
+              "The snapshot header is out of the file, the snapshot is truncated" );
+   FC_ASSERT( fc::sha256::hash( data + header_offset, header_size ) == header_checksum,
+              "The snapshot header is corrupt" );
+
+   snapshot_header header;
+   fc::datastream<const char*> ds( data + header_offset, header_size );
+   fc::raw::unpack( ds, header );
+   for( const auto& section : header.sections )
+      FC_ASSERT( section.offset >= prefix_size && section.offset <= header_offset
+                 && section.size <= header_offset - section.offset,
+                 "Section ${s}.${t} is out of the snapshot", ("s", section.space_id)("t", section.type_id) );
+   return header;
+} FC_CAPTURE_AND_RETHROW() }
+
+} } // graphene::chain
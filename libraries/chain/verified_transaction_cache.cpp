@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include <graphene/chain/verified_transaction_cache.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/custom_authority_object.hpp>
+
+#include <fc/io/raw.hpp>
+
+namespace graphene { namespace chain {
+
+digest_type verified_transaction_cache::signatures_digest( const signed_transaction& trx )
+{
+   digest_type::encoder enc;
+   fc::raw::pack( enc, trx.signatures );
+   return enc.result();
+}
+
+bool verified_transaction_cache::is_verified( const transaction_id_type& id, const digest_type& signatures,
+                                              uint32_t max_depth )const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   auto itr = _entries.find( id );
+   if( itr == _entries.end() )
+      return false;
+   const entry& e = itr->second;
+   if( e.signatures != signatures || e.max_depth != max_depth )
+      return false;
+   for( const auto& account : e.accounts )
+   {
+      auto changed = _changed_at.find( account );
+      if( changed != _changed_at.end() && changed->second > e.verified_at )
+         return false;
+   }
+   return true;
+}
+
+void verified_transaction_cache::add( const transaction_id_type& id, const digest_type& signatures, uint32_t max_depth,
+                                      const flat_set<account_id_type>& accounts )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   // the change times of accounts are only forgotten along with every check
+   if( _changed_at.size() > max_size )
+   {
+      _entries.clear();
+      _order.clear();
+      _changed_at.clear();
+   }
+
+   auto itr = _entries.find( id );
+   if( itr == _entries.end() )
+   {
+      itr = _entries.emplace( id, entry() ).first;
+      _order.push_back( id );
+   }
+   entry& e = itr->second;
+   e.signatures = signatures;
+   e.max_depth = max_depth;
+   e.verified_at = _clock;
+   e.accounts.assign( accounts.begin(), accounts.end() );
+
+   while( _order.size() > max_size )
+   {
+      _entries.erase( _order.front() );
+      _order.pop_front();
+   }
+}
+
+void verified_transaction_cache::authority_changed( account_id_type account )
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   _changed_at[account] = ++_clock;
+}
+
+void verified_transaction_cache::clear()
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   _entries.clear();
+   _order.clear();
+   _changed_at.clear();
+}
+
+void account_authority_watcher::object_inserted( const object& obj )
+{
+   _cache->authority_changed( static_cast<const account_object&>( obj ).id );
+}
+
+void account_authority_watcher::object_removed( const object& obj )
+{
+   _cache->authority_changed( static_cast<const account_object&>( obj ).id );
+}
+
+void account_authority_watcher::about_to_modify( const object& before )
+{
+   const auto& account = static_cast<const account_object&>( before );
+   _before_owner = account.owner;
+   _before_active = account.active;
+}
+
+void account_authority_watcher::object_modified( const object& after )
+{
+   const auto& account = static_cast<const account_object&>( after );
+   if( account.owner != _before_owner || account.active != _before_active )
+      _cache->authority_changed( account.id );
+}
+
+void custom_authority_watcher::object_inserted( const object& obj )
+{
+   _cache->authority_changed( static_cast<const custom_authority_object&>( obj ).account );
+}
+
+void custom_authority_watcher::object_removed( const object& obj )
+{
+   _cache->authority_changed( static_cast<const custom_authority_object&>( obj ).account );
+}
+
+void custom_authority_watcher::about_to_modify( const object& before )
+{
+   _cache->authority_changed( static_cast<const custom_authority_object&>( before ).account );
+}
+
+void custom_authority_watcher::object_modified( const object& after )
+{
+   _cache->authority_changed( static_cast<const custom_authority_object&>( after ).account );
+}
+
+} } // graphene::chain
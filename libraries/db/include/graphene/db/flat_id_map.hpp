@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/protocol/object_id.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace db {
+
+   namespace detail {
+
+      /**
+       * Open-addressed hash table keyed by object id, probing linearly in one flat array.
+       * Clearing keeps the storage of small tables, so a table reused for many short undo
+       * sessions stops allocating once it has grown to its working size.
+       */
+      template<typename Entry, typename KeyOf>
+      class flat_id_table
+      {
+         public:
+            class const_iterator
+            {
+               public:
+                  typedef std::forward_iterator_tag iterator_category;
+                  typedef Entry                     value_type;
+                  typedef std::ptrdiff_t            difference_type;
+                  typedef const Entry*              pointer;
+                  typedef const Entry&              reference;
+
+                  const_iterator() {}
+
+                  reference operator*()const  { return _table->_entries[_pos]; }
+                  pointer   operator->()const { return &_table->_entries[_pos]; }
+
+                  const_iterator& operator++() { _pos = _table->next_full( _pos + 1 ); return *this; }
+                  const_iterator  operator++( int ) { auto tmp = *this; ++*this; return tmp; }
+
+                  bool operator==( const const_iterator& o )const { return _pos == o._pos; }
+                  bool operator!=( const const_iterator& o )const { return _pos != o._pos; }
+
+               private:
+                  friend class flat_id_table;
+                  const_iterator( const flat_id_table* table, size_t pos ) : _table( table ), _pos( pos ) {}
+
+                  const flat_id_table* _table = nullptr;
+                  size_t               _pos = 0;
+            };
+            typedef const_iterator iterator;
+
+            flat_id_table() {}
+            flat_id_table( const flat_id_table& ) = default;
+            flat_id_table& operator=( const flat_id_table& ) = default;
+            flat_id_table( flat_id_table&& o )
+               : _entries( std::move( o._entries ) ), _states( std::move( o._states ) ),
+                 _size( o._size ), _used( o._used ), _shift( o._shift )
+            {
+               o.release();
+            }
+            flat_id_table& operator=( flat_id_table&& o )
+            {
+               if( this != &o )
+               {
+                  _entries = std::move( o._entries );
+                  _states = std::move( o._states );
+                  _size = o._size;
+                  _used = o._used;
+                  _shift = o._shift;
+                  o.release();
+               }
+               return *this;
+            }
+
+            size_t size()const  { return _size; }
+            bool   empty()const { return _size == 0; }
+
+            const_iterator begin()const { return const_iterator( this, next_full( 0 ) ); }
+            const_iterator end()const   { return const_iterator( this, _states.size() ); }
+
+            const_iterator find( object_id_type id )const
+            {
+               return const_iterator( this, find_slot( id ) );
+            }
+            size_t count( object_id_type id )const { return find_slot( id ) != _states.size() ? 1 : 0; }
+
+            size_t erase( object_id_type id )
+            {
+               const size_t pos = find_slot( id );
+               if( pos == _states.size() )
+                  return 0;
+               _states[pos] = deleted;
+               _entries[pos] = Entry();
+               --_size;
+               return 1;
+            }
+
+            /// Forgets every entry, tables beyond @ref retained_capacity give their storage back
+            void clear()
+            {
+               if( _states.size() > retained_capacity )
+               {
+                  release();
+                  return;
+               }
+               for( size_t i = 0; i < _states.size(); ++i )
+               {
+                  if( _states[i] == full )
+                     _entries[i] = Entry();
+                  _states[i] = empty_slot;
+               }
+               _size = 0;
+               _used = 0;
+            }
+
+            static const size_t retained_capacity = 4096;
+
+         protected:
+            /// Slot holding @p id, inserting a default entry for it if there is none
+            Entry& slot_for( object_id_type id, bool& inserted )
+            {
+               if( ( _used + 1 ) * 4 > _states.size() * 3 )
+                  rehash( _size * 2 + 2 );
+               size_t pos = home( id );
+               size_t reuse = _states.size();
+               while( _states[pos] != empty_slot )
+               {
+                  if( _states[pos] == full && KeyOf()( _entries[pos] ) == id )
+                  {
+                     inserted = false;
+                     return _entries[pos];
+                  }
+                  if( _states[pos] == deleted && reuse == _states.size() )
+                     reuse = pos;
+                  pos = ( pos + 1 ) & ( _states.size() - 1 );
+               }
+               if( reuse != _states.size() )
+                  pos = reuse;
+               else
+                  ++_used;
+               _states[pos] = full;
+               ++_size;
+               inserted = true;
+               return _entries[pos];
+            }
+
+         private:
+            enum : uint8_t { empty_slot = 0, full = 1, deleted = 2 };
+
+            size_t home( object_id_type id )const
+            {
+               // Fibonacci hashing spreads consecutive instances of one type over the table
+               return size_t( ( id.number * UINT64_C(0x9E3779B97F4A7C15) ) >> _shift );
+            }
+
+            size_t find_slot( object_id_type id )const
+            {
+               if( _size == 0 )
+                  return _states.size();
+               size_t pos = home( id );
+               while( _states[pos] != empty_slot )
+               {
+                  if( _states[pos] == full && KeyOf()( _entries[pos] ) == id )
+                     return pos;
+                  pos = ( pos + 1 ) & ( _states.size() - 1 );
+               }
+               return _states.size();
+            }
+
+            size_t next_full( size_t pos )const
+            {
+               while( pos < _states.size() && _states[pos] != full )
+                  ++pos;
+               return pos;
+            }
+
+            void rehash( size_t min_entries )
+            {
+               size_t capacity = 16;
+               unsigned bits = 4;
+               while( capacity * 3 < min_entries * 4 )
+               {
+                  capacity <<= 1;
+                  ++bits;
+               }
+               std::vector<Entry>   entries( capacity );
+               std::vector<uint8_t> states( capacity, empty_slot );
+               entries.swap( _entries );
+               states.swap( _states );
+               _shift = 64 - bits;
+               _used = _size;
+               for( size_t i = 0; i < states.size(); ++i )
+               {
+                  if( states[i] != full )
+                     continue;
+                  size_t pos = home( KeyOf()( entries[i] ) );
+                  while( _states[pos] != empty_slot )
+                     pos = ( pos + 1 ) & ( capacity - 1 );
+                  _entries[pos] = std::move( entries[i] );
+                  _states[pos] = full;
+               }
+            }
+
+            void release()
+            {
+               _entries = std::vector<Entry>();
+               _states = std::vector<uint8_t>();
+               _size = 0;
+               _used = 0;
+               _shift = 64;
+            }
+
+            std::vector<Entry>   _entries;
+            std::vector<uint8_t> _states;
+            size_t               _size = 0;
+            /// Slots not empty, including deleted ones, which keep probe sequences going
+            size_t               _used = 0;
+            unsigned             _shift = 64;
+      };
+
+      template<typename Value>
+      struct pair_key
+      {
+         object_id_type operator()( const std::pair<object_id_type, Value>& e )const { return e.first; }
+      };
+
+      struct id_key
+      {
+         object_id_type operator()( const object_id_type& e )const { return e; }
+      };
+
+   } // namespace detail
+
+   /// Map from object id to a small value, stored as an open-addressed flat table
+   template<typename Value>
+   class flat_id_map : public detail::flat_id_table< std::pair<object_id_type, Value>, detail::pair_key<Value> >
+   {
+      public:
+         Value& operator[]( object_id_type id )
+         {
+            bool inserted;
+            auto& entry = this->slot_for( id, inserted );
+            if( inserted )
+               entry.first = id;
+            return entry.second;
+         }
+
+         /// Inserts @p value unless @p id is already mapped, returns whether it was inserted
+         bool emplace( object_id_type id, const Value& value )
+         {
+            bool inserted;
+            auto& entry = this->slot_for( id, inserted );
+            if( inserted )
+               entry = std::make_pair( id, value );
+            return inserted;
+         }
+   };
+
+   /// Set of object ids, stored as an open-addressed flat table
+   class flat_id_set : public detail::flat_id_table< object_id_type, detail::id_key >
+   {
+      public:
+         bool insert( object_id_type id )
+         {
+            bool inserted;
+            auto& entry = slot_for( id, inserted );
+            if( inserted )
+               entry = id;
+            return inserted;
+         }
+   };
+
+} } // graphene::db
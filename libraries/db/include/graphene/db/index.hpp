@@ -81,6 +81,12 @@ namespace graphene { namespace db {
          virtual void           set_next_id( object_id_type id ) = 0;
 
          virtual const object&  load( const std::vector<char>& data ) = 0;
+         /**
+          *  Replaces an object by, or adds, its serialized form and removes an object by id. Used to replay
+          *  checkpoint logs on open, neither fires observers nor saves undo state.
+          */
+         virtual const object&  reload( const std::vector<char>& data ) = 0;
+         virtual void           unload( object_id_type id ) = 0;
          /**
           *  Polymorphically insert by moving an object into the index.
           *  this should throw if the object is already in the database.
@@ -98,6 +104,7 @@ namespace graphene { namespace db {
           */
          virtual void open( const fc::path& db ) = 0;
          virtual void save( const fc::path& db ) = 0;
+         virtual fc::sha256 get_object_version()const = 0;
 
 
 
@@ -336,7 +343,7 @@ namespace graphene { namespace db {
             return DerivedIndex::find( id );
          }
 
-         fc::sha256 get_object_version()const
+         virtual fc::sha256 get_object_version()const override
          {
             std::string desc = "1.0";//get_type_description<object_type>();
             return fc::sha256::hash(desc);
@@ -384,6 +391,26 @@ namespace graphene { namespace db {
             return result;
          }
 
+         virtual const object&  reload( const std::vector<char>& data )override
+         {
+            auto obj = fc::raw::unpack<object_type>( data );
+            unload( obj.id );
+            const auto& result = DerivedIndex::insert( std::move( obj ) );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            return result;
+         }
+
+         virtual void unload( object_id_type id )override
+         {
+            const object* existing = find( id );
+            if( existing == nullptr )
+               return;
+            for( const auto& item : _sindex )
+               item->object_removed( *existing );
+            DerivedIndex::remove( *existing );
+         }
+
 
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
@@ -26,6 +26,8 @@
 #include <graphene/protocol/object_id.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/crypto/city.hpp>
+#include <cstddef>
+#include <new>
 
 #define MAX_NESTING (200)
 
@@ -70,6 +72,9 @@ namespace graphene { namespace db {
 
          /// these methods are implemented for derived classes by inheriting abstract_object<DerivedClass>
          virtual unique_ptr<object> clone()const = 0;
+         /// Copy constructs the object into @p storage, which holds at least @ref object_size bytes
+         virtual object*            clone_into( void* storage )const = 0;
+         virtual size_t             object_size()const = 0;
          virtual void               move_from( object& obj ) = 0;
          virtual variant            to_variant()const  = 0;
          virtual vector<char>       pack()const = 0;
@@ -91,6 +96,13 @@ namespace graphene { namespace db {
             return unique_ptr<object>( std::make_unique<DerivedClass>( *static_cast<const DerivedClass*>(this) ) );
          }
 
+         virtual object* clone_into( void* storage )const
+         {
+            static_assert( alignof(DerivedClass) <= alignof(std::max_align_t), "over-aligned objects are not supported" );
+            return new (storage) DerivedClass( *static_cast<const DerivedClass*>(this) );
+         }
+         virtual size_t object_size()const { return sizeof(DerivedClass); }
+
          virtual void    move_from( object& obj )
          {
             static_cast<DerivedClass&>(*this) = std::move( static_cast<DerivedClass&>(obj) );
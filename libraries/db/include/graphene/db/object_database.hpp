@@ -26,7 +26,9 @@
 #include <graphene/db/index.hpp>
 #include <graphene/db/undo_database.hpp>
 
+#include <fc/container/flat.hpp>
 #include <fc/log/logger.hpp>
+#include <fc/thread/future.hpp>
 
 #include <map>
 
@@ -53,6 +55,23 @@ namespace graphene { namespace db {
          void wipe(const fc::path& data_dir); // remove from disk
          void close();
 
+         /**
+          * Enables incremental checkpoints: changed objects are tracked and save_checkpoint() appends them to
+          * per-index logs on top of the full dump written by flush(), which open() replays. Every
+          * @p compact_every checkpoints the logs are merged into the dump, 0 never compacts.
+          */
+         void enable_checkpoints( uint32_t compact_every );
+         bool checkpoints_enabled()const { return _undo_db.tracking_dirty_objects(); }
+
+         /**
+          * Writes every object changed since the previous checkpoint, as it was before the oldest undo state on
+          * the stack, so that the checkpoint never contains reversible changes. Objects are serialized on the
+          * calling thread, files are written in the background.
+          */
+         void save_checkpoint();
+         /// Blocks until the last checkpoint has reached the disk
+         void wait_for_checkpoint();
+
          template<typename T, typename F>
          const T& create( F&& constructor )
          {
@@ -75,8 +94,31 @@ namespace graphene { namespace db {
          const index&  get_index()const { return get_index(T::space_id,T::type_id); }
          const index&  get_index(uint8_t space_id, uint8_t type_id)const;
          const index&  get_index(object_id_type id)const { return get_index(id.space(),id.type()); }
+         /// The index of @p space_id and @p type_id, null if there is none
+         const index*  find_index(uint8_t space_id, uint8_t type_id)const;
          /// @}
 
+         /// An index serialized like the files of the object database: next id, object version, packed objects
+         struct index_dump
+         {
+            uint8_t      space_id = 0;
+            uint8_t      type_id = 0;
+            uint64_t     object_count = 0;
+            vector<char> data;
+         };
+
+         /**
+          * Serializes every index as it was before the oldest undo state, like save_checkpoint(), so that
+          * reversible changes are left out. Indexes are serialized in parallel on worker threads, the database
+          * must not change until this returns.
+          */
+         vector<index_dump> dump_indexes()const;
+         /**
+          * Loads the objects and the next id of an index from its dump, the index must be empty. Can be called
+          * for different indexes at once.
+          */
+         void load_index_dump( uint8_t space_id, uint8_t type_id, const char* data, size_t size );
+
          const object& get_object( object_id_type id )const;
          const object* find_object( object_id_type id )const;
 
@@ -174,8 +216,30 @@ namespace graphene { namespace db {
          void save_undo_add( const object& obj );
          void save_undo_remove( const object& obj );
 
+         struct checkpoint_frame
+         {
+            object_id_type         next_id;
+            vector<object_id_type> removed;
+            vector< vector<char> > objects;
+         };
+         typedef std::map< object_id_type, checkpoint_frame > checkpoint_frames;
+
+         void open_checkpoint_logs();
+         void write_checkpoint( const checkpoint_frames& frames );
+         void compact_checkpoint_logs();
+         void replace_with_tmp_dir();
+
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+
+         /// State of the checkpoint logs, owned by the background task while one is running
+         ///@{
+         fc::future<void>                                          _checkpoint_task;
+         std::unordered_set<object_id_type>                        _checkpoint_ids;
+         fc::flat_map<object_id_type, uint64_t>                    _log_sizes;
+         uint32_t                                                  _checkpoints_since_compaction = 0;
+         uint32_t                                                  _compact_every = 0;
+         ///@}
    };
 
 } } // graphene::db
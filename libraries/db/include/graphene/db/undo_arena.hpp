@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/db/object.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace graphene { namespace db {
+
+   /**
+    * Spare memory blocks shared by the undo states of one undo_database, so that sessions
+    * opened and closed for every transaction reuse the blocks of their predecessors.
+    */
+   class undo_block_pool
+   {
+      public:
+         static const size_t block_size = 64 * 1024;
+
+         explicit undo_block_pool( size_t max_spare_blocks = 64 ) : _max_spare( max_spare_blocks ) {}
+
+         std::unique_ptr<char[]> acquire();
+         void release( std::unique_ptr<char[]> block );
+
+      private:
+         const size_t                         _max_spare;
+         std::vector<std::unique_ptr<char[]>> _spare;
+   };
+
+   /**
+    * Bump allocator holding the saved object values of one undo state. Memory is only given
+    * back as a whole, by @ref reset; the objects themselves are destroyed by their owner.
+    */
+   class undo_arena
+   {
+      public:
+         explicit undo_arena( undo_block_pool* pool = nullptr ) : _pool( pool ) {}
+         undo_arena( undo_arena&& o );
+         undo_arena& operator=( undo_arena&& o );
+         ~undo_arena() { reset(); }
+
+         /// Returns a copy of @p obj living in the arena
+         object* copy( const object& obj )
+         {
+            return obj.clone_into( allocate( obj.object_size() ) );
+         }
+
+         /// Takes over the memory of @p other, which keeps no block
+         void adopt( undo_arena& other );
+         /// Hands every block back to the pool, the objects in them must have been destroyed
+         void reset();
+
+      private:
+         struct block
+         {
+            std::unique_ptr<char[]> data;
+            size_t                  size;
+         };
+
+         void* allocate( size_t size );
+
+         undo_block_pool*   _pool;
+         std::vector<block> _blocks;
+         char*              _next = nullptr;
+         char*              _end = nullptr;
+   };
+
+} } // graphene::db
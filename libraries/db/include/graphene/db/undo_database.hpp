@@ -23,6 +23,8 @@
  */
 #pragma once
 #include <graphene/db/object.hpp>
+#include <graphene/db/flat_id_map.hpp>
+#include <graphene/db/undo_arena.hpp>
 #include <deque>
 #include <fc/exception/exception.hpp>
 
@@ -32,12 +34,40 @@ namespace graphene { namespace db {
    using fc::flat_set;
    class object_database;
 
+   /**
+    * The changes made during one undo session. The saved values in old_values and removed are
+    * owned by the state and live in its arena.
+    */
    struct undo_state
    {
-      unordered_map<object_id_type, unique_ptr<object> > old_values;
-      unordered_map<object_id_type, object_id_type>      old_index_next_ids;
-      std::unordered_set<object_id_type>                 new_ids;
-      unordered_map<object_id_type, unique_ptr<object> > removed;
+      explicit undo_state( undo_block_pool* pool = nullptr ) : arena( pool ) {}
+      undo_state( undo_state&& o ) = default;
+      undo_state& operator=( undo_state&& o );
+      ~undo_state() { clear(); }
+
+      /// Saves a copy of @p obj in the arena
+      object* save( const object& obj ) { return arena.copy( obj ); }
+      /// Destroys a saved value which is no longer referenced
+      static void discard( object* obj ) { obj->~object(); }
+      /// Destroys the saved values and empties the state, keeping the storage of small states
+      void clear();
+
+      flat_id_map<object*>        old_values;
+      flat_id_map<object_id_type> old_index_next_ids;
+      flat_id_set                 new_ids;
+      flat_id_map<object*>        removed;
+      undo_arena                  arena;
+   };
+
+   /**
+    * The state preceding every undo state on the stack, expressed as its differences to the current state.
+    * Object pointers refer to values held by the stack and are invalidated by the next change to it.
+    */
+   struct reverted_state
+   {
+      /// Objects touched by the stack, nullptr if the object did not exist yet
+      unordered_map<object_id_type, const object*>  objects;
+      unordered_map<object_id_type, object_id_type> index_next_ids;
    };
 
 
@@ -123,14 +153,42 @@ namespace graphene { namespace db {
 
          const undo_state& head()const;
 
+         /**
+          * Records the ids of all objects created, modified or removed from now on, whether undo is enabled or
+          * not, so that incremental checkpoints only need to write what changed.
+          */
+         void track_dirty_objects( bool enable ) { _track_dirty = enable; if( !enable ) _dirty.clear(); }
+         bool tracking_dirty_objects()const { return _track_dirty; }
+
+         /**
+          * Returns the objects changed since the previous call. Objects still referenced by the stack stay
+          * dirty, as their change may be undone or written with another value next time.
+          */
+         std::unordered_set<object_id_type> take_dirty_objects();
+         /// Marks objects dirty again, after a checkpoint failed to write them
+         void restore_dirty_objects( const std::unordered_set<object_id_type>& ids );
+
+         reverted_state get_reverted_state()const;
+
       private:
          void undo();
          void merge();
          void commit();
 
+         /// Pushes an empty state on the stack, recycling a spare one if there is any
+         void push_state();
+         void pop_state_back();
+         void pop_state_front();
+         void recycle( undo_state&& state );
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
+         bool                    _track_dirty = false;
+         std::unordered_set<object_id_type> _dirty;
+         undo_block_pool         _block_pool;
          std::deque<undo_state>  _stack;
+         /// Emptied states kept for the next sessions, along with the capacity of their tables
+         std::vector<undo_state> _spare_states;
          object_database&        _db;
          size_t                  _max_size = 256;
    };
@@ -23,12 +23,94 @@
  */
 #include <graphene/db/object_database.hpp>
 
+#include <fc/io/fstream.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/container/flat.hpp>
 #include <fc/thread/parallel.hpp>
 
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace graphene { namespace db {
 
+namespace {
+
+fc::path checkpoint_manifest_path( const fc::path& data_dir )
+{
+   return data_dir / "object_database" / "checkpoint";
+}
+
+fc::path checkpoint_log_path( const fc::path& data_dir, object_id_type index_id )
+{
+   return data_dir / "object_database" / fc::to_string( index_id.space() )
+                   / ( fc::to_string( index_id.type() ) + ".log" );
+}
+
+/// Makes sure a file is on disk before anything refers to it
+void sync_file( const fc::path& file )
+{
+#ifndef _WIN32
+   int fd = ::open( file.generic_string().c_str(), O_RDONLY );
+   FC_ASSERT( fd >= 0, "Unable to open ${f}", ("f", file) );
+   int result = ::fsync( fd );
+   ::close( fd );
+   FC_ASSERT( result == 0, "Unable to sync ${f}", ("f", file) );
+#endif
+}
+
+void write_checkpoint_manifest( const fc::path& data_dir, uint32_t checkpoints,
+                                const fc::flat_map<object_id_type, uint64_t>& log_sizes )
+{
+   const fc::path manifest = checkpoint_manifest_path( data_dir );
+   const fc::path tmp = manifest.generic_string() + ".tmp";
+   {
+      std::ofstream out( tmp.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+      fc::raw::pack( out, checkpoints );
+      fc::raw::pack( out, log_sizes );
+      out.close();
+      FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+   }
+   sync_file( tmp );
+   fc::rename( tmp, manifest );
+}
+
+/// Every object serializes its id first, so the id can be read without knowing the object type
+object_id_type packed_object_id( const vector<char>& data )
+{
+   fc::datastream<const char*> ds( data.data(), data.size() );
+   object_id_type id;
+   fc::raw::unpack( ds, id );
+   return id;
+}
+
+/// Calls @p visit with the next id, removed ids and packed objects of every frame in the first @p size bytes of a log
+template<typename Visitor>
+void read_checkpoint_log( const fc::path& log, uint64_t size, Visitor&& visit )
+{
+   FC_ASSERT( fc::exists( log ) && fc::file_size( log ) >= size,
+              "Checkpoint log ${l} is shorter than recorded", ("l", log)("size", size) );
+   fc::file_mapping fm( log.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, size );
+   fc::datastream<const char*> ds( (const char*)mr.get_address(), size );
+   while( ds.remaining() > 0 )
+   {
+      object_id_type next_id;
+      vector<object_id_type> removed;
+      vector< vector<char> > objects;
+      fc::raw::unpack( ds, next_id );
+      fc::raw::unpack( ds, removed );
+      fc::raw::unpack( ds, objects );
+      visit( next_id, removed, objects );
+   }
+}
+
+} // anonymous namespace
+
 object_database::object_database()
 :_undo_db(*this)
 {
@@ -36,10 +118,14 @@ object_database::object_database()
    _undo_db.enable();
 }
 
-object_database::~object_database(){}
+object_database::~object_database()
+{
+   wait_for_checkpoint();
+}
 
 void object_database::close()
 {
+   wait_for_checkpoint();
 }
 
 const object* object_database::find_object( object_id_type id )const
@@ -59,6 +145,13 @@ const index& object_database::get_index(uint8_t space_id, uint8_t type_id)const
    FC_ASSERT( tmp );
    return *tmp;
 }
+const index* object_database::find_index(uint8_t space_id, uint8_t type_id)const
+{
+   if( _index.size() <= space_id || _index[space_id].size() <= type_id )
+      return nullptr;
+   return _index[space_id][type_id].get();
+}
+
 index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
 {
    FC_ASSERT( _index.size() > space_id, "", ("space_id",space_id)("type_id",type_id)("index.size",_index.size()) );
@@ -71,6 +164,9 @@ index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
 void object_database::flush()
 {
 //   ilog("Save object_database in ${d}", ("d", _data_dir));
+   wait_for_checkpoint();
+   // the full dump covers every change so far, only those still on the undo stack stay dirty
+   _undo_db.take_dirty_objects();
    fc::create_directories( _data_dir / "object_database.tmp" / "lock" );
    std::vector<fc::future<void>> tasks;
    tasks.reserve(200);
@@ -87,23 +183,299 @@ void object_database::flush()
    for( auto& task : tasks )
       task.wait();
    fc::remove_all( _data_dir / "object_database.tmp" / "lock" );
+   replace_with_tmp_dir();
+   _log_sizes.clear();
+   _checkpoints_since_compaction = 0;
+}
+
+void object_database::replace_with_tmp_dir()
+{
    if( fc::exists( _data_dir / "object_database" ) )
       fc::rename( _data_dir / "object_database", _data_dir / "object_database.old" );
    fc::rename( _data_dir / "object_database.tmp", _data_dir / "object_database" );
    fc::remove_all( _data_dir / "object_database.old" );
 }
 
+void object_database::enable_checkpoints( uint32_t compact_every )
+{
+   _compact_every = compact_every;
+   _undo_db.track_dirty_objects( true );
+}
+
+void object_database::save_checkpoint()
+{ try {
+   wait_for_checkpoint();
+
+   const auto reverted = _undo_db.get_reverted_state();
+   _checkpoint_ids = _undo_db.take_dirty_objects();
+   if( _checkpoint_ids.empty() )
+      return;
+
+   auto frames = std::make_shared<checkpoint_frames>();
+   for( const auto& id : _checkpoint_ids )
+   {
+      const object_id_type index_id( id.space(), id.type(), 0 );
+      auto frame_itr = frames->find( index_id );
+      if( frame_itr == frames->end() )
+      {
+         frame_itr = frames->emplace( index_id, checkpoint_frame() ).first;
+         auto next_itr = reverted.index_next_ids.find( index_id );
+         frame_itr->second.next_id = next_itr != reverted.index_next_ids.end() ?
+                                     next_itr->second : get_index( id.space(), id.type() ).get_next_id();
+      }
+      auto value_itr = reverted.objects.find( id );
+      const object* value = value_itr != reverted.objects.end() ? value_itr->second : find_object( id );
+      if( value != nullptr )
+         frame_itr->second.objects.push_back( value->pack() );
+      else
+         frame_itr->second.removed.push_back( id );
+   }
+
+   const bool compact = _compact_every > 0 && _checkpoints_since_compaction + 1 >= _compact_every;
+   _checkpoint_task = fc::do_parallel( [this,frames,compact] () {
+      write_checkpoint( *frames );
+      if( compact )
+         compact_checkpoint_logs();
+   } );
+} FC_CAPTURE_AND_RETHROW() }
+
+vector<object_database::index_dump> object_database::dump_indexes()const
+{ try {
+   const auto reverted = _undo_db.get_reverted_state();
+   // objects the undo stack would bring back, by index
+   std::map< object_id_type, vector<const object*> > removed;
+   for( const auto& item : reverted.objects )
+      if( item.second != nullptr && find_object( item.first ) == nullptr )
+         removed[ object_id_type( item.first.space(), item.first.type(), 0 ) ].push_back( item.second );
+
+   vector<index_dump> dumps;
+   for( uint32_t space = 0; space < _index.size(); ++space )
+      for( uint32_t type = 0; type < _index[space].size(); ++type )
+         if( _index[space][type] )
+         {
+            dumps.emplace_back();
+            dumps.back().space_id = space;
+            dumps.back().type_id = type;
+         }
+
+   std::vector<fc::future<void>> tasks;
+   tasks.reserve( dumps.size() );
+   for( auto& dump : dumps )
+      tasks.push_back( fc::do_parallel( [this,&dump,&reverted,&removed] () {
+         const index& idx = *_index[dump.space_id][dump.type_id];
+         const object_id_type index_id( dump.space_id, dump.type_id, 0 );
+         auto next_itr = reverted.index_next_ids.find( index_id );
+         const object_id_type next_id = next_itr != reverted.index_next_ids.end() ? next_itr->second
+                                                                                  : idx.get_next_id();
+         auto append = [&dump]( const vector<char>& bytes ) {
+            dump.data.insert( dump.data.end(), bytes.begin(), bytes.end() );
+         };
+         append( fc::raw::pack( next_id ) );
+         append( fc::raw::pack( idx.get_object_version() ) );
+         auto append_object = [&dump,&append]( const object& o ) {
+            const auto packed = o.pack();
+            append( fc::raw::pack( fc::unsigned_int( packed.size() ) ) );
+            append( packed );
+            ++dump.object_count;
+         };
+         idx.inspect_all_objects( [&reverted,&append_object]( const object& o ) {
+            auto itr = reverted.objects.find( o.id );
+            if( itr == reverted.objects.end() )
+               append_object( o );
+            else if( itr->second != nullptr )
+               append_object( *itr->second );
+         } );
+         auto removed_itr = removed.find( index_id );
+         if( removed_itr != removed.end() )
+            for( const object* o : removed_itr->second )
+               append_object( *o );
+      } ) );
+   for( auto& task : tasks )
+      task.wait();
+   return dumps;
+} FC_CAPTURE_AND_RETHROW() }
+
+void object_database::load_index_dump( uint8_t space_id, uint8_t type_id, const char* data, size_t size )
+{ try {
+   index& idx = get_mutable_index( space_id, type_id );
+   fc::datastream<const char*> ds( data, size );
+   object_id_type next_id;
+   fc::sha256 version;
+   fc::raw::unpack( ds, next_id );
+   fc::raw::unpack( ds, version );
+   FC_ASSERT( version == idx.get_object_version(), "Incompatible object version" );
+   vector<char> packed;
+   while( ds.remaining() > 0 )
+   {
+      fc::raw::unpack( ds, packed );
+      idx.load( packed );
+   }
+   idx.set_next_id( next_id );
+} FC_CAPTURE_AND_RETHROW( (space_id)(type_id) ) }
+
+void object_database::wait_for_checkpoint()
+{
+   if( !_checkpoint_task.valid() )
+      return;
+   try {
+      _checkpoint_task.wait();
+   } catch( const fc::exception& e ) {
+      elog( "Failed to write object database checkpoint: ${e}", ("e", e.to_detail_string()) );
+      _undo_db.restore_dirty_objects( _checkpoint_ids );
+   }
+   _checkpoint_task = fc::future<void>();
+   _checkpoint_ids.clear();
+}
+
+void object_database::write_checkpoint( const checkpoint_frames& frames )
+{
+   auto log_sizes = _log_sizes;
+   for( const auto& item : frames )
+   {
+      const fc::path log = checkpoint_log_path( _data_dir, item.first );
+      fc::create_directories( log.parent_path() );
+      uint64_t& size = log_sizes[item.first];
+      // drop whatever a failed attempt left behind the committed end
+      if( fc::exists( log ) && fc::file_size( log ) != size )
+         fc::resize_file( log, size );
+      {
+         std::ofstream out( log.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::app );
+         FC_ASSERT( out, "Unable to write ${f}", ("f", log) );
+         fc::raw::pack( out, item.second.next_id );
+         fc::raw::pack( out, item.second.removed );
+         fc::raw::pack( out, item.second.objects );
+         out.close();
+         FC_ASSERT( out, "Unable to write ${f}", ("f", log) );
+      }
+      sync_file( log );
+      size = fc::file_size( log );
+   }
+   // the appended frames only become part of the database once the manifest refers to them
+   write_checkpoint_manifest( _data_dir, _checkpoints_since_compaction + 1, log_sizes );
+   _log_sizes = std::move( log_sizes );
+   ++_checkpoints_since_compaction;
+}
+
+void object_database::compact_checkpoint_logs()
+{
+   // Each index file is replaced on its own. Replaying a log onto a file that already contains it gives the
+   // same state, so a crash in between leaves a consistent database as long as the manifest is kept.
+   for( const auto& item : _log_sizes )
+   {
+      if( item.second == 0 )
+         continue;
+      const auto& idx = get_index( item.first.space(), item.first.type() );
+      const fc::path file = _data_dir / "object_database" / fc::to_string( item.first.space() )
+                                      / fc::to_string( item.first.type() );
+      object_id_type next_id( item.first.space(), item.first.type(), 0 );
+      std::map< object_id_type, vector<char> > objects;
+      if( fc::exists( file ) && fc::file_size( file ) > 0 )
+      {
+         fc::file_mapping fm( file.generic_string().c_str(), fc::read_only );
+         fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( file ) );
+         fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+         fc::sha256 version;
+         fc::raw::unpack( ds, next_id );
+         fc::raw::unpack( ds, version );
+         FC_ASSERT( version == idx.get_object_version(), "Incompatible object version in ${f}", ("f", file) );
+         while( ds.remaining() > 0 )
+         {
+            vector<char> data;
+            fc::raw::unpack( ds, data );
+            const auto id = packed_object_id( data );
+            objects[id] = std::move( data );
+         }
+      }
+      read_checkpoint_log( checkpoint_log_path( _data_dir, item.first ), item.second,
+         [&next_id,&objects]( object_id_type frame_next_id, vector<object_id_type>& removed,
+                              vector< vector<char> >& packed ) {
+            for( const auto& id : removed )
+               objects.erase( id );
+            for( auto& data : packed )
+            {
+               const auto id = packed_object_id( data );
+               objects[id] = std::move( data );
+            }
+            next_id = frame_next_id;
+         } );
+
+      const fc::path tmp = file.generic_string() + ".tmp";
+      {
+         std::ofstream out( tmp.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+         FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+         fc::raw::pack( out, next_id );
+         fc::raw::pack( out, idx.get_object_version() );
+         for( const auto& entry : objects )
+            fc::raw::pack( out, entry.second );
+         out.close();
+         FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+      }
+      sync_file( tmp );
+      fc::rename( tmp, file );
+   }
+
+   write_checkpoint_manifest( _data_dir, 0, fc::flat_map<object_id_type, uint64_t>() );
+   for( const auto& item : _log_sizes )
+      fc::remove_all( checkpoint_log_path( _data_dir, item.first ) );
+   _log_sizes.clear();
+   _checkpoints_since_compaction = 0;
+}
+
+void object_database::open_checkpoint_logs()
+{
+   const fc::path manifest = checkpoint_manifest_path( _data_dir );
+   if( !fc::exists( manifest ) )
+      return;
+   {
+      std::string data;
+      fc::read_file_contents( manifest, data );
+      fc::datastream<const char*> ds( data.data(), data.size() );
+      fc::raw::unpack( ds, _checkpoints_since_compaction );
+      fc::raw::unpack( ds, _log_sizes );
+   }
+
+   std::vector<fc::future<void>> tasks;
+   tasks.reserve( _log_sizes.size() );
+   for( const auto& item : _log_sizes )
+   {
+      if( item.second == 0 )
+         continue;
+      index& idx = get_mutable_index( item.first.space(), item.first.type() );
+      const fc::path log = checkpoint_log_path( _data_dir, item.first );
+      const uint64_t size = item.second;
+      tasks.push_back( fc::do_parallel( [&idx,log,size] () {
+         read_checkpoint_log( log, size,
+            [&idx]( object_id_type next_id, vector<object_id_type>& removed, vector< vector<char> >& objects ) {
+               for( const auto& id : removed )
+                  idx.unload( id );
+               for( const auto& data : objects )
+                  idx.reload( data );
+               idx.set_next_id( next_id );
+            } );
+      } ) );
+   }
+   for( auto& task : tasks )
+      task.wait();
+   ilog( "Replayed ${n} object database checkpoints", ("n", _checkpoints_since_compaction) );
+}
+
 void object_database::wipe(const fc::path& data_dir)
 {
    close();
    ilog("Wiping object database...");
    fc::remove_all(data_dir / "object_database");
+   _log_sizes.clear();
+   _checkpoints_since_compaction = 0;
+   _undo_db.take_dirty_objects();
    ilog("Done wiping object database.");
 }
 
 void object_database::open(const fc::path& data_dir)
 { try {
    _data_dir = data_dir;
+   // a crash while replacing the directory leaves only the previous one
+   if( !fc::exists( _data_dir / "object_database" ) && fc::exists( _data_dir / "object_database.old" ) )
+      fc::rename( _data_dir / "object_database.old", _data_dir / "object_database" );
    if( fc::exists( _data_dir / "object_database" / "lock" ) )
    {
        wlog("Ignoring locked object_database");
@@ -120,6 +492,7 @@ void object_database::open(const fc::path& data_dir)
             } ) );
    for( auto& task : tasks )
       task.wait();
+   open_checkpoint_logs();
    ilog( "Done opening object database." );
 
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
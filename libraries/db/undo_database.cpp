@@ -26,8 +26,115 @@
 #include <graphene/db/undo_database.hpp>
 #include <fc/reflect/variant.hpp>
 
+#include <iterator>
+
 namespace graphene { namespace db {
 
+std::unique_ptr<char[]> undo_block_pool::acquire()
+{
+   if( _spare.empty() )
+      return std::unique_ptr<char[]>( new char[block_size] );
+   auto block = std::move( _spare.back() );
+   _spare.pop_back();
+   return block;
+}
+
+void undo_block_pool::release( std::unique_ptr<char[]> block )
+{
+   if( _spare.size() < _max_spare )
+      _spare.push_back( std::move( block ) );
+}
+
+undo_arena::undo_arena( undo_arena&& o )
+   : _pool( o._pool ), _blocks( std::move( o._blocks ) ), _next( o._next ), _end( o._end )
+{
+   o._blocks.clear();
+   o._next = o._end = nullptr;
+}
+
+undo_arena& undo_arena::operator=( undo_arena&& o )
+{
+   if( this != &o )
+   {
+      reset();
+      _pool = o._pool;
+      _blocks = std::move( o._blocks );
+      _next = o._next;
+      _end = o._end;
+      o._blocks.clear();
+      o._next = o._end = nullptr;
+   }
+   return *this;
+}
+
+void* undo_arena::allocate( size_t size )
+{
+   const size_t align = alignof(std::max_align_t);
+   size = ( size + align - 1 ) & ~( align - 1 );
+   if( size > size_t( _end - _next ) )
+   {
+      if( size > undo_block_pool::block_size )
+      {
+         // oversized values get a block of their own, the current one stays in use
+         _blocks.insert( _blocks.begin(), block{ std::unique_ptr<char[]>( new char[size] ), size } );
+         return _blocks.front().data.get();
+      }
+      block b{ _pool ? _pool->acquire() : std::unique_ptr<char[]>( new char[undo_block_pool::block_size] ),
+               undo_block_pool::block_size };
+      _next = b.data.get();
+      _end = _next + b.size;
+      _blocks.push_back( std::move( b ) );
+   }
+   void* result = _next;
+   _next += size;
+   return result;
+}
+
+void undo_arena::adopt( undo_arena& other )
+{
+   // the adopted blocks go in front, so that allocation goes on in the current block
+   _blocks.insert( _blocks.begin(), std::make_move_iterator( other._blocks.begin() ),
+                   std::make_move_iterator( other._blocks.end() ) );
+   other._blocks.clear();
+   other._next = other._end = nullptr;
+}
+
+void undo_arena::reset()
+{
+   for( auto& b : _blocks )
+      if( _pool && b.size == undo_block_pool::block_size )
+         _pool->release( std::move( b.data ) );
+   _blocks.clear();
+   _next = _end = nullptr;
+}
+
+undo_state& undo_state::operator=( undo_state&& o )
+{
+   if( this != &o )
+   {
+      clear();
+      old_values = std::move( o.old_values );
+      old_index_next_ids = std::move( o.old_index_next_ids );
+      new_ids = std::move( o.new_ids );
+      removed = std::move( o.removed );
+      arena = std::move( o.arena );
+   }
+   return *this;
+}
+
+void undo_state::clear()
+{
+   for( const auto& item : old_values )
+      discard( item.second );
+   for( const auto& item : removed )
+      discard( item.second );
+   old_values.clear();
+   old_index_next_ids.clear();
+   new_ids.clear();
+   removed.clear();
+   arena.reset();
+}
+
 void undo_database::enable()  { _disabled = false; }
 void undo_database::disable() { _disabled = true; }
 
@@ -52,18 +159,19 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
       _disabled = false;
 
    while( size() > max_size() )
-      _stack.pop_front();
+      pop_state_front();
 
-   _stack.emplace_back();
+   push_state();
    ++_active_sessions;
    return session(*this, disable_on_exit );
 }
 void undo_database::on_create( const object& obj )
 {
+   if( _track_dirty ) _dirty.insert( obj.id );
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      push_state();
    auto& state = _stack.back();
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
@@ -73,37 +181,40 @@ void undo_database::on_create( const object& obj )
 }
 void undo_database::on_modify( const object& obj )
 {
+   if( _track_dirty ) _dirty.insert( obj.id );
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      push_state();
    auto& state = _stack.back();
    if( state.new_ids.find(obj.id) != state.new_ids.end() )
       return;
    auto itr =  state.old_values.find(obj.id);
    if( itr != state.old_values.end() ) return;
-   state.old_values[obj.id] = obj.clone();
+   state.old_values[obj.id] = state.save( obj );
 }
 void undo_database::on_remove( const object& obj )
 {
+   if( _track_dirty ) _dirty.insert( obj.id );
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      push_state();
    undo_state& state = _stack.back();
    if( state.new_ids.count(obj.id) > 0 )
    {
       state.new_ids.erase(obj.id);
       return;
    }
-   if( state.old_values.count(obj.id) > 0 )
+   auto itr = state.old_values.find(obj.id);
+   if( itr != state.old_values.end() )
    {
-      state.removed[obj.id] = std::move(state.old_values[obj.id]);
+      state.removed[obj.id] = itr->second;
       state.old_values.erase(obj.id);
       return;
    }
    if( state.removed.count(obj.id) > 0 ) return;
-   state.removed[obj.id] = obj.clone();
+   state.removed[obj.id] = state.save( obj );
 }
 
 void undo_database::undo()
@@ -131,7 +242,7 @@ void undo_database::undo()
    for( auto& item : state.removed )
       _db.insert( std::move(*item.second) );
 
-   _stack.pop_back();
+   pop_state_back();
    enable();
    --_active_sessions;
 } FC_CAPTURE_AND_RETHROW() }
@@ -141,7 +252,7 @@ void undo_database::merge()
    FC_ASSERT( _active_sessions > 0 );
    if( _active_sessions == 1 && _stack.size() == 1 )
    {
-      _stack.pop_back();
+      pop_state_back();
       --_active_sessions;
       return;
    }
@@ -190,24 +301,30 @@ void undo_database::merge()
    //
 
    // We can only be outside type A/AB (the nop path) if B is not nop, so it suffices to iterate through B's three containers.
+   //
+   // The saved values of B live in its arena, which prev_state takes over. Values prev_state does not keep are
+   // destroyed right away, the others change hands.
+   prev_state.arena.adopt( state.arena );
 
    // *+upd
-   for( auto& obj : state.old_values )
+   for( const auto& obj : state.old_values )
    {
-      if( prev_state.new_ids.find(obj.second->id) != prev_state.new_ids.end() )
+      if( prev_state.new_ids.find(obj.first) != prev_state.new_ids.end() )
       {
          // new+upd -> new, type A
+         undo_state::discard( obj.second );
          continue;
       }
-      if( prev_state.old_values.find(obj.second->id) != prev_state.old_values.end() )
+      if( prev_state.old_values.find(obj.first) != prev_state.old_values.end() )
       {
          // upd(was=X) + upd(was=Y) -> upd(was=X), type A
+         undo_state::discard( obj.second );
          continue;
       }
       // del+upd -> N/A
-      assert( prev_state.removed.find(obj.second->id) == prev_state.removed.end() );
+      assert( prev_state.removed.find(obj.first) == prev_state.removed.end() );
       // nop+upd(was=Y) -> upd(was=Y), type B
-      prev_state.old_values[obj.second->id] = std::move(obj.second);
+      prev_state.old_values[obj.first] = obj.second;
    }
 
    // *+new, but we assume the N/A cases don't happen, leaving type B nop+new -> new
@@ -215,45 +332,42 @@ void undo_database::merge()
       prev_state.new_ids.insert(id);
 
    // old_index_next_ids can only be updated, iterate over *+upd cases
-   for( auto& item : state.old_index_next_ids )
+   for( const auto& item : state.old_index_next_ids )
    {
-      if( prev_state.old_index_next_ids.find( item.first ) == prev_state.old_index_next_ids.end() )
-      {
-         // nop+upd(was=Y) -> upd(was=Y), type B
-         prev_state.old_index_next_ids[item.first] = item.second;
-         continue;
-      }
-      else
-      {
-         // upd(was=X)+upd(was=Y) -> upd(was=X), type A
-         // type A implementation is a no-op, as discussed above, so there is no code here
-         continue;
-      }
+      // nop+upd(was=Y) -> upd(was=Y), type B
+      // upd(was=X)+upd(was=Y) -> upd(was=X), type A, which emplace leaves alone
+      prev_state.old_index_next_ids.emplace( item.first, item.second );
    }
 
    // *+del
-   for( auto& obj : state.removed )
+   for( const auto& obj : state.removed )
    {
-      if( prev_state.new_ids.find(obj.second->id) != prev_state.new_ids.end() )
+      if( prev_state.new_ids.find(obj.first) != prev_state.new_ids.end() )
       {
          // new + del -> nop (type C)
-         prev_state.new_ids.erase(obj.second->id);
+         prev_state.new_ids.erase(obj.first);
+         undo_state::discard( obj.second );
          continue;
       }
-      auto it = prev_state.old_values.find(obj.second->id);
+      auto it = prev_state.old_values.find(obj.first);
       if( it != prev_state.old_values.end() )
       {
          // upd(was=X) + del(was=Y) -> del(was=X)
-         prev_state.removed[obj.second->id] = std::move(it->second);
-         prev_state.old_values.erase(obj.second->id);
+         prev_state.removed[obj.first] = it->second;
+         prev_state.old_values.erase(obj.first);
+         undo_state::discard( obj.second );
          continue;
       }
       // del + del -> N/A
-      assert( prev_state.removed.find( obj.second->id ) == prev_state.removed.end() );
+      assert( prev_state.removed.find( obj.first ) == prev_state.removed.end() );
       // nop + del(was=Y) -> del(was=Y)
-      prev_state.removed[obj.second->id] = std::move(obj.second);
+      prev_state.removed[obj.first] = obj.second;
    }
-   _stack.pop_back();
+
+   // every saved value of B is now destroyed or owned by prev_state
+   state.old_values.clear();
+   state.removed.clear();
+   pop_state_back();
    --_active_sessions;
 }
 void undo_database::commit()
@@ -289,7 +403,7 @@ void undo_database::pop_commit()
       for( auto& item : state.removed )
          _db.insert( std::move(*item.second) );
 
-      _stack.pop_back();
+      pop_state_back();
    }
    catch ( const fc::exception& e )
    {
@@ -299,10 +413,82 @@ void undo_database::pop_commit()
    }
    enable();
 }
+void undo_database::push_state()
+{
+   if( _spare_states.empty() )
+   {
+      _stack.emplace_back( &_block_pool );
+      return;
+   }
+   _stack.emplace_back( std::move( _spare_states.back() ) );
+   _spare_states.pop_back();
+}
+
+void undo_database::pop_state_back()
+{
+   recycle( std::move( _stack.back() ) );
+   _stack.pop_back();
+}
+
+void undo_database::pop_state_front()
+{
+   recycle( std::move( _stack.front() ) );
+   _stack.pop_front();
+}
+
+void undo_database::recycle( undo_state&& state )
+{
+   state.clear();
+   if( _spare_states.size() < 8 )
+      _spare_states.push_back( std::move( state ) );
+}
+
 const undo_state& undo_database::head()const
 {
    FC_ASSERT( !_stack.empty() );
    return _stack.back();
 }
 
+std::unordered_set<object_id_type> undo_database::take_dirty_objects()
+{
+   std::unordered_set<object_id_type> result;
+   result.swap( _dirty );
+   if( !_track_dirty )
+      return result;
+   for( const auto& state : _stack )
+   {
+      for( const auto& item : state.old_values )
+         _dirty.insert( item.first );
+      for( const auto& id : state.new_ids )
+         _dirty.insert( id );
+      for( const auto& item : state.removed )
+         _dirty.insert( item.first );
+   }
+   return result;
+}
+
+void undo_database::restore_dirty_objects( const std::unordered_set<object_id_type>& ids )
+{
+   if( _track_dirty )
+      _dirty.insert( ids.begin(), ids.end() );
+}
+
+reverted_state undo_database::get_reverted_state()const
+{
+   // Walking from the oldest state, the first entry found for an object tells its value before the stack
+   reverted_state result;
+   for( const auto& state : _stack )
+   {
+      for( const auto& item : state.old_values )
+         result.objects.emplace( item.first, item.second );
+      for( const auto& item : state.removed )
+         result.objects.emplace( item.first, item.second );
+      for( const auto& id : state.new_ids )
+         result.objects.emplace( id, nullptr );
+      for( const auto& item : state.old_index_next_ids )
+         result.index_next_ids.emplace( item.first, item.second );
+   }
+   return result;
+}
+
 } } // graphene::db
@@ -46,6 +46,46 @@ namespace graphene { namespace net {
   const core_message_type_enum check_firewall_reply_message::type            = core_message_type_enum::check_firewall_reply_message_type;
   const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
   const core_message_type_enum get_current_connections_reply_message::type   = core_message_type_enum::get_current_connections_reply_message_type;
+  const core_message_type_enum compact_block_message::type                   = core_message_type_enum::compact_block_message_type;
+  const core_message_type_enum fetch_block_transactions_message::type        = core_message_type_enum::fetch_block_transactions_message_type;
+  const core_message_type_enum block_transactions_message::type              = core_message_type_enum::block_transactions_message_type;
+
+  compact_block_message::compact_block_message(const signed_block& block, const block_id_type& block_id,
+                                               const item_hash_t& item_hash) :
+    item_hash(item_hash),
+    block_id(block_id),
+    header(block)
+  {
+    short_ids.reserve(block.transactions.size());
+    operation_results.reserve(block.transactions.size());
+    for (const auto& trx : block.transactions)
+    {
+      short_ids.push_back(short_transaction_id(block_id, trx.id()));
+      operation_results.push_back(trx.operation_results);
+    }
+  }
+
+  uint64_t compact_block_message::short_transaction_id(const block_id_type& block_id, const transaction_id_type& trx_id)
+  {
+    fc::sha256::encoder enc;
+    enc.write(block_id.data(), block_id.data_size());
+    enc.write(trx_id.data(), trx_id.data_size());
+    return enc.result()._hash[0];
+  }
+
+  signed_block compact_block_message::rebuild_block(std::vector<signed_transaction>&& transactions) const
+  {
+    signed_block block;
+    static_cast<graphene::protocol::signed_block_header&>(block) = header;
+    block.transactions.reserve(transactions.size());
+    for (size_t i = 0; i < transactions.size(); ++i)
+    {
+      block.transactions.emplace_back(std::move(transactions[i]));
+      if (i < operation_results.size())
+        block.transactions.back().operation_results = operation_results[i];
+    }
+    return block;
+  }
 
 } } // graphene::net
 
@@ -128,6 +168,10 @@ FC_REFLECT_DERIVED_NO_TYPENAME(graphene::net::get_current_connections_reply_mess
                                                             (upload_rate_one_hour)
                                                             (download_rate_one_hour)
                                                             (current_connections))
+FC_REFLECT_DERIVED_NO_TYPENAME(graphene::net::compact_block_message, BOOST_PP_SEQ_NIL,
+                               (item_hash)(block_id)(header)(short_ids)(operation_results))
+FC_REFLECT_DERIVED_NO_TYPENAME(graphene::net::fetch_block_transactions_message, BOOST_PP_SEQ_NIL, (block_id)(indexes))
+FC_REFLECT_DERIVED_NO_TYPENAME(graphene::net::block_transactions_message, BOOST_PP_SEQ_NIL, (block_id)(transactions))
 
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::trx_message )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::block_message )
@@ -151,3 +195,6 @@ GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::check_firewall_reply_m
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::get_current_connections_request_message )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::current_connection_data )
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::get_current_connections_reply_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::compact_block_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::fetch_block_transactions_message )
+GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::block_transactions_message )
@@ -25,7 +25,13 @@
 
 #include <stddef.h>
 
-#define GRAPHENE_NET_PROTOCOL_VERSION                        106
+#define GRAPHENE_NET_PROTOCOL_VERSION                        107
+
+/**
+ * Peers speaking this protocol version or newer can relay blocks as compact blocks,
+ * if they also announce it in their hello message
+ */
+#define GRAPHENE_NET_COMPACT_BLOCKS_PROTOCOL_VERSION         107
 
 /**
  * Define this to enable debugging code in the p2p network interface.
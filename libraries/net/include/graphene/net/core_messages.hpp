@@ -85,6 +85,9 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
+    fetch_block_transactions_message_type        = 5019,
+    block_transactions_message_type              = 5020,
     core_message_type_last                       = 5099
   };
 
@@ -399,6 +402,62 @@ namespace graphene { namespace net {
     std::vector<current_connection_data> current_connections;
   };
 
+  /**
+   * A block sent in place of a requested block_message to a peer which most likely has its
+   * transactions already: the header, plus a short id and the operation results of every
+   * transaction. The receiver looks the transactions up among the ones it was relayed, and
+   * asks for the rest with a fetch_block_transactions_message.
+   */
+  struct compact_block_message
+  {
+    static const core_message_type_enum type;
+
+    compact_block_message() {}
+    compact_block_message(const signed_block& block, const block_id_type& block_id, const item_hash_t& item_hash);
+
+    /**
+     * The short id of a transaction in the block @p block_id. Short ids are salted with the block
+     * id so that colliding transactions can not be prepared in advance; a block rebuilt from a
+     * colliding transaction fails the merkle root check and is fetched in full instead.
+     */
+    static uint64_t short_transaction_id(const block_id_type& block_id, const transaction_id_type& trx_id);
+
+    /// Puts the block back together from its transactions, given in block order
+    signed_block rebuild_block(std::vector<signed_transaction>&& transactions) const;
+
+    /// Hash of the block_message this compact block stands for, as it was requested
+    item_hash_t                   item_hash;
+    block_id_type                 block_id;
+    graphene::protocol::signed_block_header header;
+    std::vector<uint64_t>         short_ids;
+    /// The results are part of the transaction merkle root, so they travel with the block
+    std::vector<std::vector<graphene::protocol::operation_result>> operation_results;
+  };
+
+  struct fetch_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type         block_id;
+    /// Positions in the block of the transactions which are wanted
+    std::vector<uint32_t> indexes;
+
+    fetch_block_transactions_message() {}
+    fetch_block_transactions_message(const block_id_type& block_id, const std::vector<uint32_t>& indexes) :
+      block_id(block_id),
+      indexes(indexes)
+    {}
+  };
+
+  struct block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type                   block_id;
+    /// The transactions asked for, in the order of the request
+    std::vector<signed_transaction> transactions;
+  };
+
 } } // graphene::net
 
 FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
@@ -422,6 +481,9 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
+                 (fetch_block_transactions_message_type)
+                 (block_transactions_message_type)
                  (core_message_type_last) )
 FC_REFLECT_ENUM(graphene::net::rejection_reason_code, (unspecified)
                                                  (different_chain)
@@ -463,6 +525,9 @@ FC_REFLECT_TYPENAME( graphene::net::check_firewall_reply_message )
 FC_REFLECT_TYPENAME( graphene::net::get_current_connections_request_message )
 FC_REFLECT_TYPENAME( graphene::net::current_connection_data )
 FC_REFLECT_TYPENAME( graphene::net::get_current_connections_reply_message )
+FC_REFLECT_TYPENAME( graphene::net::compact_block_message )
+FC_REFLECT_TYPENAME( graphene::net::fetch_block_transactions_message )
+FC_REFLECT_TYPENAME( graphene::net::block_transactions_message )
 
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::trx_message )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::block_message )
@@ -486,6 +551,9 @@ GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::check_firewall_reply_mes
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::get_current_connections_request_message )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::current_connection_data )
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::get_current_connections_reply_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::compact_block_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::fetch_block_transactions_message )
+GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::net::block_transactions_message )
 
 #include <unordered_map>
 #include <fc/crypto/city.hpp>
@@ -136,6 +136,15 @@ namespace graphene { namespace net { namespace detail {
       FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
     }
 
+    fc::optional<message> blockchain_tied_message_cache::find_message_by_contents(
+             const message_hash_type& hash_of_msg_contents_to_lookup ) const
+    {
+      auto iter = _message_cache.get<message_contents_hash_index>().find( hash_of_msg_contents_to_lookup );
+      if( iter != _message_cache.get<message_contents_hash_index>().end() )
+        return iter->message_body;
+      return fc::optional<message>();
+    }
+
     void node_impl_deleter::operator()(node_impl* impl_to_delete)
     {
 #ifdef P2P_IN_DEDICATED_THREAD
@@ -591,7 +600,15 @@ namespace graphene { namespace net { namespace detail {
           // the fetch_items_message can only deal with one item type at a time.  
           std::map<uint32_t, std::vector<item_hash_t> > items_to_fetch_by_type;
           for (const item_id& item : peer_and_items.item_ids)
-            items_to_fetch_by_type[item.item_type].push_back(item.item_hash);
+          {
+            // blocks are asked for as compact blocks where the peer can send them, they are still
+            // recorded as requested blocks so a full block or a refusal settles them as usual
+            uint32_t type_to_request = item.item_type;
+            if (type_to_request == block_message_type && _compact_blocks_enabled &&
+                peer_and_items.peer->supports_compact_blocks)
+              type_to_request = compact_block_message_type;
+            items_to_fetch_by_type[type_to_request].push_back(item.item_hash);
+          }
           for (auto& items_by_type : items_to_fetch_by_type)
           {
             dlog("requesting ${count} items of type ${type} from peer ${endpoint}: ${hashes}",
@@ -1289,6 +1306,15 @@ namespace graphene { namespace net { namespace detail {
       case core_message_type_enum::item_not_available_message_type:
         on_item_not_available_message(originating_peer, received_message.as<item_not_available_message>());
         break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
+      case core_message_type_enum::fetch_block_transactions_message_type:
+        on_fetch_block_transactions_message(originating_peer, received_message.as<fetch_block_transactions_message>());
+        break;
+      case core_message_type_enum::block_transactions_message_type:
+        on_block_transactions_message(originating_peer, received_message.as<block_transactions_message>());
+        break;
       case core_message_type_enum::item_ids_inventory_message_type:
         on_item_ids_inventory_message(originating_peer, received_message.as<item_ids_inventory_message>());
         break;
@@ -1359,6 +1385,9 @@ namespace graphene { namespace net { namespace detail {
       if (!_hard_fork_block_numbers.empty())
         user_data["last_known_fork_block_number"] = _hard_fork_block_numbers.back();
 
+      if (_compact_blocks_enabled)
+        user_data["compact_blocks"] = true;
+
       return user_data;
     }
     void node_impl::parse_hello_user_data_for_peer(peer_connection* originating_peer, const fc::variant_object& user_data)
@@ -1383,6 +1412,9 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->node_id = user_data["node_id"].as<node_id_t>(1);
       if (user_data.contains("last_known_fork_block_number"))
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>(1);
+      if (user_data.contains("compact_blocks"))
+        originating_peer->supports_compact_blocks = user_data["compact_blocks"].as<bool>(1) &&
+              originating_peer->core_protocol_version >= GRAPHENE_NET_COMPACT_BLOCKS_PROTOCOL_VERSION;
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -2282,9 +2314,15 @@ namespace graphene { namespace net { namespace detail {
            ("type", fetch_items_message_received.item_type)
            ("endpoint", originating_peer->get_remote_endpoint()));
 
-      fc::optional<message> last_block_message_sent;
+      fc::optional<item_hash_t> last_block_sent;
 
-      std::list<message> reply_messages;
+      // a compact block is looked up as the block it stands for
+      const bool compact_blocks_requested = fetch_items_message_received.item_type == compact_block_message_type;
+      const uint32_t item_type = compact_blocks_requested ? uint32_t(block_message_type)
+                                                          : fetch_items_message_received.item_type;
+
+      // the requested hash is the block id, so served blocks never need to be unpacked here
+      std::list<std::pair<item_hash_t, message>> reply_messages;
       for (const item_hash_t& item_hash : fetch_items_message_received.items_to_fetch)
       {
         try
@@ -2293,9 +2331,9 @@ namespace graphene { namespace net { namespace detail {
           dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                ("endpoint", originating_peer->get_remote_endpoint())
                ("id", requested_message.id()));
-          reply_messages.push_back(requested_message);
-          if (fetch_items_message_received.item_type == block_message_type)
-            last_block_message_sent = requested_message;
+          reply_messages.emplace_back(item_hash, std::move(requested_message));
+          if (item_type == block_message_type)
+            last_block_sent = item_hash;
           continue;
         }
         catch (fc::key_not_found_exception&)
@@ -2303,7 +2341,7 @@ namespace graphene { namespace net { namespace detail {
            // it wasn't in our local cache, that's ok ask the client
         }
 
-        item_id item_to_fetch(fetch_items_message_received.item_type, item_hash);
+        item_id item_to_fetch(item_type, item_hash);
         try
         {
           message requested_message = _delegate->get_item(item_to_fetch);
@@ -2311,34 +2349,197 @@ namespace graphene { namespace net { namespace detail {
                ("id", requested_message.id())
                ("size", requested_message.size)
                ("endpoint", originating_peer->get_remote_endpoint()));
-          reply_messages.push_back(requested_message);
-          if (fetch_items_message_received.item_type == block_message_type)
-            last_block_message_sent = requested_message;
+          reply_messages.emplace_back(item_hash, std::move(requested_message));
+          if (item_type == block_message_type)
+            last_block_sent = item_hash;
           continue;
         }
         catch (fc::key_not_found_exception&)
         {
-          reply_messages.push_back(item_not_available_message(item_to_fetch));
+          reply_messages.emplace_back(item_hash, item_not_available_message(item_to_fetch));
           dlog("received item request from peer ${endpoint} but we don't have it",
                ("endpoint", originating_peer->get_remote_endpoint()));
         }
       }
 
       // if we sent them a block, update our record of the last block they've seen accordingly
-      if (last_block_message_sent)
+      if (last_block_sent)
       {
-        graphene::net::block_message block = last_block_message_sent->as<graphene::net::block_message>();
-        originating_peer->last_block_delegate_has_seen = block.block_id;
-        originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(block.block_id);
+        originating_peer->last_block_delegate_has_seen = *last_block_sent;
+        originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(*last_block_sent);
       }
 
-      for (const message& reply : reply_messages)
+      for (const auto& reply : reply_messages)
       {
-        if (reply.msg_type.value() == block_message_type)
-          originating_peer->send_item(item_id(block_message_type, reply.as<graphene::net::block_message>().block_id));
+        if (reply.second.msg_type.value() == block_message_type && compact_blocks_requested)
+        {
+          const graphene::net::block_message full_block = reply.second.as<graphene::net::block_message>();
+          originating_peer->send_message(compact_block_message(full_block.block, full_block.block_id, reply.first));
+        }
+        else if (reply.second.msg_type.value() == block_message_type)
+          originating_peer->send_item(item_id(block_message_type, reply.first));
         else
-          originating_peer->send_message(reply);
+          originating_peer->send_message(reply.second);
+      }
+    }
+
+    void node_impl::on_compact_block_message(peer_connection* originating_peer,
+                                             const compact_block_message& compact_block_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_id requested_item(block_message_type, compact_block_message_received.item_hash);
+      if (originating_peer->items_requested_from_peer.find(requested_item) == originating_peer->items_requested_from_peer.end())
+      {
+        wlog("received compact block ${id} from peer ${endpoint} which we didn't ask for, ignoring it",
+             ("id", compact_block_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        return;
       }
+      if (compact_block_message_received.operation_results.size() != compact_block_message_received.short_ids.size())
+      {
+        request_full_block(originating_peer, compact_block_message_received.item_hash);
+        return;
+      }
+      // we only wait for the transactions of one compact block per peer
+      if (originating_peer->compact_block_being_completed)
+      {
+        const item_hash_t superseded = originating_peer->compact_block_being_completed->block.item_hash;
+        originating_peer->compact_block_being_completed.reset();
+        request_full_block(originating_peer, superseded);
+      }
+
+      peer_connection::partial_compact_block partial;
+      partial.block = compact_block_message_received;
+      partial.transactions.resize(partial.block.short_ids.size());
+
+      // look the transactions up among the ones relayed to us, which sit in the message cache
+      std::unordered_map<uint64_t, uint32_t> index_of_short_id;
+      for (uint32_t i = 0; i < partial.block.short_ids.size(); ++i)
+        index_of_short_id.emplace(partial.block.short_ids[i], i);
+      _message_cache.for_each_message_of_type(trx_message_type,
+            [&partial, &index_of_short_id](const message& cached_message, const message_hash_type& trx_id) {
+        auto iter = index_of_short_id.find(compact_block_message::short_transaction_id(partial.block.block_id, trx_id));
+        if (iter != index_of_short_id.end() && !partial.transactions[iter->second])
+          partial.transactions[iter->second] = signed_transaction(cached_message.as<trx_message>().trx);
+      });
+
+      for (uint32_t i = 0; i < partial.transactions.size(); ++i)
+        if (!partial.transactions[i])
+          partial.missing_indexes.push_back(i);
+
+      if (partial.missing_indexes.empty())
+      {
+        process_compact_block(originating_peer, std::move(partial));
+        return;
+      }
+      dlog("received compact block ${id} from peer ${endpoint}, asking for ${count} of its ${total} transactions",
+           ("id", partial.block.block_id)("endpoint", originating_peer->get_remote_endpoint())
+           ("count", partial.missing_indexes.size())("total", partial.transactions.size()));
+      originating_peer->send_message(fetch_block_transactions_message(partial.block.block_id, partial.missing_indexes));
+      originating_peer->compact_block_being_completed = std::move(partial);
+    }
+
+    void node_impl::on_fetch_block_transactions_message(peer_connection* originating_peer,
+                                                        const fetch_block_transactions_message& fetch_block_transactions_message_received) const
+    {
+      VERIFY_CORRECT_THREAD();
+      block_transactions_message reply;
+      reply.block_id = fetch_block_transactions_message_received.block_id;
+
+      fc::optional<message> block_to_send = _message_cache.find_message_by_contents(reply.block_id);
+      if (!block_to_send)
+      {
+        try
+        {
+          block_to_send = _delegate->get_item(item_id(block_message_type, reply.block_id));
+        }
+        catch (const fc::exception&)
+        {
+          dlog("peer ${endpoint} asked for transactions of block ${id} which we don't have",
+               ("endpoint", originating_peer->get_remote_endpoint())("id", reply.block_id));
+        }
+      }
+
+      // an empty reply makes the peer fall back to fetching the full block
+      if (block_to_send && block_to_send->msg_type.value() == block_message_type)
+      {
+        const graphene::net::block_message full_block = block_to_send->as<graphene::net::block_message>();
+        const auto& transactions = full_block.block.transactions;
+        reply.transactions.reserve(fetch_block_transactions_message_received.indexes.size());
+        for (uint32_t index : fetch_block_transactions_message_received.indexes)
+        {
+          if (index >= transactions.size())
+          {
+            reply.transactions.clear();
+            break;
+          }
+          reply.transactions.push_back(transactions[index]);
+        }
+      }
+      originating_peer->send_message(reply);
+    }
+
+    void node_impl::on_block_transactions_message(peer_connection* originating_peer,
+                                                  const block_transactions_message& block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      if (!originating_peer->compact_block_being_completed ||
+          originating_peer->compact_block_being_completed->block.block_id != block_transactions_message_received.block_id)
+      {
+        wlog("received transactions of block ${id} from peer ${endpoint} which we didn't ask for, ignoring them",
+             ("id", block_transactions_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        return;
+      }
+      peer_connection::partial_compact_block partial = std::move(*originating_peer->compact_block_being_completed);
+      originating_peer->compact_block_being_completed.reset();
+
+      if (block_transactions_message_received.transactions.size() != partial.missing_indexes.size())
+      {
+        request_full_block(originating_peer, partial.block.item_hash);
+        return;
+      }
+      for (size_t i = 0; i < partial.missing_indexes.size(); ++i)
+        partial.transactions[partial.missing_indexes[i]] = block_transactions_message_received.transactions[i];
+      partial.missing_indexes.clear();
+      process_compact_block(originating_peer, std::move(partial));
+    }
+
+    void node_impl::process_compact_block(peer_connection* originating_peer,
+                                          peer_connection::partial_compact_block&& compact_block)
+    {
+      VERIFY_CORRECT_THREAD();
+      std::vector<signed_transaction> transactions;
+      transactions.reserve(compact_block.transactions.size());
+      for (auto& trx : compact_block.transactions)
+        transactions.emplace_back(std::move(*trx));
+      const graphene::net::block_message rebuilt_block(compact_block.block.rebuild_block(std::move(transactions)));
+
+      // a short id collision or a dishonest peer shows up as a block which doesn't match its header, the
+      // item hash also covers the witness signature and is what the block is settled, cached and relayed as
+      if (rebuilt_block.block_id != compact_block.block.block_id ||
+          rebuilt_block.block.calculate_merkle_root() != rebuilt_block.block.transaction_merkle_root ||
+          message(rebuilt_block).id() != compact_block.block.item_hash)
+      {
+        wlog("compact block ${id} from peer ${endpoint} could not be rebuilt, fetching the full block",
+             ("id", compact_block.block.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        request_full_block(originating_peer, compact_block.block.item_hash);
+        return;
+      }
+
+      auto item_iter = originating_peer->items_requested_from_peer.find(
+                             item_id(block_message_type, compact_block.block.item_hash));
+      if (item_iter == originating_peer->items_requested_from_peer.end())
+        return; // the request was given up on in the meantime
+      originating_peer->items_requested_from_peer.erase(item_iter);
+      process_block_when_in_sync(originating_peer, rebuilt_block, compact_block.block.item_hash);
+      if (originating_peer->idle())
+        trigger_fetch_items_loop();
+    }
+
+    void node_impl::request_full_block(peer_connection* originating_peer, const item_hash_t& item_hash)
+    {
+      VERIFY_CORRECT_THREAD();
+      // the block stays in items_requested_from_peer, the full block settles it as usual
+      originating_peer->send_message(fetch_items_message(block_message_type, std::vector<item_hash_t>{ item_hash }));
     }
 
     void node_impl::on_item_not_available_message( peer_connection* originating_peer, const item_not_available_message& item_not_available_message_received )
@@ -4546,6 +4747,7 @@ namespace graphene { namespace net { namespace detail {
 
         peer_details["peer_needs_sync_items_from_us"] = peer->peer_needs_sync_items_from_us;
         peer_details["we_need_sync_items_from_peer"] = peer->we_need_sync_items_from_peer;
+        peer_details["compact_blocks"] = peer->supports_compact_blocks;
 
         this_peer_status.info = peer_details;
         statuses.push_back(this_peer_status);
@@ -4630,6 +4832,8 @@ namespace graphene { namespace net { namespace detail {
         _max_sync_blocks_to_prefetch = params["max_sync_blocks_to_prefetch"].as<uint32_t>(1);
       if (params.contains("max_sync_blocks_per_peer"))
         _max_sync_blocks_per_peer = params["max_sync_blocks_per_peer"].as<uint32_t>(1);
+      if (params.contains("compact_blocks"))
+        _compact_blocks_enabled = params["compact_blocks"].as<bool>(1);
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4649,6 +4853,7 @@ namespace graphene { namespace net { namespace detail {
       result["max_blocks_to_handle_at_once"] = _max_blocks_to_handle_at_once;
       result["max_sync_blocks_to_prefetch"] = _max_sync_blocks_to_prefetch;
       result["max_sync_blocks_per_peer"] = _max_sync_blocks_per_peer;
+      result["compact_blocks"] = _compact_blocks_enabled;
       return result;
     }
 
@@ -203,6 +203,16 @@ public:
    message get_message( const message_hash_type& hash_of_message_to_lookup ) const;
    message_propagation_data get_message_propagation_data(
          const message_hash_type& hash_of_msg_contents_to_lookup ) const;
+   /// The cached message holding the transaction or block @p hash_of_msg_contents_to_lookup, if any
+   fc::optional<message> find_message_by_contents( const message_hash_type& hash_of_msg_contents_to_lookup ) const;
+   /// Calls @p f with the body and the contents hash of every cached message of type @p msg_type
+   template<typename Function>
+   void for_each_message_of_type( uint32_t msg_type, Function&& f ) const
+   {
+      for( const message_info& info : _message_cache )
+         if( info.message_body.msg_type.value() == msg_type )
+            f( info.message_body, info.message_contents_hash );
+   }
    size_t size() const { return _message_cache.size(); }
 };
 
@@ -587,6 +597,8 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
       size_t _max_sync_blocks_to_prefetch = MAX_SYNC_BLOCKS_TO_PREFETCH;
       /// Maximum number of blocks per peer during syncing
       size_t _max_sync_blocks_per_peer = GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING;
+      /// Whether we offer, and ask peers for, compact blocks during normal operation
+      bool _compact_blocks_enabled = true;
 
       std::list<fc::future<void> > _handle_message_calls_in_progress;
 
@@ -669,6 +681,15 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
       void on_item_not_available_message( peer_connection* originating_peer,
                                           const item_not_available_message& item_not_available_message_received );
 
+      void on_compact_block_message( peer_connection* originating_peer,
+                                     const compact_block_message& compact_block_message_received );
+
+      void on_fetch_block_transactions_message( peer_connection* originating_peer,
+                                                const fetch_block_transactions_message& fetch_block_transactions_message_received ) const;
+
+      void on_block_transactions_message( peer_connection* originating_peer,
+                                          const block_transactions_message& block_transactions_message_received );
+
       void on_item_ids_inventory_message( peer_connection* originating_peer,
                                           const item_ids_inventory_message& item_ids_inventory_message_received );
 
@@ -706,6 +727,12 @@ class node_impl : public peer_connection_delegate, public std::enable_shared_fro
                   peer_connection* originating_peer,
                   const message& message_to_process,
                   const message_hash_type& message_hash);
+      /// Hands a compact block, once all its transactions are known, on as a block received in sync
+      void process_compact_block(
+                  peer_connection* originating_peer,
+                  peer_connection::partial_compact_block&& compact_block);
+      /// Gives up on a compact block and asks the peer for the full block instead
+      void request_full_block(peer_connection* originating_peer, const item_hash_t& item_hash);
 
       void process_ordinary_message(
                   peer_connection* originating_peer,
@@ -48,10 +48,24 @@ void content_cards_plugin::plugin_set_program_options(
    boost::program_options::options_description& cfg
    )
 {
+   cli.add_options()
+         ("content-cards-store", boost::program_options::value<bool>()->default_value(false),
+          "Keep url, description, content key and storage data of content cards in an append-only file "
+          "instead of memory (turning it off again requires a replay)")
+         ("content-cards-store-cache-mb", boost::program_options::value<uint64_t>()->default_value(64),
+          "Megabytes of recently read content card payloads to keep in memory when content-cards-store is set")
+         ;
+   cfg.add(cli);
 }
 
 void content_cards_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 {
+   if( options.count("content-cards-store") > 0 && options["content-cards-store"].as<bool>() )
+   {
+      const uint64_t cache_mb = options["content-cards-store-cache-mb"].as<uint64_t>();
+      database().enable_content_store( cache_mb << 20 );
+      ilog( "content_cards: keeping payloads in the content store, ${mb} MiB cache", ("mb", cache_mb) );
+   }
 }
 
 void content_cards_plugin::plugin_startup()
@@ -31,6 +31,8 @@
 #include <fc/rpc/websocket_api.hpp>
 #include <fc/api.hpp>
 
+#include <deque>
+
 namespace graphene { namespace delayed_node {
 namespace bpo = boost::program_options;
 
@@ -40,10 +42,35 @@ struct delayed_node_plugin_impl {
    fc::http::websocket_client client;
    std::shared_ptr<fc::rpc::websocket_api_connection> client_connection;
    fc::api<graphene::app::database_api> database_api;
+   /// Set when the trusted node lets us use its block API, blocks are fetched one by one otherwise
+   fc::optional<fc::api<graphene::app::block_api>> block_api;
    boost::signals2::scoped_connection client_connection_closed;
    graphene::chain::block_id_type last_received_remote_head;
    graphene::chain::block_id_type last_processed_remote_head;
+
+   uint32_t blocks_per_request = 100;
+   uint32_t requests_in_flight = 4;
+
+   std::vector<fc::optional<graphene::chain::signed_block>> fetch_blocks( uint32_t block_num_from,
+                                                                          uint32_t block_num_to );
 };
+
+std::vector<fc::optional<graphene::chain::signed_block>> delayed_node_plugin_impl::fetch_blocks(
+      uint32_t block_num_from, uint32_t block_num_to )
+{
+   // keep our own copies of the API handles, the connection may be replaced while we wait
+   if( block_api.valid() )
+   {
+      auto remote_block_api = *block_api;
+      return remote_block_api->get_blocks( block_num_from, block_num_to );
+   }
+   auto remote_database_api = database_api;
+   std::vector<fc::optional<graphene::chain::signed_block>> blocks;
+   blocks.reserve( block_num_to - block_num_from + 1 );
+   for( uint32_t block_num = block_num_from; block_num <= block_num_to; ++block_num )
+      blocks.push_back( remote_database_api->get_block( block_num ) );
+   return blocks;
+}
 }
 
 delayed_node_plugin::delayed_node_plugin(graphene::app::application& app) :
@@ -59,6 +86,10 @@ void delayed_node_plugin::plugin_set_program_options(bpo::options_description& c
    cli.add_options()
          ("trusted-node", boost::program_options::value<std::string>(),
           "RPC endpoint of a trusted validating node (required for delayed_node)")
+         ("delayed-node-blocks-per-request", boost::program_options::value<uint32_t>()->default_value(100),
+          "Number of blocks asked from the trusted node in one request while catching up")
+         ("delayed-node-requests-in-flight", boost::program_options::value<uint32_t>()->default_value(4),
+          "Number of block requests sent to the trusted node ahead of the blocks being applied")
          ;
    cfg.add(cli);
 }
@@ -83,6 +114,18 @@ void delayed_node_plugin::connect()
    {
       fc::from_variant( block_id, my->last_received_remote_head, GRAPHENE_MAX_NESTED_OBJECTS );
    } );
+   my->block_api.reset();
+   try
+   {
+      auto login = my->client_connection->get_remote_api<graphene::app::login_api>(1);
+      if( login->login( "", "" ) )
+         my->block_api = login->block();
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Trusted node does not offer its block API, blocks will be fetched one at a time: ${e}",
+            ("e", e.to_string()) );
+   }
    my->client_connection_closed = my->client_connection->closed.connect([this] {
       connection_failed();
    });
@@ -93,6 +136,12 @@ void delayed_node_plugin::plugin_initialize(const boost::program_options::variab
    FC_ASSERT(options.count("trusted-node") > 0);
    my = std::make_unique<detail::delayed_node_plugin_impl>();
    my->remote_endpoint = "ws://" + options.at("trusted-node").as<std::string>();
+   if( options.count("delayed-node-blocks-per-request") > 0 )
+      my->blocks_per_request = options.at("delayed-node-blocks-per-request").as<uint32_t>();
+   if( options.count("delayed-node-requests-in-flight") > 0 )
+      my->requests_in_flight = options.at("delayed-node-requests-in-flight").as<uint32_t>();
+   FC_ASSERT( my->blocks_per_request > 0, "delayed-node-blocks-per-request must be positive" );
+   FC_ASSERT( my->requests_in_flight > 0, "delayed-node-requests-in-flight must be positive" );
 }
 
 void delayed_node_plugin::sync_with_trusted_node()
@@ -100,31 +149,98 @@ void delayed_node_plugin::sync_with_trusted_node()
    auto& db = database();
    uint32_t synced_blocks = 0;
    uint32_t pass_count = 0;
+   const fc::time_point sync_start = fc::time_point::now();
+   fc::time_point last_report = sync_start;
+   uint32_t blocks_at_last_report = 0;
    while( true )
    {
       graphene::chain::dynamic_global_property_object remote_dpo = my->database_api->get_dynamic_global_properties();
-      if( remote_dpo.last_irreversible_block_num <= db.head_block_num() )
+      const uint32_t target = remote_dpo.last_irreversible_block_num;
+      if( target <= db.head_block_num() )
       {
-         if( remote_dpo.last_irreversible_block_num < db.head_block_num() )
+         if( target < db.head_block_num() )
          {
             wlog( "Trusted node seems to be behind delayed node" );
          }
          if( synced_blocks > 1 )
          {
-            ilog( "Delayed node finished syncing ${n} blocks in ${k} passes", ("n", synced_blocks)("k", pass_count) );
+            const double seconds = std::max<int64_t>( ( fc::time_point::now() - sync_start ).count(), 1 ) / 1e6;
+            ilog( "Delayed node finished syncing ${n} blocks in ${k} passes, ${rate} blocks/s",
+                  ("n", synced_blocks)("k", pass_count)("rate", uint64_t( synced_blocks / seconds )) );
          }
          break;
       }
       pass_count++;
-      while( remote_dpo.last_irreversible_block_num > db.head_block_num() )
+
+      // Ranges of blocks are requested ahead of the head, the signatures of a fetched range are checked
+      // on the thread pool while the blocks before them are applied.
+      typedef std::vector<fc::optional<graphene::chain::signed_block>> block_range;
+      std::deque<fc::future<block_range>> requests;
+      // precompute_parallel() keeps references to the blocks, a deque does not move them around
+      std::deque<std::pair<graphene::chain::signed_block, fc::future<void>>> blocks;
+      uint32_t next_to_request = db.head_block_num() + 1;
+
+      auto request_more = [&]() {
+         while( requests.size() < my->requests_in_flight && next_to_request <= target )
+         {
+            const uint32_t from = next_to_request;
+            const uint32_t to = static_cast<uint32_t>(
+                  std::min<uint64_t>( uint64_t( from ) + my->blocks_per_request - 1, target ) );
+            auto impl = my.get();
+            requests.push_back( fc::async( [impl, from, to]() { return impl->fetch_blocks( from, to ); },
+                                           "delayed_node fetch blocks" ) );
+            next_to_request = to + 1;
+         }
+      };
+      auto precompute_range = [&]() {
+         block_range range = requests.front().wait();
+         requests.pop_front();
+         for( auto& block : range )
+         {
+            FC_ASSERT( block, "Trusted node claims it has blocks it doesn't actually have." );
+            blocks.emplace_back( std::move( *block ), fc::future<void>() );
+            blocks.back().second = db.precompute_parallel( blocks.back().first, graphene::chain::database::skip_nothing );
+         }
+         request_more();
+      };
+
+      try
+      {
+         request_more();
+         while( db.head_block_num() < target )
+         {
+            if( blocks.empty() )
+               precompute_range();
+            // start on the next range while this one is applied
+            else if( !requests.empty() && requests.front().ready() )
+               precompute_range();
+
+            auto& next = blocks.front();
+            next.second.wait();
+            db.push_block( next.first );
+            blocks.pop_front();
+            synced_blocks++;
+
+            const fc::time_point now = fc::time_point::now();
+            if( now - last_report >= fc::seconds( 10 ) )
+            {
+               const double seconds = ( now - last_report ).count() / 1e6;
+               ilog( "Delayed node at block #${n}, ${rate} blocks/s, ${left} blocks to go",
+                     ("n", db.head_block_num())("rate", uint64_t( ( synced_blocks - blocks_at_last_report ) / seconds ))
+                     ("left", target - db.head_block_num()) );
+               last_report = now;
+               blocks_at_last_report = synced_blocks;
+            }
+         }
+      }
+      catch( ... )
       {
-         fc::optional<graphene::chain::signed_block> block = my->database_api->get_block( db.head_block_num()+1 );
-         // TODO: during sync, decouple requesting blocks from preprocessing + applying them
-         FC_ASSERT(block, "Trusted node claims it has blocks it doesn't actually have.");
-         ilog("Pushing block #${n}", ("n", block->block_num()));
-         db.precompute_parallel( *block, graphene::chain::database::skip_nothing ).wait();
-         db.push_block(*block);
-         synced_blocks++;
+         // nothing may outlive this pass while it still refers to it
+         for( auto& request : requests )
+            try { request.wait(); } catch( ... ) {}
+         for( auto& block : blocks )
+            try { block.second.wait(); } catch( ... ) {}
+         throw;
       }
    }
 }
@@ -356,6 +356,7 @@ const account_transaction_history_object& elasticsearch_plugin_impl::addNewEntry
    graphene::chain::database& db = database();
    const auto &ath = db.create<account_transaction_history_object>([&](account_transaction_history_object &obj) {
       obj.operation_id = oho->id;
+      obj.op_type = oho->op.which();
       obj.account = account_id;
       obj.sequence = stats_obj.total_ops + 1;
       obj.next = stats_obj.most_recent_op;
@@ -24,6 +24,21 @@ namespace detail
 
 enum mode { only_save = 0, only_query = 1, all = 2 };
 
+/// Progress of the asynchronous PostgreSQL writer
+struct writer_stats
+{
+   uint32_t queue_depth = 0;        ///< batches waiting for the writer thread
+   uint32_t queue_capacity = 0;
+   uint32_t head_block = 0;         ///< last block applied by the chain
+   uint32_t last_queued_block = 0;
+   uint32_t last_written_block = 0; ///< last block committed to indexer_sync_state
+   uint32_t lag_blocks = 0;         ///< head_block - last_written_block
+   uint64_t batches_written = 0;
+   uint64_t statements_written = 0;
+   uint64_t retries = 0;
+   uint64_t producer_waits = 0;     ///< times block application waited on a full queue
+};
+
 class postgres_indexer_plugin : public graphene::app::plugin
 {
    public:
@@ -49,6 +64,7 @@ class postgres_indexer_plugin : public graphene::app::plugin
          unsigned limit,
          operation_history_id_type start);
       mode get_running_mode();
+      writer_stats get_writer_stats();
 
       friend class detail::postgres_indexer_plugin_impl;
       std::unique_ptr<detail::postgres_indexer_plugin_impl> my;
@@ -57,3 +73,6 @@ class postgres_indexer_plugin : public graphene::app::plugin
 } } // graphene::postgres_indexer
 
 FC_REFLECT_ENUM( graphene::postgres_indexer::mode, (only_save)(only_query)(all) )
+FC_REFLECT( graphene::postgres_indexer::writer_stats,
+            (queue_depth)(queue_capacity)(head_block)(last_queued_block)(last_written_block)(lag_blocks)
+            (batches_written)(statements_written)(retries)(producer_waits) )
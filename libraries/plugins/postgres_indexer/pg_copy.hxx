@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace graphene { namespace postgres_indexer { namespace detail {
+
+/**
+ * Encodes rows in the PostgreSQL binary COPY format (COPY ... FROM STDIN (FORMAT binary)).
+ * Every field is written in network byte order, prefixed with its length; column types on the
+ * receiving table must match exactly (int2, int4, int8, float8, bool, text, bytea).
+ */
+class pg_binary_copy
+{
+   public:
+      bool empty() const { return _rows == 0; }
+      size_t rows() const { return _rows; }
+
+      void begin_row( int16_t fields )
+      {
+         if( _data.empty() )
+         {
+            static const char signature[] = "PGCOPY\n\377\r\n";
+            _data.append( signature, sizeof( signature ) ); // includes the trailing '\0'
+            put<int32_t>( 0 ); // flags
+            put<int32_t>( 0 ); // header extension length
+         }
+         put<int16_t>( fields );
+         ++_rows;
+      }
+
+      void add_null() { put<int32_t>( -1 ); }
+
+      void add_text( const std::string& value ) { add_bytes( value.data(), value.size() ); }
+
+      void add_bytes( const char* data, size_t size )
+      {
+         put<int32_t>( static_cast<int32_t>( size ) );
+         _data.append( data, size );
+      }
+
+      void add_int16( int16_t value ) { put<int32_t>( 2 ); put<int16_t>( value ); }
+      void add_int32( int32_t value ) { put<int32_t>( 4 ); put<int32_t>( value ); }
+      void add_int64( int64_t value ) { put<int32_t>( 8 ); put<int64_t>( value ); }
+      void add_bool( bool value ) { put<int32_t>( 1 ); _data.push_back( value ? 1 : 0 ); }
+
+      void add_double( double value )
+      {
+         int64_t bits;
+         static_assert( sizeof( bits ) == sizeof( value ), "double must be 64 bits" );
+         std::memcpy( &bits, &value, sizeof( bits ) );
+         add_int64( bits );
+      }
+
+      /// Appends the trailer and hands over the encoded stream, leaving the encoder empty
+      std::string finish()
+      {
+         put<int16_t>( -1 );
+         std::string result;
+         result.swap( _data );
+         _rows = 0;
+         return result;
+      }
+
+   private:
+      template<typename T>
+      void put( T value )
+      {
+         auto bits = static_cast<typename std::make_unsigned<T>::type>( value );
+         for( int shift = ( sizeof( T ) - 1 ) * 8; shift >= 0; shift -= 8 )
+            _data.push_back( static_cast<char>( ( bits >> shift ) & 0xff ) );
+      }
+
+      std::string _data;
+      size_t      _rows = 0;
+};
+
+} } } // graphene::postgres_indexer::detail
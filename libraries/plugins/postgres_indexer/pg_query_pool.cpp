@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+
+#include "pg_query_pool.hxx"
+
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+
+namespace graphene { namespace postgres_indexer { namespace detail {
+
+namespace {
+
+const char* operation_by_id_statement = "pi_operation_by_id";
+const char* account_history_statement = "pi_account_history";
+
+// Result columns shared by both statements
+const char* history_columns = "operation_id_num, op_packed, op_string, operation_result, "
+                              "block_num, trx_in_block, op_in_trx, virtual_op";
+
+const Oid int8_oid = 20;
+const Oid text_oid = 25;
+
+void write_int64( char* out, int64_t value )
+{
+   auto bits = static_cast<uint64_t>( value );
+   for( int i = 7; i >= 0; --i, bits >>= 8 )
+      out[i] = static_cast<char>( bits & 0xff );
+}
+
+uint64_t read_uint( const char* in, int length )
+{
+   uint64_t value = 0;
+   for( int i = 0; i < length; ++i )
+      value = ( value << 8 ) | static_cast<uint8_t>( in[i] );
+   return value;
+}
+
+uint64_t get_uint( PGresult* res, int row, int column )
+{
+   return read_uint( PQgetvalue( res, row, column ), PQgetlength( res, row, column ) );
+}
+
+operation_history_object decode_row( PGresult* res, int row )
+{
+   operation_history_object obj;
+
+   if( !PQgetisnull( res, row, 1 ) )
+   {
+      // Rows written with op_packed carry the whole object, no JSON parsing needed
+      fc::datastream<const char*> ds( PQgetvalue( res, row, 1 ), PQgetlength( res, row, 1 ) );
+      fc::raw::unpack( ds, obj, GRAPHENE_MAX_NESTED_OBJECTS );
+   }
+   else
+   {
+      // Rows indexed before op_packed existed
+      if( !PQgetisnull( res, row, 2 ) )
+         fc::from_variant( fc::json::from_string( PQgetvalue( res, row, 2 ) ), obj.op,
+                           GRAPHENE_MAX_NESTED_OBJECTS );
+      if( !PQgetisnull( res, row, 3 ) )
+         fc::from_variant( fc::json::from_string( PQgetvalue( res, row, 3 ) ), obj.result,
+                           GRAPHENE_MAX_NESTED_OBJECTS );
+      obj.block_num = get_uint( res, row, 4 );
+      obj.trx_in_block = get_uint( res, row, 5 );
+      obj.op_in_trx = get_uint( res, row, 6 );
+      obj.virtual_op = get_uint( res, row, 7 );
+   }
+   obj.id = operation_history_id_type( get_uint( res, row, 0 ) );
+   return obj;
+}
+
+} // anonymous namespace
+
+pg_query_pool::pg_query_pool( const std::string& url, uint32_t size )
+   : _url( url ), _size( std::max<uint32_t>( size, 1 ) )
+{
+}
+
+pg_query_pool::~pg_query_pool()
+{
+   for( auto& c : _connections )
+   {
+      if( c.conn )
+         c.thread->async( [&c]() { PQfinish( c.conn ); }, "postgres_indexer query close" ).wait();
+      c.thread->quit();
+   }
+}
+
+bool pg_query_pool::connect( connection& c )
+{
+   if( c.conn )
+   {
+      if( PQstatus( c.conn ) == CONNECTION_OK )
+         return true;
+      PQfinish( c.conn );
+   }
+   c.conn = PQconnectdb( _url.c_str() );
+   if( PQstatus( c.conn ) != CONNECTION_OK )
+   {
+      elog( "postgres_indexer query: connection failed: ${e}", ("e", PQerrorMessage( c.conn )) );
+      PQfinish( c.conn );
+      c.conn = nullptr;
+      return false;
+   }
+
+   PGresult* res = PQexec( c.conn, "SET SESSION CHARACTERISTICS AS TRANSACTION READ ONLY" );
+   bool ok = PQresultStatus( res ) == PGRES_COMMAND_OK;
+   PQclear( res );
+
+   const std::string by_id_sql = std::string( "SELECT " ) + history_columns
+      + " FROM indexer_operation_history WHERE operation_id = $1 LIMIT 1";
+   const Oid by_id_types[] = { text_oid };
+   res = PQprepare( c.conn, operation_by_id_statement, by_id_sql.c_str(), 1, by_id_types );
+   ok = ok && PQresultStatus( res ) == PGRES_COMMAND_OK;
+   PQclear( res );
+
+   const std::string history_sql = std::string( "SELECT " ) + history_columns
+      + " FROM indexer_operation_history"
+        " WHERE account_id = $1 AND operation_id_num >= $2 AND operation_id_num <= $3"
+        " ORDER BY operation_id_num DESC LIMIT $4";
+   const Oid history_types[] = { text_oid, int8_oid, int8_oid, int8_oid };
+   res = PQprepare( c.conn, account_history_statement, history_sql.c_str(), 4, history_types );
+   ok = ok && PQresultStatus( res ) == PGRES_COMMAND_OK;
+   PQclear( res );
+
+   if( !ok )
+   {
+      elog( "postgres_indexer query: failed to prepare statements: ${e}", ("e", PQerrorMessage( c.conn )) );
+      PQfinish( c.conn );
+      c.conn = nullptr;
+   }
+   return ok;
+}
+
+void pg_query_pool::open()
+{
+   _connections.resize( _size );
+   for( uint32_t i = 0; i < _size; ++i )
+   {
+      auto& c = _connections[i];
+      c.thread = std::make_shared<fc::thread>( "postgres_indexer_query_" + std::to_string( i ) );
+      bool ok = c.thread->async( [this, &c]() { return connect( c ); }, "postgres_indexer query connect" ).wait();
+      FC_ASSERT( ok, "Failed to open PostgreSQL query connection ${i}", ("i", i) );
+   }
+   ilog( "postgres_indexer: ${n} query connections ready", ("n", _size) );
+}
+
+template<typename Function>
+auto pg_query_pool::run( Function&& f ) -> decltype( f( std::declval<PGconn*>() ) )
+{
+   FC_ASSERT( !_connections.empty(), "PostgreSQL query connections are not open" );
+   auto& c = _connections[ _next++ % _connections.size() ];
+   return c.thread->async( [this, &c, &f]() {
+      FC_ASSERT( connect( c ), "PostgreSQL query connection is down" );
+      return f( c.conn );
+   }, "postgres_indexer query" ).wait();
+}
+
+operation_history_object pg_query_pool::get_operation_by_id( operation_history_id_type id )
+{
+   const std::string operation_id = std::string( object_id_type( id ) );
+   return run( [&operation_id]( PGconn* conn ) {
+      const char* values[] = { operation_id.c_str() };
+      PGresult* res = PQexecPrepared( conn, operation_by_id_statement, 1, values, nullptr, nullptr, 1 );
+      if( PQresultStatus( res ) != PGRES_TUPLES_OK || PQntuples( res ) == 0 )
+      {
+         PQclear( res );
+         FC_THROW_EXCEPTION( fc::exception, "Operation not found: ${id}", ("id", operation_id) );
+      }
+      try {
+         auto result = decode_row( res, 0 );
+         PQclear( res );
+         return result;
+      } catch( ... ) {
+         PQclear( res );
+         throw;
+      }
+   } );
+}
+
+vector<operation_history_object> pg_query_pool::get_account_history( account_id_type account_id,
+                                                                     operation_history_id_type stop,
+                                                                     unsigned limit,
+                                                                     operation_history_id_type start )
+{
+   const std::string account = std::string( object_id_type( account_id ) );
+   // stop is exclusive unless it is the first operation
+   const int64_t lower = stop.instance.value == 0 ? 0 : stop.instance.value + 1;
+   const int64_t upper = start.instance.value;
+
+   return run( [&]( PGconn* conn ) {
+      char lower_buf[8], upper_buf[8], limit_buf[8];
+      write_int64( lower_buf, lower );
+      write_int64( upper_buf, upper );
+      write_int64( limit_buf, limit );
+      const char* values[] = { account.c_str(), lower_buf, upper_buf, limit_buf };
+      const int lengths[] = { 0, 8, 8, 8 };
+      const int formats[] = { 0, 1, 1, 1 };
+
+      vector<operation_history_object> result;
+      PGresult* res = PQexecPrepared( conn, account_history_statement, 4, values, lengths, formats, 1 );
+      if( PQresultStatus( res ) != PGRES_TUPLES_OK )
+      {
+         elog( "PostgreSQL query error: ${e}", ("e", PQerrorMessage( conn )) );
+         PQclear( res );
+         return result;
+      }
+      try {
+         const int rows = PQntuples( res );
+         result.reserve( rows );
+         for( int i = 0; i < rows; ++i )
+            result.push_back( decode_row( res, i ) );
+         PQclear( res );
+         return result;
+      } catch( ... ) {
+         PQclear( res );
+         throw;
+      }
+   } );
+}
+
+} } } // graphene::postgres_indexer::detail
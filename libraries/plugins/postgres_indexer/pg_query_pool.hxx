@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+
+#include <libpq-fe.h>
+
+namespace graphene { namespace postgres_indexer { namespace detail {
+
+using namespace graphene::chain;
+
+/**
+ * A small pool of read-only connections serving the history query API. Each connection has
+ * its own thread, statements are prepared once per session and results come back in binary
+ * format, so concurrent API calls neither serialize on one connection nor parse SQL or JSON.
+ */
+class pg_query_pool
+{
+   public:
+      pg_query_pool( const std::string& url, uint32_t size );
+      ~pg_query_pool();
+
+      /// Connect every pooled session and prepare its statements, throws on failure
+      void open();
+
+      operation_history_object get_operation_by_id( operation_history_id_type id );
+      vector<operation_history_object> get_account_history( account_id_type account_id,
+                                                            operation_history_id_type stop,
+                                                            unsigned limit,
+                                                            operation_history_id_type start );
+
+   private:
+      struct connection
+      {
+         PGconn*                     conn = nullptr;
+         std::shared_ptr<fc::thread> thread;
+      };
+
+      template<typename Function>
+      auto run( Function&& f ) -> decltype( f( std::declval<PGconn*>() ) );
+
+      bool connect( connection& c );
+
+      const std::string       _url;
+      const uint32_t          _size;
+      std::vector<connection> _connections;
+      std::atomic<uint32_t>   _next{ 0 };
+};
+
+} } } // graphene::postgres_indexer::detail
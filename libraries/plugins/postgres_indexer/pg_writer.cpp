@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+
+#include "pg_writer.hxx"
+
+#include <graphene/chain/exceptions.hpp>
+
+#include <chrono>
+
+namespace graphene { namespace postgres_indexer { namespace detail {
+
+// Statements sent before the pipeline is synced and its results collected, keeps both
+// socket buffers bounded on large replay batches
+static const size_t pipeline_chunk_size = 1000;
+static const uint32_t max_write_attempts = 5;
+static const size_t copy_chunk_size = 1 << 20;
+
+pg_writer::pg_writer( const std::string& url, uint32_t capacity )
+   : _url( url ), _capacity( std::max<uint32_t>( capacity, 1 ) )
+{
+}
+
+pg_writer::~pg_writer()
+{
+   stop();
+   if( _conn )
+   {
+      PQfinish( _conn );
+      _conn = nullptr;
+   }
+}
+
+bool pg_writer::connect()
+{
+   _conn = PQconnectdb( _url.c_str() );
+   if( PQstatus( _conn ) != CONNECTION_OK )
+   {
+      elog( "postgres_indexer writer: connection failed: ${e}", ("e", PQerrorMessage( _conn )) );
+      PQfinish( _conn );
+      _conn = nullptr;
+      return false;
+   }
+   return true;
+}
+
+bool pg_writer::ensure_connected()
+{
+   if( !_conn )
+      return connect();
+   if( PQstatus( _conn ) == CONNECTION_OK )
+      return true;
+   PQreset( _conn );
+   return PQstatus( _conn ) == CONNECTION_OK;
+}
+
+void pg_writer::start( uint32_t last_written_block )
+{
+   _last_written_block = last_written_block;
+   _last_queued_block = last_written_block;
+   if( !connect() )
+      FC_THROW_EXCEPTION( fc::exception, "postgres_indexer writer failed to connect to PostgreSQL" );
+#ifdef LIBPQ_HAS_PIPELINING
+   ilog( "postgres_indexer writer: using libpq pipeline mode" );
+#endif
+   _thread = std::thread( [this]() { run(); } );
+}
+
+void pg_writer::stop()
+{
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( !_thread.joinable() )
+         return;
+      _stopping = true;
+   }
+   _not_empty.notify_all();
+   _thread.join();
+}
+
+void pg_writer::push( pg_write_batch&& batch )
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   if( _queue.size() >= _capacity && !_failed )
+   {
+      ++_producer_waits;
+      _not_full.wait( lock, [this]() { return _queue.size() < _capacity || _failed; } );
+   }
+   if( _failed )
+      FC_THROW_EXCEPTION( graphene::chain::plugin_exception,
+                          "PostgreSQL writer stopped: ${e}", ("e", _failure) );
+
+   if( batch.block_num > _last_queued_block )
+      _last_queued_block = batch.block_num;
+   _queue.push_back( std::move( batch ) );
+   lock.unlock();
+   _not_empty.notify_one();
+}
+
+void pg_writer::drain()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   if( !_thread.joinable() )
+      return;
+   _idle.wait( lock, [this]() { return ( _queue.empty() && !_busy ) || _failed; } );
+   if( _failed )
+      FC_THROW_EXCEPTION( graphene::chain::plugin_exception,
+                          "PostgreSQL writer stopped: ${e}", ("e", _failure) );
+}
+
+writer_stats pg_writer::get_stats() const
+{
+   writer_stats stats;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      stats.queue_depth = _queue.size();
+   }
+   stats.queue_capacity = _capacity;
+   stats.head_block = _head_block;
+   stats.last_queued_block = _last_queued_block;
+   stats.last_written_block = _last_written_block;
+   stats.lag_blocks = stats.head_block > stats.last_written_block ?
+                      stats.head_block - stats.last_written_block : 0;
+   stats.batches_written = _batches_written;
+   stats.statements_written = _statements_written;
+   stats.retries = _retries;
+   stats.producer_waits = _producer_waits;
+   return stats;
+}
+
+void pg_writer::run()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   while( true )
+   {
+      _not_empty.wait( lock, [this]() { return _stopping || !_queue.empty(); } );
+      if( _queue.empty() )
+         break; // stopping and fully drained
+
+      pg_write_batch batch = std::move( _queue.front() );
+      _queue.pop_front();
+      _busy = true;
+      lock.unlock();
+      _not_full.notify_one();
+
+      bool ok = write( batch );
+
+      lock.lock();
+      _busy = false;
+      if( !ok )
+      {
+         _failed = true;
+         _failure = "batch for block " + std::to_string( batch.block_num ) + " failed after "
+                    + std::to_string( max_write_attempts ) + " attempts";
+         elog( "postgres_indexer writer: ${f}", ("f", _failure) );
+         break;
+      }
+      if( _queue.empty() )
+         _idle.notify_all();
+   }
+   lock.unlock();
+   _idle.notify_all();
+   _not_full.notify_all();
+}
+
+bool pg_writer::write( const pg_write_batch& batch )
+{
+   for( uint32_t attempt = 1; attempt <= max_write_attempts; ++attempt )
+   {
+      if( ensure_connected() )
+      {
+         bool ok = batch.atomic ? write_atomic( batch ) : write_independent( batch );
+         if( ok )
+         {
+            ++_batches_written;
+            _statements_written += batch.statements.size();
+            if( batch.block_num > _last_written_block )
+               _last_written_block = batch.block_num;
+            return true;
+         }
+      }
+      ++_retries;
+      wlog( "postgres_indexer writer: batch for block ${b} failed, attempt ${a} of ${m}",
+            ("b", batch.block_num)("a", attempt)("m", max_write_attempts) );
+      std::this_thread::sleep_for( std::chrono::seconds( attempt ) );
+   }
+   return false;
+}
+
+bool pg_writer::exec( const std::string& sql )
+{
+   PGresult* res = PQexec( _conn, sql.c_str() );
+   ExecStatusType status = PQresultStatus( res );
+   bool success = ( status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK );
+   if( !success )
+   {
+      elog( "PostgreSQL error: ${e}", ("e", PQerrorMessage( _conn )) );
+      elog( "SQL: ${s}", ("s", sql.substr( 0, 500 )) );
+   }
+   PQclear( res );
+   return success;
+}
+
+bool pg_writer::copy_in( const std::string& statement, const std::string& data )
+{
+   PGresult* res = PQexec( _conn, statement.c_str() );
+   if( PQresultStatus( res ) != PGRES_COPY_IN )
+   {
+      elog( "PostgreSQL COPY error: ${e}", ("e", PQerrorMessage( _conn )) );
+      PQclear( res );
+      return false;
+   }
+   PQclear( res );
+
+   bool sent = true;
+   for( size_t offset = 0; sent && offset < data.size(); offset += copy_chunk_size )
+   {
+      const size_t length = std::min( copy_chunk_size, data.size() - offset );
+      sent = PQputCopyData( _conn, data.data() + offset, static_cast<int>( length ) ) == 1;
+   }
+   if( PQputCopyEnd( _conn, sent ? nullptr : "client failed to send COPY data" ) != 1 )
+      sent = false;
+
+   bool ok = sent;
+   while( ( res = PQgetResult( _conn ) ) != nullptr )
+   {
+      if( PQresultStatus( res ) != PGRES_COMMAND_OK )
+      {
+         elog( "PostgreSQL COPY error: ${e}", ("e", PQresultErrorMessage( res )) );
+         ok = false;
+      }
+      PQclear( res );
+   }
+   return ok;
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+
+bool pg_writer::send( const std::string& sql )
+{
+   if( PQsendQueryParams( _conn, sql.c_str(), 0, nullptr, nullptr, nullptr, nullptr, 0 ) == 1 )
+      return true;
+   elog( "PostgreSQL send error: ${e}", ("e", PQerrorMessage( _conn )) );
+   return false;
+}
+
+bool pg_writer::sync()
+{
+   return PQpipelineSync( _conn ) == 1;
+}
+
+// Reads results until @p syncs sync points have been seen. Returns false only when the
+// connection is lost; statement errors clear @p all_ok.
+bool pg_writer::collect( uint32_t syncs, bool& all_ok )
+{
+   uint32_t seen = 0;
+   while( seen < syncs )
+   {
+      PGresult* res = PQgetResult( _conn );
+      if( !res )
+      {
+         if( PQstatus( _conn ) != CONNECTION_OK )
+            return false;
+         continue;
+      }
+      switch( PQresultStatus( res ) )
+      {
+         case PGRES_PIPELINE_SYNC:
+            ++seen;
+            break;
+         case PGRES_COMMAND_OK:
+         case PGRES_TUPLES_OK:
+            break;
+         case PGRES_PIPELINE_ABORTED:
+            all_ok = false;
+            break;
+         default:
+            all_ok = false;
+            elog( "PostgreSQL error: ${e}", ("e", PQresultErrorMessage( res )) );
+            break;
+      }
+      PQclear( res );
+   }
+   return true;
+}
+
+bool pg_writer::write_atomic( const pg_write_batch& batch )
+{
+   // COPY is not allowed in pipeline mode, so the transaction is opened and the rows are
+   // streamed before switching to the pipeline for the remaining statements
+   bool in_transaction = false;
+   if( !batch.copy_data.empty() )
+   {
+      if( !exec( "BEGIN" ) )
+         return false;
+      if( !copy_in( batch.copy_statement, batch.copy_data ) )
+      {
+         exec( "ROLLBACK" );
+         return false;
+      }
+      in_transaction = true;
+   }
+
+   if( PQenterPipelineMode( _conn ) != 1 )
+   {
+      if( in_transaction )
+         exec( "ROLLBACK" );
+      return false;
+   }
+
+   bool all_ok = true;
+   bool alive = in_transaction || send( "BEGIN" );
+   size_t in_chunk = 0;
+   for( const auto& sql : batch.statements )
+   {
+      if( !alive || !all_ok )
+         break;
+      alive = send( sql );
+      if( alive && ++in_chunk == pipeline_chunk_size )
+      {
+         alive = sync() && collect( 1, all_ok );
+         in_chunk = 0;
+      }
+   }
+   if( alive && all_ok )
+      alive = send( "COMMIT" ) && sync() && collect( 1, all_ok );
+   if( alive && !all_ok )
+   {
+      bool ignored = true;
+      alive = send( "ROLLBACK" ) && sync() && collect( 1, ignored );
+   }
+   if( alive )
+      PQexitPipelineMode( _conn );
+   return alive && all_ok;
+}
+
+bool pg_writer::write_independent( const pg_write_batch& batch )
+{
+   if( PQenterPipelineMode( _conn ) != 1 )
+      return false;
+
+   // Every statement gets its own sync point, so each one is an implicit transaction of its own
+   // and a failing statement does not abort the rest
+   bool all_ok = true;
+   bool alive = true;
+   uint32_t pending = 0;
+   for( const auto& sql : batch.statements )
+   {
+      alive = send( sql ) && sync();
+      if( alive && ++pending == pipeline_chunk_size )
+      {
+         alive = collect( pending, all_ok );
+         pending = 0;
+      }
+      if( !alive )
+         break;
+   }
+   if( alive && pending > 0 )
+      alive = collect( pending, all_ok );
+   if( alive )
+      PQexitPipelineMode( _conn );
+   if( !all_ok )
+      wlog( "postgres_indexer writer: some statements of the batch for block ${b} failed",
+            ("b", batch.block_num) );
+   return alive;
+}
+
+#else // LIBPQ_HAS_PIPELINING
+
+bool pg_writer::write_atomic( const pg_write_batch& batch )
+{
+   std::string combined;
+   if( !batch.copy_data.empty() )
+   {
+      if( !exec( "BEGIN" ) )
+         return false;
+      if( !copy_in( batch.copy_statement, batch.copy_data ) )
+      {
+         exec( "ROLLBACK" );
+         return false;
+      }
+   }
+   else
+      combined = "BEGIN;\n";
+   for( const auto& sql : batch.statements )
+      combined += sql + ";\n";
+   combined += "COMMIT;";
+
+   if( exec( combined ) )
+      return true;
+   exec( "ROLLBACK;" );
+   return false;
+}
+
+bool pg_writer::write_independent( const pg_write_batch& batch )
+{
+   for( const auto& sql : batch.statements )
+      exec( sql );
+   return PQstatus( _conn ) == CONNECTION_OK;
+}
+
+#endif // LIBPQ_HAS_PIPELINING
+
+} } } // graphene::postgres_indexer::detail
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <graphene/postgres_indexer/postgres_indexer_plugin.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <libpq-fe.h>
+
+namespace graphene { namespace postgres_indexer { namespace detail {
+
+/**
+ * A unit of work for the writer thread. Atomic batches commit as one transaction and are
+ * retried on failure; non-atomic batches run each statement on its own and only log errors.
+ * An atomic batch may carry a binary COPY stream, which is loaded before its statements run.
+ */
+struct pg_write_batch
+{
+   std::vector<std::string> statements;
+   std::string              copy_statement;
+   std::string              copy_data;
+   bool                     atomic = true;
+   /// Highest block fully covered by this batch (0 if it does not advance the sync state)
+   uint32_t                 block_num = 0;
+};
+
+/**
+ * Drains a bounded queue of SQL batches on a dedicated thread with its own connection, so
+ * that block application never waits on PostgreSQL unless the queue is full.
+ */
+class pg_writer
+{
+   public:
+      pg_writer( const std::string& url, uint32_t capacity );
+      ~pg_writer();
+
+      /// Connect and start the writer thread, @p last_written_block is the persisted sync state
+      void start( uint32_t last_written_block );
+      /// Wait for the queue to drain, then stop the writer thread
+      void stop();
+
+      /// Enqueue a batch, blocking while the queue is full. Throws if the writer has failed.
+      void push( pg_write_batch&& batch );
+      /// Block until every queued batch has been written
+      void drain();
+
+      void set_head_block( uint32_t block_num ) { _head_block = block_num; }
+      writer_stats get_stats() const;
+
+   private:
+      void run();
+      bool connect();
+      bool ensure_connected();
+      bool write( const pg_write_batch& batch );
+      bool write_atomic( const pg_write_batch& batch );
+      bool write_independent( const pg_write_batch& batch );
+      bool exec( const std::string& sql );
+      bool copy_in( const std::string& statement, const std::string& data );
+#ifdef LIBPQ_HAS_PIPELINING
+      bool send( const std::string& sql );
+      bool sync();
+      bool collect( uint32_t syncs, bool& all_ok );
+#endif
+
+      const std::string            _url;
+      const uint32_t               _capacity;
+      PGconn*                      _conn = nullptr;
+      std::thread                  _thread;
+
+      mutable std::mutex           _mutex;
+      std::condition_variable      _not_empty;
+      std::condition_variable      _not_full;
+      std::condition_variable      _idle;
+      std::deque<pg_write_batch>   _queue;
+      bool                         _busy = false;
+      bool                         _stopping = false;
+      bool                         _failed = false;
+      std::string                  _failure;
+
+      std::atomic<uint32_t>        _head_block{ 0 };
+      std::atomic<uint32_t>        _last_queued_block{ 0 };
+      std::atomic<uint32_t>        _last_written_block{ 0 };
+      std::atomic<uint64_t>        _batches_written{ 0 };
+      std::atomic<uint64_t>        _statements_written{ 0 };
+      std::atomic<uint64_t>        _retries{ 0 };
+      std::atomic<uint64_t>        _producer_waits{ 0 };
+};
+
+} } } // graphene::postgres_indexer::detail
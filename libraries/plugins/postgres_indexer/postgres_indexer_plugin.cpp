@@ -20,8 +20,13 @@
 #include <graphene/chain/room_object.hpp>
 
 #include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
 #include <libpq-fe.h>
 
+#include "pg_copy.hxx"
+#include "pg_query_pool.hxx"
+#include "pg_writer.hxx"
+
 namespace graphene { namespace postgres_indexer {
 
 namespace detail
@@ -78,6 +83,45 @@ struct pg_operation_visitor {
    }
 };
 
+// Secondary indexes of the history table. COPY replay leaves them out during the initial catch-up and
+// builds them once caught up; the unique (account_id, sequence) index always stays, it is what makes
+// replayed rows idempotent. One statement each, the pipelined writer sends single statements only.
+static const char* const history_secondary_indexes_sql[] = {
+   "CREATE INDEX IF NOT EXISTS idx_oh_account_id ON indexer_operation_history(account_id)",
+   "CREATE INDEX IF NOT EXISTS idx_oh_account_op ON indexer_operation_history(account_id, operation_id_num DESC)",
+   "CREATE INDEX IF NOT EXISTS idx_oh_operation_id ON indexer_operation_history(operation_id)",
+   "CREATE INDEX IF NOT EXISTS idx_oh_block_num ON indexer_operation_history(block_num)"
+};
+static const char* const drop_history_secondary_indexes_sql[] = {
+   "DROP INDEX IF EXISTS idx_oh_account_id",
+   "DROP INDEX IF EXISTS idx_oh_account_op",
+   "DROP INDEX IF EXISTS idx_oh_operation_id",
+   "DROP INDEX IF EXISTS idx_oh_block_num"
+};
+
+static const char* history_copy_sql =
+   "COPY indexer_operation_history_staging FROM STDIN (FORMAT binary)";
+static const char* history_merge_sql =
+   "INSERT INTO indexer_operation_history "
+   "(account_id, operation_id, operation_id_num, sequence, trx_in_block, op_in_trx, "
+   "operation_result, virtual_op, op_type, op_object, op_string, block_num, block_time, trx_id, "
+   "fee_asset, fee_asset_name, fee_amount, fee_amount_units, "
+   "transfer_asset, transfer_asset_name, transfer_amount, transfer_amount_units, transfer_from, transfer_to, "
+   "fill_order_id, fill_account_id, fill_pays_asset_id, fill_pays_asset_name, fill_pays_amount, "
+   "fill_pays_amount_units, fill_receives_asset_id, fill_receives_asset_name, fill_receives_amount, "
+   "fill_receives_amount_units, fill_price, fill_price_units, fill_is_maker, op_packed) "
+   "SELECT account_id, operation_id, operation_id_num, sequence, trx_in_block, op_in_trx, "
+   "operation_result, virtual_op, op_type, op_object::jsonb, op_string, block_num, "
+   "to_timestamp(block_time_epoch), trx_id, "
+   "fee_asset, fee_asset_name, fee_amount, fee_amount_units, "
+   "transfer_asset, transfer_asset_name, transfer_amount, transfer_amount_units, transfer_from, transfer_to, "
+   "fill_order_id, fill_account_id, fill_pays_asset_id, fill_pays_asset_name, fill_pays_amount, "
+   "fill_pays_amount_units, fill_receives_asset_id, fill_receives_asset_name, fill_receives_amount, "
+   "fill_receives_amount_units, fill_price, fill_price_units, fill_is_maker, op_packed "
+   "FROM indexer_operation_history_staging "
+   "ON CONFLICT (account_id, sequence) DO NOTHING";
+static const int16_t history_copy_fields = 38;
+
 class postgres_indexer_plugin_impl
 {
    public:
@@ -87,6 +131,8 @@ class postgres_indexer_plugin_impl
 
       ~postgres_indexer_plugin_impl()
       {
+         _writer.reset();
+         _query_pool.reset();
          if (pg_conn) {
             PQfinish(pg_conn);
             pg_conn = nullptr;
@@ -104,7 +150,10 @@ class postgres_indexer_plugin_impl
       std::string escape_string(const std::string& input);
       bool execute_sql(const std::string& sql);
       PGresult* execute_query(const std::string& sql);
+      uint32_t read_sync_state();
+      size_t buffered_statements() const;
       void flush_bulk_buffer();
+      bool complete_block(const signed_block& b);
 
       // --- Operation history (from elasticsearch) ---
       bool update_account_histories(const signed_block& b);
@@ -126,6 +175,9 @@ class postgres_indexer_plugin_impl
       void cleanObjects(const account_transaction_history_id_type& ath,
                         const account_id_type& account_id);
       void createInsertLine(const account_transaction_history_object& ath);
+      void createCopyRow(const account_transaction_history_object& ath);
+      bool history_indexes_exist();
+      void update_history_indexes();
 
       // --- Blockchain objects (from es_objects) ---
       bool genesis();
@@ -171,17 +223,11 @@ class postgres_indexer_plugin_impl
                                    uint32_t block_num, fc::time_point_sec block_time,
                                    const std::string& trx_id);
 
-      // --- Query API ---
-      operation_history_object pg_get_operation_by_id(operation_history_id_type id);
-      vector<operation_history_object> pg_get_account_history(
-         const account_id_type account_id,
-         operation_history_id_type stop,
-         unsigned limit,
-         operation_history_id_type start);
-
       // --- State ---
       postgres_indexer_plugin& _self;
       PGconn* pg_conn = nullptr;
+      std::unique_ptr<pg_writer> _writer;
+      std::unique_ptr<pg_query_pool> _query_pool;
       primary_index<operation_history_index>* _oho_index = nullptr;
 
       // Config
@@ -194,6 +240,9 @@ class postgres_indexer_plugin_impl
       uint32_t _start_after_block = 0;
       mode _mode = mode::only_save;
       uint32_t _content_start_block = 0;
+      uint32_t _queue_size = 64;
+      uint32_t _query_connections = 4;
+      bool _copy_replay = false;
 
       // Object type toggles
       bool _index_proposals = true;
@@ -208,6 +257,13 @@ class postgres_indexer_plugin_impl
       bool is_sync = false;
       uint32_t limit_documents = 0;
       std::vector<std::string> bulk_sql_buffer;
+      std::vector<std::string> content_sql_buffer;
+      pg_binary_copy history_copy;
+      enum class index_state { unknown, deferred, built };
+      index_state history_indexes = index_state::unknown;
+      uint32_t _resume_block = 0;             // last block found in indexer_sync_state at startup
+      uint32_t _last_complete_block = 0;      // last block whose history and content are entirely in the buffer
+      fc::time_point_sec _last_complete_block_time;
 
       // Current operation data (reused across calls within a block)
       int16_t op_type = 0;
@@ -218,6 +274,7 @@ class postgres_indexer_plugin_impl
          uint32_t virtual_op = 0;
          std::string op_string;
          std::string op_object_json;
+         std::vector<char> op_packed;
       } current_op;
 
       struct {
@@ -369,10 +426,6 @@ bool postgres_indexer_plugin_impl::create_tables()
          created_at              TIMESTAMP DEFAULT CURRENT_TIMESTAMP
       );
 
-      CREATE INDEX IF NOT EXISTS idx_oh_account_id ON indexer_operation_history(account_id);
-      CREATE INDEX IF NOT EXISTS idx_oh_account_op ON indexer_operation_history(account_id, operation_id_num DESC);
-      CREATE INDEX IF NOT EXISTS idx_oh_operation_id ON indexer_operation_history(operation_id);
-      CREATE INDEX IF NOT EXISTS idx_oh_block_num ON indexer_operation_history(block_num);
       CREATE UNIQUE INDEX IF NOT EXISTS idx_oh_account_seq ON indexer_operation_history(account_id, sequence);
 
       -- Blockchain object tables (replaces es_objects plugin)
@@ -572,6 +625,7 @@ bool postgres_indexer_plugin_impl::create_tables()
       -- Migrations for existing deployments
       ALTER TABLE indexer_rooms ADD COLUMN IF NOT EXISTS current_epoch INTEGER NOT NULL DEFAULT 0;
       ALTER TABLE indexer_content_cards ADD COLUMN IF NOT EXISTS key_epoch INTEGER NOT NULL DEFAULT 0;
+      ALTER TABLE indexer_operation_history ADD COLUMN IF NOT EXISTS op_packed BYTEA;
 
       -- Sync state bookkeeping
       CREATE TABLE IF NOT EXISTS indexer_sync_state (
@@ -582,6 +636,49 @@ bool postgres_indexer_plugin_impl::create_tables()
       );
       INSERT INTO indexer_sync_state (id, last_block_num) VALUES (1, 0) ON CONFLICT (id) DO NOTHING;
 
+      -- Staging table for binary COPY replay, merged into indexer_operation_history per batch
+      CREATE UNLOGGED TABLE IF NOT EXISTS indexer_operation_history_staging (
+         account_id                 TEXT,
+         operation_id               TEXT,
+         operation_id_num           BIGINT,
+         sequence                   BIGINT,
+         trx_in_block               INTEGER,
+         op_in_trx                  INTEGER,
+         operation_result           TEXT,
+         virtual_op                 INTEGER,
+         op_type                    SMALLINT,
+         op_object                  TEXT,
+         op_string                  TEXT,
+         block_num                  BIGINT,
+         block_time_epoch           BIGINT,
+         trx_id                     TEXT,
+         fee_asset                  TEXT,
+         fee_asset_name             TEXT,
+         fee_amount                 BIGINT,
+         fee_amount_units           DOUBLE PRECISION,
+         transfer_asset             TEXT,
+         transfer_asset_name        TEXT,
+         transfer_amount            BIGINT,
+         transfer_amount_units      DOUBLE PRECISION,
+         transfer_from              TEXT,
+         transfer_to                TEXT,
+         fill_order_id              TEXT,
+         fill_account_id            TEXT,
+         fill_pays_asset_id         TEXT,
+         fill_pays_asset_name       TEXT,
+         fill_pays_amount           BIGINT,
+         fill_pays_amount_units     DOUBLE PRECISION,
+         fill_receives_asset_id     TEXT,
+         fill_receives_asset_name   TEXT,
+         fill_receives_amount       BIGINT,
+         fill_receives_amount_units DOUBLE PRECISION,
+         fill_price                 DOUBLE PRECISION,
+         fill_price_units           DOUBLE PRECISION,
+         fill_is_maker              BOOLEAN,
+         op_packed                  BYTEA
+      );
+      ALTER TABLE indexer_operation_history_staging ADD COLUMN IF NOT EXISTS op_packed BYTEA;
+
    )";
 
    if (!execute_sql(sql)) {
@@ -589,6 +686,16 @@ bool postgres_indexer_plugin_impl::create_tables()
       return false;
    }
 
+   // With COPY replay the secondary indexes are managed by update_history_indexes()
+   if (!_copy_replay || _mode == mode::only_query) {
+      for (const char* sql : history_secondary_indexes_sql) {
+         if (!execute_sql(sql)) {
+            elog("Failed to create operation history indexes");
+            return false;
+         }
+      }
+   }
+
    // Add UNIQUE constraints on object tables only when keeping current state
    if (_keep_only_current) {
       const std::string unique_sql = R"(
@@ -623,36 +730,78 @@ bool postgres_indexer_plugin_impl::create_tables()
    return true;
 }
 
-void postgres_indexer_plugin_impl::flush_bulk_buffer()
+uint32_t postgres_indexer_plugin_impl::read_sync_state()
 {
-   if (bulk_sql_buffer.empty()) return;
+   PGresult* res = execute_query("SELECT last_block_num FROM indexer_sync_state WHERE id = 1");
+   if (!res) return 0;
 
-   std::string combined = "BEGIN;\n";
-   for (const auto& sql : bulk_sql_buffer)
-   {
-      combined += sql + ";\n";
-   }
+   uint32_t last_block_num = 0;
+   if (PQntuples(res) > 0 && !PQgetisnull(res, 0, 0))
+      last_block_num = std::stoul(PQgetvalue(res, 0, 0));
+   PQclear(res);
+   return last_block_num;
+}
 
-   // Update sync state with current block info
-   if (current_block.block_num > 0) {
-      combined += "UPDATE indexer_sync_state SET last_block_num = "
-         + std::to_string(current_block.block_num)
+size_t postgres_indexer_plugin_impl::buffered_statements() const
+{
+   return bulk_sql_buffer.size() + history_copy.rows() + content_sql_buffer.size();
+}
+
+void postgres_indexer_plugin_impl::flush_bulk_buffer()
+{
+   if (buffered_statements() == 0 || !_writer) return;
+
+   pg_write_batch batch;
+   if (!history_copy.empty()) {
+      batch.copy_statement = history_copy_sql;
+      batch.copy_data = history_copy.finish();
+      batch.statements.push_back(history_merge_sql);
+      batch.statements.push_back("TRUNCATE indexer_operation_history_staging");
+      batch.statements.insert(batch.statements.end(),
+         std::make_move_iterator(bulk_sql_buffer.begin()), std::make_move_iterator(bulk_sql_buffer.end()));
+      bulk_sql_buffer.clear();
+   }
+   else
+      batch.statements.swap(bulk_sql_buffer);
+
+   // Content is only buffered once the history of its block is complete, so it never belongs to a
+   // block past the sync state below and commits together with it
+   batch.statements.insert(batch.statements.end(),
+      std::make_move_iterator(content_sql_buffer.begin()), std::make_move_iterator(content_sql_buffer.end()));
+   content_sql_buffer.clear();
+
+   // Only blocks whose history and content are entirely in this batch advance the sync state, a block
+   // flushed halfway is written again after a restart and deduplicated by the unique (account_id, sequence)
+   if (_last_complete_block > _resume_block) {
+      batch.statements.push_back("UPDATE indexer_sync_state SET last_block_num = "
+         + std::to_string(_last_complete_block)
          + ", last_block_time = to_timestamp("
-         + std::to_string(current_block.block_time.sec_since_epoch())
-         + "), updated_at = CURRENT_TIMESTAMP WHERE id = 1;\n";
+         + std::to_string(_last_complete_block_time.sec_since_epoch())
+         + "), updated_at = CURRENT_TIMESTAMP WHERE id = 1");
+      batch.block_num = _last_complete_block;
    }
 
-   combined += "COMMIT;";
+   _writer->push(std::move(batch));
+}
+
+bool postgres_indexer_plugin_impl::complete_block(const signed_block& b)
+{
+   _last_complete_block = b.block_num();
+   _last_complete_block_time = b.timestamp;
+   if (_writer)
+      _writer->set_head_block(b.block_num());
 
-   if (!execute_sql(combined))
+   // Flush at end of block when in sync mode, during replay once the batch is full
+   if (buffered_statements() > 0 && (is_sync || buffered_statements() >= limit_documents))
    {
-      elog("Bulk flush failed for ${n} statements", ("n", bulk_sql_buffer.size()));
-      execute_sql("ROLLBACK;");
-      FC_THROW_EXCEPTION(graphene::chain::plugin_exception,
-         "Error in bulk flush to PostgreSQL.");
+      try {
+         flush_bulk_buffer();
+      } catch (...) {
+         return false;
+      }
    }
 
-   bulk_sql_buffer.clear();
+   return true;
 }
 
 // ============================================================================
@@ -673,6 +822,40 @@ void postgres_indexer_plugin_impl::checkState(const fc::time_point_sec& block_ti
    }
 }
 
+bool postgres_indexer_plugin_impl::history_indexes_exist()
+{
+   PGresult* res = execute_query("SELECT 1 FROM pg_indexes WHERE indexname = 'idx_oh_account_id'");
+   if (!res) return false;
+   bool exist = PQntuples(res) > 0;
+   PQclear(res);
+   return exist;
+}
+
+void postgres_indexer_plugin_impl::update_history_indexes()
+{
+   if (!_copy_replay || !_writer) return;
+
+   // Only the initial catch-up goes without the indexes; a live node lagging for a moment keeps them,
+   // rebuilding them on a large table would take far longer than the lag
+   if (!is_sync && history_indexes == index_state::unknown) {
+      ilog("postgres_indexer: dropping operation history indexes for COPY replay");
+      pg_write_batch batch;
+      for (const char* sql : drop_history_secondary_indexes_sql)
+         batch.statements.push_back(sql);
+      _writer->push(std::move(batch));
+      history_indexes = index_state::deferred;
+   }
+   else if (is_sync && history_indexes != index_state::built) {
+      ilog("postgres_indexer: caught up, building operation history indexes");
+      flush_bulk_buffer();
+      pg_write_batch batch;
+      for (const char* sql : history_secondary_indexes_sql)
+         batch.statements.push_back(sql);
+      _writer->push(std::move(batch));
+      history_indexes = index_state::built;
+   }
+}
+
 void postgres_indexer_plugin_impl::getOperationType(const optional<operation_history_object>& oho)
 {
    if (!oho->id.is_null())
@@ -691,8 +874,11 @@ void postgres_indexer_plugin_impl::doOperationHistory(const optional<operation_h
       oho->op.visit(fc::from_static_variant(op_object, FC_PACK_MAX_DEPTH));
       current_op.op_object_json = fc::json::to_string(op_object, fc::json::legacy_generator);
    }
-   if (_operation_string)
+   if (_operation_string) {
       current_op.op_string = fc::json::to_string(oho->op);
+      // Binary form of the whole object, decoded directly by the query connections
+      current_op.op_packed = fc::raw::pack(*oho);
+   }
 }
 
 void postgres_indexer_plugin_impl::doBlock(uint32_t trx_in_block, const signed_block& b)
@@ -770,6 +956,7 @@ const account_transaction_history_object& postgres_indexer_plugin_impl::addNewEn
    graphene::chain::database& db = database();
    const auto& ath = db.create<account_transaction_history_object>([&](account_transaction_history_object& obj) {
       obj.operation_id = oho->id;
+      obj.op_type = oho->op.which();
       obj.account = account_id;
       obj.sequence = stats_obj.total_ops + 1;
       obj.next = stats_obj.most_recent_op;
@@ -821,7 +1008,7 @@ void postgres_indexer_plugin_impl::createInsertLine(const account_transaction_hi
 
    std::string sql = "INSERT INTO indexer_operation_history "
       "(account_id, operation_id, operation_id_num, sequence, trx_in_block, op_in_trx, "
-      "operation_result, virtual_op, op_type, op_object, op_string, "
+      "operation_result, virtual_op, op_type, op_object, op_string, op_packed, "
       "block_num, block_time, trx_id";
 
    if (_visitor) {
@@ -855,6 +1042,11 @@ void postgres_indexer_plugin_impl::createInsertLine(const account_transaction_hi
    else
       sql += "NULL, ";
 
+   if (_operation_string && !current_op.op_packed.empty())
+      sql += "decode('" + fc::to_hex(current_op.op_packed.data(), current_op.op_packed.size()) + "', 'hex'), ";
+   else
+      sql += "NULL, ";
+
    sql += std::to_string(current_block.block_num) + ", "
       "to_timestamp(" + std::to_string(current_block.block_time.sec_since_epoch()) + "), "
       + escape_string(current_block.trx_id);
@@ -890,6 +1082,68 @@ void postgres_indexer_plugin_impl::createInsertLine(const account_transaction_hi
    bulk_sql_buffer.push_back(sql);
 }
 
+void postgres_indexer_plugin_impl::createCopyRow(const account_transaction_history_object& ath)
+{
+   history_copy.begin_row(history_copy_fields);
+   history_copy.add_text(std::string(object_id_type(ath.account)));
+   history_copy.add_text(std::string(object_id_type(ath.operation_id)));
+   history_copy.add_int64(ath.operation_id.instance.value);
+   history_copy.add_int64(ath.sequence);
+   history_copy.add_int32(current_op.trx_in_block);
+   history_copy.add_int32(current_op.op_in_trx);
+   history_copy.add_text(current_op.operation_result);
+   history_copy.add_int32(current_op.virtual_op);
+   history_copy.add_int16(op_type);
+
+   if (_operation_object && !current_op.op_object_json.empty())
+      history_copy.add_text(current_op.op_object_json);
+   else
+      history_copy.add_null();
+
+   if (_operation_string && !current_op.op_string.empty())
+      history_copy.add_text(current_op.op_string);
+   else
+      history_copy.add_null();
+
+   history_copy.add_int64(current_block.block_num);
+   history_copy.add_int64(current_block.block_time.sec_since_epoch());
+   history_copy.add_text(current_block.trx_id);
+
+   if (_visitor) {
+      history_copy.add_text(current_visitor.fee_asset);
+      history_copy.add_text(current_visitor.fee_asset_name);
+      history_copy.add_int64(current_visitor.fee_amount);
+      history_copy.add_double(current_visitor.fee_amount_units);
+      history_copy.add_text(current_visitor.transfer_asset);
+      history_copy.add_text(current_visitor.transfer_asset_name);
+      history_copy.add_int64(current_visitor.transfer_amount);
+      history_copy.add_double(current_visitor.transfer_amount_units);
+      history_copy.add_text(current_visitor.transfer_from);
+      history_copy.add_text(current_visitor.transfer_to);
+      history_copy.add_text(current_visitor.fill_order_id);
+      history_copy.add_text(current_visitor.fill_account_id);
+      history_copy.add_text(current_visitor.fill_pays_asset_id);
+      history_copy.add_text(current_visitor.fill_pays_asset_name);
+      history_copy.add_int64(current_visitor.fill_pays_amount);
+      history_copy.add_double(current_visitor.fill_pays_amount_units);
+      history_copy.add_text(current_visitor.fill_receives_asset_id);
+      history_copy.add_text(current_visitor.fill_receives_asset_name);
+      history_copy.add_int64(current_visitor.fill_receives_amount);
+      history_copy.add_double(current_visitor.fill_receives_amount_units);
+      history_copy.add_double(current_visitor.fill_price);
+      history_copy.add_double(current_visitor.fill_price_units);
+      history_copy.add_bool(current_visitor.fill_is_maker);
+   } else {
+      for (int i = 0; i < 23; ++i)
+         history_copy.add_null();
+   }
+
+   if (_operation_string && !current_op.op_packed.empty())
+      history_copy.add_bytes(current_op.op_packed.data(), current_op.op_packed.size());
+   else
+      history_copy.add_null();
+}
+
 bool postgres_indexer_plugin_impl::add_to_postgres(const account_id_type account_id,
                                                     const optional<operation_history_object>& oho,
                                                     const uint32_t block_number)
@@ -898,12 +1152,15 @@ bool postgres_indexer_plugin_impl::add_to_postgres(const account_id_type account
    const auto& ath = addNewEntry(stats_obj, account_id, oho);
    growStats(stats_obj, ath);
 
-   if (block_number > _start_after_block) {
-      createInsertLine(ath);
+   if (block_number > _start_after_block && block_number > _resume_block) {
+      if (_copy_replay && !is_sync)
+         createCopyRow(ath);
+      else
+         createInsertLine(ath);
    }
    cleanObjects(ath.id, account_id);
 
-   if (bulk_sql_buffer.size() >= limit_documents) {
+   if (buffered_statements() >= limit_documents) {
       try {
          flush_bulk_buffer();
       } catch (...) {
@@ -917,6 +1174,7 @@ bool postgres_indexer_plugin_impl::add_to_postgres(const account_id_type account
 bool postgres_indexer_plugin_impl::update_account_histories(const signed_block& b)
 {
    checkState(b.timestamp);
+   update_history_indexes();
 
    graphene::chain::database& db = database();
    const vector<optional<operation_history_object>>& hist = db.get_applied_operations();
@@ -1000,16 +1258,6 @@ bool postgres_indexer_plugin_impl::update_account_histories(const signed_block&
       }
    }
 
-   // Flush at end of block when in sync mode
-   if (is_sync && !bulk_sql_buffer.empty())
-   {
-      try {
-         flush_bulk_buffer();
-      } catch (...) {
-         return false;
-      }
-   }
-
    return true;
 }
 
@@ -1212,13 +1460,7 @@ bool postgres_indexer_plugin_impl::genesis()
       });
    }
 
-   // Flush genesis data
-   try {
-      flush_bulk_buffer();
-   } catch (...) {
-      FC_THROW_EXCEPTION(graphene::chain::plugin_exception, "Error inserting genesis data.");
-   }
-
+   // Genesis data is flushed with block 1, so it only commits together with the sync state that skips it
    return true;
 }
 
@@ -1229,7 +1471,9 @@ bool postgres_indexer_plugin_impl::index_database(const vector<object_id_type>&
    obj_block_time = db.head_block_time();
    obj_block_number = db.head_block_num();
 
-   if (obj_block_number > _start_after_block) {
+   // Objects changed in the last synced block are queued after its history was flushed, so they
+   // are only known to be written for blocks before it
+   if (obj_block_number > _start_after_block && obj_block_number >= _resume_block) {
 
       uint32_t obj_limit_documents = 0;
       if ((fc::time_point::now() - obj_block_time) < fc::seconds(30))
@@ -1295,7 +1539,7 @@ bool postgres_indexer_plugin_impl::index_database(const vector<object_id_type>&
          }
       }
 
-      if (bulk_sql_buffer.size() >= obj_limit_documents) {
+      if (buffered_statements() >= obj_limit_documents) {
          try {
             flush_bulk_buffer();
          } catch (...) {
@@ -1324,7 +1568,7 @@ void postgres_indexer_plugin_impl::on_block_content(const signed_block& b)
    if (!pg_conn) return;
 
    uint32_t block_num = b.block_num();
-   if (block_num < _content_start_block) return;
+   if (block_num < _content_start_block || block_num <= _resume_block) return;
 
    graphene::chain::database& db = database();
    const auto& hist = db.get_applied_operations();
@@ -1449,9 +1693,7 @@ void postgres_indexer_plugin_impl::handle_content_card_create(
       "storage_data = EXCLUDED.storage_data, file_name = EXCLUDED.file_name, "
       "file_size = EXCLUDED.file_size, room_id = EXCLUDED.room_id, key_epoch = EXCLUDED.key_epoch";
 
-   if (!execute_sql(sql)) {
-      elog("Failed to insert content_card_create: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 }
 
 void postgres_indexer_plugin_impl::handle_content_card_update(
@@ -1510,9 +1752,7 @@ void postgres_indexer_plugin_impl::handle_content_card_update(
       "block_num = EXCLUDED.block_num, "
       "block_time = EXCLUDED.block_time, operation_type = 42";
 
-   if (!execute_sql(sql)) {
-      elog("Failed to insert content_card_update: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 }
 
 void postgres_indexer_plugin_impl::handle_content_card_remove(
@@ -1528,9 +1768,7 @@ void postgres_indexer_plugin_impl::handle_content_card_remove(
       "operation_type = 43 "
       "WHERE content_card_id = " + escape_string(content_id);
 
-   if (!execute_sql(sql)) {
-      elog("Failed to update content_card_remove: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 }
 
 void postgres_indexer_plugin_impl::handle_permission_create(
@@ -1559,9 +1797,7 @@ void postgres_indexer_plugin_impl::handle_permission_create(
       "ON CONFLICT (permission_id) DO UPDATE SET "
       "permission_type = EXCLUDED.permission_type, content_key = EXCLUDED.content_key";
 
-   if (!execute_sql(sql)) {
-      elog("Failed to insert permission_create: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 }
 
 void postgres_indexer_plugin_impl::handle_permission_create_many(
@@ -1600,9 +1836,7 @@ void postgres_indexer_plugin_impl::handle_permission_create_many(
          "ON CONFLICT (permission_id) DO UPDATE SET "
          "permission_type = EXCLUDED.permission_type, content_key = EXCLUDED.content_key";
 
-      if (!execute_sql(sql)) {
-         elog("Failed to insert permission_create_many: block ${b}", ("b", block_num));
-      }
+      content_sql_buffer.push_back(sql);
    }
 }
 
@@ -1619,9 +1853,7 @@ void postgres_indexer_plugin_impl::handle_permission_remove(
       "operation_type = 45 "
       "WHERE permission_id = " + escape_string(permission_id);
 
-   if (!execute_sql(sql)) {
-      elog("Failed to update permission_remove: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 }
 
 void postgres_indexer_plugin_impl::handle_room_create(
@@ -1646,9 +1878,7 @@ void postgres_indexer_plugin_impl::handle_room_create(
       "ON CONFLICT (room_id) DO UPDATE SET "
       "name = EXCLUDED.name, room_key = EXCLUDED.room_key, current_epoch = EXCLUDED.current_epoch";
 
-   if (!execute_sql(sql)) {
-      elog("Failed to insert room_create: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 
    // Create epoch 0 record for the owner
    std::string epoch_sql = "INSERT INTO indexer_room_key_epochs "
@@ -1660,9 +1890,7 @@ void postgres_indexer_plugin_impl::handle_room_create(
       "to_timestamp(" + std::to_string(block_time.sec_since_epoch()) + ")) "
       "ON CONFLICT (room_id, epoch, participant) DO UPDATE SET encrypted_key = EXCLUDED.encrypted_key";
 
-   if (!execute_sql(epoch_sql)) {
-      elog("Failed to insert room_create epoch 0: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(epoch_sql);
 }
 
 void postgres_indexer_plugin_impl::handle_room_update(
@@ -1678,9 +1906,7 @@ void postgres_indexer_plugin_impl::handle_room_update(
       "operation_type = 66 "
       "WHERE room_id = " + escape_string(room_id);
 
-   if (!execute_sql(sql)) {
-      elog("Failed to update room_update: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 }
 
 void postgres_indexer_plugin_impl::handle_room_add_participant(
@@ -1705,9 +1931,7 @@ void postgres_indexer_plugin_impl::handle_room_add_participant(
       "ON CONFLICT (participant_id) DO UPDATE SET "
       "content_key = EXCLUDED.content_key, is_removed = FALSE";
 
-   if (!execute_sql(sql)) {
-      elog("Failed to insert room_add_participant: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 
    // Insert current epoch key record
    uint32_t current_epoch = 0;
@@ -1723,9 +1947,7 @@ void postgres_indexer_plugin_impl::handle_room_add_participant(
       "to_timestamp(" + std::to_string(block_time.sec_since_epoch()) + ")) "
       "ON CONFLICT (room_id, epoch, participant) DO UPDATE SET encrypted_key = EXCLUDED.encrypted_key";
 
-   if (!execute_sql(epoch_sql)) {
-      elog("Failed to insert room_add_participant epoch key: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(epoch_sql);
 
    // Insert historical epoch keys if provided
    for (const auto& ek : op.epoch_keys) {
@@ -1739,9 +1961,7 @@ void postgres_indexer_plugin_impl::handle_room_add_participant(
          "to_timestamp(" + std::to_string(block_time.sec_since_epoch()) + ")) "
          "ON CONFLICT (room_id, epoch, participant) DO UPDATE SET encrypted_key = EXCLUDED.encrypted_key";
 
-      if (!execute_sql(hist_sql)) {
-         elog("Failed to insert room_add_participant historical epoch key: block ${b}", ("b", block_num));
-      }
+      content_sql_buffer.push_back(hist_sql);
    }
 }
 
@@ -1758,9 +1978,7 @@ void postgres_indexer_plugin_impl::handle_room_remove_participant(
       "operation_type = 68 "
       "WHERE participant_id = " + escape_string(participant_id);
 
-   if (!execute_sql(sql)) {
-      elog("Failed to update room_remove_participant: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 }
 
 void postgres_indexer_plugin_impl::handle_room_rotate_key(
@@ -1783,9 +2001,7 @@ void postgres_indexer_plugin_impl::handle_room_rotate_key(
       "operation_type = 69 "
       "WHERE room_id = " + escape_string(room_id);
 
-   if (!execute_sql(sql)) {
-      elog("Failed to update room_rotate_key: block ${b}", ("b", block_num));
-   }
+   content_sql_buffer.push_back(sql);
 
    // Update each participant's content_key in indexer_room_participants
    for (const auto& pk : op.participant_keys) {
@@ -1797,9 +2013,7 @@ void postgres_indexer_plugin_impl::handle_room_rotate_key(
          "AND participant = " + escape_string(part_account) + " "
          "AND is_removed = FALSE";
 
-      if (!execute_sql(upd_sql)) {
-         elog("Failed to update participant key during rotate: block ${b}", ("b", block_num));
-      }
+      content_sql_buffer.push_back(upd_sql);
 
       // Insert epoch record for each participant
       std::string epoch_sql = "INSERT INTO indexer_room_key_epochs "
@@ -1812,134 +2026,7 @@ void postgres_indexer_plugin_impl::handle_room_rotate_key(
          "to_timestamp(" + std::to_string(block_time.sec_since_epoch()) + ")) "
          "ON CONFLICT (room_id, epoch, participant) DO UPDATE SET encrypted_key = EXCLUDED.encrypted_key";
 
-      if (!execute_sql(epoch_sql)) {
-         elog("Failed to insert epoch key during rotate: block ${b}", ("b", block_num));
-      }
-   }
-}
-
-// ============================================================================
-// Query API (replaces elasticsearch query methods)
-// ============================================================================
-
-operation_history_object postgres_indexer_plugin_impl::pg_get_operation_by_id(operation_history_id_type id)
-{
-   const string operation_id_string = std::string(object_id_type(id));
-
-   std::string sql = "SELECT operation_id, op_string, operation_result, block_num, "
-      "trx_in_block, op_in_trx, virtual_op "
-      "FROM indexer_operation_history "
-      "WHERE operation_id = " + escape_string(operation_id_string) + " "
-      "LIMIT 1";
-
-   PGresult* res = execute_query(sql);
-   if (!res || PQntuples(res) == 0) {
-      if (res) PQclear(res);
-      FC_THROW_EXCEPTION(fc::exception, "Operation not found: ${id}", ("id", operation_id_string));
-   }
-
-   try {
-      operation_history_object result;
-
-      // Parse operation_id
-      std::string op_id_str = PQgetvalue(res, 0, 0);
-      fc::variant op_id_var(op_id_str);
-      fc::from_variant(op_id_var, result.id, GRAPHENE_MAX_NESTED_OBJECTS);
-
-      // Parse operation
-      if (!PQgetisnull(res, 0, 1)) {
-         std::string op_str = PQgetvalue(res, 0, 1);
-         auto op_var = fc::json::from_string(op_str);
-         fc::from_variant(op_var, result.op, GRAPHENE_MAX_NESTED_OBJECTS);
-      }
-
-      // Parse result
-      if (!PQgetisnull(res, 0, 2)) {
-         std::string result_str = PQgetvalue(res, 0, 2);
-         auto result_var = fc::json::from_string(result_str);
-         fc::from_variant(result_var, result.result, GRAPHENE_MAX_NESTED_OBJECTS);
-      }
-
-      result.block_num = std::stoul(PQgetvalue(res, 0, 3));
-      result.trx_in_block = std::stoul(PQgetvalue(res, 0, 4));
-      result.op_in_trx = std::stoul(PQgetvalue(res, 0, 5));
-      result.virtual_op = std::stoul(PQgetvalue(res, 0, 6));
-
-      PQclear(res);
-      return result;
-   } catch (...) {
-      PQclear(res);
-      throw;
-   }
-}
-
-vector<operation_history_object> postgres_indexer_plugin_impl::pg_get_account_history(
-   const account_id_type account_id,
-   operation_history_id_type stop,
-   unsigned limit,
-   operation_history_id_type start)
-{
-   const string account_id_string = std::string(object_id_type(account_id));
-   const auto stop_number = stop.instance.value;
-   const auto start_number = start.instance.value;
-
-   std::string sql = "SELECT operation_id, op_string, operation_result, block_num, "
-      "trx_in_block, op_in_trx, virtual_op "
-      "FROM indexer_operation_history "
-      "WHERE account_id = " + escape_string(account_id_string);
-
-   if (stop_number == 0)
-      sql += " AND operation_id_num >= " + fc::to_string(stop_number)
-           + " AND operation_id_num <= " + fc::to_string(start_number);
-   else if (stop_number > 0)
-      sql += " AND operation_id_num > " + fc::to_string(stop_number)
-           + " AND operation_id_num <= " + fc::to_string(start_number);
-
-   sql += " ORDER BY operation_id_num DESC LIMIT " + fc::to_string(limit);
-
-   PGresult* res = execute_query(sql);
-   vector<operation_history_object> result;
-
-   if (!res) return result;
-
-   try {
-      int nrows = PQntuples(res);
-      for (int i = 0; i < nrows; i++)
-      {
-         operation_history_object obj;
-
-         // Parse operation_id
-         std::string op_id_str = PQgetvalue(res, i, 0);
-         fc::variant op_id_var(op_id_str);
-         fc::from_variant(op_id_var, obj.id, GRAPHENE_MAX_NESTED_OBJECTS);
-
-         // Parse operation
-         if (!PQgetisnull(res, i, 1)) {
-            std::string op_str = PQgetvalue(res, i, 1);
-            auto op_var = fc::json::from_string(op_str);
-            fc::from_variant(op_var, obj.op, GRAPHENE_MAX_NESTED_OBJECTS);
-         }
-
-         // Parse result
-         if (!PQgetisnull(res, i, 2)) {
-            std::string result_str = PQgetvalue(res, i, 2);
-            auto result_var = fc::json::from_string(result_str);
-            fc::from_variant(result_var, obj.result, GRAPHENE_MAX_NESTED_OBJECTS);
-         }
-
-         obj.block_num = std::stoul(PQgetvalue(res, i, 3));
-         obj.trx_in_block = std::stoul(PQgetvalue(res, i, 4));
-         obj.op_in_trx = std::stoul(PQgetvalue(res, i, 5));
-         obj.virtual_op = std::stoul(PQgetvalue(res, i, 6));
-
-         result.push_back(obj);
-      }
-
-      PQclear(res);
-      return result;
-   } catch (...) {
-      PQclear(res);
-      throw;
+      content_sql_buffer.push_back(epoch_sql);
    }
 }
 
@@ -2005,6 +2092,13 @@ void postgres_indexer_plugin::plugin_set_program_options(
          "Keep only current state of objects (default: true)")
       ("postgres-indexer-content-start-block", boost::program_options::value<uint32_t>(),
          "Start content card/permission indexing from this block (default: 0)")
+      ("postgres-indexer-copy-replay", boost::program_options::value<bool>(),
+         "Load operation history with binary COPY while replaying, and build its secondary indexes "
+         "only after catching up (default: false)")
+      ("postgres-indexer-query-connections", boost::program_options::value<uint32_t>(),
+         "Number of read-only connections serving history queries (default: 4)")
+      ("postgres-indexer-queue-size", boost::program_options::value<uint32_t>(),
+         "Number of SQL batches buffered for the writer thread before block application waits (default: 64)")
       ;
    cfg.add(cli);
 }
@@ -2055,6 +2149,12 @@ void postgres_indexer_plugin::plugin_initialize(const boost::program_options::va
       my->_keep_only_current = options["postgres-indexer-keep-only-current"].as<bool>();
    if (options.count("postgres-indexer-content-start-block") > 0)
       my->_content_start_block = options["postgres-indexer-content-start-block"].as<uint32_t>();
+   if (options.count("postgres-indexer-copy-replay") > 0)
+      my->_copy_replay = options["postgres-indexer-copy-replay"].as<bool>();
+   if (options.count("postgres-indexer-query-connections") > 0)
+      my->_query_connections = options["postgres-indexer-query-connections"].as<uint32_t>();
+   if (options.count("postgres-indexer-queue-size") > 0)
+      my->_queue_size = options["postgres-indexer-queue-size"].as<uint32_t>();
 
    // Validate mode constraints
    if (my->_mode == mode::all && !my->_operation_string)
@@ -2065,8 +2165,32 @@ void postgres_indexer_plugin::plugin_initialize(const boost::program_options::va
    my->_oho_index = database().add_index<primary_index<operation_history_index>>();
    database().add_index<primary_index<account_transaction_history_index>>();
 
+   // Replay runs before plugin_startup(), so the connection and the writer have to be ready here
+   if (!my->connect_to_postgres()) {
+      FC_THROW_EXCEPTION(fc::exception, "Failed to connect to PostgreSQL at ${url}",
+                         ("url", my->_postgres_url));
+   }
+
+   if (!my->create_tables()) {
+      FC_THROW_EXCEPTION(fc::exception, "Failed to create PostgreSQL tables");
+   }
+
+   if (my->_mode != mode::only_save) {
+      my->_query_pool = std::make_unique<detail::pg_query_pool>(my->_postgres_url, my->_query_connections);
+      my->_query_pool->open();
+   }
+
    if (my->_mode != mode::only_query) {
 
+      my->_resume_block = my->read_sync_state();
+      if (my->_resume_block > 0)
+         ilog("postgres_indexer: resuming after block ${b}", ("b", my->_resume_block));
+      // indexes built by an earlier run are kept, even while catching up again
+      if (my->_copy_replay && my->history_indexes_exist())
+         my->history_indexes = detail::postgres_indexer_plugin_impl::index_state::built;
+      my->_writer = std::make_unique<detail::pg_writer>(my->_postgres_url, my->_queue_size);
+      my->_writer->start(my->_resume_block);
+
       // Signal 1: applied_block - operation history + content + genesis
       database().applied_block.connect([this](const signed_block& b) {
          // Operation history indexing
@@ -2078,11 +2202,19 @@ void postgres_indexer_plugin::plugin_initialize(const boost::program_options::va
          my->on_block_content(b);
 
          // Genesis handling for blockchain objects
-         if (b.block_num() == 1 && my->_start_after_block == 0) {
+         if (b.block_num() == 1 && my->_start_after_block == 0 && my->_resume_block == 0) {
             if (!my->genesis())
                FC_THROW_EXCEPTION(graphene::chain::plugin_exception,
                   "Error populating genesis data.");
          }
+
+         // History and content of the block are buffered, a flush from here on may advance the sync state
+         if (!my->complete_block(b))
+            FC_THROW_EXCEPTION(graphene::chain::plugin_exception,
+               "Error writing block to PostgreSQL.");
+
+         if (b.block_num() % 10000 == 0)
+            ilog("postgres_indexer: writer ${s}", ("s", my->_writer->get_stats()));
       });
 
       // Signal 2: new_objects
@@ -2127,13 +2259,11 @@ void postgres_indexer_plugin::plugin_startup()
       return;
    }
 
-   if (!my->connect_to_postgres()) {
-      FC_THROW_EXCEPTION(fc::exception, "Failed to connect to PostgreSQL at ${url}",
-                         ("url", my->_postgres_url));
-   }
-
-   if (!my->create_tables()) {
-      FC_THROW_EXCEPTION(fc::exception, "Failed to create PostgreSQL tables");
+   if (my->_writer) {
+      const auto head = database().head_block_num();
+      if (head > 0 && my->_resume_block > head)
+         wlog("postgres_indexer: PostgreSQL is ahead of the chain (block ${p} > ${h}), "
+              "blocks up to ${p} will not be indexed again", ("p", my->_resume_block)("h", head));
    }
 
    ilog("postgres_indexer: Plugin started successfully");
@@ -2142,20 +2272,25 @@ void postgres_indexer_plugin::plugin_startup()
 void postgres_indexer_plugin::plugin_shutdown()
 {
    ilog("postgres_indexer: plugin_shutdown()");
-   // Flush remaining buffer
-   if (!my->bulk_sql_buffer.empty()) {
-      try {
-         my->flush_bulk_buffer();
-      } catch (...) {
-         elog("postgres_indexer: Failed to flush remaining buffer on shutdown");
-      }
+   if (!my->_writer)
+      return;
+
+   // Flush remaining buffers and let the writer drain its queue
+   try {
+      my->flush_bulk_buffer();
+      my->_writer->drain();
+   } catch (...) {
+      elog("postgres_indexer: Failed to flush remaining buffer on shutdown");
    }
+   ilog("postgres_indexer: writer ${s}", ("s", my->_writer->get_stats()));
+   my->_writer->stop();
 }
 
-// Query API delegators
+// Query API delegators, the pool runs each call on one of its connection threads
 operation_history_object postgres_indexer_plugin::get_operation_by_id(operation_history_id_type id)
 {
-   return my->pg_get_operation_by_id(id);
+   FC_ASSERT(my->_query_pool, "postgres_indexer is not running in query mode");
+   return my->_query_pool->get_operation_by_id(id);
 }
 
 vector<operation_history_object> postgres_indexer_plugin::get_account_history(
@@ -2164,7 +2299,8 @@ vector<operation_history_object> postgres_indexer_plugin::get_account_history(
    unsigned limit,
    operation_history_id_type start)
 {
-   return my->pg_get_account_history(account_id, stop, limit, start);
+   FC_ASSERT(my->_query_pool, "postgres_indexer is not running in query mode");
+   return my->_query_pool->get_account_history(account_id, stop, limit, start);
 }
 
 mode postgres_indexer_plugin::get_running_mode()
@@ -2172,4 +2308,11 @@ mode postgres_indexer_plugin::get_running_mode()
    return my->_mode;
 }
 
+writer_stats postgres_indexer_plugin::get_writer_stats()
+{
+   if (!my->_writer)
+      return writer_stats();
+   return my->_writer->get_stats();
+}
+
 } } // graphene::postgres_indexer
@@ -36,6 +36,8 @@ namespace bpo = boost::program_options;
 static const char* OPT_BLOCK_NUM  = "snapshot-at-block";
 static const char* OPT_BLOCK_TIME = "snapshot-at-time";
 static const char* OPT_DEST       = "snapshot-to";
+static const char* OPT_FORMAT     = "snapshot-format";
+static const char* OPT_LOAD       = "snapshot-load-from";
 
 void snapshot_plugin::plugin_set_program_options(
    boost::program_options::options_description& command_line_options,
@@ -44,7 +46,13 @@ void snapshot_plugin::plugin_set_program_options(
    command_line_options.add_options()
          (OPT_BLOCK_NUM, bpo::value<uint32_t>(), "Block number after which to do a snapshot")
          (OPT_BLOCK_TIME, bpo::value<string>(), "Block time (ISO format) after which to do a snapshot")
-         (OPT_DEST, bpo::value<string>(), "Pathname of JSON file where to store the snapshot")
+         (OPT_DEST, bpo::value<string>(), "Pathname of the file where to store the snapshot")
+         (OPT_FORMAT, bpo::value<string>()->default_value("json"),
+          "Format of the snapshot: json, one object per line of the state after the block, or binary, "
+          "the state without its reversible blocks, written in the background, which a node can start from")
+         (OPT_LOAD, bpo::value<string>(),
+          "Binary snapshot to start from instead of the genesis state when the object database is empty, "
+          "e.g. with --replay-blockchain")
          ;
    config_file_options.add(command_line_options);
 }
@@ -68,6 +76,9 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
       FC_ASSERT( options.count(OPT_DEST) > 0,
                  "Must specify snapshot-to in addition to snapshot-at-block or snapshot-at-time!" );
       dest = options[OPT_DEST].as<std::string>();
+      const std::string format = options[OPT_FORMAT].as<std::string>();
+      FC_ASSERT( format == "json" || format == "binary", "Unknown snapshot format ${f}", ("f", format) );
+      binary = ( format == "binary" );
       if( options.count(OPT_BLOCK_NUM) > 0 )
          snapshot_block = options[OPT_BLOCK_NUM].as<uint32_t>();
       if( options.count(OPT_BLOCK_TIME) > 0 )
@@ -79,6 +90,9 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
    else
       ilog("snapshot plugin is not enabled because neither snapshot-at-block nor snapshot-at-time is specified");
 
+   if( options.count(OPT_LOAD) > 0 )
+      database().start_from_snapshot( options[OPT_LOAD].as<std::string>() );
+
    ilog("snapshot plugin: plugin_initialize() end");
 } FC_LOG_AND_RETHROW() }
 
@@ -98,16 +112,10 @@ static void create_snapshot( const graphene::chain::database& db, const fc::path
    for( uint32_t space_id = 0; space_id < 256; space_id++ )
       for( uint32_t type_id = 0; type_id < 256; type_id++ )
       {
-         try
-         {
-            db.get_index( (uint8_t)space_id, (uint8_t)type_id );
-         }
-         catch (fc::assert_exception& e)
-         {
+         const auto* index = db.find_index( (uint8_t)space_id, (uint8_t)type_id );
+         if( index == nullptr )
             continue;
-         }
-         auto& index = db.get_index( (uint8_t)space_id, (uint8_t)type_id );
-         index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
+         index->inspect_all_objects( [&out]( const graphene::db::object& o ) {
             out << fc::json::to_string( o.to_variant() ) << '\n';
          });
       }
@@ -120,7 +128,35 @@ void snapshot_plugin::check_snapshot( const graphene::chain::signed_block& b )
     uint32_t current_block = b.block_num();
     if( (last_block < snapshot_block && snapshot_block <= current_block)
            || (last_time < snapshot_time && snapshot_time <= b.timestamp) )
-       create_snapshot( database(), dest );
+    {
+       if( !binary )
+          create_snapshot( database(), dest );
+       else
+       {
+          wait_for_binary_snapshot();
+          pending_snapshot = database().write_snapshot( dest );
+       }
+    }
     last_block = current_block;
     last_time = b.timestamp;
 } FC_LOG_AND_RETHROW() }
+
+void snapshot_plugin::wait_for_binary_snapshot()
+{
+   if( !pending_snapshot.valid() )
+      return;
+   try
+   {
+      pending_snapshot.wait();
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Failed to write snapshot: ${ex}", ("ex",e.to_detail_string()) );
+   }
+   pending_snapshot = fc::future<void>();
+}
+
+void snapshot_plugin::plugin_shutdown()
+{
+   wait_for_binary_snapshot();
+}
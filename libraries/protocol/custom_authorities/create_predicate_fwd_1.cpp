@@ -33,7 +33,8 @@ FWD_FIELD_TYPES="$FWD_FIELD_TYPES string std::vector<char> time_point_sec"
 for T in $FWD_FIELD_TYPES; do
     echo "template"
     echo "object_restriction_predicate<$T> create_predicate_function( "
-    echo "    restriction_function func, restriction_argument arg );"
+    echo "    restriction_function func, restriction_argument arg,"
+    echo "    restriction_program_builder& program, uint32_t offset );"
 done
  */
 
@@ -41,27 +42,35 @@ namespace graphene { namespace protocol {
 
 template
 object_restriction_predicate<share_type> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<asset_id_type> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<flat_set<asset_id_type>> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<asset> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<price> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<string> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<std::vector<char>> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<time_point_sec> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 
 } } // namespace graphene::protocol
@@ -32,7 +32,8 @@ FWD_FIELD_TYPES="account_id_type flat_set<account_id_type> public_key_type autho
 for T in $FWD_FIELD_TYPES; do
     echo "template"
     echo "object_restriction_predicate<$T> create_predicate_function( "
-    echo "    restriction_function func, restriction_argument arg );"
+    echo "    restriction_function func, restriction_argument arg,"
+    echo "    restriction_program_builder& program, uint32_t offset );"
 done
  */
 
@@ -40,18 +41,23 @@ namespace graphene { namespace protocol {
 
 template
 object_restriction_predicate<account_id_type> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<flat_set<account_id_type>> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<public_key_type> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<authority> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<optional<authority>> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 
 } } // namespace graphene::protocol
@@ -32,7 +32,8 @@ FWD_FIELD_TYPES="bool uint8_t uint16_t uint32_t unsigned_int extensions_type"
 for T in $FWD_FIELD_TYPES; do
     echo "template"
     echo "object_restriction_predicate<$T> create_predicate_function( "
-    echo "    restriction_function func, restriction_argument arg );"
+    echo "    restriction_function func, restriction_argument arg,"
+    echo "    restriction_program_builder& program, uint32_t offset );"
 done
  */
 
@@ -40,21 +41,27 @@ namespace graphene { namespace protocol {
 
 template
 object_restriction_predicate<bool> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<uint8_t> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<uint16_t> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<uint32_t> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<unsigned_int> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 template
 object_restriction_predicate<extensions_type> create_predicate_function(
-    restriction_function func, restriction_argument arg );
+    restriction_function func, restriction_argument arg,
+    restriction_program_builder& program, uint32_t offset );
 
 } } // namespace graphene::protocol
@@ -27,6 +27,7 @@
 
 #include <fc/exception/exception.hpp>
 
+#include "restriction_program.hxx"
 #include "safe_compare.hpp"
 
 namespace graphene { namespace protocol {
@@ -117,6 +118,11 @@ namespace safenum = boost::safe_numerics::safe_compare;
 //  - embed_argument<Field, Predicate, Argument>() -- Embeds the argument into the predicate if it is a valid type
 //    for the predicate, and throws otherwise.
 //  - predicate_xyz<Argument> -- These are functors implementing the various predicate function types
+//
+// Alongside the predicate, each layer emits the same checks into a restriction_program_builder: a test instruction
+// per predicate, calling the same functor through run_predicate, and enter/leave instructions around attribute and
+// variant assertions. The resulting flat program decides whether an operation complies without the nested
+// std::function calls of the predicate, which is then only run to explain a rejection.
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // These typelists contain the argument types legal for various function types:
@@ -372,19 +378,70 @@ struct predicate_has_none<fc::optional<OptionalType>, Argument, void> : predicat
 };
 ////////////////////////////////////////////// END PREDICATE FUNCTORS //////////////////////////////////////////////
 
+///////////////////////////////////////////// PROGRAM ENTRY POINTS /////////////////////////////////////////////
+// Run a predicate functor on a field, as a test instruction of a restriction_program
+template<typename P, typename F, typename A>
+bool run_predicate(const char* field, const void* argument) {
+   return P()(*reinterpret_cast<const F*>(field), *static_cast<const A*>(argument));
+}
+// Enter the value of an optional field, if any
+template<typename F>
+const char* enter_optional(const char* field) {
+   const auto& f = *reinterpret_cast<const fc::optional<F>*>(field);
+   if (!f.valid()) return nullptr;
+   return reinterpret_cast<const char*>(&*f);
+}
+// Enter the value of an extension field
+template<typename Extension>
+const char* enter_extension(const char* field) {
+   return reinterpret_cast<const char*>(&reinterpret_cast<const extension<Extension>*>(field)->value);
+}
+// Enter the value of a variant field, if it holds a Value
+template<typename Variant, typename Value>
+const char* enter_variant(const char* field) {
+   const auto& v = *reinterpret_cast<const Variant*>(field);
+   if (v.which() != Variant::template tag<Value>::value) return nullptr;
+   return reinterpret_cast<const char*>(&v.template get<Value>());
+}
+template<typename Variant, typename Value>
+const char* enter_optional_variant(const char* field) {
+   const auto& opt = *reinterpret_cast<const fc::optional<Variant>*>(field);
+   if (!opt.valid()) return nullptr;
+   return enter_variant<Variant, Value>(reinterpret_cast<const char*>(&*opt));
+}
+// Offset of a reflected field within its object
+template<typename Object, typename FieldReflection>
+uint32_t field_offset() {
+   static const Object sample{};
+   static const uint32_t offset = static_cast<uint32_t>(reinterpret_cast<const char*>(&FieldReflection::get(sample))
+                                                        - reinterpret_cast<const char*>(&sample));
+   return offset;
+}
+/////////////////////////////////////////// END PROGRAM ENTRY POINTS ///////////////////////////////////////////
+
 // Forward declaration of restrictions_to_predicate, because attribute assertions and logical ORs recurse into it
-template<typename Object> object_restriction_predicate<Object> restrictions_to_predicate(vector<restriction>, bool);
+template<typename Object>
+object_restriction_predicate<Object> restrictions_to_predicate(vector<restriction>, bool, restriction_program_builder&);
 
 template<typename Field>
 struct attribute_assertion {
-   static object_restriction_predicate<Field> create(vector<restriction>&& rs) {
-      return restrictions_to_predicate<Field>(std::move(rs), false);
+   static object_restriction_predicate<Field> create(vector<restriction>&& rs, restriction_program_builder& program,
+                                                     uint32_t offset) {
+      program.enter(offset);
+      auto p = restrictions_to_predicate<Field>(std::move(rs), false, program);
+      program.leave();
+      return p;
    }
 };
 template<typename Field>
 struct attribute_assertion<fc::optional<Field>> {
-   static object_restriction_predicate<fc::optional<Field>> create(vector<restriction>&& rs) {
-      return [p=restrictions_to_predicate<Field>(std::move(rs), false)](const fc::optional<Field>& f) {
+   static object_restriction_predicate<fc::optional<Field>> create(vector<restriction>&& rs,
+                                                                   restriction_program_builder& program,
+                                                                   uint32_t offset) {
+      program.enter(offset, enter_optional<Field>);
+      auto p = restrictions_to_predicate<Field>(std::move(rs), false, program);
+      program.leave();
+      return [p=std::move(p)](const fc::optional<Field>& f) {
          if (!f.valid()) return predicate_result::Rejection(predicate_result::null_optional);
          return p(*f);
       };
@@ -392,8 +449,13 @@ struct attribute_assertion<fc::optional<Field>> {
 };
 template<typename Extension>
 struct attribute_assertion<extension<Extension>> {
-   static object_restriction_predicate<extension<Extension>> create(vector<restriction>&& rs) {
-      return [p=restrictions_to_predicate<Extension>(std::move(rs), false)](const extension<Extension>& x) {
+   static object_restriction_predicate<extension<Extension>> create(vector<restriction>&& rs,
+                                                                    restriction_program_builder& program,
+                                                                    uint32_t offset) {
+      program.enter(offset, enter_extension<Extension>);
+      auto p = restrictions_to_predicate<Extension>(std::move(rs), false, program);
+      program.leave();
+      return [p=std::move(p)](const extension<Extension>& x) {
          return p(x.value);
       };
    }
@@ -401,7 +463,8 @@ struct attribute_assertion<extension<Extension>> {
 
 template<typename Variant>
 struct variant_assertion {
-   static object_restriction_predicate<Variant> create(restriction::variant_assert_argument_type&&) {
+   static object_restriction_predicate<Variant> create(restriction::variant_assert_argument_type&&,
+                                                       restriction_program_builder&, uint32_t) {
       FC_THROW_EXCEPTION(fc::assert_exception, "Invalid variant assertion on non-variant field",
                          ("Field", fc::get_typename<Variant>::name()));
    }
@@ -411,18 +474,24 @@ struct variant_assertion<static_variant<Types...>> {
    using Variant = static_variant<Types...>;
 
    template<typename Value>
-   static auto make_predicate(vector<restriction>&& rs) {
-      return [p=restrictions_to_predicate<Value>(std::move(rs), true)](const Variant& v) {
+   static auto make_predicate(vector<restriction>&& rs, restriction_program_builder& program, uint32_t offset,
+                              restriction_program::enter_function enter) {
+      program.enter(offset, enter);
+      auto p = restrictions_to_predicate<Value>(std::move(rs), true, program);
+      program.leave();
+      return [p=std::move(p)](const Variant& v) {
          if (v.which() == Variant::template tag<Value>::value)
             return p(v.template get<Value>());
          return predicate_result::Rejection(predicate_result::incorrect_variant_type);
       };
    }
-   static object_restriction_predicate<Variant> create(restriction::variant_assert_argument_type&& arg) {
+   static object_restriction_predicate<Variant> create(restriction::variant_assert_argument_type&& arg,
+                                                       restriction_program_builder& program, uint32_t offset) {
       return typelist::runtime::dispatch(typelist::list<Types...>(), arg.first,
-                                         [&arg](auto t) -> object_restriction_predicate<Variant> {
+                                         [&arg, &program, offset](auto t) -> object_restriction_predicate<Variant> {
          using Value = typename decltype(t)::type;
-         return variant_assertion::make_predicate<Value>(std::move(arg.second));
+         return variant_assertion::make_predicate<Value>(std::move(arg.second), program, offset,
+                                                         enter_variant<Variant, Value>);
       });
    }
 };
@@ -430,11 +499,14 @@ template<typename... Types>
 struct variant_assertion<fc::optional<static_variant<Types...>>> {
    using Variant = static_variant<Types...>;
    using Optional = fc::optional<Variant>;
-   static object_restriction_predicate<Optional> create(restriction::variant_assert_argument_type&& arg) {
+   static object_restriction_predicate<Optional> create(restriction::variant_assert_argument_type&& arg,
+                                                        restriction_program_builder& program, uint32_t offset) {
       return typelist::runtime::dispatch(typelist::list<Types...>(), arg.first,
-                                         [&arg](auto t) -> object_restriction_predicate<Optional> {
+                                         [&arg, &program, offset](auto t) -> object_restriction_predicate<Optional> {
          using Value = typename decltype(t)::type;
-         auto pred = variant_assertion<Variant>::template make_predicate<Value>(std::move(arg.second));
+         auto pred = variant_assertion<Variant>::template make_predicate<Value>(std::move(arg.second), program,
+                                                                                offset,
+                                                                                enter_optional_variant<Variant, Value>);
          return [p=std::move(pred)](const Optional& opt) {
             if (!opt.valid()) return predicate_result::Rejection(predicate_result::null_optional);
             return p(*opt);
@@ -445,66 +517,75 @@ struct variant_assertion<fc::optional<static_variant<Types...>>> {
 
 // Embed the argument into the predicate functor
 template<typename F, typename P, typename A, typename = std::enable_if_t<P::valid>>
-object_restriction_predicate<F> embed_argument(P p, A a, short) {
+object_restriction_predicate<F> embed_argument(P p, A a, restriction_program_builder& program, uint32_t offset,
+                                               short) {
+   program.test(offset, run_predicate<P, F, A>, a);
    return [p=std::move(p), a=std::move(a)](const F& f) {
       if (p(f, a)) return predicate_result::Success();
       return predicate_result::Rejection(predicate_result::predicate_was_false);
    };
 }
 template<typename F, typename P, typename A>
-object_restriction_predicate<F> embed_argument(P, A, long) {
+object_restriction_predicate<F> embed_argument(P, A, restriction_program_builder&, uint32_t, long) {
    FC_THROW_EXCEPTION(fc::assert_exception, "Invalid types for predicate");
 }
 
 // Resolve the argument type and make a predicate for it
 template<template<typename...> class Predicate, typename Field, typename ArgVariant>
-object_restriction_predicate<Field> make_predicate(ArgVariant arg) {
+object_restriction_predicate<Field> make_predicate(ArgVariant arg, restriction_program_builder& program,
+                                                   uint32_t offset) {
    return typelist::runtime::dispatch(typename ArgVariant::list(), arg.which(),
-                                      [&arg](auto t) mutable -> object_restriction_predicate<Field> {
+                                      [&arg, &program, offset](auto t) mutable -> object_restriction_predicate<Field> {
       using Arg = typename decltype(t)::type;
-      return embed_argument<Field>(Predicate<Field, Arg>(), std::move(arg.template get<Arg>()), short());
+      return embed_argument<Field>(Predicate<Field, Arg>(), std::move(arg.template get<Arg>()), program, offset,
+                                   short());
    });
 }
 
 template<typename Field>
-object_restriction_predicate<Field> create_predicate_function(restriction_function func, restriction_argument arg) {
+object_restriction_predicate<Field> create_predicate_function(restriction_function func, restriction_argument arg,
+                                                              restriction_program_builder& program, uint32_t offset) {
    try {
       switch(func) {
       case restriction::func_eq:
-         return make_predicate<predicate_eq, Field>(static_variant<equality_types_list>::import_from(std::move(arg)));
+         return make_predicate<predicate_eq, Field>(static_variant<equality_types_list>::import_from(std::move(arg)),
+                                                    program, offset);
       case restriction::func_ne:
-         return make_predicate<predicate_ne, Field>(static_variant<equality_types_list>::import_from(std::move(arg)));
+         return make_predicate<predicate_ne, Field>(static_variant<equality_types_list>::import_from(std::move(arg)),
+                                                    program, offset);
       case restriction::func_lt:
          return make_predicate<predicate_lt, Field>(static_variant<comparable_types_list>
-                                                    ::import_from(std::move(arg)));
+                                                    ::import_from(std::move(arg)), program, offset);
       case restriction::func_le:
          return make_predicate<predicate_le, Field>(static_variant<comparable_types_list>
-                                                    ::import_from(std::move(arg)));
+                                                    ::import_from(std::move(arg)), program, offset);
       case restriction::func_gt:
          return make_predicate<predicate_gt, Field>(static_variant<comparable_types_list>
-                                                    ::import_from(std::move(arg)));
+                                                    ::import_from(std::move(arg)), program, offset);
       case restriction::func_ge:
          return make_predicate<predicate_ge, Field>(static_variant<comparable_types_list>
-                                                    ::import_from(std::move(arg)));
+                                                    ::import_from(std::move(arg)), program, offset);
       case restriction::func_in:
-         return make_predicate<predicate_in, Field>(static_variant<list_types_list>::import_from(std::move(arg)));
+         return make_predicate<predicate_in, Field>(static_variant<list_types_list>::import_from(std::move(arg)),
+                                                    program, offset);
       case restriction::func_not_in:
          return make_predicate<predicate_not_in, Field>(static_variant<list_types_list>
-                                                        ::import_from(std::move(arg)));
+                                                        ::import_from(std::move(arg)), program, offset);
       case restriction::func_has_all:
          return make_predicate<predicate_has_all, Field>(static_variant<list_types_list>
-                                                         ::import_from(std::move(arg)));
+                                                         ::import_from(std::move(arg)), program, offset);
       case restriction::func_has_none:
          return make_predicate<predicate_has_none, Field>(static_variant<list_types_list>
-                                                          ::import_from(std::move(arg)));
+                                                          ::import_from(std::move(arg)), program, offset);
       case restriction::func_attr:
          FC_ASSERT(arg.which() == restriction_argument::tag<vector<restriction>>::value,
                    "Argument type for attribute assertion must be restriction list");
-         return attribute_assertion<Field>::create(std::move(arg.get<vector<restriction>>()));
+         return attribute_assertion<Field>::create(std::move(arg.get<vector<restriction>>()), program, offset);
       case restriction::func_variant_assert:
          FC_ASSERT(arg.which() == restriction_argument::tag<restriction::variant_assert_argument_type>::value,
                    "Argument type for attribute assertion must be pair of variant tag and restriction list");
-         return variant_assertion<Field>::create(std::move(arg.get<restriction::variant_assert_argument_type>()));
+         return variant_assertion<Field>::create(std::move(arg.get<restriction::variant_assert_argument_type>()),
+                                                 program, offset);
       default:
           FC_THROW_EXCEPTION(fc::assert_exception, "Invalid function type on restriction");
       }
@@ -524,33 +605,49 @@ object_restriction_predicate<Field> create_predicate_function(restriction_functi
  */
 template<typename Object,
          typename = std::enable_if_t<typelist::length<typename fc::reflector<Object>::native_members>() != 0>>
-object_restriction_predicate<Object> create_field_predicate(restriction&& r, short) {
+object_restriction_predicate<Object> create_field_predicate(restriction&& r, restriction_program_builder& program,
+                                                            short) {
    using member_list = typename fc::reflector<Object>::native_members;
    FC_ASSERT( r.member_index < static_cast<uint64_t>(typelist::length<member_list>()),
               "Invalid member index ${I} for object ${O}",
               ("I", r.member_index)("O", fc::get_typename<Object>::name()) );
-   auto predicator = [f=r.restriction_type, a=std::move(r.argument)](auto t) -> object_restriction_predicate<Object> {
+   auto predicator = [f=r.restriction_type, a=std::move(r.argument), &program]
+                     (auto t) -> object_restriction_predicate<Object> {
       using FieldReflection = typename decltype(t)::type;
       using Field = typename FieldReflection::type;
-      auto p = create_predicate_function<Field>(static_cast<restriction_function>(f), std::move(a));
+      auto p = create_predicate_function<Field>(static_cast<restriction_function>(f), std::move(a), program,
+                                                field_offset<Object, FieldReflection>());
       return [p=std::move(p)](const Object& o) { return p(FieldReflection::get(o)); };
    };
    return typelist::runtime::dispatch(member_list(), static_cast<size_t>(r.member_index.value), predicator);
 }
 template<typename Object>
-object_restriction_predicate<Object> create_field_predicate(restriction&&, long) {
+object_restriction_predicate<Object> create_field_predicate(restriction&&, restriction_program_builder&, long) {
    FC_THROW_EXCEPTION(fc::assert_exception, "Invalid restriction references member of non-object type: ${O}",
                       ("O", fc::get_typename<Object>::name()));
 }
 
 template<typename Object>
-object_restriction_predicate<Object> create_logical_or_predicate(vector<vector<restriction>> rs) {
+object_restriction_predicate<Object> create_logical_or_predicate(vector<vector<restriction>> rs,
+                                                                 restriction_program_builder& program) {
    FC_ASSERT(rs.size() > 1, "Logical OR must have at least two branches");
-   auto to_predicate = std::bind(restrictions_to_predicate<Object>, std::placeholders::_1, false);
 
+   // In the program, a failing branch continues with the next one, and the last one fails the OR
    vector<object_restriction_predicate<Object>> predicates;
-   std::transform(std::make_move_iterator(rs.begin()), std::make_move_iterator(rs.end()),
-                  std::back_inserter(predicates), to_predicate);
+   auto end = program.new_label();
+   for (size_t i = 0; i < rs.size(); ++i) {
+      if (i + 1 == rs.size()) {
+         predicates.push_back(restrictions_to_predicate<Object>(std::move(rs[i]), false, program));
+         break;
+      }
+      auto next = program.new_label();
+      program.push_failure(next);
+      predicates.push_back(restrictions_to_predicate<Object>(std::move(rs[i]), false, program));
+      program.pop_failure();
+      program.jump(end);
+      program.place(next);
+   }
+   program.place(end);
 
    return [predicates=std::move(predicates)](const Object& obj) {
       vector<predicate_result> rejections;
@@ -566,19 +663,21 @@ object_restriction_predicate<Object> create_logical_or_predicate(vector<vector<r
 }
 
 template<typename Object>
-object_restriction_predicate<Object> restrictions_to_predicate(vector<restriction> rs, bool allow_empty) {
+object_restriction_predicate<Object> restrictions_to_predicate(vector<restriction> rs, bool allow_empty,
+                                                               restriction_program_builder& program) {
    if (!allow_empty)
       FC_ASSERT(!rs.empty(), "Empty attribute assertions and logical OR branches are not permitted");
 
    vector<object_restriction_predicate<Object>> predicates;
    std::transform(std::make_move_iterator(rs.begin()), std::make_move_iterator(rs.end()),
-                  std::back_inserter(predicates), [](restriction&& r) {
+                  std::back_inserter(predicates), [&program](restriction&& r) {
       if (r.restriction_type.value == restriction::func_logical_or) {
           FC_ASSERT(r.argument.which() == restriction_argument::tag<vector<vector<restriction>>>::value,
                     "Restriction argument for logical OR function type must be list of restriction lists.");
-          return create_logical_or_predicate<Object>(std::move(r.argument.get<vector<vector<restriction>>>()));
+          return create_logical_or_predicate<Object>(std::move(r.argument.get<vector<vector<restriction>>>()),
+                                                     program);
       }
-      return create_field_predicate<Object>(std::move(r), short());
+      return create_field_predicate<Object>(std::move(r), program, short());
    });
 
    return [predicates=std::move(predicates)](const Object& obj) {
@@ -593,4 +692,23 @@ object_restriction_predicate<Object> restrictions_to_predicate(vector<restrictio
    };
 }
 
+/**
+ * @brief Create the predicate of restrictions on an operation
+ *
+ * The restrictions are compiled into a restriction_program which decides whether the operation complies; the
+ * predicate tree is only run on a rejection, to explain it.
+ */
+template<typename Op>
+object_restriction_predicate<operation> operation_predicate(vector<restriction> rs) {
+   restriction_program_builder builder;
+   auto p = restrictions_to_predicate<Op>(std::move(rs), true, builder);
+   return [p=std::move(p), program=builder.finish()] (const operation& op) {
+      FC_ASSERT(op.which() == operation::tag<Op>::value,
+                "Supplied operation is incorrect type for restriction predicate");
+      const Op& o = op.get<Op>();
+      if (program.run(&o)) return predicate_result::Success();
+      return p(o);
+   };
+}
+
 } } // namespace graphene::protocol
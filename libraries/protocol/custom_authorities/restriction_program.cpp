@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include "restriction_program.hxx"
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/container/small_vector.hpp>
+
+namespace graphene { namespace protocol {
+
+bool restriction_program::run(const void* object) const {
+   // Objects entered so far, the examined one last; few restrictions nest deeper than this
+   boost::container::small_vector<const char*, 8> bases(1, static_cast<const char*>(object));
+   uint32_t pc = 0;
+   const uint32_t end = static_cast<uint32_t>(_code.size());
+   while (pc < end) {
+      const instruction& i = _code[pc];
+      switch (i.code) {
+      case op_test:
+         if (i.test(bases.back() + i.offset, i.argument)) {
+            ++pc;
+            continue;
+         }
+         break;
+      case op_enter: {
+         const char* field = bases.back() + i.offset;
+         const char* entered = i.enter == nullptr ? field : i.enter(field);
+         if (entered != nullptr) {
+            bases.push_back(entered);
+            ++pc;
+            continue;
+         }
+         break;
+      }
+      case op_leave:
+         bases.pop_back();
+         ++pc;
+         continue;
+      case op_jump:
+         pc = i.target;
+         continue;
+      }
+      if (i.target == reject)
+         return false;
+      bases.resize(i.failure_depth);
+      pc = i.target;
+   }
+   return true;
+}
+
+restriction_program_builder::restriction_program_builder() : _labels(1), _failure(1, 0) {}
+
+void restriction_program_builder::enter(uint32_t offset, restriction_program::enter_function enter) {
+   FC_ASSERT(_depth < std::numeric_limits<uint16_t>::max(), "Restrictions nested too deep");
+   restriction_program::instruction i;
+   i.code = restriction_program::op_enter;
+   i.offset = offset;
+   i.target = _failure.back();
+   i.enter = enter;
+   _program._code.push_back(i);
+   ++_depth;
+}
+
+void restriction_program_builder::leave() {
+   restriction_program::instruction i;
+   i.code = restriction_program::op_leave;
+   _program._code.push_back(i);
+   --_depth;
+}
+
+restriction_program_builder::label restriction_program_builder::new_label() {
+   _labels.emplace_back();
+   return static_cast<label>(_labels.size() - 1);
+}
+
+void restriction_program_builder::place(label l) {
+   _labels[l].position = static_cast<uint32_t>(_program._code.size());
+   _labels[l].depth = _depth;
+}
+
+void restriction_program_builder::jump(label l) {
+   restriction_program::instruction i;
+   i.code = restriction_program::op_jump;
+   i.target = l;
+   _program._code.push_back(i);
+}
+
+restriction_program restriction_program_builder::finish() {
+   FC_ASSERT(_program._code.size() < restriction_program::reject, "Restriction program too long");
+   // Until now, targets are labels
+   for (auto& i : _program._code) {
+      if (i.code == restriction_program::op_leave)
+         continue;
+      const label_position& target = _labels[i.target];
+      i.target = target.position;
+      i.failure_depth = target.depth;
+   }
+   return std::move(_program);
+}
+
+} } // namespace graphene::protocol
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace graphene { namespace protocol {
+
+/**
+ * Restrictions compiled into a flat sequence of instructions, run against an operation without any of the
+ * std::function calls of the predicate tree. Each instruction reads a field at a fixed offset from the object
+ * currently examined: a test runs a comparison on the field, an enter makes the field (or the value held by an
+ * optional, extension or variant field) the examined object, and a leave returns to the enclosing object. A failed
+ * test or enter jumps to the next branch of the enclosing logical OR, or rejects the operation.
+ *
+ * The program only tells whether the operation complies; the predicate tree still explains rejections.
+ */
+class restriction_program {
+public:
+   /// Runs a comparison on the field against the restriction's argument
+   using test_function = bool (*)(const char* field, const void* argument);
+   /// Resolves the object held by the field, nullptr if it holds none of the expected type
+   using enter_function = const char* (*)(const char* field);
+
+   bool run(const void* object) const;
+   size_t size() const { return _code.size(); }
+
+private:
+   friend class restriction_program_builder;
+
+   enum opcode : uint8_t { op_test, op_enter, op_leave, op_jump };
+   static constexpr uint32_t reject = std::numeric_limits<uint32_t>::max();
+
+   struct instruction {
+      opcode         code = op_test;
+      /// Number of enclosing objects at the failure target
+      uint16_t       failure_depth = 0;
+      uint32_t       offset = 0;
+      /// Next instruction of a jump, or target of a failed test or enter
+      uint32_t       target = reject;
+      test_function  test = nullptr;
+      enter_function enter = nullptr;
+      const void*    argument = nullptr;
+   };
+
+   std::vector<instruction>           _code;
+   std::vector<std::shared_ptr<void>> _arguments;
+};
+
+/// Emits the instructions of a restriction_program while the predicate tree is created
+class restriction_program_builder {
+public:
+   using label = uint32_t;
+
+   restriction_program_builder();
+
+   template<typename Argument>
+   void test(uint32_t offset, restriction_program::test_function test, const Argument& argument) {
+      auto stored = std::make_shared<Argument>(argument);
+      restriction_program::instruction i;
+      i.code = restriction_program::op_test;
+      i.offset = offset;
+      i.target = _failure.back();
+      i.test = test;
+      i.argument = stored.get();
+      _program._arguments.push_back(std::move(stored));
+      _program._code.push_back(i);
+   }
+   /// Enters the field at @p offset, through @p enter unless the field is a plain struct
+   void enter(uint32_t offset, restriction_program::enter_function enter = nullptr);
+   void leave();
+
+   /// A new label, placed later; failures within the branch started by push_failure() jump to it
+   label new_label();
+   void place(label l);
+   void jump(label l);
+   void push_failure(label l) { _failure.push_back(l); }
+   void pop_failure() { _failure.pop_back(); }
+
+   /// Resolves the labels and hands over the program
+   restriction_program finish();
+
+private:
+   struct label_position {
+      uint32_t position = restriction_program::reject;
+      uint16_t depth = 0;
+   };
+
+   restriction_program         _program;
+   /// Label 0 rejects the operation
+   std::vector<label_position> _labels;
+   std::vector<label>          _failure;
+   uint16_t                    _depth = 1;
+};
+
+} } // namespace graphene::protocol
@@ -214,6 +214,17 @@ namespace graphene { namespace protocol {
        */
       virtual const flat_set<public_key_type>& get_signature_keys( const chain_id_type& chain_id )const;
 
+      /**
+       * @brief Stores public keys recovered from the signatures elsewhere, E.G. by a batch covering a whole block.
+       * @param keys The key of each signature, in the order of @ref signatures
+       * @return Public keys, as get_signature_keys() would return them
+       * @note Throws on duplicate signatures, as get_signature_keys() does.
+       */
+      const flat_set<public_key_type>& set_signature_keys( const vector<public_key_type>& keys )const;
+
+      /** Whether get_signature_keys() returns without recovering any key */
+      bool has_signature_keys()const { return signatures.empty() || !_signees.empty(); }
+
       /** Signatures */
       vector<signature_type> signatures;
 
@@ -363,6 +363,22 @@ const flat_set<public_key_type>& signed_transaction::get_signature_keys( const c
    return _signees;
 } FC_CAPTURE_AND_RETHROW() }
 
+const flat_set<public_key_type>& signed_transaction::set_signature_keys( const vector<public_key_type>& keys )const
+{ try {
+   FC_ASSERT( keys.size() == signatures.size(), "Expected one key per signature" );
+   flat_set<public_key_type> result;
+   result.reserve( keys.size() );
+   for( const auto& key : keys )
+   {
+      GRAPHENE_ASSERT(
+         result.insert( key ).second,
+            tx_duplicate_sig,
+            "Duplicate Signature detected" );
+   }
+   _signees = std::move( result );
+   return _signees;
+} FC_CAPTURE_AND_RETHROW() }
+
 
 set<public_key_type> signed_transaction::get_required_signatures( const chain_id_type& chain_id,
                                                                   const flat_set<public_key_type>& available_keys,
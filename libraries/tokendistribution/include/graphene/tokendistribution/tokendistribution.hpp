@@ -26,16 +26,61 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace graphene { namespace tokendistribution {
 
-void preparePubKey(std::string* pubKey);
+/// Uncompressed secp256k1 public key without the leading 0x04 byte
+typedef std::array<std::uint8_t, 64> eth_public_key;
+/// Recoverable signature, r and s followed by the recovery id (27 or 28)
+typedef std::array<std::uint8_t, 65> eth_signature;
+typedef std::array<std::uint8_t, 32> eth_hash;
+typedef std::array<std::uint8_t, 20> eth_address;
 
-void prepareSignature(std::string& pubKey);
+/// One personal_sign signature to verify, see verify_messages()
+struct eth_signed_message
+{
+   eth_public_key key;
+   eth_hash       hash;
+   eth_signature  signature;
+};
+
+/// Parses a hex public key, with or without its "04" prefix. Throws if the length is wrong.
+eth_public_key parse_public_key(const std::string& hex);
+
+/// Parses a hex signature, with or without its "0x" prefix. Throws if the length is wrong.
+eth_signature parse_signature(const std::string& hex);
+
+/// Address of a public key: the last 20 bytes of its Keccak-256 hash
+eth_address get_address(const eth_public_key& key);
+
+/// Hash signed by personal_sign: Keccak-256 of "\x19Ethereum Signed Message:\n" + length + message
+eth_hash hash_message(const std::string& message);
+
+/// Recovers the key which produced @p signature over @p hash, returns false if none can be recovered
+bool recover_public_key(const eth_hash& hash, const eth_signature& signature, eth_public_key& key);
+
+/// Whether @p signature over @p hash was made with @p key
+bool verify_message(const eth_public_key& key, const eth_hash& hash, const eth_signature& signature);
+
+/// Verifies every message of the batch, element i of the result tells whether message i verified
+std::vector<bool> verify_messages(const std::vector<eth_signed_message>& messages);
+
+std::string to_hex(const eth_address& address);
+
+/// @name Hex string helpers kept for wallet and tooling code
+///@{
+void preparePubKey(std::string& pubKey);
+
+void prepareSignature(std::string& sig);
 
 std::string getAddress(std::string pubKey);
 
+/// Returns 0 when @p sig over @p msg was made with @p pubKey
 int verifyMessage (std::string pubKey, std::string msg, std::string sig);
+///@}
 
-} }
\ No newline at end of file
+} }
@@ -28,9 +28,122 @@
 #include <fc/exception/exception.hpp>
 
 #include <graphene/tokendistribution/Keccak256.hpp>
+#include <graphene/tokendistribution/tokendistribution.hpp>
+
+#include <algorithm>
 
 namespace graphene { namespace tokendistribution {
 
+namespace {
+
+int hex_digit(char c)
+{
+   if (c >= '0' && c <= '9') return c - '0';
+   if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+   if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+   return -1;
+}
+
+template<size_t N>
+void parse_hex(const char* hex, std::array<std::uint8_t, N>& out, const char* what)
+{
+   for (size_t i = 0; i < N; ++i)
+   {
+      int high = hex_digit(hex[2 * i]);
+      int low = hex_digit(hex[2 * i + 1]);
+      if (high < 0 || low < 0)
+         FC_THROW_EXCEPTION(fc::assert_exception, "${what} is not a hex string", ("what", what));
+      out[i] = static_cast<std::uint8_t>(high * 16 + low);
+   }
+}
+
+// Recovery only reads the context, so one context is shared by every thread
+const secp256k1_context_t* recovery_context()
+{
+   static const secp256k1_context_t* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN);
+   return ctx;
+}
+
+bool recover(const secp256k1_context_t* ctx, const eth_hash& hash, const eth_signature& signature, eth_public_key& key)
+{
+   int recoveryId = static_cast<int>(signature[64]);
+   if (recoveryId != 27 && recoveryId != 28)
+      return false;
+
+   std::uint8_t recovered[65];
+   int recovered_len = 0;
+   const int compressed = 0;
+   int r = secp256k1_ecdsa_recover_compact(ctx, hash.data(), signature.data(), recovered, &recovered_len,
+                                           compressed, recoveryId - 27);
+   if (r != 1 || recovered_len != 65)
+      return false;
+   std::copy(recovered + 1, recovered + 65, key.begin()); // drop the 0x04 prefix
+   return true;
+}
+
+} // anonymous namespace
+
+eth_public_key parse_public_key(const std::string& hex)
+{
+   if (hex.length() != 130 && hex.length() != 128)
+      FC_THROW_EXCEPTION(fc::assert_exception, "Ethereum key length is incorrect. Is it a real key?");
+   eth_public_key key;
+   parse_hex(hex.c_str() + hex.length() - 128, key, "Ethereum key"); // skip "04"
+   return key;
+}
+
+eth_signature parse_signature(const std::string& hex)
+{
+   if (hex.length() != 132 && hex.length() != 130)
+      FC_THROW_EXCEPTION(fc::assert_exception, "Ethereum signature length is incorrect. Is it a real signature?");
+   eth_signature signature;
+   parse_hex(hex.c_str() + hex.length() - 130, signature, "Ethereum signature"); // skip "0x"
+   return signature;
+}
+
+eth_address get_address(const eth_public_key& key)
+{
+   std::uint8_t hash[Keccak256::HASH_LEN];
+   Keccak256::getHash(key.data(), key.size(), hash);
+   eth_address address;
+   std::copy(hash + Keccak256::HASH_LEN - address.size(), hash + Keccak256::HASH_LEN, address.begin());
+   return address;
+}
+
+eth_hash hash_message(const std::string& message)
+{
+   std::string wrapped = "\x19" "Ethereum Signed Message:\n" + std::to_string(message.size()) + message;
+   eth_hash hash;
+   Keccak256::getHash(reinterpret_cast<const std::uint8_t*>(wrapped.data()), wrapped.size(), hash.data());
+   return hash;
+}
+
+bool recover_public_key(const eth_hash& hash, const eth_signature& signature, eth_public_key& key)
+{
+   return recover(recovery_context(), hash, signature, key);
+}
+
+bool verify_message(const eth_public_key& key, const eth_hash& hash, const eth_signature& signature)
+{
+   eth_public_key recovered;
+   return recover(recovery_context(), hash, signature, recovered) && recovered == key;
+}
+
+std::vector<bool> verify_messages(const std::vector<eth_signed_message>& messages)
+{
+   const secp256k1_context_t* ctx = recovery_context();
+   std::vector<bool> result(messages.size(), false);
+   eth_public_key recovered;
+   for (size_t i = 0; i < messages.size(); ++i)
+      result[i] = recover(ctx, messages[i].hash, messages[i].signature, recovered) && recovered == messages[i].key;
+   return result;
+}
+
+std::string to_hex(const eth_address& address)
+{
+   return bytesHex(Bytes(address.begin(), address.end()));
+}
+
 void preparePubKey(std::string& pubKey) {
     if (pubKey.length() == 130)
       pubKey = pubKey.erase(0, 2); // drop "04"
@@ -39,70 +152,32 @@ void preparePubKey(std::string& pubKey) {
       FC_THROW_EXCEPTION(fc::assert_exception, "Ethereum key length is incorrect. Is it a real key?");
 }
 
-void prepareSignature(std::string& pubKey) {
-    if (pubKey.length() == 132)
-      pubKey = pubKey.erase(0, 2); // drop "0x"
+void prepareSignature(std::string& sig) {
+    if (sig.length() == 132)
+      sig = sig.erase(0, 2); // drop "0x"
 
-   if (pubKey.length() != 130)
+   if (sig.length() != 130)
       FC_THROW_EXCEPTION(fc::assert_exception, "Ethereum signature length is incorrect. Is it a real signature?");
 }
 
 std::string getAddress(std::string pubKey)
 {
-   preparePubKey(pubKey);
-
-   Bytes message = hexBytes(pubKey.c_str());
-   std::uint8_t hashBuff[Keccak256::HASH_LEN];
-   Keccak256::getHash(message.data(), message.size(), hashBuff);
-   Bytes hash(hashBuff, hashBuff + Keccak256::HASH_LEN);
-
-   std::string address = bytesHex(hash);
-   address = address.substr(address.length() - 40); // Take the last 40 characters
-   return address;
+   return to_hex(get_address(parse_public_key(pubKey)));
 }
 
 int verifyMessage (std::string pubKey, std::string msg, std::string sig) {
-   preparePubKey(pubKey);
-
-   // Wrap the phrase
-   std::ostringstream msgToHash;
-   msgToHash << '\x19' << "Ethereum Signed Message:\n"
-              << msg.size() << msg;
-
-   // Hash the phrase
-   Bytes message = asciiBytes(msgToHash.str().c_str());
-   std::uint8_t hashBuff[Keccak256::HASH_LEN];
-   Keccak256::getHash(message.data(), message.size(), hashBuff);
-   Bytes hash(hashBuff, hashBuff + Keccak256::HASH_LEN);
-
-   // Read signature
-   prepareSignature(sig);
-   Bytes signature = hexBytes(sig.c_str());
+   eth_signature signature = parse_signature(sig);
    int recoveryId = static_cast<int>(signature[64]);
    if (recoveryId != 27 && recoveryId != 28)
       FC_THROW_EXCEPTION(fc::assert_exception, "Signature has unexpected value");
-   recoveryId -= 27;
 
-   // Recover public key from signature
-   Bytes recKey(65, 0);
-   unsigned int rk_len;
-   const int compressed = 0;
-   static secp256k1_context_t *ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN );
-   int r = secp256k1_ecdsa_recover_compact(ctx,
-                reinterpret_cast<const unsigned char *>(hash.data()),
-                reinterpret_cast<const unsigned char *>(signature.data()),
-                reinterpret_cast<      unsigned char *>(recKey.data()),
-                reinterpret_cast<int *>                (&rk_len),
-                                                        compressed,
-                                                        recoveryId);
-
-   if (r != 1 || rk_len != 65)
+   eth_public_key recovered;
+   if (!recover_public_key(hash_message(msg), signature, recovered))
       FC_THROW_EXCEPTION(fc::assert_exception, "Public key can't be recovered: incorrect signature");
 
    // If the recovered key matches the original one, then everything is fine
-   std::string recoveredKey = bytesHex(recKey);
-   preparePubKey(recoveredKey);
-   return recoveredKey.compare(pubKey);
+   preparePubKey(pubKey);
+   return bytesHex(Bytes(recovered.begin(), recovered.end())).compare(pubKey);
 }
 
-} }
\ No newline at end of file
+} }
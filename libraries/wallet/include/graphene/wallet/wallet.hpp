@@ -431,6 +431,25 @@ class wallet_api
        */
       void remove_builder_transaction(transaction_handle_type handle);
 
+      /**
+       * @ingroup Transaction Builder API
+       *
+       * Read operations, one per line, sign them and broadcast them to the network in bulk.
+       *
+       * Each line holds an operation as \c [name or number, operation], e.g.
+       * \c ["content_card_create",{"subject_account":"1.2.17",...}]; fees are set from the fee
+       * schedule, which is read once. Empty lines and lines starting with \c # are skipped. Consecutive
+       * operations are packed into transactions up to the maximum transaction size, the keys signing for
+       * each set of required authorities are looked up once, and up to \c max_in_flight transactions are
+       * broadcast at the same time. Operations which fail do not stop the run, they are reported with
+       * the lines they were read from.
+       *
+       * @param filename file to read the operations from
+       * @param max_in_flight maximum number of transactions being broadcast at the same time
+       * @return operations read and failed, transactions accepted and throughput
+       */
+      bulk_broadcast_result bulk_broadcast_operations( string filename, uint32_t max_in_flight = 16 );
+
       /** Checks whether the wallet has just been created and has not yet had a password set.
        *
        * Calling \c set_password will transition the wallet to the locked state.
@@ -1806,9 +1825,10 @@ class wallet_api
        * @param owner the owner account.
        * @param start_room lower bound of room instance id to start getting results.
        * @param limit maximum number of rooms to retrieve.
-       * @returns the list of room objects.
+       * @returns the room objects, and in @c next the id (1.24.x) of the room starting the next page if there
+       *          is one; pass its instance as @p start_room to get that page.
        */
-      std::vector<room_object> get_rooms_by_owner( const string& owner,
+      room_page get_rooms_by_owner( const string& owner,
             uint64_t start_room,
             unsigned limit = 100 ) const;
 
@@ -1818,9 +1838,10 @@ class wallet_api
        * @param room the room id in canonical format (1.24.x).
        * @param start_participant lower bound of participant instance id to start getting results.
        * @param limit maximum number of participants to retrieve.
-       * @returns the list of room participant objects.
+       * @returns the room participant objects, and in @c next the id (1.25.x) of the record starting the next
+       *          page if there is one; pass its instance as @p start_participant to get that page.
        */
-      std::vector<room_participant_object> get_room_participants(
+      room_participant_page get_room_participants(
             const string& room,
             uint64_t start_participant,
             unsigned limit = 100 ) const;
@@ -1831,9 +1852,10 @@ class wallet_api
        * @param participant the participant account.
        * @param start_record lower bound of participant instance id to start getting results.
        * @param limit maximum number of participant objects to retrieve.
-       * @returns the list of room participant objects.
+       * @returns the room participant objects, and in @c next the id (1.25.x) of the record starting the next
+       *          page if there is one; pass its instance as @p start_record to get that page.
        */
-      std::vector<room_participant_object> get_rooms_by_participant( const string& participant,
+      room_participant_page get_rooms_by_participant( const string& participant,
             uint64_t start_record,
             unsigned limit = 100 ) const;
 
@@ -1935,6 +1957,7 @@ FC_API( graphene::wallet::wallet_api,
         (broadcast_transaction)
         (propose_builder_transaction)
         (remove_builder_transaction)
+        (bulk_broadcast_operations)
         (is_new)
         (is_locked)
         (lock)(unlock)(set_password)
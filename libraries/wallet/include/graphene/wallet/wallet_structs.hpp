@@ -144,6 +144,24 @@ struct worker_vote_delta
    flat_set<worker_id_type> unvote_for;
 };
 
+/// Operations of a bulk broadcast which were not accepted, by the lines they were read from
+struct bulk_broadcast_failure
+{
+   uint32_t first_line = 0;
+   uint32_t last_line = 0;
+   string   error;
+};
+
+struct bulk_broadcast_result
+{
+   uint32_t operations = 0;          ///< Operations read
+   uint32_t failed_operations = 0;   ///< Operations which could not be read or were in a rejected transaction
+   uint32_t transactions = 0;        ///< Transactions accepted by the node
+   uint64_t milliseconds = 0;
+   double   operations_per_second = 0;
+   vector<bulk_broadcast_failure> failures;
+};
+
 struct signed_block_with_info : public signed_block
 {
    signed_block_with_info( const signed_block& block );
@@ -280,6 +298,11 @@ FC_REFLECT( graphene::wallet::worker_vote_delta,
    (unvote_for)
 )
 
+FC_REFLECT( graphene::wallet::bulk_broadcast_failure, (first_line)(last_line)(error) )
+
+FC_REFLECT( graphene::wallet::bulk_broadcast_result,
+   (operations)(failed_operations)(transactions)(milliseconds)(operations_per_second)(failures) )
+
 FC_REFLECT_DERIVED( graphene::wallet::signed_block_with_info, (graphene::chain::signed_block),
    (block_id)(signing_key)(transaction_ids) )
 
@@ -554,6 +554,12 @@ void wallet_api::remove_builder_transaction(transaction_handle_type handle)
    return my->remove_builder_transaction(handle);
 }
 
+bulk_broadcast_result wallet_api::bulk_broadcast_operations( string filename, uint32_t max_in_flight )
+{
+   FC_ASSERT( !is_locked() );
+   return my->bulk_broadcast_operations( filename, max_in_flight );
+}
+
 account_object wallet_api::get_account(string account_name_or_id) const
 {
    return my->get_account(account_name_or_id);
@@ -1163,7 +1169,7 @@ room_object wallet_api::get_room_by_id( const string& room ) const
    return my->get_room_by_id(room);
 }
 
-std::vector<room_object> wallet_api::get_rooms_by_owner(
+room_page wallet_api::get_rooms_by_owner(
       const string& owner,
       uint64_t start_room,
       unsigned limit ) const
@@ -1171,7 +1177,7 @@ std::vector<room_object> wallet_api::get_rooms_by_owner(
    return my->get_rooms_by_owner(owner, start_room, limit);
 }
 
-std::vector<room_participant_object> wallet_api::get_room_participants(
+room_participant_page wallet_api::get_room_participants(
       const string& room,
       uint64_t start_participant,
       unsigned limit ) const
@@ -1179,7 +1185,7 @@ std::vector<room_participant_object> wallet_api::get_room_participants(
    return my->get_room_participants(room, start_participant, limit);
 }
 
-std::vector<room_participant_object> wallet_api::get_rooms_by_participant(
+room_participant_page wallet_api::get_rooms_by_participant(
       const string& participant,
       uint64_t start_record,
       unsigned limit ) const
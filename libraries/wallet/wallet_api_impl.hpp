@@ -234,6 +234,8 @@ public:
 
    void remove_builder_transaction(transaction_handle_type handle);
 
+   bulk_broadcast_result bulk_broadcast_operations( const string& filename, uint32_t max_in_flight );
+
    signed_transaction register_account(string name, public_key_type owner, public_key_type active,
          string  registrar_account, string  referrer_account, uint32_t referrer_percent,
          bool broadcast = false);
@@ -470,15 +472,15 @@ public:
 
    room_object get_room_by_id( const string& room ) const;
 
-   std::vector<room_object> get_rooms_by_owner( const string& owner,
+   room_page get_rooms_by_owner( const string& owner,
          uint64_t start_room,
          unsigned limit = 100 ) const;
 
-   std::vector<room_participant_object> get_room_participants( const string& room,
+   room_participant_page get_room_participants( const string& room,
          uint64_t start_participant,
          unsigned limit = 100 ) const;
 
-   std::vector<room_participant_object> get_rooms_by_participant( const string& participant,
+   room_participant_page get_rooms_by_participant( const string& participant,
          uint64_t start_record,
          unsigned limit = 100 ) const;
 
@@ -546,6 +548,11 @@ private:
    //
    void claim_registered_witness(const std::string& witness_name);
 
+   // Signs tx, which has its reference block set, with keys, moving its expiration forward until its ID
+   // differs from those of the transactions generated recently
+   void sign_new_transaction( signed_transaction& tx, const set<public_key_type>& keys,
+                              const dynamic_global_property_object& dyn_props );
+
    fc::mutex _resync_mutex;
    void resync();
 
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ */
+#include "wallet_api_impl.hpp"
+
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include <deque>
+#include <fstream>
+
+/****
+ * Methods to broadcast operations in bulk
+ */
+
+namespace graphene { namespace wallet { namespace detail {
+
+   namespace {
+
+   /// Room left in each transaction for its signatures and the size of its operation count
+   const uint32_t bulk_signature_reserve = 1024;
+
+   /// How long the reference block and time of bulk transactions are used before reading them again
+   const fc::microseconds bulk_reference_block_lifetime = fc::seconds(10);
+
+   struct bulk_transaction
+   {
+      signed_transaction trx;
+      uint32_t           packed_size = 0;
+      uint32_t           first_line = 0;
+      uint32_t           last_line = 0;
+   };
+
+   /// Parses [name or number, operation], fee may be omitted
+   operation parse_bulk_operation( const string& line, const static_variant_map& which_map )
+   {
+      const variants entry = fc::json::from_string( line ).get_array();
+      FC_ASSERT( entry.size() == 2, "Expected [operation name or number, operation]" );
+
+      int64_t which;
+      if( entry[0].is_string() )
+      {
+         auto itr = which_map.name_to_which.find( entry[0].get_string() );
+         FC_ASSERT( itr != which_map.name_to_which.end(), "Unknown operation ${o}", ("o", entry[0]) );
+         which = itr->second;
+      }
+      else
+         which = entry[0].as_int64();
+      FC_ASSERT( which >= 0 && which < int64_t( which_map.which_to_name.size() ),
+                 "Unknown operation ${o}", ("o", entry[0]) );
+
+      operation op = from_which_variant< operation >( int( which ), entry[1], GRAPHENE_MAX_NESTED_OBJECTS );
+      operation_validate( op );
+      return op;
+   }
+
+   }
+
+   bulk_broadcast_result wallet_api_impl::bulk_broadcast_operations( const string& filename, uint32_t max_in_flight )
+   {
+      FC_ASSERT( max_in_flight > 0, "At least one transaction must be in flight" );
+
+      // only from a file, the standard input is the console of an interactive wallet
+      std::ifstream input( filename );
+      FC_ASSERT( input, "Cannot open ${f}", ("f", filename) );
+
+      // fees and limits are read once for the whole run
+      const chain_parameters parameters = get_global_properties().parameters;
+      const fee_schedule& fees = parameters.get_current_fees();
+      FC_ASSERT( parameters.maximum_transaction_size > bulk_signature_reserve );
+      const uint32_t max_packed_size = parameters.maximum_transaction_size - bulk_signature_reserve;
+
+      dynamic_global_property_object dyn_props = get_dynamic_global_properties();
+      fc::time_point dyn_props_read = fc::time_point::now();
+
+      // owned keys signing for each set of required active and owner authorities
+      map< std::pair< flat_set<account_id_type>, flat_set<account_id_type> >, set<public_key_type> > signing_keys;
+
+      bulk_broadcast_result result;
+      const fc::time_point start = fc::time_point::now();
+
+      auto fail = [&result]( const bulk_transaction& bt, uint32_t operation_count, const fc::exception& e ) {
+         elog( "Bulk operations on lines ${f} to ${l} failed: ${e}",
+               ("f", bt.first_line)("l", bt.last_line)("e", e.to_detail_string()) );
+         result.failed_operations += operation_count;
+         result.failures.push_back( bulk_broadcast_failure{ bt.first_line, bt.last_line, e.to_string() } );
+      };
+
+      std::deque< std::pair< bulk_transaction, fc::future<void> > > in_flight;
+      auto wait_oldest = [&]() {
+         auto& oldest = in_flight.front();
+         try
+         {
+            oldest.second.wait();
+            ++result.transactions;
+         }
+         catch( const fc::exception& e )
+         {
+            fail( oldest.first, uint32_t( oldest.first.trx.operations.size() ), e );
+         }
+         in_flight.pop_front();
+      };
+
+      auto send = [&]( bulk_transaction& bt ) {
+         try
+         {
+            bt.trx.validate();
+
+            flat_set<account_id_type> active;
+            flat_set<account_id_type> owner;
+            vector<authority> other;
+            for( const auto& op : bt.trx.operations )
+               operation_get_required_authorities( op, active, owner, other, false );
+
+            set<public_key_type> keys;
+            if( other.empty() )
+            {
+               auto signers = std::make_pair( std::move( active ), std::move( owner ) );
+               auto itr = signing_keys.find( signers );
+               if( itr == signing_keys.end() )
+                  itr = signing_keys.emplace( std::move( signers ), get_owned_required_keys( bt.trx ) ).first;
+               keys = itr->second;
+            }
+            else
+               keys = get_owned_required_keys( bt.trx );
+
+            if( fc::time_point::now() - dyn_props_read > bulk_reference_block_lifetime )
+            {
+               dyn_props = get_dynamic_global_properties();
+               dyn_props_read = fc::time_point::now();
+            }
+            bt.trx.set_reference_block( dyn_props.head_block_id );
+            sign_new_transaction( bt.trx, keys, dyn_props );
+         }
+         catch( const fc::exception& e )
+         {
+            fail( bt, uint32_t( bt.trx.operations.size() ), e );
+            return;
+         }
+
+         while( in_flight.size() >= max_in_flight )
+            wait_oldest();
+         const signed_transaction trx = bt.trx;
+         in_flight.emplace_back( std::move( bt ), fc::async( [this,trx]() {
+            _remote_net_broadcast->broadcast_transaction( trx );
+         }, "bulk broadcast" ) );
+      };
+
+      bulk_transaction current;
+      uint32_t line_number = 0;
+      string line;
+      while( std::getline( input, line ) )
+      {
+         ++line_number;
+         boost::algorithm::trim( line );
+         if( line.empty() || line.front() == '#' )
+            continue;
+
+         ++result.operations;
+         operation op;
+         try
+         {
+            op = parse_bulk_operation( line, _operation_which_map );
+            fees.set_fee( op );
+         }
+         catch( const fc::exception& e )
+         {
+            bulk_transaction failed;
+            failed.first_line = failed.last_line = line_number;
+            fail( failed, 1, e );
+            continue;
+         }
+
+         const uint32_t op_size = fc::raw::pack_size( op );
+         if( !current.trx.operations.empty() && current.packed_size + op_size > max_packed_size )
+         {
+            send( current );
+            current = bulk_transaction();
+         }
+         if( current.trx.operations.empty() )
+         {
+            current.packed_size = fc::raw::pack_size( current.trx );
+            current.first_line = line_number;
+         }
+         current.trx.operations.push_back( std::move( op ) );
+         current.packed_size += op_size;
+         current.last_line = line_number;
+      }
+      if( !current.trx.operations.empty() )
+         send( current );
+      while( !in_flight.empty() )
+         wait_oldest();
+
+      result.milliseconds = ( fc::time_point::now() - start ).count() / 1000;
+      if( result.milliseconds > 0 )
+         result.operations_per_second = ( result.operations - result.failed_operations ) * 1000.0
+                                        / result.milliseconds;
+      ilog( "Broadcast ${o} operations in ${t} transactions in ${ms} milliseconds, ${f} failed",
+            ("o", result.operations - result.failed_operations)("t", result.transactions)
+            ("ms", result.milliseconds)("f", result.failed_operations) );
+      return result;
+   }
+
+}}} // namespace graphene::wallet::detail
@@ -351,7 +351,28 @@ namespace graphene { namespace wallet { namespace detail {
 
       auto dyn_props = get_dynamic_global_properties();
       tx.set_reference_block( dyn_props.head_block_id );
+      sign_new_transaction( tx, approving_key_set, dyn_props );
 
+      if( broadcast )
+      {
+         try
+         {
+            _remote_net_broadcast->broadcast_transaction( tx );
+         }
+         catch (const fc::exception& e)
+         {
+            elog("Caught exception while broadcasting tx ${id}:  ${e}",
+                 ("id", tx.id().str())("e", e.to_detail_string()) );
+            throw;
+         }
+      }
+
+      return tx;
+   }
+
+   void wallet_api_impl::sign_new_transaction( signed_transaction& tx, const set<public_key_type>& keys,
+                                               const dynamic_global_property_object& dyn_props )
+   {
       // first, some bookkeeping, expire old items from _recently_generated_transactions
       // since transactions include the head block id, we just need the index for keeping transactions unique
       // when there are multiple transactions in the same block.  choose a time period that should be at
@@ -368,7 +389,7 @@ namespace graphene { namespace wallet { namespace detail {
          tx.set_expiration( dyn_props.time + fc::seconds(30 + expiration_time_offset) );
          tx.clear_signatures();
 
-         for( const public_key_type& key : approving_key_set )
+         for( const public_key_type& key : keys )
             tx.sign( get_private_key(key), _chain_id );
 
          graphene::chain::transaction_id_type this_transaction_id = tx.id();
@@ -386,22 +407,6 @@ namespace graphene { namespace wallet { namespace detail {
          // else we've generated a dupe, increment expiration time and re-sign it
          ++expiration_time_offset;
       }
-
-      if( broadcast )
-      {
-         try
-         {
-            _remote_net_broadcast->broadcast_transaction( tx );
-         }
-         catch (const fc::exception& e)
-         {
-            elog("Caught exception while broadcasting tx ${id}:  ${e}",
-                 ("id", tx.id().str())("e", e.to_detail_string()) );
-            throw;
-         }
-      }
-
-      return tx;
    }
 
    fc::ecc::private_key wallet_api_impl::get_private_key(const public_key_type& id)const
@@ -916,7 +921,7 @@ namespace graphene { namespace wallet { namespace detail {
       return *room_obj;
    }
 
-   std::vector<room_object> wallet_api_impl::get_rooms_by_owner( const string& owner,
+   room_page wallet_api_impl::get_rooms_by_owner( const string& owner,
          uint64_t start_room,
          unsigned limit ) const
    {
@@ -925,7 +930,7 @@ namespace graphene { namespace wallet { namespace detail {
       return rooms;
    }
 
-   std::vector<room_participant_object> wallet_api_impl::get_room_participants( const string& room,
+   room_participant_page wallet_api_impl::get_room_participants( const string& room,
          uint64_t start_participant,
          unsigned limit ) const
    {
@@ -934,7 +939,7 @@ namespace graphene { namespace wallet { namespace detail {
       return participants;
    }
 
-   std::vector<room_participant_object> wallet_api_impl::get_rooms_by_participant( const string& participant,
+   room_participant_page wallet_api_impl::get_rooms_by_participant( const string& participant,
          uint64_t start_record,
          unsigned limit ) const
    {
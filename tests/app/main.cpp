@@ -387,6 +387,148 @@ BOOST_AUTO_TEST_CASE( two_node_network )
    }
 }
 
+/////////////
+/// @brief relay a block as a compact block, one of its transactions known to the receiver and one not
+/////////////
+BOOST_AUTO_TEST_CASE( two_node_compact_block_relay )
+{
+   using namespace graphene::chain;
+   using namespace graphene::app;
+   try {
+      auto port = fc::network::get_available_port();
+      auto app1_p2p_endpoint_str = string("127.0.0.1:") + std::to_string(port);
+      auto app2_seed_nodes_str = string("[\"") + app1_p2p_endpoint_str + "\"]";
+
+      fc::temp_directory app_dir( graphene::utilities::temp_directory_path() );
+      auto genesis_file = create_genesis_file(app_dir);
+
+      graphene::app::application app1;
+      app1.register_plugin< graphene::witness_plugin::witness_plugin >();
+      auto sharable_cfg = std::make_shared<boost::program_options::variables_map>();
+      auto& cfg = *sharable_cfg;
+      fc::set_option( cfg, "p2p-endpoint", app1_p2p_endpoint_str );
+      fc::set_option( cfg, "genesis-json", genesis_file );
+      fc::set_option( cfg, "seed-nodes", string("[]") );
+      app1.initialize(app_dir.path(), sharable_cfg);
+      app1.startup();
+
+      auto node_startup_wait_time = fc::seconds(15);
+
+      fc::wait_for( node_startup_wait_time, [&app1,port] () {
+         const auto status = app1.p2p_node()->network_get_info();
+         return status["listening_on"].as<fc::ip::endpoint>( 5 ).port() == port;
+      });
+
+      fc::temp_directory app2_dir( graphene::utilities::temp_directory_path() );
+      graphene::app::application app2;
+      app2.register_plugin< graphene::witness_plugin::witness_plugin >();
+      auto sharable_cfg2 = std::make_shared<boost::program_options::variables_map>();
+      auto& cfg2 = *sharable_cfg2;
+      fc::set_option( cfg2, "genesis-json", genesis_file );
+      fc::set_option( cfg2, "seed-nodes", app2_seed_nodes_str );
+      app2.initialize(app2_dir.path(), sharable_cfg2);
+      app2.startup();
+
+      fc::wait_for( node_startup_wait_time, [&app1] () {
+         if( app1.p2p_node()->get_connection_count() > 0 )
+         {
+            auto peers = app1.p2p_node()->get_connected_peers();
+            const auto& peer_info = peers.front().info;
+            auto itr = peer_info.find( "peer_needs_sync_items_from_us" );
+            if( itr == peer_info.end() )
+               return false;
+            return !itr->value().as<bool>(1);
+         }
+         return false;
+      });
+
+      BOOST_REQUIRE_EQUAL(app1.p2p_node()->get_connection_count(), 1u);
+      // both nodes announced compact block relay in their hello messages
+      auto peers = app1.p2p_node()->get_connected_peers();
+      const auto& peer_info = peers.front().info;
+      BOOST_REQUIRE( peer_info.find( "compact_blocks" ) != peer_info.end() );
+      BOOST_CHECK( peer_info["compact_blocks"].as<bool>(1) );
+
+      std::shared_ptr<chain::database> db1 = app1.chain_database();
+      std::shared_ptr<chain::database> db2 = app2.chain_database();
+
+      account_id_type actanet_id = db2->get_index_type<account_index>().indices().get<by_name>().find( "actanet" )->id;
+      fc::ecc::private_key actanet_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("actanet")));
+      auto make_transfer = [&]( int64_t amount, bool claim ) {
+         graphene::chain::precomputable_transaction trx;
+         if( claim )
+         {
+            balance_claim_operation claim_op;
+            balance_id_type bid = balance_id_type();
+            claim_op.deposit_to_account = actanet_id;
+            claim_op.balance_to_claim = bid;
+            claim_op.balance_owner_key = actanet_key.get_public_key();
+            claim_op.total_claimed = bid(*db2).balance;
+            trx.operations.push_back( claim_op );
+            db2->current_fee_schedule().set_fee( trx.operations.back() );
+         }
+
+         transfer_operation xfer_op;
+         xfer_op.from = actanet_id;
+         xfer_op.to = GRAPHENE_NULL_ACCOUNT;
+         xfer_op.amount = asset( amount );
+         trx.operations.push_back( xfer_op );
+         db2->current_fee_schedule().set_fee( trx.operations.back() );
+
+         trx.set_expiration( db2->get_slot_time( 10 ) );
+         trx.sign( actanet_key, db2->get_chain_id() );
+         trx.validate();
+         return trx;
+      };
+
+      auto broadcast_wait_time = fc::seconds(15);
+
+      // the first transaction is relayed to app1, so the compact block finds it there
+      BOOST_TEST_MESSAGE( "Relaying the first transaction" );
+      const auto relayed_trx = make_transfer( 1000000, true );
+      db2->push_transaction( relayed_trx );
+      app2.p2p_node()->broadcast( graphene::net::trx_message( relayed_trx ) );
+      fc::wait_for( broadcast_wait_time, [db1] () {
+         return db1->get_balance( GRAPHENE_NULL_ACCOUNT, asset_id_type() ).amount.value == 1000000;
+      });
+
+      // the second one only app2 has, app1 has to ask for it after receiving the compact block
+      const auto unrelayed_trx = make_transfer( 500000, false );
+      db2->push_transaction( unrelayed_trx );
+      BOOST_CHECK_EQUAL( db1->get_balance( GRAPHENE_NULL_ACCOUNT, asset_id_type() ).amount.value, 1000000 );
+      BOOST_CHECK_EQUAL( db2->get_balance( GRAPHENE_NULL_ACCOUNT, asset_id_type() ).amount.value, 1500000 );
+
+      // the other node will reject the block if its timestamp is in the future, so we wait
+      fc::wait_for( broadcast_wait_time, [db2] () {
+         return db2->get_slot_time(1) <= fc::time_point::now();
+      });
+
+      auto block_1 = db2->generate_block(
+         db2->get_slot_time(1),
+         db2->get_scheduled_witness(1),
+         actanet_key,
+         database::skip_nothing);
+      BOOST_REQUIRE_EQUAL( block_1.transactions.size(), 2u );
+
+      BOOST_TEST_MESSAGE( "Broadcasting block" );
+      app2.p2p_node()->broadcast(graphene::net::block_message( block_1 ));
+
+      fc::wait_for( broadcast_wait_time, [db1] () {
+         return db1->head_block_num() == 1;
+      });
+
+      // the block app1 put together is the one app2 produced, with both transactions
+      BOOST_CHECK( db1->head_block_id() == block_1.id() );
+      BOOST_CHECK_EQUAL( app1.p2p_node()->get_connection_count(), 1u );
+      BOOST_CHECK_EQUAL( db1->get_balance( GRAPHENE_NULL_ACCOUNT, asset_id_type() ).amount.value, 1500000 );
+      BOOST_CHECK_EQUAL( db2->get_balance( GRAPHENE_NULL_ACCOUNT, asset_id_type() ).amount.value, 1500000 );
+
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 // a contrived example to test the breaking out of application_impl to a header file
 BOOST_AUTO_TEST_CASE(application_impl_breakout) {
 
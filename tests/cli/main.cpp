@@ -56,6 +56,7 @@
    #include <netinet/in.h>
    #include <netinet/ip.h>
 #endif
+#include <fstream>
 #include <thread>
 
 #include <boost/filesystem/path.hpp>
@@ -1503,6 +1504,55 @@ BOOST_FIXTURE_TEST_CASE( general_storage, cli_fixture )
    }
 }
 
+///////////////////////
+// Read operations from a file and broadcast them in bulk
+///////////////////////
+BOOST_FIXTURE_TEST_CASE( cli_bulk_broadcast_operations, cli_fixture )
+{
+   try {
+      INVOKE(create_new_account);
+
+      transfer_operation op;
+      op.from = con.wallet_api_ptr->get_account("actanet").get_id();
+      op.to = con.wallet_api_ptr->get_account("jmjatlanta").get_id();
+      op.amount = asset(100);
+      const string transfer = "[\"transfer\"," + fc::json::to_string( fc::variant( op, GRAPHENE_MAX_NESTED_OBJECTS ) )
+                              + "]";
+
+      const string filename = ( app_dir.path() / "operations.txt" ).generic_string();
+      {
+         std::ofstream file( filename );
+         file << "# three transfers and an unknown operation\n"
+              << transfer << "\n"
+              << "[\"no_such_operation\",{}]\n"
+              << "\n"
+              << transfer << "\n"
+              << "[0," << fc::json::to_string( fc::variant( op, GRAPHENE_MAX_NESTED_OBJECTS ) ) << "]\n";
+      }
+
+      const auto balance = [this]() {
+         return con.wallet_api_ptr->list_account_balances("jmjatlanta").front().amount;
+      };
+      const share_type balance_before = balance();
+
+      BOOST_TEST_MESSAGE("Broadcasting the operations of the file.");
+      graphene::wallet::bulk_broadcast_result result = con.wallet_api_ptr->bulk_broadcast_operations( filename, 2 );
+      BOOST_CHECK_EQUAL( result.operations, 4u );
+      BOOST_CHECK_EQUAL( result.failed_operations, 1u );
+      BOOST_CHECK_EQUAL( result.transactions, 1u );
+      BOOST_REQUIRE_EQUAL( result.failures.size(), 1u );
+      BOOST_CHECK_EQUAL( result.failures[0].first_line, 3u );
+      BOOST_CHECK_EQUAL( result.failures[0].last_line, 3u );
+
+      BOOST_CHECK(generate_block(app1));
+      BOOST_CHECK_EQUAL( balance().value, balance_before.value + 300 );
+
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 //////
 // Template copied
 //////
@@ -32,6 +32,7 @@
 #include <graphene/es_objects/es_objects.hpp>
 #include <graphene/custom_operations/custom_operations_plugin.hpp>
 #include <graphene/content_cards/content_cards.hpp>
+#include <graphene/postgres_indexer/postgres_indexer_plugin.hpp>
 
 #include <graphene/chain/balance_object.hpp>
 #include <graphene/chain/committee_member_object.hpp>
@@ -47,6 +48,7 @@
 #include <fc/crypto/digest.hpp>
 
 #include <iomanip>
+#include <libpq-fe.h>
 
 #include "database_fixture.hpp"
 
@@ -54,6 +56,7 @@ using namespace graphene::chain::test;
 
 extern uint32_t    GRAPHENE_TESTING_GENESIS_TIMESTAMP;
 extern std::string GRAPHENE_TESTING_ES_URL;
+extern std::string GRAPHENE_TESTING_PG_URL;
 
 namespace graphene { namespace chain {
 
@@ -126,6 +129,15 @@ database_fixture_base::~database_fixture_base()
       }
    }
 
+   // cleanup data in PostgreSQL
+   if( !pg_schema.empty() )
+   {
+      PGconn* conn = PQconnectdb( GRAPHENE_TESTING_PG_URL.c_str() );
+      if( PQstatus( conn ) == CONNECTION_OK )
+         PQclear( PQexec( conn, ( "DROP SCHEMA IF EXISTS " + pg_schema + " CASCADE" ).c_str() ) );
+      PQfinish( conn );
+   }
+
    try {
       // If we're unwinding due to an exception, don't do any more checks.
       // This way, boost test's last checkpoint tells us approximately where the error was.
@@ -338,6 +350,33 @@ std::shared_ptr<boost::program_options::variables_map> database_fixture_base::in
       BOOST_TEST_MESSAGE( string("ES index prefix is ") + fixture.es_index_prefix );
       fc::set_option( options, "elasticsearch-index-prefix", fixture.es_index_prefix );
    }
+   else if( fixture.current_suite_name == "postgres_indexer_tests" ) {
+      fixture.app.register_plugin<graphene::postgres_indexer::postgres_indexer_plugin>(true);
+
+      // every test writes to a schema of its own, so no sync state of an earlier run is resumed
+      fixture.pg_schema = string("indexer_test_") + fc::to_string(uint64_t(rand()));
+      BOOST_TEST_MESSAGE( string("PostgreSQL schema is ") + fixture.pg_schema );
+      PGconn* conn = PQconnectdb( GRAPHENE_TESTING_PG_URL.c_str() );
+      BOOST_REQUIRE_MESSAGE( PQstatus( conn ) == CONNECTION_OK, PQerrorMessage( conn ) );
+      PGresult* res = PQexec( conn, ( "CREATE SCHEMA " + fixture.pg_schema ).c_str() );
+      const bool created = PQresultStatus( res ) == PGRES_COMMAND_OK;
+      PQclear( res );
+      PQfinish( conn );
+      BOOST_REQUIRE( created );
+      fixture.pg_url = GRAPHENE_TESTING_PG_URL
+                       + ( GRAPHENE_TESTING_PG_URL.find('?') == string::npos ? "?" : "&" )
+                       + "options=-csearch_path%3D" + fixture.pg_schema;
+
+      fc::set_option( options, "postgres-indexer-url", fixture.pg_url );
+      fc::set_option( options, "postgres-indexer-bulk-replay", uint32_t(1) );
+      fc::set_option( options, "postgres-indexer-bulk-sync", uint32_t(1) );
+      fc::set_option( options, "postgres-indexer-mode", uint16_t(0) );
+   }
+   else if( fixture.current_test_name == "content_cards_store_api_test" ) {
+      fixture.app.register_plugin<graphene::content_cards::content_cards_plugin>(true);
+      fc::set_option( options, "content-cards-store", true );
+      fc::set_option( options, "content-cards-store-cache-mb", uint64_t(1) );
+   }
    else if( fixture.current_suite_name == "content_cards_tests" ) {
       // fixture.app.register_plugin<graphene::content_cards::content_cards_plugin>(true);
    }
@@ -218,6 +218,8 @@ struct database_fixture_base {
 
    string es_index_prefix; ///< Index prefix for elasticsearch plugin
    string es_obj_index_prefix; ///< Index prefix for es_objects plugin
+   string pg_schema; ///< Schema for postgres_indexer plugin
+   string pg_url; ///< URL of the postgres_indexer plugin, connecting to pg_schema
 
    const std::string current_test_name;
    const std::string current_suite_name;
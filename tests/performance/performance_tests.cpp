@@ -30,16 +30,30 @@
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/content_hash.hpp>
 #include <graphene/chain/proposal_object.hpp>
+#include <graphene/chain/room_object.hpp>
 
 #include <graphene/db/simple_index.hpp>
 
+#include <graphene/app/api_read_pool.hpp>
+#include <graphene/app/database_api.hpp>
+
+#include <graphene/protocol/restriction_predicate.hpp>
+
 #include <fc/crypto/digest.hpp>
 
+#include "../../libraries/protocol/custom_authorities/restriction_predicate.hxx"
+
 #include "../common/database_fixture.hpp"
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 using namespace graphene::chain;
 
 BOOST_FIXTURE_TEST_SUITE( performance_tests, database_fixture )
@@ -56,6 +70,50 @@ BOOST_AUTO_TEST_CASE( sigcheck_benchmark )
    auto end = fc::time_point::now();
    auto elapsed = end-start;
    wlog( "Benchmark: verify ${sps} signatures/s", ("sps",(cycles*1000000)/elapsed.count()) );
+
+   // the same signatures spread over the transactions of a block, recovered one transaction at a time,
+   // then by the block batch, first without and then with the keys cached by the mempool
+   const uint32_t block_transactions = 2000;
+   std::vector<fc::ecc::private_key> signers;
+   for( uint32_t i = 0; i < 50; ++i )
+      signers.push_back( fc::ecc::private_key::regenerate( fc::sha256::hash( "signer" + fc::to_string(i) ) ) );
+   signed_block block;
+   for( uint32_t i = 0; i < block_transactions; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = account_id_type( 100 + i % signers.size() );
+      op.to = account_id_type( 99 );
+      op.amount = asset( 1 + i );
+      tx.operations.push_back( op );
+      tx.set_expiration( db.head_block_time() + fc::minutes(1) );
+      tx.sign( signers[i % signers.size()], db.get_chain_id() );
+      block.transactions.emplace_back( tx );
+   }
+   const uint32_t skip = database::skip_witness_signature | database::skip_merkle_check;
+
+   start = fc::time_point::now();
+   for( const auto& tx : block.transactions )
+      signed_transaction( tx ).get_signature_keys( db.get_chain_id() );
+   elapsed = fc::time_point::now() - start;
+   wlog( "Benchmark: ${sps} signatures/s recovered per transaction",
+         ("sps",(block_transactions*1000000)/elapsed.count()) );
+
+   signed_block cold = block;
+   start = fc::time_point::now();
+   db.precompute_parallel( cold, skip ).wait();
+   elapsed = fc::time_point::now() - start;
+   wlog( "Benchmark: ${sps} signatures/s recovered by the block batch",
+         ("sps",(block_transactions*1000000)/elapsed.count()) );
+
+   for( const auto& tx : block.transactions )
+      db.precompute_parallel( precomputable_transaction( signed_transaction( tx ) ) ).wait();
+   signed_block warm = block;
+   start = fc::time_point::now();
+   db.precompute_parallel( warm, skip ).wait();
+   elapsed = fc::time_point::now() - start;
+   wlog( "Benchmark: ${sps} signatures/s by the block batch with keys cached from the mempool",
+         ("sps",(block_transactions*1000000)/elapsed.count()) );
 }
 
 // See https://bitshares.org/blog/2015/06/08/measuring-performance/
@@ -210,4 +268,424 @@ BOOST_AUTO_TEST_CASE( one_hundred_k_benchmark )
    db._undo_db.enable();
 } FC_LOG_AND_RETHROW() }
 
+
+// Block latency and read-only API throughput while both run at once, first with the queries
+// interleaved with block production on one thread, then served by the API read pool
+BOOST_AUTO_TEST_CASE( api_read_pool_benchmark )
+{ try {
+   const uint32_t account_count = 200;
+   const uint32_t blocks = 100;
+   const uint32_t queries_per_block = 200;
+   const uint32_t pool_threads = 4;
+   const uint32_t clients = 8;
+
+   vector<string> names;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      names.push_back( "reader" + fc::to_string( i ) );
+      create_account( names.back() );
+   }
+   generate_block();
+
+   graphene::app::database_api serial_api( db );
+   auto query = [&names]( graphene::app::database_api& api, uint32_t i ) {
+      api.get_full_accounts( { names[ i % names.size() ], names[ ( i * 7 + 3 ) % names.size() ] }, false );
+   };
+   auto produce_block = [this,&names]( uint32_t i ) {
+      transfer( account_id_type(), get_account( names[ i % names.size() ] ).id, asset( 1 ) );
+      auto start = fc::time_point::now();
+      generate_block();
+      return ( fc::time_point::now() - start ).count();
+   };
+
+   {
+      int64_t block_us = 0;
+      int64_t max_block_us = 0;
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         // the block waits for the queries which arrived before it
+         auto arrived = fc::time_point::now();
+         for( uint32_t q = 0; q < queries_per_block; ++q )
+            query( serial_api, b * queries_per_block + q );
+         produce_block( b );
+         const int64_t latency = ( fc::time_point::now() - arrived ).count();
+         block_us += latency;
+         max_block_us = std::max( max_block_us, latency );
+      }
+      const int64_t elapsed = ( fc::time_point::now() - start ).count();
+      wlog( "Serial: ${qps} queries/s, block latency ${avg}us average, ${max}us max",
+            ("qps",uint64_t(blocks)*queries_per_block*1000000/elapsed)
+            ("avg",block_us/blocks)("max",max_block_us) );
+   }
+
+   graphene::app::api_read_pool::start( db, pool_threads );
+   {
+      graphene::app::database_api pooled_api( db );
+      std::atomic<bool> stop{ false };
+      std::atomic<uint64_t> queries{ 0 };
+      std::vector<std::unique_ptr<fc::thread>> client_threads;
+      std::vector<fc::future<void>> client_loops;
+      for( uint32_t c = 0; c < clients; ++c )
+      {
+         client_threads.emplace_back( new fc::thread( "api_client_" + fc::to_string( c ) ) );
+         client_loops.push_back( client_threads.back()->async( [&, c]() {
+            for( uint32_t i = c; !stop; i += clients )
+            {
+               query( pooled_api, i );
+               ++queries;
+            }
+         } ) );
+      }
+
+      int64_t block_us = 0;
+      int64_t max_block_us = 0;
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         const int64_t latency = produce_block( b );
+         block_us += latency;
+         max_block_us = std::max( max_block_us, latency );
+      }
+      const int64_t elapsed = ( fc::time_point::now() - start ).count();
+      const uint64_t served = queries;
+      stop = true;
+      for( auto& loop : client_loops )
+         loop.wait();
+      for( auto& thread : client_threads )
+         thread->quit();
+      wlog( "Pool of ${t} threads, ${c} clients: ${qps} queries/s, block latency ${avg}us average, ${max}us max",
+            ("t",pool_threads)("c",clients)("qps",served*1000000/elapsed)
+            ("avg",block_us/blocks)("max",max_block_us) );
+   }
+   graphene::app::api_read_pool::stop( db );
+} FC_LOG_AND_RETHROW() }
+
+// Undo bookkeeping of modify-heavy blocks: every transaction opens a nested session, modifies a
+// few objects and is merged into the block session, which is undone at the end like a pending block
+BOOST_AUTO_TEST_CASE( undo_session_benchmark )
+{ try {
+   const uint32_t account_count = 2000;
+   const uint32_t blocks = 50;
+   const uint32_t transactions_per_block = 2000;
+   const uint32_t modifies_per_transaction = 8;
+
+   vector<const account_statistics_object*> stats;
+   for( uint32_t i = 0; i < account_count; ++i )
+      stats.push_back( &create_account( "undo" + fc::to_string( i ) ).statistics( db ) );
+   generate_block();
+
+   auto modify_transaction = [&]( uint32_t& next ) {
+      for( uint32_t m = 0; m < modifies_per_transaction; ++m )
+         db.modify( *stats[ next++ % stats.size() ], []( account_statistics_object& s ) { ++s.total_ops; } );
+   };
+   auto run = [&]( bool with_undo ) {
+      const bool was_enabled = db._undo_db.enabled();
+      if( with_undo )
+         db._undo_db.enable();
+      else
+         db._undo_db.disable();
+      uint32_t next = 0;
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         if( !with_undo )
+         {
+            for( uint32_t t = 0; t < transactions_per_block; ++t )
+               modify_transaction( next );
+            continue;
+         }
+         auto block_session = db._undo_db.start_undo_session();
+         for( uint32_t t = 0; t < transactions_per_block; ++t )
+         {
+            auto trx_session = db._undo_db.start_undo_session();
+            modify_transaction( next );
+            trx_session.merge();
+         }
+      }
+      const int64_t elapsed = ( fc::time_point::now() - start ).count();
+      if( was_enabled )
+         db._undo_db.enable();
+      else
+         db._undo_db.disable();
+      return elapsed;
+   };
+
+   const uint64_t modifies = uint64_t( blocks ) * transactions_per_block * modifies_per_transaction;
+   const int64_t without_undo = run( false );
+   const int64_t with_undo = run( true );
+   wlog( "${m} modifies in ${b} blocks: ${plain}ms without undo, ${undo}ms with undo sessions, "
+         "${ns}ns of undo bookkeeping per modify",
+         ("m",modifies)("b",blocks)("plain",without_undo/1000)("undo",with_undo/1000)
+         ("ns",( with_undo - without_undo ) * 1000 / int64_t( modifies )) );
+} FC_LOG_AND_RETHROW() }
+
+// Cost of the account member index on account modifications, as done by maintenance and by votes: most
+// modifications leave the authorities alone, some replace a key of the active authority
+BOOST_AUTO_TEST_CASE( account_member_index_benchmark )
+{ try {
+   const uint32_t account_count = 2000;
+   const uint32_t keys_per_account = 8;
+   const uint32_t rounds = 100;
+
+   vector<const account_object*> accounts;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const account_object& account = create_account( "members" + fc::to_string( i ) );
+      db.modify( account, [&]( account_object& a ) {
+         for( uint32_t k = 1; k < keys_per_account; ++k )
+            a.active.add_authority( generate_private_key( a.name + fc::to_string( k ) ).get_public_key(), 1 );
+      });
+      accounts.push_back( &account );
+   }
+   generate_block();
+
+   const public_key_type replacement_key = generate_private_key( "replacement" ).get_public_key();
+   auto run = [&]( bool change_authorities ) {
+      auto start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+         for( const account_object* account : accounts )
+            db.modify( *account, [change_authorities,&replacement_key]( account_object& a ) {
+               ++a.num_committee_voted;
+               if( change_authorities )
+               {
+                  // swap the replacement key in and out
+                  if( a.active.key_auths.erase( replacement_key ) == 0 )
+                     a.active.key_auths[replacement_key] = 1;
+               }
+            });
+      return ( fc::time_point::now() - start ).count();
+   };
+
+   const uint64_t modifies = uint64_t( rounds ) * account_count;
+   const int64_t unchanged = run( false );
+   const int64_t changed = run( true );
+   wlog( "${m} account modifies: ${u}ns each leaving the authorities alone, ${c}ns each changing a key",
+         ("m",modifies)("u",unchanged*1000/int64_t( modifies ))("c",changed*1000/int64_t( modifies )) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( room_key_rotation_benchmark )
+{ try {
+   const uint32_t participant_count = 10000;
+   const uint32_t rotations = 20;
+
+   ACTOR( owner );
+   const room_object& room = db.create<room_object>( [owner_id]( room_object& r ) {
+      r.owner = owner_id;
+      r.name = "large";
+      r.room_key = "owner0";
+   });
+   room_rotate_key_operation rotate;
+   rotate.owner = owner_id;
+   rotate.room = room.id;
+   rotate.participant_keys[owner_id];
+   for( uint32_t i = 1; i < participant_count; ++i )
+      rotate.participant_keys[account_id_type( owner_id.instance.value + i )];
+   for( const auto& pk : rotate.participant_keys )
+      db.create<room_participant_object>( [&room,&pk]( room_participant_object& p ) {
+         p.room = room.id;
+         p.participant = pk.first;
+         p.content_key = "key0";
+      });
+   generate_block();
+
+   auto start = fc::time_point::now();
+   for( uint32_t r = 1; r <= rotations; ++r )
+   {
+      const string key = "key" + fc::to_string( r ) + std::string( 60, 'x' );
+      rotate.new_room_key = key;
+      for( auto& pk : rotate.participant_keys )
+         pk.second = key;
+      trx.operations.push_back( rotate );
+      PUSH_TX( db, trx, ~0 );
+      trx.clear();
+   }
+   const int64_t rotation_time = ( fc::time_point::now() - start ).count();
+
+   graphene::app::database_api db_api( db );
+   start = fc::time_point::now();
+   uint32_t found = 0;
+   for( uint32_t r = 1; r <= rotations; ++r )
+      for( const auto& pk : rotate.participant_keys )
+         found += db_api.get_room_key_epoch( room.id, r, pk.first ).valid();
+   const int64_t lookup_time = ( fc::time_point::now() - start ).count();
+   FC_ASSERT( found == rotations * participant_count );
+
+   wlog( "${r} rotations of a ${n} participant room: ${t}ms each, ${o} epoch objects; ${l}ns per key lookup",
+         ("r",rotations)("n",participant_count)("t",rotation_time/1000/rotations)
+         ("o",db.get_index_type<room_key_epoch_index>().indices().size()
+              + db.get_index_type<room_key_epoch_table_index>().indices().size())
+         ("l",lookup_time*1000/int64_t( found )) );
+} FC_LOG_AND_RETHROW() }
+
+namespace {
+
+// Bytes allocated on the heap, 0 where the C library cannot tell
+uint64_t heap_bytes()
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2,33)
+   return mallinfo2().uordblks;
+#else
+   return 0;
+#endif
+}
+
+template<typename Key>
+struct hash_entry
+{
+   account_id_type subject_account;
+   Key             hash;
+   object_id_type  id;
+};
+
+// the keys of content_card_index which contain the hash
+template<typename Key>
+using hash_entry_index = boost::multi_index_container<
+   hash_entry<Key>,
+   boost::multi_index::indexed_by<
+      boost::multi_index::ordered_unique< boost::multi_index::composite_key< hash_entry<Key>,
+         boost::multi_index::member< hash_entry<Key>, account_id_type, &hash_entry<Key>::subject_account >,
+         boost::multi_index::member< hash_entry<Key>, Key, &hash_entry<Key>::hash > > >,
+      boost::multi_index::ordered_unique< boost::multi_index::composite_key< hash_entry<Key>,
+         boost::multi_index::member< hash_entry<Key>, Key, &hash_entry<Key>::hash >,
+         boost::multi_index::member< hash_entry<Key>, object_id_type, &hash_entry<Key>::id > > >
+   >
+>;
+
+std::string card_hash( uint64_t i )
+{
+   return fc::sha256::hash( (const char*)&i, sizeof(i) ).str();
+}
+
+template<typename Key>
+void run_hash_key_benchmark( const char* name, uint64_t cards, const std::vector<std::string>& lookups )
+{
+   const uint32_t accounts = 100000;
+   const uint64_t heap_before = heap_bytes();
+   auto start = fc::time_point::now();
+   {
+      hash_entry_index<Key> index;
+      for( uint64_t i = 0; i < cards; ++i )
+         index.insert( hash_entry<Key>{ account_id_type( i % accounts ), Key( card_hash( i ) ),
+                                        object_id_type( 1, 12, i ) } );
+      const int64_t fill_us = ( fc::time_point::now() - start ).count();
+      const uint64_t heap_after = heap_bytes();
+
+      // the lookups content card evaluators make, from the hash string of the operation
+      const auto& by_account_and_hash = index.template get<0>();
+      uint64_t found = 0;
+      start = fc::time_point::now();
+      for( uint64_t i = 0; i < lookups.size(); ++i )
+         found += by_account_and_hash.count( boost::make_tuple( account_id_type( ( i * 7919 ) % cards % accounts ),
+                                                                Key( lookups[i] ) ) );
+      const int64_t lookup_us = ( fc::time_point::now() - start ).count();
+
+      wlog( "${name} keys, ${n} cards: filled in ${f}ms, ${b} heap bytes per card, ${l} lookups/s (${found} found)",
+            ("name",name)("n",cards)("f",fill_us/1000)
+            ("b",heap_after > heap_before ? ( heap_after - heap_before ) / cards : 0)
+            ("l",lookups.size()*1000000/std::max<int64_t>(lookup_us,1))("found",found) );
+   }
+}
+
+} // anonymous namespace
+
+// Index memory and lookup speed of content card hashes kept as strings and as fixed-size digests.
+// Set CONTENT_HASH_BENCHMARK_CARDS to change the number of cards, e.g. to 10000000.
+BOOST_AUTO_TEST_CASE( content_hash_benchmark )
+{ try {
+   uint64_t cards = 1000000;
+   if( const char* env = std::getenv( "CONTENT_HASH_BENCHMARK_CARDS" ) )
+      cards = std::max<uint64_t>( std::strtoull( env, nullptr, 10 ), 1 );
+
+   // half of the lookups hit, on the account which owns the card
+   std::vector<std::string> lookups;
+   const uint64_t lookup_count = std::min<uint64_t>( cards, 1000000 );
+   lookups.reserve( lookup_count );
+   for( uint64_t i = 0; i < lookup_count; ++i )
+   {
+      const uint64_t card = ( i * 7919 ) % cards;
+      lookups.push_back( card_hash( i % 2 == 0 ? card : card + cards ) );
+   }
+
+   run_hash_key_benchmark<std::string>( "String", cards, lookups );
+   run_hash_key_benchmark<content_hash>( "Digest", cards, lookups );
+} FC_LOG_AND_RETHROW() }
+
+namespace {
+
+template<typename Object>
+unsigned_int reflected_member_index( const std::string& name )
+{
+   unsigned_int index;
+   fc::typelist::runtime::for_each( typename fc::reflector<Object>::native_members(), [&name, &index]( auto t ) {
+      if( name == decltype(t)::type::get_name() )
+         index = decltype(t)::type::index;
+   });
+   return index;
+}
+
+} // anonymous namespace
+
+// Evaluation speed of custom authority restrictions, on transfers which comply and on transfers which do not,
+// by the predicate tree alone, by the compiled restriction program alone and by the operation predicate using both
+BOOST_AUTO_TEST_CASE( restriction_predicate_benchmark )
+{ try {
+   const uint32_t evaluations = 1000000;
+   using restriction_list = vector<restriction>;
+
+   // transfers of the core asset to one of a few accounts, for a small fee paid in core or with a memo
+   const auto asset_amount = reflected_member_index<asset>( "amount" );
+   const auto asset_id = reflected_member_index<asset>( "asset_id" );
+   restriction_list fee_branch = { restriction( reflected_member_index<transfer_operation>( "fee" ),
+         restriction::func_attr,
+         restriction_list{ restriction( asset_amount, restriction::func_lt, int64_t(1000) ),
+                           restriction( asset_id, restriction::func_eq, asset_id_type(0) ) } ) };
+   restriction_list memo_branch = { restriction( reflected_member_index<transfer_operation>( "memo" ),
+         restriction::func_attr,
+         restriction_list{ restriction( reflected_member_index<memo_data>( "nonce" ), restriction::func_ne,
+                                        int64_t(0) ) } ) };
+   restriction_list restrictions = {
+      restriction( reflected_member_index<transfer_operation>( "to" ), restriction::func_in,
+                   flat_set<account_id_type>{ account_id_type(12), account_id_type(15), account_id_type(17) } ),
+      restriction( reflected_member_index<transfer_operation>( "amount" ), restriction::func_attr,
+                   restriction_list{ restriction( asset_amount, restriction::func_le, int64_t(1000000) ),
+                                     restriction( asset_id, restriction::func_eq, asset_id_type(0) ) } ),
+      restriction( unsigned_int(999), restriction::func_logical_or,
+                   vector<restriction_list>{ fee_branch, memo_branch } ) };
+   auto predicate = get_restriction_predicate( restrictions, operation::tag<transfer_operation>::value );
+   restriction_program_builder builder;
+   auto tree = restrictions_to_predicate<transfer_operation>( restrictions, true, builder );
+   const restriction_program program = builder.finish();
+
+   transfer_operation complying;
+   complying.to = account_id_type(15);
+   complying.amount = asset( 5000 );
+   complying.fee = asset( 2000 );
+   complying.memo = memo_data();
+   complying.memo->nonce = 1;
+   transfer_operation rejected = complying;
+   rejected.memo->nonce = 0;
+
+   // evaluations per second of one way to evaluate the restrictions, checking each result
+   auto measure = [evaluations]( auto&& evaluate ) {
+      uint32_t matching = 0;
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < evaluations; ++i )
+         matching += evaluate();
+      auto elapsed = ( fc::time_point::now() - start ).count();
+      BOOST_CHECK_EQUAL( matching, evaluations );
+      return uint64_t(evaluations) * 1000000 / std::max<int64_t>( elapsed, 1 );
+   };
+   auto run = [&]( const char* name, const transfer_operation& transfer, bool expected ) {
+      const operation op = transfer;
+      const uint64_t tree_rate = measure( [&]() { return tree( transfer ).success == expected; } );
+      const uint64_t program_rate = measure( [&]() { return program.run( &transfer ) == expected; } );
+      const uint64_t predicate_rate = measure( [&]() { return predicate( op ).success == expected; } );
+      wlog( "${name} transfers: ${t} evaluations/s by the tree, ${p} by the program, ${o} by the operation predicate",
+            ("name",name)("t",tree_rate)("p",program_rate)("o",predicate_rate) );
+   };
+   run( "Complying", complying, true );
+   run( "Rejected", rejected, false );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024 contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/app/api.hpp>
+#include <graphene/postgres_indexer/postgres_indexer_plugin.hpp>
+#include <fc/crypto/sha256.hpp>
+
+#include <libpq-fe.h>
+
+#include "../common/init_unit_test_suite.hpp"
+
+#include "../common/database_fixture.hpp"
+
+#include "../common/utils.hpp"
+
+#define PG_WAIT_TIME (fc::milliseconds(10000))
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using namespace graphene::app;
+
+namespace {
+
+/// A connection of its own to the schema the plugin of the fixture writes to
+struct pg_connection
+{
+   explicit pg_connection( const std::string& url ) : conn( PQconnectdb( url.c_str() ) )
+   {
+      BOOST_REQUIRE_MESSAGE( PQstatus( conn ) == CONNECTION_OK, PQerrorMessage( conn ) );
+   }
+   ~pg_connection() { PQfinish( conn ); }
+
+   void exec( const std::string& sql )
+   {
+      PGresult* res = PQexec( conn, sql.c_str() );
+      const bool ok = PQresultStatus( res ) == PGRES_COMMAND_OK;
+      PQclear( res );
+      BOOST_REQUIRE_MESSAGE( ok, sql + ": " + PQerrorMessage( conn ) );
+   }
+
+   /// First column of the first row as a number, 0 if there is no row
+   int64_t query_number( const std::string& sql )
+   {
+      PGresult* res = PQexec( conn, sql.c_str() );
+      BOOST_REQUIRE_MESSAGE( PQresultStatus( res ) == PGRES_TUPLES_OK, sql + ": " + PQerrorMessage( conn ) );
+      int64_t value = 0;
+      if( PQntuples( res ) > 0 && !PQgetisnull( res, 0, 0 ) )
+         value = std::stoll( PQgetvalue( res, 0, 0 ) );
+      PQclear( res );
+      return value;
+   }
+
+   PGconn* conn;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( postgres_indexer_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( postgres_indexer_content_commits_with_sync_state )
+{
+   try {
+      auto plugin = app.get_plugin<graphene::postgres_indexer::postgres_indexer_plugin>( "postgres_indexer" );
+      BOOST_REQUIRE( plugin );
+      pg_connection pg( pg_url );
+
+      ACTORS((alice));
+      transfer( account_id_type()(db), alice, asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      generate_block();
+
+      auto create_content_card = [&]( const std::string& content ) {
+         content_card_create_operation op;
+         op.subject_account = alice_id;
+         op.hash = fc::sha256::hash( content ).str();
+         op.url = "http://some.image.url/" + content;
+         op.type = "image/png";
+         op.description = content;
+         op.content_key = fc::ecc::private_key::generate().get_public_key().to_base58();
+         op.storage_data = "[\"GD\",\"1.0\",\"file_id_in_google_disk\"]";
+         op.fee = db.get_global_properties().parameters.get_current_fees().calculate_fee( op );
+
+         signed_transaction trx;
+         set_expiration( db, trx );
+         trx.operations.push_back( op );
+         processed_transaction ptx = PUSH_TX( db, trx, ~0 );
+         return std::string( ptx.operation_results[0].get<object_id_type>() );
+      };
+      auto sync_state = [&]() {
+         return uint32_t( pg.query_number( "SELECT last_block_num FROM indexer_sync_state WHERE id = 1" ) );
+      };
+      auto card_rows = [&]( const std::string& table, const std::string& card_id ) {
+         return pg.query_number( "SELECT COUNT(*) FROM " + table + " WHERE content_card_id = '" + card_id + "'" );
+      };
+
+      // A card of a written block is there together with the sync state that skips the block after a restart
+      const std::string first_card = create_content_card( "first" );
+      generate_block();
+      const uint32_t first_block = db.head_block_num();
+      fc::wait_for( PG_WAIT_TIME, [&]() { return plugin->get_writer_stats().last_written_block >= first_block; } );
+      BOOST_CHECK_GE( sync_state(), first_block );
+      BOOST_CHECK_EQUAL( card_rows( "indexer_content_cards", first_card ), 1 );
+
+      // With a bulk size of 1 the history of the next block is flushed, and committed, row by row before
+      // its content is buffered. The content write is then made to fail, which is where a crash between
+      // the two writes would leave the database.
+      pg.exec( "ALTER TABLE indexer_content_cards RENAME TO indexer_content_cards_away" );
+      const auto retries = plugin->get_writer_stats().retries;
+      const std::string second_card = create_content_card( "second" );
+      generate_block();
+      const uint32_t second_block = db.head_block_num();
+      fc::wait_for( PG_WAIT_TIME, [&]() { return plugin->get_writer_stats().retries > retries; } );
+
+      BOOST_CHECK_GT( pg.query_number( "SELECT COUNT(*) FROM indexer_operation_history WHERE block_num = "
+                                       + std::to_string( second_block ) ), 0 );
+      BOOST_CHECK_EQUAL( card_rows( "indexer_content_cards_away", second_card ), 0 );
+      // A restart resumes after the sync state, so it must still be before the block of the missing card
+      BOOST_CHECK_LT( sync_state(), second_block );
+
+      // Once the content can be written, it commits together with the sync state of its block
+      pg.exec( "ALTER TABLE indexer_content_cards_away RENAME TO indexer_content_cards" );
+      fc::wait_for( PG_WAIT_TIME, [&]() { return plugin->get_writer_stats().last_written_block >= second_block; } );
+      BOOST_CHECK_GE( sync_state(), second_block );
+      BOOST_CHECK_EQUAL( card_rows( "indexer_content_cards", second_card ), 1 );
+   }
+   catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -62,6 +62,27 @@ BOOST_AUTO_TEST_CASE( asset_holders )
    BOOST_CHECK(holders[1].name == "bob");
    BOOST_CHECK(holders[2].name == "alice");
    BOOST_CHECK(holders[3].name == "dan");
+
+   // pages start at any position, the count follows the holders
+   const std::string core = std::string( static_cast<object_id_type>(asset_id_type()) );
+   BOOST_CHECK_EQUAL( asset_api.get_asset_holders_count( core ), 4 );
+   vector<account_asset_balance> page = asset_api.get_asset_holders( core, 1, 2 );
+   BOOST_REQUIRE_EQUAL( page.size(), 2u );
+   BOOST_CHECK( page[0].name == "bob" );
+   BOOST_CHECK( page[1].name == "alice" );
+   BOOST_CHECK( asset_api.get_asset_holders( core, 4, 100 ).empty() );
+
+   // an emptied balance no longer counts
+   transfer_operation xfer;
+   db.current_fee_schedule().set_fee( xfer );
+   transfer( dan, bob, asset(100) - xfer.fee, xfer.fee );
+   BOOST_CHECK_EQUAL( asset_api.get_asset_holders_count( core ), 3 );
+   holders = asset_api.get_asset_holders( core, 0, 100 );
+   BOOST_REQUIRE_EQUAL( holders.size(), 3u );
+   BOOST_CHECK( holders[2].name == "alice" );
+   for( const auto& ah : asset_api.get_all_asset_holders() )
+      if( ah.asset_id == asset_id_type() )
+         BOOST_CHECK_EQUAL( ah.count, 3 );
 }
 BOOST_AUTO_TEST_CASE( api_limit_get_asset_holders )
 {
@@ -2294,4 +2294,85 @@ BOOST_AUTO_TEST_CASE( self_deleting_proposal )
    GRAPHENE_REQUIRE_THROW(PUSH_TX( db, trx, ~0 ), fc::exception);
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( verified_transaction_cache_entries )
+{ try {
+   verified_transaction_cache cache;
+   transaction_id_type id = transaction_id_type::hash( std::string( "trx" ) );
+   const digest_type signatures = digest_type::hash( std::string( "signatures" ) );
+   const account_id_type alice( 10 );
+   const account_id_type bob( 11 );
+
+   BOOST_CHECK( !cache.is_verified( id, signatures, 2 ) );
+   cache.add( id, signatures, 2, { alice } );
+   BOOST_CHECK( cache.is_verified( id, signatures, 2 ) );
+   BOOST_CHECK( !cache.is_verified( id, digest_type::hash( std::string( "other" ) ), 2 ) );
+   BOOST_CHECK( !cache.is_verified( id, signatures, 3 ) );
+
+   cache.authority_changed( bob );
+   BOOST_CHECK( cache.is_verified( id, signatures, 2 ) );
+   cache.authority_changed( alice );
+   BOOST_CHECK( !cache.is_verified( id, signatures, 2 ) );
+
+   // checked again after the change
+   cache.add( id, signatures, 2, { alice, bob } );
+   BOOST_CHECK( cache.is_verified( id, signatures, 2 ) );
+   cache.clear();
+   BOOST_CHECK( !cache.is_verified( id, signatures, 2 ) );
+} FC_LOG_AND_RETHROW() }
+
+/// A transaction which passed its authority check against a key change must be checked again once the change is undone
+BOOST_AUTO_TEST_CASE( verified_transaction_cache_undo )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   const fc::ecc::private_key new_key = generate_private_key( "alice_new_key" );
+   const authority old_active = alice_id(db).active;
+   {
+      account_update_operation op;
+      op.account = alice_id;
+      op.owner = authority( 1, public_key_type( new_key.get_public_key() ), 1 );
+      op.active = authority( 1, public_key_type( new_key.get_public_key() ), 1 );
+      trx.clear();
+      set_expiration( db, trx );
+      trx.operations.push_back( op );
+      sign( trx, alice_private_key );
+      PUSH_TX( db, trx );
+   }
+
+   signed_transaction xfer;
+   {
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( 100 );
+      xfer.operations.push_back( op );
+      set_expiration( db, xfer );
+      sign( xfer, new_key );
+   }
+   PUSH_TX( db, xfer );
+
+   BOOST_TEST_MESSAGE( "Dropping the pending key change" );
+   db.clear_pending();
+   BOOST_CHECK( alice_id(db).active == old_active );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, xfer ), tx_missing_active_auth );
+
+   BOOST_TEST_MESSAGE( "A transaction checked in the mempool is applied in the block" );
+   signed_transaction xfer_old_key;
+   {
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( 200 );
+      xfer_old_key.operations.push_back( op );
+      set_expiration( db, xfer_old_key );
+      sign( xfer_old_key, alice_private_key );
+   }
+   PUSH_TX( db, xfer_old_key );
+   const signed_block block = generate_block();
+   BOOST_REQUIRE_EQUAL( block.transactions.size(), 1u );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 200 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -33,6 +33,8 @@
 
 #include <graphene/db/simple_index.hpp>
 
+#include <graphene/tokendistribution/tokendistribution.hpp>
+
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/hex.hpp>
 #include "../common/database_fixture.hpp"
@@ -630,4 +632,47 @@ BOOST_AUTO_TEST_CASE( bitasset_feed_expiration_test )
    BOOST_CHECK( !o.feed_is_expired( now ) );
 }
 
+
+BOOST_AUTO_TEST_CASE( eth_signature_bytes_api )
+{
+   namespace td = graphene::tokendistribution;
+   const std::string pub_key = "04e68acfc0253a10620dff706b0a1b1f1f5833ea3beb3bde2250d5f271f3563606672ebc45e0b7ea2e8"
+                               "16ecb70ca03137b1c9476eec63d4632e990020b7b6fba39";
+   const std::string sig = "0b149134fcb989ae11ceb2dabe86f2cdd16e04088c72bebe378f78011296b2876304d468b200b9d792582360"
+                           "7934cb5a6d99660f1870f802e1d4c97b25b22c7e1c";
+
+   // with or without the prefixes
+   const auto key = td::parse_public_key( pub_key );
+   BOOST_CHECK( key == td::parse_public_key( pub_key.substr(2) ) );
+   const auto signature = td::parse_signature( sig );
+   BOOST_CHECK( signature == td::parse_signature( "0x" + sig ) );
+   GRAPHENE_REQUIRE_THROW( td::parse_public_key( pub_key.substr(4) ), fc::assert_exception );
+   GRAPHENE_REQUIRE_THROW( td::parse_signature( "zz" + sig.substr(2) ), fc::assert_exception );
+
+   BOOST_CHECK_EQUAL( td::to_hex( td::get_address( key ) ), td::getAddress( pub_key ) );
+   BOOST_CHECK_EQUAL( td::getAddress( pub_key ).size(), 40u );
+
+   // the batch agrees with the single message checks, for matching and mismatching phrases
+   std::vector<td::eth_signed_message> batch;
+   for( const std::string msg : { "init0", "init1" } )
+   {
+      td::eth_signed_message m;
+      m.key = key;
+      m.hash = td::hash_message( msg );
+      m.signature = signature;
+      batch.push_back( m );
+
+      bool legacy = false;
+      try {
+         legacy = td::verifyMessage( pub_key, msg, sig ) == 0;
+      } catch( const fc::exception& ) {}
+      BOOST_CHECK_EQUAL( td::verify_message( key, m.hash, signature ), legacy );
+   }
+   const auto verified = td::verify_messages( batch );
+   BOOST_REQUIRE_EQUAL( verified.size(), 2u );
+   BOOST_CHECK_EQUAL( verified[0], td::verify_message( key, batch[0].hash, signature ) );
+   BOOST_CHECK_EQUAL( verified[1], td::verify_message( key, batch[1].hash, signature ) );
+   BOOST_CHECK( !( verified[0] && verified[1] ) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
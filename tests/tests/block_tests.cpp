@@ -35,14 +35,20 @@
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/snapshot.hpp>
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 
 #include <graphene/utilities/tempdir.hpp>
 
+#include <graphene/net/core_messages.hpp>
+#include <graphene/net/message.hpp>
+
 #include <fc/crypto/digest.hpp>
 #include <fc/io/fstream.hpp>
 
+#include <fstream>
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -72,6 +78,52 @@ genesis_state_type make_genesis() {
    return genesis_state;
 }
 
+/// Every object of @p db packed and keyed by id, to compare the states two databases ended up in
+std::map<object_id_type, vector<char>> object_state( const database& db )
+{
+   std::map<object_id_type, vector<char>> state;
+   for( uint8_t space_id = 0; space_id <= implementation_ids; ++space_id )
+      for( uint16_t type_id = 0; type_id < 255; ++type_id )
+      {
+         const graphene::db::index* idx = db.find_index( space_id, uint8_t(type_id) );
+         if( idx != nullptr )
+            idx->inspect_all_objects( [&state]( const graphene::db::object& obj ) { state[obj.id] = obj.pack(); } );
+      }
+   return state;
+}
+
+/// Generates @p count blocks on @p db, creating an account before every tenth one
+void generate_blocks_with_accounts( database& db, uint32_t count )
+{
+   auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+   for( uint32_t i = 0; i < count; ++i )
+   {
+      if( db.head_block_num() % 10 == 0 )
+      {
+         signed_transaction trx;
+         set_expiration( db, trx );
+         account_create_operation cop;
+         cop.registrar = GRAPHENE_TEMP_ACCOUNT;
+         cop.name = "replayed" + fc::to_string( db.head_block_num() );
+         cop.owner = authority( 1, init_account_priv_key.get_public_key(), 1 );
+         cop.active = cop.owner;
+         trx.operations.push_back( cop );
+         PUSH_TX( db, trx );
+      }
+      db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                         database::skip_nothing );
+   }
+}
+
+/// Puts @p block into the block log of @p data_dir in place of the block of the same number
+void replace_logged_block( const fc::path& data_dir, const signed_block& block )
+{
+   block_database bdb;
+   bdb.open( data_dir / "database" / "block_num_to_block" );
+   bdb.store( block.id(), block );
+   bdb.close();
+}
+
 BOOST_AUTO_TEST_SUITE(block_tests)
 
 BOOST_AUTO_TEST_CASE( block_database_test )
@@ -129,6 +181,12 @@ BOOST_AUTO_TEST_CASE( block_database_test )
          FC_ASSERT( blk->witness == witness_id_type(blk->block_num()) );
       }
 
+      // packed blocks are served as stored, after whatever is already in the buffer
+      vector<char> packed( 3, 'x' );
+      FC_ASSERT( bdb.fetch_packed( b.id(), packed ) );
+      FC_ASSERT( vector<char>( packed.begin() + 3, packed.end() ) == fc::raw::pack( signed_block( b ) ) );
+      FC_ASSERT( !bdb.fetch_packed( block_id_type(), packed ) );
+
    } catch (fc::exception& e) {
       edump((e.to_detail_string()));
       throw;
@@ -194,6 +252,274 @@ BOOST_AUTO_TEST_CASE( generate_empty_blocks )
    }
 }
 
+BOOST_AUTO_TEST_CASE( object_checkpoints_survive_crash )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+      uint32_t last_block;
+      block_id_type last_block_id;
+      {
+         database db;
+         db.enable_object_checkpoints( 10, 3 );
+         db.open(data_dir.path(), make_genesis, "TEST" );
+         while( db.get_dynamic_global_properties().last_irreversible_block_num < 100 )
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                              database::skip_nothing);
+         last_block = db.head_block_num();
+         last_block_id = db.head_block_id();
+         // no close(), as if the node crashed
+      }
+      BOOST_CHECK( fc::exists( data_dir.path() / "object_database" / "checkpoint" ) );
+      {
+         database db;
+         db.open(data_dir.path(), []{return genesis_state_type();}, "TEST");
+         BOOST_CHECK_EQUAL( db.head_block_num(), last_block );
+         BOOST_CHECK( db.head_block_id() == last_block_id );
+         for( uint32_t i = 0; i < 20; ++i )
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                              database::skip_nothing);
+         BOOST_CHECK_EQUAL( db.head_block_num(), last_block + 20 );
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( start_from_binary_snapshot )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory snapshot_dir( graphene::utilities::temp_directory_path() );
+      const fc::path snapshot_file = snapshot_dir.path() / "snapshot.bin";
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+      uint32_t last_block;
+      uint32_t account_count;
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis, "TEST" );
+         while( db.get_dynamic_global_properties().last_irreversible_block_num < 50 )
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                              database::skip_nothing);
+         db.write_snapshot( snapshot_file ).wait();
+         last_block = db.head_block_num();
+         account_count = db.get_index_type<account_index>().indices().size();
+         db.close();
+      }
+
+      std::string data;
+      fc::read_file_contents( snapshot_file, data );
+      const snapshot_header header = read_snapshot_header( data.data(), data.size() );
+      BOOST_CHECK( header.head_block_num >= 50 && header.head_block_num <= last_block );
+      BOOST_CHECK_EQUAL( header.db_version, "TEST" );
+
+      // a corrupt section is rejected
+      {
+         fc::temp_directory corrupt_dir( graphene::utilities::temp_directory_path() );
+         std::string corrupt = data;
+         corrupt[ header.sections.front().offset ] ^= 1;
+         const fc::path corrupt_file = corrupt_dir.path() / "snapshot.bin";
+         {
+            std::ofstream out( corrupt_file.generic_string(), std::ofstream::binary );
+            out.write( corrupt.data(), corrupt.size() );
+         }
+         database db;
+         db.start_from_snapshot( corrupt_file );
+         BOOST_CHECK_THROW( db.open( corrupt_dir.path() / "node", make_genesis, "TEST" ), fc::exception );
+      }
+
+      // without blocks
+      {
+         fc::temp_directory new_dir( graphene::utilities::temp_directory_path() );
+         database db;
+         db.start_from_snapshot( snapshot_file );
+         db.open( new_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK_EQUAL( db.head_block_num(), header.head_block_num );
+         BOOST_CHECK( db.head_block_id() == header.head_block_id );
+         BOOST_CHECK_EQUAL( db.get_index_type<account_index>().indices().size(), account_count );
+         // known from the block summaries only
+         BOOST_CHECK( db.get_block_id_for_num( header.head_block_num ) == header.head_block_id );
+         for( uint32_t i = 0; i < 20; ++i )
+            db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                              database::skip_nothing);
+         BOOST_CHECK_EQUAL( db.head_block_num(), header.head_block_num + 20 );
+      }
+
+      // the blocks of the block log which follow the snapshot are replayed
+      {
+         database db;
+         db.wipe( data_dir.path(), false );
+         db.start_from_snapshot( snapshot_file );
+         db.open( data_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK_EQUAL( db.head_block_num(), last_block );
+         BOOST_CHECK_EQUAL( db.get_index_type<account_index>().indices().size(), account_count );
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( replay_pipeline_matches_sequential_apply )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const uint32_t failing_block = 30;
+      const uint32_t undecodable_block = 40;
+      std::map<object_id_type, vector<char>> state_before_failing;
+      std::map<object_id_type, vector<char>> state_before_undecodable;
+      std::map<object_id_type, vector<char>> final_state;
+      uint32_t last_block;
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis, "TEST" );
+         generate_blocks_with_accounts( db, failing_block - 1 );
+         state_before_failing = object_state( db );
+         generate_blocks_with_accounts( db, undecodable_block - failing_block );
+         state_before_undecodable = object_state( db );
+         generate_blocks_with_accounts( db, 60 - undecodable_block + 1 );
+         final_state = object_state( db );
+         last_block = db.head_block_num();
+         db.close();
+      }
+
+      // lookahead and decoding threads only change how far ahead blocks are prepared, never the state
+      const std::vector< std::pair<uint32_t, uint32_t> > pipelines = { {1, 1}, {2, 1}, {8, 3}, {256, 0} };
+      for( const auto& pipeline : pipelines )
+      {
+         BOOST_TEST_MESSAGE( "Replaying with lookahead " + fc::to_string( pipeline.first )
+                             + " on " + fc::to_string( pipeline.second ) + " threads" );
+         database db;
+         db.wipe( data_dir.path(), false );
+         db.set_replay_pipeline( pipeline.first, pipeline.second );
+         db.open( data_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK_EQUAL( db.head_block_num(), last_block );
+         BOOST_CHECK( object_state( db ) == final_state );
+         db.close();
+      }
+
+      // a block failing to apply stops the replay in the state before it, with later blocks already decoded
+      optional<signed_block> original;
+      {
+         block_database bdb;
+         bdb.open( data_dir.path() / "database" / "block_num_to_block" );
+         original = bdb.fetch_by_number( failing_block );
+         bdb.close();
+      }
+      BOOST_REQUIRE( original.valid() );
+      signed_block unsigned_block = *original;
+      unsigned_block.timestamp += GRAPHENE_DEFAULT_BLOCK_INTERVAL;
+      replace_logged_block( data_dir.path(), unsigned_block );
+      {
+         database db;
+         db.wipe( data_dir.path(), false );
+         db.set_replay_pipeline( 16, 4 );
+         BOOST_CHECK_THROW( db.open( data_dir.path(), make_genesis, "TEST" ), fc::exception );
+         BOOST_CHECK_EQUAL( db.head_block_num(), failing_block - 1 );
+         BOOST_CHECK( object_state( db ) == state_before_failing );
+      }
+      replace_logged_block( data_dir.path(), *original );
+
+      // a block which can not be decoded ends the replay like a gap, the blocks after it are dropped
+      {
+         index_entry entry;
+         {
+            std::ifstream index( ( data_dir.path() / "database" / "block_num_to_block" / "index" ).generic_string(),
+                                 std::ios::binary );
+            index.seekg( sizeof( index_entry ) * undecodable_block );
+            index.read( (char*)&entry, sizeof( entry ) );
+         }
+         // a byte of the previous block id, so the block no longer hashes to the id it was logged under
+         std::fstream blocks( ( data_dir.path() / "database" / "block_num_to_block" / "blocks" ).generic_string(),
+                              std::ios::binary | std::ios::in | std::ios::out );
+         blocks.seekg( entry.block_pos.value() + 10 );
+         char byte = 0;
+         blocks.read( &byte, 1 );
+         byte ^= 1;
+         blocks.seekp( entry.block_pos.value() + 10 );
+         blocks.write( &byte, 1 );
+      }
+      {
+         database db;
+         db.wipe( data_dir.path(), false );
+         db.set_replay_pipeline( 16, 4 );
+         db.open( data_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK_EQUAL( db.head_block_num(), undecodable_block - 1 );
+         BOOST_CHECK( object_state( db ) == state_before_undecodable );
+         BOOST_CHECK( !db.fetch_block_by_number( undecodable_block + 1 ).valid() );
+         db.close();
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( replay_pipeline_crosses_undo_point )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      // the undo point is 20 blocks in, before it blocks are applied without undo states
+      const uint32_t failing_block = 10;
+      std::map<object_id_type, vector<char>> final_state;
+      uint32_t last_block;
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis, "TEST" );
+         generate_blocks_with_accounts( db, GRAPHENE_MAX_UNDO_HISTORY + 20 );
+         final_state = object_state( db );
+         last_block = db.head_block_num();
+         db.close();
+      }
+
+      {
+         database db;
+         db.wipe( data_dir.path(), false );
+         db.set_replay_pipeline( 64, 2 );
+         db.open( data_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK_EQUAL( db.head_block_num(), last_block );
+         BOOST_CHECK( object_state( db ) == final_state );
+         db.close();
+      }
+
+      // a block failing to apply before the undo point still ends the replay with an error, with the
+      // decoding threads busy on the blocks after it
+      optional<signed_block> original;
+      {
+         block_database bdb;
+         bdb.open( data_dir.path() / "database" / "block_num_to_block" );
+         original = bdb.fetch_by_number( failing_block );
+         bdb.close();
+      }
+      BOOST_REQUIRE( original.valid() );
+      signed_block unsigned_block = *original;
+      unsigned_block.timestamp += GRAPHENE_DEFAULT_BLOCK_INTERVAL;
+      replace_logged_block( data_dir.path(), unsigned_block );
+      {
+         database db;
+         db.wipe( data_dir.path(), false );
+         db.set_replay_pipeline( 64, 2 );
+         BOOST_CHECK_THROW( db.open( data_dir.path(), make_genesis, "TEST" ), fc::exception );
+         BOOST_CHECK_EQUAL( db.head_block_num(), failing_block - 1 );
+      }
+
+      // once the block is back the replay gets through again
+      replace_logged_block( data_dir.path(), *original );
+      {
+         database db;
+         db.wipe( data_dir.path(), false );
+         db.open( data_dir.path(), make_genesis, "TEST" );
+         BOOST_CHECK_EQUAL( db.head_block_num(), last_block );
+         BOOST_CHECK( object_state( db ) == final_state );
+         db.close();
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( undo_block )
 {
    try {
@@ -1874,4 +2200,119 @@ BOOST_FIXTURE_TEST_CASE( block_size_test, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( precompute_block_signatures, database_fixture )
+{
+   try
+   {
+      ACTORS((alice)(bob));
+      transfer(committee_account, alice_id, asset(10000000));
+
+      auto make_transfer = [&]( share_type amount ) {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = alice_id;
+         op.to = bob_id;
+         op.amount = asset(amount);
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         return tx;
+      };
+      signed_transaction from_mempool = make_transfer( 1 );
+      sign( from_mempool, alice_private_key );
+      signed_transaction two_signers = make_transfer( 2 );
+      sign( two_signers, alice_private_key );
+      sign( two_signers, bob_private_key );
+      signed_transaction unsigned_tx = make_transfer( 3 );
+
+      BOOST_TEST_MESSAGE( "Keys of a mempool transaction are recovered and cached" );
+      precomputable_transaction pending( from_mempool );
+      db.precompute_parallel( pending ).wait();
+      BOOST_CHECK( pending.has_signature_keys() );
+      BOOST_CHECK( pending.get_signature_keys( db.get_chain_id() ) == flat_set<public_key_type>{ alice_public_key } );
+
+      BOOST_TEST_MESSAGE( "Keys of every transaction of a block are set by the block batch" );
+      signed_block block;
+      block.transactions.emplace_back( from_mempool );
+      block.transactions.emplace_back( two_signers );
+      block.transactions.emplace_back( unsigned_tx );
+      // the same transaction twice, both copies get its keys
+      block.transactions.emplace_back( two_signers );
+      for( const auto& tx : block.transactions )
+         BOOST_CHECK_EQUAL( tx.has_signature_keys(), tx.signatures.empty() );
+
+      db.precompute_parallel( block, database::skip_transaction_signatures ).wait();
+      BOOST_CHECK( !block.transactions[0].has_signature_keys() );
+
+      db.precompute_parallel( block, database::skip_witness_signature | database::skip_merkle_check ).wait();
+      for( const auto& tx : block.transactions )
+      {
+         BOOST_REQUIRE( tx.has_signature_keys() );
+         // recovered one signature at a time for comparison
+         const signed_transaction plain( tx );
+         BOOST_CHECK( tx.get_signature_keys( db.get_chain_id() ) == plain.get_signature_keys( db.get_chain_id() ) );
+      }
+      BOOST_CHECK( block.transactions[1].get_signature_keys( db.get_chain_id() )
+                   == flat_set<public_key_type>( { alice_public_key, bob_public_key } ) );
+      BOOST_CHECK( block.transactions[2].get_signature_keys( db.get_chain_id() ).empty() );
+      BOOST_CHECK( block.transactions[3].get_signature_keys( db.get_chain_id() )
+                   == block.transactions[1].get_signature_keys( db.get_chain_id() ) );
+
+      BOOST_TEST_MESSAGE( "A duplicate signature still rejects the block" );
+      signed_transaction duplicate = make_transfer( 4 );
+      sign( duplicate, alice_private_key );
+      duplicate.signatures.push_back( duplicate.signatures.front() );
+      signed_block bad_block;
+      bad_block.transactions.emplace_back( from_mempool );
+      bad_block.transactions.emplace_back( duplicate );
+      GRAPHENE_REQUIRE_THROW( db.precompute_parallel( bad_block, database::skip_witness_signature
+                                                                 | database::skip_merkle_check ).wait(),
+                              tx_duplicate_sig );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( compact_block_rebuild, database_fixture )
+{
+   try
+   {
+      ACTORS((alice)(bob));
+      transfer(committee_account, alice_id, asset(10000000));
+      transfer(alice_id, bob_id, asset(1000));
+      transfer(alice_id, bob_id, asset(2000));
+      const signed_block block = generate_block();
+      BOOST_REQUIRE_GE( block.transactions.size(), 3u );
+
+      const graphene::net::block_message full( block );
+      const graphene::net::message full_message( full );
+      const graphene::net::compact_block_message compact( full.block, full.block_id, full_message.id() );
+      BOOST_CHECK_EQUAL( compact.short_ids.size(), block.transactions.size() );
+      BOOST_CHECK_EQUAL( compact.short_ids[0],
+                         graphene::net::compact_block_message::short_transaction_id( block.id(), block.transactions[0].id() ) );
+      BOOST_CHECK_LT( fc::raw::pack_size( compact ), fc::raw::pack_size( full ) );
+
+      // the transactions as they were relayed, without their results
+      vector<signed_transaction> transactions( block.transactions.begin(), block.transactions.end() );
+
+      // rebuilt from its transactions, the block is the one which was requested
+      const graphene::net::block_message rebuilt( compact.rebuild_block( vector<signed_transaction>( transactions ) ) );
+      BOOST_CHECK( rebuilt.block_id == block.id() );
+      BOOST_CHECK( rebuilt.block.calculate_merkle_root() == block.transaction_merkle_root );
+      BOOST_CHECK( graphene::net::message( rebuilt ).id() == full_message.id() );
+
+      // a wrong transaction does not match the header
+      std::swap( transactions[1], transactions[2] );
+      const signed_block mismatched = compact.rebuild_block( std::move( transactions ) );
+      BOOST_CHECK( mismatched.calculate_merkle_root() != block.transaction_merkle_root );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
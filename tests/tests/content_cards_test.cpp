@@ -27,7 +27,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/app/database_api.hpp>
+#include <graphene/chain/content_hash.hpp>
+#include <graphene/chain/content_store.hpp>
 #include <graphene/content_cards/content_cards.hpp>
+#include <graphene/utilities/tempdir.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -108,14 +111,14 @@ try {
 
    const auto &cc = db_api.get_content_card_by_id(content_card_id);
    BOOST_CHECK( cc.valid() );
-   BOOST_CHECK_EQUAL( cc->hash, hash );
+   BOOST_CHECK_EQUAL( cc->hash.str(), hash );
    BOOST_CHECK_EQUAL( cc->content_key, content_key );
    BOOST_CHECK_EQUAL( cc->url, content_url );
    BOOST_CHECK_EQUAL( cc->type, content_type );
    BOOST_CHECK_EQUAL( cc->storage_data, content_storage_data );
 
    const auto& ccs = db_api.get_content_cards(alice_id, content_card_id, 100);
-   BOOST_CHECK_EQUAL( ccs[0].hash, hash );
+   BOOST_CHECK_EQUAL( ccs[0].hash.str(), hash );
    BOOST_CHECK_EQUAL( ccs[0].content_key, content_key );
    BOOST_CHECK_EQUAL( ccs[0].url, content_url );
    BOOST_CHECK_EQUAL( ccs[0].type, content_type );
@@ -126,4 +129,158 @@ catch (fc::exception &e) {
    throw;
 } }
 
+BOOST_AUTO_TEST_CASE(content_cards_store_api_test)
+{
+try {
+   ACTORS((alice));
+   BOOST_REQUIRE( db.get_content_store() != nullptr );
+
+   room_create_operation create;
+   create.owner = alice_id;
+   create.name = "room";
+   create.room_key = "alice0";
+   trx.operations.push_back(create);
+   set_expiration(db, trx);
+   sign(trx, alice_private_key);
+   room_id_type room = PUSH_TX(db, trx).operation_results[0].get<object_id_type>();
+   trx.clear();
+
+   content_card_create_operation op;
+   op.subject_account = alice_id;
+   op.hash = hash;
+   op.url = content_url;
+   op.type = content_type;
+   op.description = content_description;
+   op.content_key = content_key;
+   op.storage_data = content_storage_data;
+   op.room = room;
+   op.fee = db.get_global_properties().parameters.get_current_fees().calculate_fee(op);
+   trx.operations.push_back(op);
+   set_expiration(db, trx);
+   sign(trx, alice_private_key);
+   content_card_id_type content_card_id = PUSH_TX(db, trx).operation_results[0].get<object_id_type>();
+   trx.clear();
+
+   // the payload lives in the store, not in the object
+   const content_card_object& card = content_card_id(db);
+   BOOST_REQUIRE( card.payload.valid() );
+   BOOST_CHECK( card.url.empty() );
+
+   auto check_payload = []( const content_card_object& cc ) {
+      BOOST_CHECK_EQUAL( cc.url, content_url );
+      BOOST_CHECK_EQUAL( cc.description, content_description );
+      BOOST_CHECK_EQUAL( cc.content_key, content_key );
+      BOOST_CHECK_EQUAL( cc.storage_data, content_storage_data );
+   };
+
+   graphene::app::database_api db_api(db);
+
+   const auto cc = db_api.get_content_card_by_id(content_card_id);
+   BOOST_REQUIRE( cc.valid() );
+   check_payload( *cc );
+
+   const auto ccs = db_api.get_content_cards(alice_id, content_card_id, 100);
+   BOOST_REQUIRE_EQUAL( ccs.size(), 1u );
+   check_payload( ccs[0] );
+
+   const auto by_room = db_api.get_content_cards_by_room(room, content_card_id, 100);
+   BOOST_REQUIRE_EQUAL( by_room.size(), 1u );
+   check_payload( by_room[0] );
+}
+catch (fc::exception &e) {
+   edump((e.to_detail_string()));
+   throw;
+} }
+
+BOOST_AUTO_TEST_CASE(content_hash_test)
+{
+try {
+   const content_hash digest( hash );
+   BOOST_CHECK( digest.is_digest() );
+   BOOST_CHECK_EQUAL( digest.str(), hash );
+
+   // anything but 64 lowercase hex digits is kept as given
+   std::string upper = hash;
+   std::transform( upper.begin(), upper.end(), upper.begin(), ::toupper );
+   const content_hash upper_hash( upper );
+   const content_hash short_hash( "abc" );
+   BOOST_CHECK( !upper_hash.is_digest() );
+   BOOST_CHECK( !short_hash.is_digest() );
+   BOOST_CHECK_EQUAL( upper_hash.str(), upper );
+   BOOST_CHECK( upper_hash != digest );
+   BOOST_CHECK( content_hash( upper ) == upper_hash );
+   BOOST_CHECK( content_hash( hash ) == digest );
+
+   // digests sort like their hex strings, before other hashes
+   const std::string other = fc::sha256::hash( std::string( "other content" ) );
+   BOOST_CHECK_EQUAL( content_hash( other ) < digest, other < hash );
+   BOOST_CHECK( digest < short_hash );
+   BOOST_CHECK( !( short_hash < digest ) );
+   BOOST_CHECK( short_hash < upper_hash || upper_hash < short_hash );
+
+   // serialized as the string
+   BOOST_CHECK( fc::raw::pack( digest ) == fc::raw::pack( hash ) );
+   BOOST_CHECK( fc::raw::unpack<content_hash>( fc::raw::pack( upper ) ) == upper_hash );
+   BOOST_CHECK_EQUAL( fc::variant( digest, 1 ).as_string(), hash );
+   BOOST_CHECK( fc::variant( upper, 1 ).as<content_hash>( 1 ) == upper_hash );
+}
+catch (fc::exception &e) {
+   edump((e.to_detail_string()));
+   throw;
+} }
+
+BOOST_AUTO_TEST_CASE(content_store_test)
+{
+try {
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path filename = data_dir.path() / "content_store" / "payloads";
+
+   content_payload first{ content_url, content_description, content_key, content_storage_data };
+   content_payload second{ content_url + "?2", content_description, content_key, content_storage_data };
+
+   content_store_ref first_ref, second_ref;
+   {
+      // too small a cache to hold both payloads
+      content_store store( sizeof(content_payload) + 100 );
+      store.open( filename );
+      first_ref = store.append( first );
+      second_ref = store.append( second );
+      BOOST_CHECK_EQUAL( second_ref.offset, first_ref.offset + first_ref.size );
+
+      // payloads appended again are not stored twice
+      const content_store_ref again = store.append( first );
+      BOOST_CHECK_EQUAL( again.offset, first_ref.offset );
+      BOOST_CHECK_EQUAL( store.size(), second_ref.offset + second_ref.size );
+
+      for( int i = 0; i < 2; ++i )
+      {
+         BOOST_CHECK_EQUAL( store.read( first_ref ).url, content_url );
+         BOOST_CHECK_EQUAL( store.read( second_ref ).url, content_url + "?2" );
+      }
+      BOOST_CHECK_EQUAL( store.read( second_ref ).storage_data, content_storage_data );
+
+      content_store_ref past_end = second_ref;
+      past_end.offset += 1;
+      GRAPHENE_REQUIRE_THROW( store.read( past_end ), fc::exception );
+      store.close();
+   }
+
+   // references stay valid once the store is opened again
+   content_store store( 1 << 20 );
+   store.open( filename );
+   const content_payload read = store.read( first_ref );
+   BOOST_CHECK_EQUAL( read.url, content_url );
+   BOOST_CHECK_EQUAL( read.description, content_description );
+   BOOST_CHECK_EQUAL( read.content_key, content_key );
+   BOOST_CHECK_EQUAL( read.storage_data, content_storage_data );
+
+   store.clear();
+   BOOST_CHECK_EQUAL( store.size(), 0u );
+   GRAPHENE_REQUIRE_THROW( store.read( first_ref ), fc::exception );
+}
+catch (fc::exception &e) {
+   edump((e.to_detail_string()));
+   throw;
+} }
+
 BOOST_AUTO_TEST_SUITE_END()
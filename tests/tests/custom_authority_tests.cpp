@@ -455,6 +455,52 @@ BOOST_AUTO_TEST_CASE(container_in_not_in_checks) { try {
    BOOST_CHECK(!pred(op));
 } FC_LOG_AND_RETHROW() }
 
+// Branches of a logical OR failing within attribute assertions, where the compiled program must resume on the
+// operation itself for the next branch and the restrictions after the OR
+BOOST_AUTO_TEST_CASE(restriction_program_branch_checks) { try {
+   auto asset_amount_index = member_index<asset>("amount");
+   auto asset_id_index = member_index<asset>("asset_id");
+   vector<restriction> fee_branch = {restriction(member_index<transfer_operation>("fee"), FUNC(attr),
+         vector<restriction>{restriction(asset_amount_index, FUNC(lt), int64_t(10)),
+                             restriction(asset_id_index, FUNC(eq), asset_id_type(1))})};
+   vector<restriction> memo_branch = {restriction(member_index<transfer_operation>("memo"), FUNC(attr),
+         vector<restriction>{restriction(member_index<memo_data>("nonce"), FUNC(eq), int64_t(7))})};
+   vector<restriction> amount_branch = {restriction(member_index<transfer_operation>("amount"), FUNC(attr),
+         vector<restriction>{restriction(asset_id_index, FUNC(eq), asset_id_type(0))})};
+   unsigned_int dummy_index = 999;
+   vector<restriction> restrictions = {
+      restriction(dummy_index, FUNC(logical_or), vector<vector<restriction>>{fee_branch, memo_branch, amount_branch}),
+      restriction(member_index<transfer_operation>("to"), FUNC(eq), account_id_type(12))};
+   auto predicate = get_restriction_predicate(restrictions, operation::tag<transfer_operation>::value);
+
+   // The fee branch fails on the asset, the memo branch on the null memo
+   transfer_operation transfer;
+   transfer.fee = asset(5, asset_id_type(0));
+   transfer.amount = asset(100, asset_id_type(0));
+   transfer.to = account_id_type(12);
+   BOOST_CHECK(predicate(transfer));
+   transfer.to = account_id_type(13);
+   BOOST_CHECK(!predicate(transfer));
+   BOOST_CHECK_EQUAL(predicate(transfer).rejection_path[0].get<size_t>(), 1u);
+
+   // All branches fail
+   transfer.to = account_id_type(12);
+   transfer.amount = asset(100, asset_id_type(2));
+   auto result = predicate(transfer);
+   BOOST_CHECK(!result);
+   BOOST_CHECK_EQUAL(result.rejection_path[0].get<size_t>(), 0u);
+   BOOST_CHECK_EQUAL(result.rejection_path[1].get<vector<predicate_result>>().size(), 3u);
+
+   transfer.memo = memo_data();
+   transfer.memo->nonce = 7;
+   BOOST_CHECK(predicate(transfer));
+   transfer.memo.reset();
+   transfer.fee = asset(5, asset_id_type(1));
+   BOOST_CHECK(predicate(transfer));
+   transfer.fee = asset(10, asset_id_type(1));
+   BOOST_CHECK(!predicate(transfer));
+} FC_LOG_AND_RETHROW() }
+
    /**
     * Test predicates containing logical ORs
     * Test of authorization and revocation of one account (actanet) authorizing multiple other accounts (Bob and Charlie)
@@ -26,6 +26,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/api_read_pool.hpp>
 #include <graphene/app/database_api.hpp>
 #include <graphene/chain/hardfork.hpp>
 
@@ -34,6 +35,9 @@
 
 #include "../common/database_fixture.hpp"
 
+#include "../../libraries/app/subscription_hub.hxx"
+
+#include <atomic>
 #include <random>
 
 using namespace graphene::chain;
@@ -1051,6 +1055,95 @@ BOOST_AUTO_TEST_CASE( subscription_notification_test )
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( subscription_hub_delivery )
+{ try {
+   auto hub = graphene::app::subscription_hub::get( db );
+   BOOST_CHECK( hub == graphene::app::subscription_hub::get( db ) );
+
+   // the dynamic global properties change in every block
+   const object_id_type dgp_id = db.get_dynamic_global_properties().id;
+   std::atomic<uint32_t> first_updates{0};
+   std::atomic<uint32_t> second_updates{0};
+   std::atomic<bool> hold_first{false};
+   std::atomic<bool> first_held{false};
+   auto wait_for = []( const std::atomic<bool>& flag ) {
+      for( int i = 0; i < 1000 && !flag; ++i )
+         fc::usleep( fc::milliseconds(1) );
+   };
+   auto wait_for_deliveries = []() {
+      fc::usleep( fc::milliseconds(200) ); // sleep a while to execute callback in another thread
+   };
+
+   const uint64_t first = hub->add_subscriber();
+   const uint64_t second = hub->add_subscriber();
+   hub->set_callback( first, [&]( const variant& ) {
+      ++first_updates;
+      if( hold_first )
+      {
+         first_held = true;
+         while( hold_first )
+            fc::usleep( fc::milliseconds(1) );
+      }
+   }, false );
+   hub->subscribe_to_object( first, dgp_id );
+
+   // subscribed without a callback
+   hub->subscribe_to_object( second, dgp_id );
+   generate_block();
+   wait_for_deliveries();
+   BOOST_CHECK_GE( first_updates.load(), 1u );
+   BOOST_CHECK_EQUAL( second_updates.load(), 0u );
+
+   hub->set_callback( second, [&]( const variant& ) { ++second_updates; }, false );
+   hub->subscribe_to_object( second, dgp_id );
+   first_updates = 0;
+   generate_block();
+   wait_for_deliveries();
+   BOOST_CHECK_GE( first_updates.load(), 1u );
+   BOOST_CHECK_GE( second_updates.load(), 1u );
+
+   // reset without dropping the callback ends the subscriptions
+   hub->reset( first, false );
+   first_updates = 0;
+   second_updates = 0;
+   generate_block();
+   wait_for_deliveries();
+   BOOST_CHECK_EQUAL( first_updates.load(), 0u );
+   BOOST_CHECK_GE( second_updates.load(), 1u );
+
+   // updates queued before a cancellation are not delivered: the second subscriber cancels while the
+   // first one's callback of the same batch runs
+   hub->subscribe_to_object( first, dgp_id );
+   hold_first = true;
+   generate_block();
+   wait_for( first_held );
+   BOOST_REQUIRE( first_held );
+   second_updates = 0;
+   hub->reset( second, true );
+   hold_first = false;
+   wait_for_deliveries();
+   BOOST_CHECK_EQUAL( second_updates.load(), 0u );
+
+   // nor to a removed subscriber
+   first_held = false;
+   hold_first = true;
+   hub->set_callback( second, [&]( const variant& ) { ++second_updates; }, false );
+   hub->subscribe_to_object( second, dgp_id );
+   generate_block();
+   wait_for( first_held );
+   BOOST_REQUIRE( first_held );
+   hub->remove_subscriber( second );
+   hold_first = false;
+   wait_for_deliveries();
+   BOOST_CHECK_EQUAL( second_updates.load(), 0u );
+
+   hub->remove_subscriber( first );
+   first_updates = 0;
+   generate_block();
+   wait_for_deliveries();
+   BOOST_CHECK_EQUAL( first_updates.load(), 0u );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( get_all_workers )
 { try {
    graphene::app::database_api db_api( db, &( app.get_options() ));
@@ -1327,4 +1420,381 @@ BOOST_AUTO_TEST_CASE( verify_authority_multiple_accounts )
    }
 }
 
+BOOST_AUTO_TEST_CASE( room_key_epoch_tables )
+{ try {
+   ACTORS( (alice)(bob)(charlie) );
+
+   graphene::app::database_api db_api( db );
+
+   auto push = [this,&alice_private_key]( const operation& op ) {
+      trx.operations.push_back( op );
+      sign( trx, alice_private_key );
+      processed_transaction ptx = PUSH_TX( db, trx );
+      trx.clear();
+      return ptx.operation_results[0].get<object_id_type>();
+   };
+
+   room_create_operation create;
+   create.owner = alice_id;
+   create.name = "room";
+   create.room_key = "alice0";
+   room_id_type room = push( create );
+
+   room_add_participant_operation add;
+   add.owner = alice_id;
+   add.room = room;
+   add.participant = bob_id;
+   add.content_key = "bob0";
+   push( add );
+
+   room_rotate_key_operation rotate;
+   rotate.owner = alice_id;
+   rotate.room = room;
+   rotate.new_room_key = "alice1";
+   rotate.participant_keys = { { alice_id, "alice1" }, { bob_id, "bob1" } };
+   push( rotate );
+
+   // added during epoch 1, with the key of epoch 0
+   add.participant = charlie_id;
+   add.content_key = "charlie1";
+   add.epoch_keys = { { 0, "charlie0" } };
+   push( add );
+
+   rotate.new_room_key = "alice2";
+   rotate.participant_keys = { { alice_id, "alice2" }, { bob_id, "bob2" }, { charlie_id, "charlie2" } };
+   push( rotate );
+
+   // one table per rotation, no per participant records
+   const auto& tables = db.get_index_type<room_key_epoch_table_index>().indices().get<by_room_and_epoch>();
+   BOOST_CHECK_EQUAL( 2u, tables.size() );
+   const auto& records = db.get_index_type<room_key_epoch_index>().indices().get<by_room_epoch_participant>();
+   BOOST_CHECK( records.find( boost::make_tuple( room, 1u, bob_id ) ) == records.end() );
+
+   auto keys = []( const vector<room_key_epoch_object>& epochs ) {
+      vector<string> result;
+      for( const auto& e : epochs )
+         result.push_back( std::to_string( e.epoch ) + ":" + e.content_key );
+      return result;
+   };
+   auto expected = []( std::initializer_list<string> l ) { return vector<string>( l ); };
+
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, alice_id, 100 ) )
+                == expected( { "0:alice0", "1:alice1", "2:alice2" } ) );
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, bob_id, 100 ) )
+                == expected( { "0:bob0", "1:bob1", "2:bob2" } ) );
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, charlie_id, 100 ) )
+                == expected( { "0:charlie0", "1:charlie1", "2:charlie2" } ) );
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, bob_id, 2 ) ) == expected( { "0:bob0", "1:bob1" } ) );
+
+   // keys from a table have no object of their own, so no two participants' keys share an ID
+   std::set<object_id_type> ids;
+   size_t with_id = 0;
+   for( const auto& participant : { alice_id, bob_id, charlie_id } )
+      for( const auto& e : db_api.get_room_key_epochs( room, participant, 100 ) )
+      {
+         if( e.id == object_id_type() )
+            continue;
+         ++with_id;
+         ids.insert( e.id );
+         BOOST_CHECK( e.id.is<room_key_epoch_id_type>() );
+      }
+   BOOST_CHECK_EQUAL( ids.size(), with_id );
+   BOOST_CHECK( db_api.get_room_key_epoch( room, 1, bob_id )->id == object_id_type() );
+   BOOST_CHECK( db_api.get_room_key_epoch( room, 2, alice_id )->id == object_id_type() );
+
+   BOOST_REQUIRE( db_api.get_room_key_epoch( room, 1, bob_id ).valid() );
+   BOOST_CHECK_EQUAL( "bob1", db_api.get_room_key_epoch( room, 1, bob_id )->content_key );
+   BOOST_REQUIRE( db_api.get_room_key_epoch( room, 1, charlie_id ).valid() );
+   BOOST_CHECK_EQUAL( "charlie1", db_api.get_room_key_epoch( room, 1, charlie_id )->content_key );
+   BOOST_CHECK( !db_api.get_room_key_epoch( room, 3, bob_id ).valid() );
+
+   const auto& participants = db.get_index_type<room_participant_index>().indices().get<by_room_and_participant>();
+   BOOST_CHECK_EQUAL( "bob2", participants.find( boost::make_tuple( room, bob_id ) )->content_key );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( room_key_epoch_records_and_tables )
+{ try {
+   ACTORS( (alice)(bob)(dave) );
+
+   graphene::app::database_api db_api( db );
+
+   auto push = [this,&alice_private_key]( const operation& op ) {
+      trx.operations.push_back( op );
+      sign( trx, alice_private_key );
+      processed_transaction ptx = PUSH_TX( db, trx );
+      trx.clear();
+      return ptx.operation_results[0].get<object_id_type>();
+   };
+   auto keys = []( const vector<room_key_epoch_object>& epochs ) {
+      vector<string> result;
+      for( const auto& e : epochs )
+         result.push_back( std::to_string( e.epoch ) + ":" + e.content_key );
+      return result;
+   };
+   auto expected = []( std::initializer_list<string> l ) { return vector<string>( l ); };
+
+   room_create_operation create;
+   create.owner = alice_id;
+   create.name = "room";
+   create.room_key = "alice0";
+   room_id_type room = push( create );
+
+   room_add_participant_operation add;
+   add.owner = alice_id;
+   add.room = room;
+   add.participant = bob_id;
+   add.content_key = "bob0";
+   push( add );
+
+   room_rotate_key_operation rotate;
+   rotate.owner = alice_id;
+   rotate.room = room;
+   rotate.new_room_key = "alice1";
+   rotate.participant_keys = { { alice_id, "alice1" }, { bob_id, "bob1" } };
+   push( rotate );
+
+   // bob removed and added again in epoch 1: the key of the re-add takes precedence over the table's
+   const auto& participants = db.get_index_type<room_participant_index>().indices().get<by_room_and_participant>();
+   room_remove_participant_operation remove;
+   remove.owner = alice_id;
+   remove.participant_id = participants.find( boost::make_tuple( room, bob_id ) )->id;
+   push( remove );
+   add.content_key = "bob1again";
+   push( add );
+
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, bob_id, 100 ) )
+                == expected( { "0:bob0", "1:bob1again" } ) );
+   BOOST_REQUIRE( db_api.get_room_key_epoch( room, 1, bob_id ).valid() );
+   BOOST_CHECK_EQUAL( "bob1again", db_api.get_room_key_epoch( room, 1, bob_id )->content_key );
+   BOOST_CHECK( db_api.get_room_key_epoch( room, 1, bob_id )->id.is<room_key_epoch_id_type>() );
+
+   rotate.new_room_key = "alice2";
+   rotate.participant_keys = { { alice_id, "alice2" }, { bob_id, "bob2" } };
+   push( rotate );
+   rotate.new_room_key = "alice3";
+   rotate.participant_keys = { { alice_id, "alice3" }, { bob_id, "bob3" } };
+   push( rotate );
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, bob_id, 100 ) )
+                == expected( { "0:bob0", "1:bob1again", "2:bob2", "3:bob3" } ) );
+
+   // dave added in epoch 3 with the keys of every past epoch, which are records only: they come back
+   // ordered by epoch, the current one last
+   add.participant = dave_id;
+   add.content_key = "dave3";
+   add.epoch_keys = { { 2, "dave2" }, { 0, "dave0" }, { 1, "dave1" } };
+   push( add );
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, dave_id, 100 ) )
+                == expected( { "0:dave0", "1:dave1", "2:dave2", "3:dave3" } ) );
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, dave_id, 2 ) ) == expected( { "0:dave0", "1:dave1" } ) );
+
+   // the next rotation's table follows dave's records
+   rotate.new_room_key = "alice4";
+   rotate.participant_keys = { { alice_id, "alice4" }, { bob_id, "bob4" }, { dave_id, "dave4" } };
+   push( rotate );
+   BOOST_CHECK( keys( db_api.get_room_key_epochs( room, dave_id, 100 ) )
+                == expected( { "0:dave0", "1:dave1", "2:dave2", "3:dave3", "4:dave4" } ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( room_pages )
+{ try {
+   ACTORS( (alice)(bob)(charlie)(dave)(edgar) );
+
+   graphene::app::database_api db_api( db );
+
+   auto push = [this]( const operation& op, const fc::ecc::private_key& key ) {
+      trx.operations.push_back( op );
+      sign( trx, key );
+      processed_transaction ptx = PUSH_TX( db, trx );
+      trx.clear();
+      return ptx.operation_results[0].get<object_id_type>();
+   };
+
+   room_create_operation create;
+   create.owner = alice_id;
+   create.room_key = "alice";
+   vector<room_id_type> rooms;
+   for( int i = 0; i < 5; ++i )
+   {
+      create.name = "room" + fc::to_string( i );
+      rooms.push_back( push( create, alice_private_key ) );
+      // rooms of another owner in between
+      create.owner = bob_id;
+      create.room_key = "bob";
+      push( create, bob_private_key );
+      create.owner = alice_id;
+      create.room_key = "alice";
+   }
+
+   // the pages of alice's rooms, walked by following next
+   vector<room_id_type> walked;
+   room_page page = db_api.get_rooms_by_owner( alice_id, room_id_type(), 2 );
+   BOOST_CHECK_EQUAL( page.rooms.size(), 2u );
+   for( uint32_t pages = 1; ; ++pages )
+   {
+      for( const auto& r : page.rooms )
+      {
+         BOOST_CHECK( r.owner == alice_id );
+         walked.push_back( room_id_type( r.id ) );
+      }
+      if( !page.next.valid() )
+      {
+         BOOST_CHECK_EQUAL( pages, 3u );
+         break;
+      }
+      BOOST_CHECK( *page.next == rooms[walked.size()] );
+      page = db_api.get_rooms_by_owner( alice_id, *page.next, 2 );
+   }
+   BOOST_CHECK( walked == rooms );
+
+   // a page ending at the last room has no next, and past it the page is empty
+   page = db_api.get_rooms_by_owner( alice_id, rooms[3], 2 );
+   BOOST_CHECK_EQUAL( page.rooms.size(), 2u );
+   BOOST_CHECK( !page.next.valid() );
+   page = db_api.get_rooms_by_owner( alice_id, room_id_type( rooms[4].instance.value + 1 ), 2 );
+   BOOST_CHECK( page.rooms.empty() );
+   BOOST_CHECK( !page.next.valid() );
+   page = db_api.get_rooms_by_owner( charlie_id, room_id_type(), 2 );
+   BOOST_CHECK( page.rooms.empty() );
+   BOOST_CHECK( !page.next.valid() );
+
+   room_add_participant_operation add;
+   add.owner = alice_id;
+   add.room = rooms[0];
+   for( const auto& p : { bob_id, charlie_id, dave_id, edgar_id } )
+   {
+      add.participant = p;
+      add.content_key = "key";
+      push( add, alice_private_key );
+   }
+
+   // alice, bob, charlie, dave and edgar
+   room_participant_page participants = db_api.get_room_participants( rooms[0], room_participant_id_type(), 2 );
+   BOOST_REQUIRE_EQUAL( participants.participants.size(), 2u );
+   BOOST_CHECK( participants.participants[0].participant == alice_id );
+   BOOST_CHECK( participants.participants[1].participant == bob_id );
+   BOOST_REQUIRE( participants.next.valid() );
+   BOOST_CHECK( (*participants.next)(db).participant == charlie_id );
+
+   // the next page starts after a participant removed since
+   room_remove_participant_operation remove;
+   remove.owner = alice_id;
+   remove.participant_id = *participants.next;
+   push( remove, alice_private_key );
+   participants = db_api.get_room_participants( rooms[0], *participants.next, 2 );
+   BOOST_REQUIRE_EQUAL( participants.participants.size(), 2u );
+   BOOST_CHECK( participants.participants[0].participant == dave_id );
+   BOOST_CHECK( participants.participants[1].participant == edgar_id );
+   BOOST_CHECK( !participants.next.valid() );
+
+   // a room without other participants
+   participants = db_api.get_room_participants( rooms[1], room_participant_id_type(), 2 );
+   BOOST_REQUIRE_EQUAL( participants.participants.size(), 1u );
+   BOOST_CHECK( !participants.next.valid() );
+
+   // the records of bob, in his own rooms and in alice's room
+   vector<room_id_type> bob_rooms;
+   participants = db_api.get_rooms_by_participant( bob_id, room_participant_id_type(), 4 );
+   while( true )
+   {
+      BOOST_CHECK_LE( participants.participants.size(), 4u );
+      for( const auto& p : participants.participants )
+      {
+         BOOST_CHECK( p.participant == bob_id );
+         bob_rooms.push_back( p.room );
+      }
+      if( !participants.next.valid() )
+         break;
+      participants = db_api.get_rooms_by_participant( bob_id, *participants.next, 4 );
+   }
+   BOOST_CHECK_EQUAL( bob_rooms.size(), 6u );
+   BOOST_CHECK( std::find( bob_rooms.begin(), bob_rooms.end(), rooms[0] ) != bob_rooms.end() );
+} FC_LOG_AND_RETHROW() }
+
+// Queries served by the API read pool while blocks are applied, and subscriptions are switched on
+// and off on the API thread, only ever see the state between two state changes
+BOOST_AUTO_TEST_CASE( pooled_reads_never_see_half_applied_blocks )
+{ try {
+   ACTORS( (alice)(bob) );
+   const int64_t total = 1000000;
+   transfer( account_id_type(), alice_id, asset( total ) );
+   generate_block();
+
+   vector<object_id_type> block_state_ids = { dynamic_global_property_id_type() };
+   for( const auto& wid : db.get_global_properties().active_witnesses )
+      block_state_ids.push_back( wid );
+
+   // the pool must not outlive the fixture's database, whatever the checks do
+   struct pool_guard
+   {
+      explicit pool_guard( database& d ) : db( d ) { graphene::app::api_read_pool::start( db, 4 ); }
+      ~pool_guard() { graphene::app::api_read_pool::stop( db ); }
+      database& db;
+   } pool( db );
+
+   graphene::app::database_api db_api( db, &( app.get_options() ) );
+   const uint32_t clients = 4;
+   std::atomic<bool> stop{ false };
+   std::atomic<uint64_t> reads{ 0 };
+   std::atomic<uint64_t> unbalanced{ 0 };
+   std::atomic<uint64_t> unconfirmed{ 0 };
+   std::atomic<uint64_t> failures{ 0 };
+   std::vector<std::unique_ptr<fc::thread>> client_threads;
+   std::vector<fc::future<void>> client_loops;
+   for( uint32_t c = 0; c < clients; ++c )
+   {
+      client_threads.emplace_back( new fc::thread( "api_client_" + fc::to_string( c ) ) );
+      client_loops.push_back( client_threads.back()->async( [&]() {
+         while( !stop )
+         {
+            try {
+               // no core asset leaves the two accounts, a half-applied transfer would show less or more
+               int64_t sum = 0;
+               for( const auto& account : db_api.get_full_accounts( { "alice", "bob" }, true ) )
+                  for( const auto& balance : account.second.balances )
+                     if( balance.asset_type == asset_id_type() )
+                        sum += balance.balance.value;
+               if( sum != total )
+                  ++unbalanced;
+
+               // the head block is confirmed by its witness in the same state change that makes it the head
+               const auto objects = db_api.get_objects( block_state_ids, true );
+               const uint64_t head = objects[0].get_object()["head_block_number"].as_uint64();
+               uint64_t confirmed = 0;
+               for( size_t i = 1; i < objects.size(); ++i )
+                  confirmed = std::max( confirmed, objects[i].get_object()["last_confirmed_block_num"].as_uint64() );
+               if( confirmed != head )
+                  ++unconfirmed;
+               ++reads;
+            } catch( const fc::exception& e ) {
+               edump( (e.to_detail_string()) );
+               ++failures;
+            }
+         }
+      } ) );
+   }
+
+   auto noop = []( const variant& ) {};
+   for( uint32_t b = 0; b < 50 || ( reads < 100 && b < 1000 ); ++b )
+   {
+      transfer( alice_id, bob_id, asset( 2 + b ) );
+      transfer( bob_id, alice_id, asset( 1 + b ) );
+      if( b % 2 == 0 )
+         db_api.set_subscribe_callback( noop, false );
+      else
+         db_api.cancel_all_subscriptions();
+      generate_block();
+   }
+   stop = true;
+   for( auto& loop : client_loops )
+      loop.wait();
+   for( auto& thread : client_threads )
+      thread->quit();
+
+   BOOST_TEST_MESSAGE( "Checked " + fc::to_string( reads.load() ) + " reads" );
+   BOOST_CHECK_EQUAL( unbalanced.load(), 0u );
+   BOOST_CHECK_EQUAL( unconfirmed.load(), 0u );
+   BOOST_CHECK_EQUAL( failures.load(), 0u );
+   BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ) + get_balance( bob_id, asset_id_type() ), total );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -281,4 +281,52 @@ BOOST_AUTO_TEST_CASE( required_approval_index_test ) // see https://github.com/b
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( account_member_index_test )
+{ try {
+   ACTORS( (alice)(bob)(charlie) );
+
+   const auto& members = db.get_index_type< primary_index< account_index > >()
+                           .get_secondary_index< account_member_index >();
+   const public_key_type new_key = generate_private_key( "new_key" ).get_public_key();
+   auto key_references = [&members]( const public_key_type& key ) {
+      auto itr = members.account_to_key_memberships.find( key );
+      return itr == members.account_to_key_memberships.end() ? 0u : itr->second.size();
+   };
+   auto account_references = [&members]( account_id_type account ) {
+      auto itr = members.account_to_account_memberships.find( account );
+      return itr == members.account_to_account_memberships.end() ? 0u : itr->second.size();
+   };
+
+   BOOST_CHECK_EQUAL( 1u, key_references( alice_private_key.get_public_key() ) );
+   BOOST_CHECK_EQUAL( 0u, account_references( bob_id ) );
+
+   // modifications leaving the authorities and memo key alone do not change the memberships
+   db.modify( alice_id(db), []( account_object& a ) {
+      ++a.num_committee_voted;
+   });
+   BOOST_CHECK_EQUAL( 1u, key_references( alice_private_key.get_public_key() ) );
+
+   // authorities
+   db.modify( alice_id(db), [bob_id,&new_key]( account_object& a ) {
+      a.active.add_authority( bob_id, 1 );
+      a.owner.add_authority( new_key, 1 );
+   });
+   BOOST_CHECK_EQUAL( 1u, account_references( bob_id ) );
+   BOOST_CHECK_EQUAL( 1u, key_references( new_key ) );
+
+   // memo key
+   db.modify( charlie_id(db), [&new_key]( account_object& a ) {
+      a.options.memo_key = new_key;
+   });
+   BOOST_CHECK_EQUAL( 2u, key_references( new_key ) );
+
+   db.modify( alice_id(db), [bob_id,&new_key]( account_object& a ) {
+      a.active.account_auths.erase( bob_id );
+      a.owner.key_auths.erase( new_key );
+   });
+   BOOST_CHECK_EQUAL( 0u, account_references( bob_id ) );
+   BOOST_CHECK_EQUAL( 1u, key_references( new_key ) );
+   BOOST_CHECK_EQUAL( 1u, key_references( alice_private_key.get_public_key() ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -197,6 +197,69 @@ BOOST_AUTO_TEST_CASE(asset_claim_pool_test)
     FC_LOG_AND_RETHROW()
 }
 
+// Fees paid within a block are applied to the fee counters after its transactions; the counters
+// must end up as when every fee is applied at once, including when read by later transactions
+BOOST_AUTO_TEST_CASE( block_fee_counters_test )
+{ try {
+   ACTORS((actanet)(bob));
+
+   const share_type core_prec = asset::scaled_precision( asset_id_type()(db).precision );
+   const asset_object& actanetusd = create_user_issued_asset( "NATHNAUSD", actanet, 0 );
+   asset_id_type actanetusd_id = actanetusd.id;
+   issue_uia( actanet, actanetusd.amount( 100000000 ) );
+   transfer( committee_account, actanet_id, asset( 10000 * core_prec ) );
+   fund_fee_pool( actanet_id(db), actanetusd_id(db), 1000 * core_prec );
+   generate_block();
+
+   enable_fees();
+
+   // transfers paying their fee from the fee pool
+   for( int i = 0; i < 10; ++i )
+   {
+      transfer_operation op;
+      op.from = actanet_id;
+      op.to = bob_id;
+      op.amount = asset( 1000 + i, actanetusd_id );
+      signed_transaction tx;
+      tx.operations.push_back( op );
+      db.current_fee_schedule().set_fee( tx.operations.back(), actanetusd_id(db).options.core_exchange_rate );
+      set_expiration( db, tx );
+      sign( tx, actanet_private_key );
+      PUSH_TX( db, tx );
+   }
+
+   // the fees accumulated so far are claimed in the same block
+   const share_type accumulated = actanetusd_id(db).dynamic_asset_data_id(db).accumulated_fees;
+   BOOST_REQUIRE( accumulated > 0 );
+   {
+      asset_claim_fees_operation claim;
+      claim.issuer = actanet_id;
+      claim.amount_to_claim = asset( accumulated, actanetusd_id );
+      signed_transaction tx;
+      tx.operations.push_back( claim );
+      db.current_fee_schedule().set_fee( tx.operations.back() );
+      set_expiration( db, tx );
+      sign( tx, actanet_private_key );
+      PUSH_TX( db, tx );
+   }
+
+   // and the fees paid by actanet so far are processed by an upgrade
+   BOOST_REQUIRE( actanet_id(db).statistics(db).has_pending_fees() );
+   upgrade_to_lifetime_member( actanet_id );
+
+   const share_type fee_pool = actanetusd_id(db).dynamic_asset_data_id(db).fee_pool;
+   BOOST_CHECK( fee_pool < 1000 * core_prec );
+
+   generate_block();
+
+   const auto& usd_data = actanetusd_id(db).dynamic_asset_data_id(db);
+   BOOST_CHECK_EQUAL( usd_data.accumulated_fees.value, 0 );
+   BOOST_CHECK_EQUAL( usd_data.fee_pool.value, fee_pool.value );
+   const auto& stats = actanet_id(db).statistics(db);
+   BOOST_CHECK_EQUAL( stats.pending_fees.value, 0 );
+   BOOST_CHECK_EQUAL( stats.pending_vested_fees.value, 0 );
+} FC_LOG_AND_RETHROW() }
+
 ///////////////////////////////////////////////////////////////
 // cashback_test infrastructure                              //
 ///////////////////////////////////////////////////////////////
@@ -84,4 +84,76 @@ BOOST_AUTO_TEST_CASE(get_account_history) {
    }
 }
 
+BOOST_AUTO_TEST_CASE(get_account_history_operations) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      auto actanet = create_account("actanet");
+      create_user_issued_asset("USD", actanet, 0);
+      create_account("dan");
+      create_account("bob");
+
+      generate_block();
+      fc::usleep(fc::milliseconds(2000));
+
+      int asset_create_op_id = operation::tag<asset_create_operation>::value;
+      int account_create_op_id = operation::tag<account_create_operation>::value;
+
+      // typed queries return what filtering the whole history would
+      for( const string& account : { string("1.2.0"), string("actanet"), string("bob") } )
+      {
+         const auto all = hist_api.get_account_history(account, operation_history_id_type(), 100, operation_history_id_type());
+         for( int op_type : { account_create_op_id, asset_create_op_id } )
+         {
+            vector<operation_history_id_type> expected;
+            for( const auto& o : all )
+               if( o.op.which() == op_type )
+                  expected.push_back( o.id );
+            const auto typed = hist_api.get_account_history_operations(account, op_type, operation_history_id_type(),
+                                                                       operation_history_id_type(), 100);
+            BOOST_REQUIRE_EQUAL(typed.size(), expected.size());
+            for( size_t i = 0; i < typed.size(); ++i )
+               BOOST_CHECK( typed[i].id == expected[i] );
+         }
+      }
+
+      //account_id_type() did 3 account_create ops, including id0
+      auto histories = hist_api.get_account_history_operations("1.2.0", account_create_op_id, operation_history_id_type(),
+                                                               operation_history_id_type(), 100);
+      BOOST_REQUIRE_EQUAL(histories.size(), 3u);
+      BOOST_CHECK_EQUAL(histories[2].id.instance(), 0u);
+
+      // limit and start page through the operations from the most recent one
+      auto page = hist_api.get_account_history_operations("1.2.0", account_create_op_id, operation_history_id_type(),
+                                                          operation_history_id_type(), 2);
+      BOOST_REQUIRE_EQUAL(page.size(), 2u);
+      BOOST_CHECK( page[0].id == histories[0].id );
+      page = hist_api.get_account_history_operations("1.2.0", account_create_op_id, histories[1].id,
+                                                     operation_history_id_type(), 100);
+      BOOST_REQUIRE_EQUAL(page.size(), 2u);
+      BOOST_CHECK( page[0].id == histories[1].id );
+
+      // stop excludes the operations up to it
+      page = hist_api.get_account_history_operations("1.2.0", account_create_op_id, operation_history_id_type(),
+                                                     operation_history_id_type(1), 100);
+      BOOST_CHECK_EQUAL(page.size(), 2u);
+
+      // the same index serves get_account_history_by_operations
+      auto detail = hist_api.get_account_history_by_operations("actanet", { uint16_t(asset_create_op_id) }, 1, 100);
+      BOOST_REQUIRE_EQUAL(detail.operation_history_objs.size(), 1u);
+      BOOST_CHECK_EQUAL(detail.operation_history_objs[0].op.which(), asset_create_op_id);
+      const auto all = hist_api.get_account_history_by_operations("actanet", {}, 1, 100);
+      BOOST_CHECK_EQUAL(detail.total_count, all.total_count);
+      detail = hist_api.get_account_history_by_operations("actanet",
+            { uint16_t(asset_create_op_id), uint16_t(account_create_op_id) }, 1, 100);
+      BOOST_REQUIRE_EQUAL(detail.operation_history_objs.size(), all.operation_history_objs.size());
+      for( size_t i = 0; i < detail.operation_history_objs.size(); ++i )
+         BOOST_CHECK( detail.operation_history_objs[i].id == all.operation_history_objs[i].id );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()